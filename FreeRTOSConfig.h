@@ -119,6 +119,14 @@ void vPostSleepProcessing( unsigned long );
 #define configPOST_SLEEP_PROCESSING( idletime ) vPostSleepProcessing( idletime );
 #endif
 
+/* heap_2 does not record its low-water mark, track it for the "mem" command */
+#if defined(MEM_STATS) && (MEM_STATS == 1)
+#ifndef __ASSEMBLER__
+void MemStatsHeapTrace(void);
+#define traceMALLOC( pvAddress, uiSize ) MemStatsHeapTrace()
+#endif
+#endif
+
 /* FreeRTOS+CLI requires this size to be defined, but we do not use it */
 #define configCOMMAND_INT_MAX_OUTPUT_SIZE 1
 
@@ -66,6 +66,10 @@ ifneq ($(DEBUG),0)
 CFG_DEV         += WSF_BUF_STATS=1
 CFG_DEV         += WSF_ASSERT_ENABLED=1
 endif
+ifeq ($(BUF_STATS),1)
+CFG_DEV         += WSF_BUF_STATS=1
+CFG_DEV         += WSF_BUF_STATS_HIST=1
+endif
 ifeq ($(TRACE),1)
 CFG_DEV         += WSF_TRACE_ENABLED=1
 endif
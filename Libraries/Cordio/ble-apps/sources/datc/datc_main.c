@@ -1010,6 +1010,12 @@ static void datcDiscCback(dmConnId_t connId, uint8_t status)
         /* store cached handle list in NVM */
         AppDbNvmStoreHdlList(AppDbGetHdl(connId));
 
+        /* store handle list shared by servers with the same database hash in NVM */
+        if (AppDbGetHdl(connId) != APP_DB_HDL_NONE)
+        {
+          AppDbNvmStoreHashHdlList(AppDbGetPeerDbHash(AppDbGetHdl(connId)));
+        }
+
         /* start configuration */
         AppDiscConfigure(connId, APP_DISC_CFG_START, DATC_DISC_CFG_LIST_LEN,
                          (attcDiscCfg_t *) datcDiscCfgList, DATC_DISC_HDL_LIST_LEN, datcCb.hdlList[connId-1]);
@@ -194,7 +194,15 @@ static void sensorDmCback(dmEvt_t *pDmEvt)
 /*************************************************************************************************/
 static void sensorAttCback(attEvt_t *pEvt)
 {
-  return;
+  attEvt_t *pMsg;
+
+  if ((pMsg = WsfMsgAlloc(sizeof(attEvt_t) + pEvt->valueLen)) != NULL)
+  {
+    memcpy(pMsg, pEvt, sizeof(attEvt_t));
+    pMsg->pValue = (uint8_t *)(pMsg + 1);
+    memcpy(pMsg->pValue, pEvt->pValue, pEvt->valueLen);
+    WsfMsgSend(sensorHandlerId, pMsg);
+  }
 }
 
 /*************************************************************************************************/
@@ -402,6 +410,14 @@ static void sensorProcMsg(wsfMsgHdr_t *pMsg)
       break;
     }
 
+    case ATTS_HANDLE_VALUE_CNF:
+    {
+      /* send next batched samples */
+      GyroHandleValueCnf((attEvt_t *) pMsg);
+      TempHandleValueCnf((attEvt_t *) pMsg);
+      break;
+    }
+
     case SENSOR_GYRO_TIMER_IND:
     {
       dmConnId_t connId = AppConnIsOpen();
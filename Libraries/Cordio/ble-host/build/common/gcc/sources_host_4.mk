@@ -60,6 +60,7 @@ C_FILES += \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_main.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_priv.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan.c \
+	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan_filt.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan_leg.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_sec.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_sec_lesc.c \
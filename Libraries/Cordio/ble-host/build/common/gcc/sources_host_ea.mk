@@ -76,6 +76,7 @@ C_FILES += \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_phy.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_priv.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan.c \
+	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan_filt.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan_ae.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_scan_leg.c \
 	$(ROOT_DIR)/ble-host/sources/stack/dm/dm_sec.c \
@@ -151,8 +151,20 @@ typedef struct
   uint16_t          mtu;              /*!< \brief desired ATT MTU */
   uint8_t           transTimeout;     /*!< \brief transcation timeout in seconds */
   uint8_t           numPrepWrites;    /*!< \brief number of queued prepare writes supported by server */
+  uint16_t          prepWriteBufLen;  /*!< \brief length of the buffer that sequential prepare writes
+                                           to the same handle are appended to and executed from with
+                                           one write, or 0 to queue each prepare write separately */
 } attCfg_t;
 
+/*! \brief ATT server prepare write queue usage */
+typedef struct
+{
+  uint8_t           numWrites;        /*!< \brief Number of queued prepare writes */
+  uint16_t          valueLen;         /*!< \brief Bytes of queued prepare write values */
+  uint16_t          bufLen;           /*!< \brief Bytes of buffers holding queued prepare writes */
+  uint16_t          peakBufLen;       /*!< \brief Highest bufLen on the connection */
+} attsPrepWriteStats_t;
+
 /*! \brief EATT run-time configurable parameters */
 typedef struct
 {
@@ -769,7 +781,8 @@ uint8_t AttsGetCccTableLen(void);
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a response to a pending write request.  For use with ATT_RSP_PENDING.
+ *  \brief  Send a response to a pending write request.  For use with ATT_RSP_PENDING.  The
+ *          response is sent on the bearer the write request was received on.
  *
  *  \param  connId      Connection ID.
  *  \param  handle      Attribute handle.
@@ -784,6 +797,18 @@ uint8_t AttsGetCccTableLen(void);
 /*************************************************************************************************/
 void AttsContinueWriteReq(dmConnId_t connId, uint16_t handle, uint8_t status);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the prepare write queue usage of a connection.
+ *
+ *  \param  connId      Connection ID.
+ *  \param  pStats      Returns the queue usage.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AttsGetPrepWriteStats(dmConnId_t connId, attsPrepWriteStats_t *pStats);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Set the peer's data signing key on this connection.  This function
@@ -105,6 +105,16 @@ extern "C" {
 #define DM_SCAN_TYPE_ACTIVE         1     /*!< \brief Active scan */
 /**@}*/
 
+/** \name DM Scan Report Filter Rule Types
+ * Types of rules matched by the scan report filter.
+ */
+/**@{*/
+#define DM_SCAN_FILT_RULE_AD_TYPE   0     /*!< \brief AD type present */
+#define DM_SCAN_FILT_RULE_UUID16    1     /*!< \brief 16-bit service UUID listed or with service data */
+#define DM_SCAN_FILT_RULE_UUID128   2     /*!< \brief 128-bit service UUID listed or with service data */
+#define DM_SCAN_FILT_RULE_MFR_ID    3     /*!< \brief Manufacturer specific data company ID */
+/**@}*/
+
 /** \name GAP Advertising Channel Map
  * Advertising channel map codes
  */
@@ -861,6 +871,25 @@ typedef struct
 /*! \brief Callback type. */
 typedef void (*dmCback_t)(dmEvt_t *pDmEvt);
 
+/*! \brief Scan report filter rule. */
+typedef struct
+{
+  uint8_t         type;           /*!< \brief Rule type */
+  uint8_t         adType;         /*!< \brief AD type, for \ref DM_SCAN_FILT_RULE_AD_TYPE */
+  uint16_t        id;             /*!< \brief 16-bit UUID or company ID */
+  const uint8_t   *pUuid128;      /*!< \brief 128-bit UUID, little endian */
+} dmScanFiltRule_t;
+
+/*! \brief Scan report filter configuration. */
+typedef struct
+{
+  const dmScanFiltRule_t *pRules; /*!< \brief Rules, a report matching any rule passes */
+  uint8_t         numRules;       /*!< \brief Number of rules, 0 to pass all reports */
+  int8_t          rssiMin;        /*!< \brief Reports with a lower RSSI are dropped */
+  uint8_t         rssiDelta;      /*!< \brief RSSI change that passes a report with unchanged data */
+  bool_t          aggregate;      /*!< \brief TRUE to pass only new or changed reports from a device */
+} dmScanFiltCfg_t;
+
 /**************************************************************************************************
   Function Declarations
 **************************************************************************************************/
@@ -965,6 +994,26 @@ void DmAdvConfig(uint8_t advHandle, uint8_t advType, uint8_t peerAddrType, uint8
 /*************************************************************************************************/
 void DmAdvSetData(uint8_t advHandle, uint8_t op, uint8_t location, uint8_t len, uint8_t *pData);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Send a change to advertising or scan response data already set.  With extended
+ *          advertising only the changed bytes are sent to the controller if it supports the
+ *          vendor specific patch command, otherwise the complete data is set again.  Legacy
+ *          advertising data and data longer than one HCI command cannot be patched.
+ *
+ *  \param  advHandle     Advertising handle.
+ *  \param  location      Data location.
+ *  \param  offset        Offset of the changed bytes in the data.
+ *  \param  len           Number of changed bytes.
+ *  \param  dataLen       Length of the data.
+ *  \param  pData         Pointer to the data, already changed.
+ *
+ *  \return TRUE if the change is sent, FALSE if the data must be set again with DmAdvSetData().
+ */
+/*************************************************************************************************/
+bool_t DmAdvPatchData(uint8_t advHandle, uint8_t location, uint16_t offset, uint8_t len,
+                      uint16_t dataLen, uint8_t *pData);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Start advertising using the given advertising set and duration.
@@ -1632,6 +1681,31 @@ void DmScanSetInterval(uint8_t scanPhys, uint16_t *pScanInterval, uint16_t *pSca
 /*************************************************************************************************/
 void DmScanSetAddrType(uint8_t addrType);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Filter scan reports before they are passed to the client.  The rules are compiled
+ *          into tables matched in one pass over the advertising data.  With aggregation only the
+ *          first report from a device and reports with changed data or RSSI are passed.  Each
+ *          device is tracked again when scanning starts.
+ *
+ *  \param  pCfg      Filter configuration.
+ *
+ *  \return TRUE if successful, FALSE if the rules do not fit in the filter tables.
+ *
+ *  \note   Fragmented extended reports are matched by their first fragment.
+ */
+/*************************************************************************************************/
+bool_t DmScanFiltSet(const dmScanFiltCfg_t *pCfg);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Stop filtering scan reports.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void DmScanFiltClear(void);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Synchronize with periodic advertising from the given advertiser, and start receiving
@@ -999,6 +999,17 @@ typedef union
   HciLeBigInfoAdvRptEvt_t             leBigInfoAdvRpt;             /*!< \brief LE BIG info advertising report. */
 } hciEvt_t;
 
+/*! \brief Per-connection ACL transmit statistics */
+typedef struct
+{
+  uint32_t          txPkts;                       /*!< \brief ACL packets started toward the controller */
+  uint32_t          txWaitSum;                    /*!< \brief Sum of queueing delay, in controller buffers sent ahead */
+  uint8_t           txWaitMax;                    /*!< \brief Maximum queueing delay, in controller buffers sent ahead */
+  uint8_t           queuedBufs;                   /*!< \brief ACL buffers currently queued or outstanding */
+  uint8_t           maxQueuedBufs;                /*!< \brief Peak ACL buffers queued or outstanding */
+  uint8_t           outBufs;                      /*!< \brief ACL buffers currently outstanding at the controller */
+} hciAclTxStats_t;
+
 /*! \} */    /* STACK_HCI_EVT_API */
 
 /*! \addtogroup STACK_HCI_CMD_API
@@ -1579,6 +1590,18 @@ hciLocalVerInfo_t *HciGetLocalVerInfo(void);
  */
 /*************************************************************************************************/
 void HciSendAclData(uint8_t *pAclData);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get ACL transmit statistics for a connection.
+ *
+ *  \param  handle      Connection handle.
+ *  \param  pStats      Storage for statistics.
+ *
+ *  \return TRUE if connection found, FALSE otherwise.
+ */
+/*************************************************************************************************/
+bool_t HciGetAclTxStats(uint16_t handle, hciAclTxStats_t *pStats);
 /**@}*/
 
 /*! \} */    /* STACK_HCI_ACL_API */
@@ -2416,6 +2439,22 @@ void HciLeSetExtAdvDataCmd(uint8_t advHandle, uint8_t op, uint8_t fragPref, uint
 void HciLeSetExtScanRespDataCmd(uint8_t advHandle, uint8_t op, uint8_t fragPref, uint8_t len,
                                 const uint8_t *pData);
 
+/*************************************************************************************************/
+/*!
+ *  \brief      HCI vendor specific patch extended advertising data command.
+ *
+ *  \param      advHandle    Advertising handle.
+ *  \param      scanRsp      TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset       Offset of the changed bytes in the data.
+ *  \param      len          Number of changed bytes.
+ *  \param      pData        Changed bytes.
+ *
+ *  \return     None.
+ */
+/*************************************************************************************************/
+void HciVsPatchExtAdvDataCmd(uint8_t advHandle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                             const uint8_t *pData);
+
 /*************************************************************************************************/
 /*!
  *  \brief      HCI LE set extended advertising enable command.
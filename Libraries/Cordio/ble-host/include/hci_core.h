@@ -59,6 +59,8 @@ typedef struct
   bool_t            flowDisabled;                 /*!< \brief TRUE if data flow disabled */
   uint8_t           queuedBufs;                   /*!< \brief Queued ACL buffers on this connection */
   uint8_t           outBufs;                      /*!< \brief Outstanding ACL buffers sent to controller */
+  wsfQueue_t        txQueue;                      /*!< \brief ACL TX queue for this connection */
+  hciAclTxStats_t   txStats;                      /*!< \brief ACL TX statistics */
 } hciCoreConn_t;
 
 /*! \brief Per-connection structure for OSI packet accounting */
@@ -74,7 +76,6 @@ typedef struct
   hciCoreCis_t      cis[DM_CIS_MAX];              /*!< \brief CIS structures */
   uint8_t           leStates[HCI_LE_STATES_LEN];  /*!< \brief Controller LE supported states */
   bdAddr_t          bdAddr;                       /*!< \brief Bluetooth device address */
-  wsfQueue_t        aclQueue;                     /*!< \brief HCI ACL TX queue */
   hciCoreConn_t     *pConnRx;                     /*!< \brief Connection struct for current transport RX packet */
   uint16_t          maxRxAclLen;                  /*!< \brief Maximum reassembled RX ACL packet length */
   uint16_t          bufSize;                      /*!< \brief Controller ACL data buffer size */
@@ -82,6 +83,8 @@ typedef struct
   uint8_t           aclQueueLo;                   /*!< \brief Enable flow when this many ACL buffers queued */
   uint8_t           availBufs;                    /*!< \brief Current avail ACL data buffers */
   uint8_t           numBufs;                      /*!< \brief Controller number of ACL data buffers */
+  uint8_t           txNextConn;                   /*!< \brief Next connection index to service for ACL TX */
+  uint8_t           txBufSeq;                     /*!< \brief ACL buffers sent to controller, modulo 256 */
   uint8_t           whiteListSize;                /*!< \brief Controller white list size */
   uint8_t           numCmdPkts;                   /*!< \brief Controller command packed count */
   uint64_t          leSupFeat;                    /*!< \brief Controller LE supported features */
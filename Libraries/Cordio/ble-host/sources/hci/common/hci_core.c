@@ -173,6 +173,8 @@ static void hciCoreConnAlloc(uint16_t handle)
       pConn->flowDisabled = FALSE;
       pConn->outBufs = 0;
       pConn->queuedBufs = 0;
+      WSF_QUEUE_INIT(&pConn->txQueue);
+      memset(&pConn->txStats, 0, sizeof(pConn->txStats));
 
       return;
     }
@@ -194,6 +196,8 @@ static void hciCoreConnFree(uint16_t handle)
 {
   uint8_t         i;
   hciCoreConn_t   *pConn = hciCoreCb.conn;
+  uint8_t         *pData;
+  wsfHandlerId_t  handlerId;
 
   /* find connection struct */
   for (i = DM_CONN_MAX; i > 0; i--, pConn++)
@@ -217,7 +221,11 @@ static void hciCoreConnFree(uint16_t handle)
       /* free structure */
       pConn->handle = HCI_HANDLE_NONE;
 
-      /* optional: iterate through tx ACL queue and free any buffers with this handle */
+      /* free any queued tx ACL packets */
+      while ((pData = WsfMsgDeq(&pConn->txQueue, &handlerId)) != NULL)
+      {
+        WsfMsgFree(pData);
+      }
 
       /* outstanding buffers are now available; service TX data path */
       hciCoreTxReady(pConn->outBufs);
@@ -279,6 +287,44 @@ static hciCoreConn_t *hciCoreNextConnFragment(void)
   return NULL;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the next connection structure ready to send an ACL buffer, in round-robin order.
+ *
+ *  \return Pointer to connection structure or NULL if not found.
+ */
+/*************************************************************************************************/
+static hciCoreConn_t *hciCoreNextConnTx(void)
+{
+  uint8_t         i;
+  uint8_t         idx = hciCoreCb.txNextConn;
+  hciCoreConn_t   *pConn;
+
+  for (i = DM_CONN_MAX; i > 0; i--)
+  {
+    pConn = &hciCoreCb.conn[idx];
+
+    if (++idx >= DM_CONN_MAX)
+    {
+      idx = 0;
+    }
+
+    if (pConn->handle != HCI_HANDLE_NONE)
+    {
+      /* ready if a fragment remains or, once the current packet is done, a new packet is queued */
+      if ((pConn->fragmenting && (pConn->txAclRemLen > 0)) ||
+          (!pConn->fragmenting && !WsfQueueEmpty(&pConn->txQueue)))
+      {
+        /* next search begins after this connection */
+        hciCoreCb.txNextConn = idx;
+        return pConn;
+      }
+    }
+  }
+
+  return NULL;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Perform internal processing on HCI connection open.
@@ -438,6 +484,9 @@ void hciCoreSendAclData(hciCoreConn_t *pConn, uint8_t *pData)
   /* increment outstanding buf count for handle */
   pConn->outBufs++;
 
+  /* advance sequence used to measure queueing delay */
+  hciCoreCb.txBufSeq++;
+
   /* send to transport */
   hciTrSendAclData(pConn, pData);
 
@@ -464,9 +513,9 @@ void hciCoreSendAclData(hciCoreConn_t *pConn, uint8_t *pData)
 void hciCoreTxReady(uint8_t bufs)
 {
   uint8_t         *pData;
-  wsfHandlerId_t  handlerId;
-  uint16_t        handle;
+  wsfHandlerId_t  seq;
   uint16_t        len;
+  uint8_t         wait;
   hciCoreConn_t   *pConn;
 
   /* increment available buffers, with ceiling */
@@ -479,38 +528,30 @@ void hciCoreTxReady(uint8_t bufs)
     }
   }
 
-  /* service ACL data queue and send as many buffers as we can */
-  while (hciCoreCb.availBufs > 0)
+  /* send one buffer per ready connection in turn while controller buffers are available */
+  while ((hciCoreCb.availBufs > 0) && ((pConn = hciCoreNextConnTx()) != NULL))
   {
-    /* send continuation of any fragments first */
-    if (hciCoreTxAclContinue(NULL) == FALSE)
+    /* send continuation of a fragmented packet */
+    if (pConn->fragmenting)
     {
-      /* if no fragments then check for any queued ACL data */
-      if ((pData = WsfMsgDeq(&hciCoreCb.aclQueue, &handlerId)) != NULL)
-      {
-        /* parse handle and length */
-        BYTES_TO_UINT16(handle, pData);
-        BYTES_TO_UINT16(len, &pData[2]);
-
-        /* look up conn structure and send data */
-        if ((pConn = hciCoreConnByHandle(handle)) != NULL)
-        {
-          hciCoreTxAclStart(pConn, len, pData);
-        }
-        /* handle not found, connection must be closed */
-        else
-        {
-          /* discard buffer */
-          WsfMsgFree(pData);
+      hciCoreTxAclContinue(pConn);
+    }
+    /* else start next queued packet */
+    else
+    {
+      pData = WsfMsgDeq(&pConn->txQueue, &seq);
 
-          HCI_TRACE_WARN1("hciCoreTxReady discarding buffer, handle=%u", handle);
-        }
-      }
-      else
+      /* queueing delay is the number of buffers sent since this packet was queued */
+      wait = hciCoreCb.txBufSeq - (uint8_t) seq;
+      pConn->txStats.txPkts++;
+      pConn->txStats.txWaitSum += wait;
+      if (wait > pConn->txStats.txWaitMax)
       {
-        /* no fragments or queued data to send; we're done */
-        break;
+        pConn->txStats.txWaitMax = wait;
       }
+
+      BYTES_TO_UINT16(len, &pData[2]);
+      hciCoreTxAclStart(pConn, len, pData);
     }
   }
 }
@@ -553,11 +594,8 @@ void hciCoreTxAclStart(hciCoreConn_t *pConn, uint16_t len, uint8_t *pData)
     /* set acl len in packet to hci acl buf len */
     UINT16_TO_BUF(&pData[2], hciLen);
 
-    /* send the packet */
+    /* send the packet; additional fragments are sent by hciCoreTxReady() */
     hciCoreSendAclData(pConn, pData);
-
-    /* send additional fragments while there are HCI buffers available */
-    while ((hciCoreCb.availBufs > 0) && hciCoreTxAclContinue(pConn));
   }
   else
   {
@@ -815,8 +853,6 @@ void HciCoreInit(void)
 {
   uint8_t   i;
 
-  WSF_QUEUE_INIT(&hciCoreCb.aclQueue);
-
   for (i = 0; i < DM_CONN_MAX; i++)
   {
     hciCoreCb.conn[i].handle = HCI_HANDLE_NONE;
@@ -830,6 +866,8 @@ void HciCoreInit(void)
   hciCoreCb.maxRxAclLen = HCI_MAX_RX_ACL_LEN;
   hciCoreCb.aclQueueHi = HCI_ACL_QUEUE_HI;
   hciCoreCb.aclQueueLo = HCI_ACL_QUEUE_LO;
+  hciCoreCb.txNextConn = 0;
+  hciCoreCb.txBufSeq = 0;
   hciCoreCb.extResetSeq = NULL;
 
   hciCoreInit();
@@ -953,27 +991,26 @@ void HciSendAclData(uint8_t *pData)
   /* look up connection structure */
   if ((pConn = hciCoreConnByHandle(handle)) != NULL)
   {
-    /* if queue empty and buffers available */
-    if (WsfQueueEmpty(&hciCoreCb.aclQueue) && hciCoreCb.availBufs > 0)
-    {
-      /* send data */
-      hciCoreTxAclStart(pConn, len, pData);
-    }
-    else
-    {
-      /* queue data - message handler ID 'handerId' not used */
-      WsfMsgEnq(&hciCoreCb.aclQueue, 0, pData);
-    }
+    /* queue data on connection, stamped with the current buffer sequence */
+    WsfMsgEnq(&pConn->txQueue, hciCoreCb.txBufSeq, pData);
 
     /* increment buffer queue count for this connection with consideration for HCI fragmentation */
     pConn->queuedBufs += ((len - 1) / HciGetBufSize()) + 1;
 
+    if (pConn->queuedBufs > pConn->txStats.maxQueuedBufs)
+    {
+      pConn->txStats.maxQueuedBufs = pConn->queuedBufs;
+    }
+
     /* manage flow control to stack */
     if (pConn->queuedBufs >= hciCoreCb.aclQueueHi && pConn->flowDisabled == FALSE)
     {
       pConn->flowDisabled = TRUE;
       (*hciCb.flowCback)(handle, TRUE);
     }
+
+    /* send data if buffers available */
+    hciCoreTxReady(0);
   }
   /* connection not found, connection must be closed */
   else
@@ -984,3 +1021,29 @@ void HciSendAclData(uint8_t *pData)
     HCI_TRACE_WARN1("HciSendAclData discarding buffer, handle=%u", handle);
   }
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get ACL transmit statistics for a connection.
+ *
+ *  \param  handle      Connection handle.
+ *  \param  pStats      Storage for statistics.
+ *
+ *  \return TRUE if connection found, FALSE otherwise.
+ */
+/*************************************************************************************************/
+bool_t HciGetAclTxStats(uint16_t handle, hciAclTxStats_t *pStats)
+{
+  hciCoreConn_t   *pConn;
+
+  if ((pConn = hciCoreConnByHandle(handle)) != NULL)
+  {
+    *pStats = pConn->txStats;
+    pStats->queuedBufs = pConn->queuedBufs;
+    pStats->outBufs = pConn->outBufs;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
@@ -164,6 +164,37 @@ void HciLeSetExtScanRespDataCmd(uint8_t advHandle, uint8_t op, uint8_t fragPref,
   }
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      HCI vendor specific patch extended advertising data command.
+ *
+ *  \param      advHandle    Advertising handle.
+ *  \param      scanRsp      TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset       Offset of the changed bytes in the data.
+ *  \param      len          Number of changed bytes.
+ *  \param      pData        Changed bytes.
+ *
+ *  \return     None.
+ */
+/*************************************************************************************************/
+void HciVsPatchExtAdvDataCmd(uint8_t advHandle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                             const uint8_t *pData)
+{
+  uint8_t *pBuf;
+  uint8_t *p;
+
+  if ((pBuf = hciCmdAlloc(HCI_OPCODE_VS_PATCH_EXT_ADV_DATA, HCI_LEN_VS_PATCH_EXT_ADV_DATA(len))) != NULL)
+  {
+    p = pBuf + HCI_CMD_HDR_LEN;
+    UINT8_TO_BSTREAM(p, advHandle);
+    UINT8_TO_BSTREAM(p, scanRsp);
+    UINT16_TO_BSTREAM(p, offset);
+    UINT8_TO_BSTREAM(p, len);
+    memcpy(p, pData, len);
+    hciCmdSend(pBuf);
+  }
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      HCI LE set extended advertising enable command.
@@ -30,6 +30,7 @@
 #include "hci_api.h"
 #include "hci_main.h"
 #include "wsf_assert.h"
+#include "wsf_trace.h"
 
 #include "ll_api.h"
 
@@ -101,6 +102,30 @@ void HciLeSetExtScanRespDataCmd(uint8_t advHandle, uint8_t op, uint8_t fragPref,
   LlSetExtScanRespData(advHandle, op, fragPref, len, pData);
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      HCI vendor specific patch extended advertising data command.
+ *
+ *  \param      advHandle    Advertising handle.
+ *  \param      scanRsp      TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset       Offset of the changed bytes in the data.
+ *  \param      len          Number of changed bytes.
+ *  \param      pData        Changed bytes.
+ *
+ *  \return     None.
+ */
+/*************************************************************************************************/
+void HciVsPatchExtAdvDataCmd(uint8_t advHandle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                             const uint8_t *pData)
+{
+  uint8_t status = LlPatchExtAdvData(advHandle, scanRsp, offset, len, pData);
+
+  if (status != LL_SUCCESS)
+  {
+    HCI_TRACE_WARN1("HciVsPatchExtAdvDataCmd failed, status=0x%02x", status);
+  }
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      HCI LE set extended advertising enable command.
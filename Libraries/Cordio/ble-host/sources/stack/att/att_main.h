@@ -100,6 +100,7 @@ typedef struct
 typedef struct
 {
   uint16_t          mtu;               /* connection mtu */
+  uint16_t          pendWriteHandle;   /* Attribute handle of pending ATTS write rsp */
   uint8_t           control;           /* Control bitfield */
 } attSccb_t;
 
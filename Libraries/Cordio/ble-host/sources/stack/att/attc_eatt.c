@@ -39,6 +39,18 @@
 #include "att_main.h"
 #include "attc_main.h"
 
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* EATT API message, queued until a bearer is free */
+typedef struct
+{
+  attcApiMsg_t  msg;          /* API message */
+  uint16_t      dataLen;      /* Length of value data */
+  uint8_t       priority;     /* Operation priority */
+} eattcPendMsg_t;
+
 /**************************************************************************************************
   Function Prototypes
 **************************************************************************************************/
@@ -62,45 +74,112 @@ static const eattFcnIf_t attcFcnIf =
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get a channel for transmission of an EATT client message.
+ *  \brief  Check whether a bearer can carry an EATT client message.
+ *
+ *  \param  connId      DM connection ID.
+ *  \param  slot        Slot ID.
+ *  \param  priority    Operation priority.
+ *  \param  dataLen     Length of value data.
+ *
+ *  \return TRUE if the bearer is open and its priority and MTU suit the message.
+ */
+/*************************************************************************************************/
+static bool_t eattcSlotFits(dmConnId_t connId, uint8_t slot, uint8_t priority, uint16_t dataLen)
+{
+  attcCcb_t    *pCcb = attcCcbByConnId(connId, slot);
+  eattConnCb_t *pEattCcb;
+  eattChanCb_t *pChanCb;
+
+  if ((pCcb == NULL) || (pCcb->pMainCcb->sccb[slot].control & ATT_CCB_STATUS_TX_TIMEOUT))
+  {
+    return FALSE;
+  }
+
+  /* ATT bearer carries messages of any priority */
+  if (slot == ATT_BEARER_SLOT_ID)
+  {
+    return (pCcb->pMainCcb->sccb[slot].mtu >= dataLen);
+  }
+
+  if ((pEattCcb = eattGetConnCb(connId)) == NULL)
+  {
+    return FALSE;
+  }
+
+  pChanCb = &pEattCcb->pChanCb[slot - 1];
+
+  return (pChanCb->inUse && (pChanCb->priority >= priority) && (pChanCb->localMtu >= dataLen));
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get a free bearer for transmission of an EATT client message.  EATT channels are
+ *          used first, then the ATT bearer.  A bearer is free when no request is outstanding on
+ *          it and none has been sent to it for setting up.
  *
  *  \param  connId      DM connection ID.
  *  \param  priority    Operation priority.
  *  \param  dataLen     Length of value data.
  *
- *  \return Slot ID
+ *  \return Slot ID or ATT_BEARER_SLOT_INVALID if all suitable bearers are busy.
  */
 /*************************************************************************************************/
 static uint8_t eattcGetFreeSlot(dmConnId_t connId, uint8_t priority, uint16_t dataLen)
 {
-  eattConnCb_t *pEattCcb = eattGetConnCb(connId);
+  attcCcb_t *pCcb;
+  uint8_t   i;
 
-  if (pEattCcb)
+  for (i = 0; i < ATT_BEARER_MAX; i++)
   {
-    uint8_t i;
+    uint8_t slot = (i + 1) % ATT_BEARER_MAX;
 
-    for (i = 0; i < EATT_CONN_CHAN_MAX; i++)
+    if (eattcSlotFits(connId, slot, priority, dataLen))
     {
-      attcCcb_t  *pCcb;
-      uint8_t    slot = i + 1;
+      pCcb = attcCcbByConnId(connId, slot);
 
-      if ((pCcb = attcCcbByConnId(connId, slot)))
+      if ((pCcb->outReq.hdr.event == ATTC_MSG_API_NONE) && !pCcb->reserved &&
+          ((slot != ATT_BEARER_SLOT_ID) || (attcCb.onDeck[connId].hdr.event == ATTC_MSG_API_NONE)))
       {
-        eattChanCb_t *pChanCb = &pEattCcb->pChanCb[i];
-  
-        if (pChanCb->inUse && (pChanCb->priority >= priority) && (pChanCb->localMtu >= dataLen))
-        {
-          if (pCcb->outReq.hdr.event == ATTC_MSG_API_NONE)
-          {
-            EATT_TRACE_INFO1("eattcGetFreeSlot: allocating slot: %#x", slot);
-            return slot;
-          }
-        }
+        EATT_TRACE_INFO1("eattcGetFreeSlot: allocating slot: %#x", slot);
+        return slot;
       }
     }
   }
 
-  return ATT_BEARER_SLOT_ID;
+  return ATT_BEARER_SLOT_INVALID;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send queued EATT client messages to free bearers, in order.
+ *
+ *  \param  connId      DM connection ID.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void eattcDispatch(dmConnId_t connId)
+{
+  eattcPendMsg_t  *pMsg;
+  wsfHandlerId_t  handlerId;
+  uint8_t         slot;
+
+  while ((pMsg = WsfMsgPeek(&attcCb.eattQueue[connId - 1], &handlerId)) != NULL)
+  {
+    if ((slot = eattcGetFreeSlot(connId, pMsg->priority, pMsg->dataLen)) == ATT_BEARER_SLOT_INVALID)
+    {
+      break;
+    }
+
+    EATT_TRACE_INFO2("eattcDispatch: sending event: %#x slot: %#x", pMsg->msg.hdr.event, slot);
+
+    /* reserve bearer until ATTC sets up the request */
+    attcCcbByConnId(connId, slot)->reserved = TRUE;
+
+    WsfMsgDeq(&attcCb.eattQueue[connId - 1], &handlerId);
+    pMsg->msg.slot = slot;
+    WsfMsgSend(attCb.handlerId, pMsg);
+  }
 }
 
 /*************************************************************************************************/
@@ -251,36 +330,35 @@ void eattcSendMsg(dmConnId_t connId, uint8_t priority, uint16_t handle, uint8_t
     }
   }
 
-  /* get the next available channel given the priority and data length */
-  slot = eattcGetFreeSlot(connId, priority, dataLen);
-
-  /* if a cid is available */
-  if (slot)
+  /* if a bearer can carry the message, queue it for the next free one */
+  for (slot = 0; slot < ATT_BEARER_MAX; slot++)
   {
-    attcApiMsg_t *pMsg;
-
-    /* allocate message buffer */
-    if ((pMsg = WsfMsgAlloc(sizeof(attcApiMsg_t))) != NULL)
+    if (eattcSlotFits(connId, slot, priority, dataLen))
     {
-      EATT_TRACE_INFO2("eattcSendMsg: sending event: %#x slot: %#x", msgId, slot);
-
-      /* set parameters */
-      pMsg->hdr.param = connId;
-      pMsg->hdr.status = continuing;
-      pMsg->hdr.event = msgId;
-      pMsg->pPkt = pPkt;
-      pMsg->handle = handle;
-      pMsg->slot = slot;
-
-      /* send message */
-      WsfMsgSend(attCb.handlerId, pMsg);
+      eattcPendMsg_t *pMsg;
+
+      /* allocate message buffer */
+      if ((pMsg = WsfMsgAlloc(sizeof(eattcPendMsg_t))) != NULL)
+      {
+        /* set parameters */
+        pMsg->msg.hdr.param = connId;
+        pMsg->msg.hdr.status = continuing;
+        pMsg->msg.hdr.event = msgId;
+        pMsg->msg.pPkt = pPkt;
+        pMsg->msg.handle = handle;
+        pMsg->dataLen = dataLen;
+        pMsg->priority = priority;
+
+        WsfMsgEnq(&attcCb.eattQueue[connId - 1], attCb.handlerId, pMsg);
+        eattcDispatch(connId);
+      }
+
+      return;
     }
   }
-  else
-  {
-    /* no EATT slot, pass to ATT */
-    attcSendMsg(connId, handle, msgId, pPkt, continuing);
-  }
+
+  /* no EATT slot, pass to ATT */
+  attcSendMsg(connId, handle, msgId, pPkt, continuing);
 }
 
 /*************************************************************************************************/
@@ -599,7 +677,33 @@ void EattcWriteReq(dmConnId_t connId, uint8_t priority, uint16_t handle, uint16_
 /*************************************************************************************************/
 void EattcCancelReq(dmConnId_t connId, uint8_t priority)
 {
-  eattcSendMsg(connId, priority, 0, ATTC_MSG_API_CANCEL, NULL, FALSE);
+  attcApiMsg_t  *pMsg;
+  attcCcb_t     *pCcb;
+  uint8_t       slot;
+
+  /* cancel goes straight to each busy bearer of the priority; it is not queued behind the
+     requests it cancels and does not reserve the bearer */
+  for (slot = 0; slot < ATT_BEARER_MAX; slot++)
+  {
+    if (eattcSlotFits(connId, slot, priority, 0) &&
+        ((pCcb = attcCcbByConnId(connId, slot)) != NULL) &&
+        ((pCcb->outReq.hdr.event != ATTC_MSG_API_NONE) || pCcb->reserved))
+    {
+      if ((pMsg = WsfMsgAlloc(sizeof(attcApiMsg_t))) != NULL)
+      {
+        EATT_TRACE_INFO1("EattcCancelReq: slot: %#x", slot);
+
+        pMsg->hdr.param = connId;
+        pMsg->hdr.status = FALSE;
+        pMsg->hdr.event = ATTC_MSG_API_CANCEL;
+        pMsg->pPkt = NULL;
+        pMsg->handle = 0;
+        pMsg->slot = slot;
+
+        WsfMsgSend(attCb.handlerId, pMsg);
+      }
+    }
+  }
 }
 
 /*************************************************************************************************/
@@ -814,4 +918,5 @@ void EattcInit()
 {
   /* set up callback interface */
   attCb.pEnClient = &attcFcnIf;
+  attcCb.eattDispatch = eattcDispatch;
 }
@@ -557,10 +557,12 @@ static void attcCtrlCback(wsfMsgHdr_t *pMsg)
 /*************************************************************************************************/
 static void attcConnCback(attCcb_t *pCcb, dmEvt_t *pDmEvt)
 {
-  attcCcb_t *pClient;
-  uint16_t  localMtu;
-  uint8_t   status;
-  uint8_t   i;
+  attcCcb_t       *pClient;
+  attcApiMsg_t    *pMsg;
+  wsfHandlerId_t  handlerId;
+  uint16_t        localMtu;
+  uint8_t         status;
+  uint8_t         i;
 
   /* if connection opened */
   if (pDmEvt->hdr.event == DM_CONN_OPEN_IND)
@@ -596,6 +598,13 @@ static void attcConnCback(attCcb_t *pCcb, dmEvt_t *pDmEvt)
       attcReqClear(pCcb->connId, &attcCb.onDeck[pCcb->connId], status);
     }
 
+    /* free any EATT req waiting for a bearer */
+    while ((pMsg = WsfMsgDeq(&attcCb.eattQueue[pCcb->connId - 1], &handlerId)) != NULL)
+    {
+      attcReqClear(pCcb->connId, pMsg, status);
+      WsfMsgFree(pMsg);
+    }
+
     for (i = 0; i < ATT_BEARER_MAX; i++)
     {
       /* get client control block directly */
@@ -609,6 +618,7 @@ static void attcConnCback(attCcb_t *pCcb, dmEvt_t *pDmEvt)
       }
 
       /* initialize other control block variables */
+      pClient->reserved = FALSE;
       pCcb->sccb[i].control &= ~ATT_CCB_STATUS_FLOW_DISABLED;
       pCcb->sccb[i].control &= ~ATT_CCB_STATUS_CNF_PENDING;
 
@@ -669,6 +679,9 @@ void attcMsgCback(attcApiMsg_t *pMsg)
   /* if an API request to send packet (non-signed) */
   if (pMsg->hdr.event <= ATTC_MSG_API_READ_MULT_VAR)
   {
+    /* slot reserved for this request, if any, is now taken up by it */
+    pCcb->reserved = FALSE;
+
     /* verify no API request already waiting on deck, in progress, or no pending write command
        already for this handle */
     if (((pCcb->slot == ATT_BEARER_SLOT_ID) &&
@@ -679,11 +692,9 @@ void attcMsgCback(attcApiMsg_t *pMsg)
     {
       /* free request and call callback with failure status */
       attcReqClear(pCcb->connId, pMsg, ATT_ERR_OVERFLOW);
-      return;
     }
-
     /* if MTU request in progress or flow controlled */
-    if ((pCcb->slot == ATT_BEARER_SLOT_ID) && (pCcb->outReq.hdr.event == ATTC_MSG_API_MTU))
+    else if ((pCcb->slot == ATT_BEARER_SLOT_ID) && (pCcb->outReq.hdr.event == ATTC_MSG_API_MTU))
     {
       /* put request "on deck" for processing later */
       attcCb.onDeck[pCcb->connId] = *pMsg;
@@ -693,6 +704,13 @@ void attcMsgCback(attcApiMsg_t *pMsg)
     {
       attcSetupReq(pCcb, pMsg);
     }
+
+    /* a write command gets no response, nor does a request that failed; if nothing is
+       outstanding send any EATT request waiting for a free bearer */
+    if ((pCcb->outReq.hdr.event == ATTC_MSG_API_NONE) && (attcCb.eattDispatch != NULL))
+    {
+      (*attcCb.eattDispatch)(pCcb->connId);
+    }
   }
   /* else if cancel request */
   else if (pMsg->hdr.event == ATTC_MSG_API_CANCEL)
@@ -703,6 +721,12 @@ void attcMsgCback(attcApiMsg_t *pMsg)
     {
       WsfTimerStop(&pCcb->outReqTimer);
       attcReqClear(pCcb->connId, &pCcb->outReq, ATT_ERR_CANCELLED);
+
+      /* send any EATT request waiting for a free bearer */
+      if (attcCb.eattDispatch != NULL)
+      {
+        (*attcCb.eattDispatch)(pCcb->connId);
+      }
     }
     /* else free any req on deck */
     else if ((pCcb->slot == ATT_BEARER_SLOT_ID) &
@@ -719,6 +743,12 @@ void attcMsgCback(attcApiMsg_t *pMsg)
     {
       attcReqClear(pCcb->connId, &pCcb->outReq, ATT_ERR_TIMEOUT);
       pCcb->pMainCcb->sccb[pMsg->slot].control |= ATT_CCB_STATUS_TX_TIMEOUT;
+
+      /* EATT requests waiting for a bearer go to the others */
+      if (attcCb.eattDispatch != NULL)
+      {
+        (*attcCb.eattDispatch)(pCcb->connId);
+      }
     }
   }
 }
@@ -855,6 +885,8 @@ void AttcInit(void)
   /* Initialize control block CCBs */
   for (i = 0; i < DM_CONN_MAX; i++)
   {
+    WSF_QUEUE_INIT(&attcCb.eattQueue[i]);
+
     for (j = 0; j < ATT_BEARER_MAX; j++)
     {
       pCcb = &attcCb.ccb[i][j];
@@ -154,6 +154,7 @@ typedef struct
   wsfTimer_t              outReqTimer;  /* Outstanding request timer */
   uint8_t                 slot;         /* ATT/EATT slot ID */
   dmConnId_t              connId;       /* DM connection ID */
+  bool_t                  reserved;     /* EATT API request sent to this slot not yet set up */
   uint16_t                pendWriteCmdHandle[ATT_NUM_SIMUL_WRITE_CMD]; /* Callback to app pending for this write cmd handle */
 } attcCcb_t;
 
@@ -168,11 +169,16 @@ typedef struct
   attcCloseCback_t        closeCback;   /* Connection close callback */
 } attcSignFcnIf_t;
 
+/* EATT request dispatch callback */
+typedef void (*attcEattDispatch_t)(dmConnId_t connId);
+
 /* Main control block of the ATTC subsystem */
 typedef struct
 {
   attcCcb_t               ccb[DM_CONN_MAX][ATT_BEARER_MAX];
   attcApiMsg_t            onDeck[DM_CONN_MAX];       /* API message "on deck" waiting to be sent */
+  wsfQueue_t              eattQueue[DM_CONN_MAX];    /* EATT API messages waiting for a free bearer */
+  attcEattDispatch_t      eattDispatch;              /* Sends EATT API messages to free bearers */
   attcSignFcnIf_t const   *pSign;
   bool_t                  autoCnf;
 } attcCb_t;
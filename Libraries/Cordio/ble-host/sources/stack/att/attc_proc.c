@@ -419,6 +419,12 @@ void attcProcRsp(attcCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
       attcCb.onDeck[pCcb->connId].hdr.event = ATTC_MSG_API_NONE;
     }
   }
+
+  /* if bearer is free send any EATT request waiting for one */
+  if ((pCcb->outReq.hdr.event == ATTC_MSG_API_NONE) && (attcCb.eattDispatch != NULL))
+  {
+    (*attcCb.eattDispatch)(pCcb->connId);
+  }
 }
 
 /*************************************************************************************************/
@@ -268,6 +268,8 @@ static void attsConnCback(attCcb_t *pCcb, dmEvt_t *pDmEvt)
         WsfTimerStop(&pAttsCb->idleTimer);
       }
     }
+
+    attsCb.prepWriteStats[pCcb->connId - 1].peakBufLen = 0;
   }
 
   /* pass event to indication interface */
@@ -366,10 +368,14 @@ void attsClearPrepWrites(attsCcb_t *pCcb)
 {
   void *pBuf;
 
-  while ((pBuf = WsfQueueDeq(&attsCb.prepWriteQueue[pCcb->connId])) != NULL)
+  while ((pBuf = WsfQueueDeq(&attsCb.prepWriteQueue[pCcb->connId - 1])) != NULL)
   {
     WsfBufFree(pBuf);
   }
+
+  attsCb.prepWriteStats[pCcb->connId - 1].numWrites = 0;
+  attsCb.prepWriteStats[pCcb->connId - 1].valueLen = 0;
+  attsCb.prepWriteStats[pCcb->connId - 1].bufLen = 0;
 }
 
 /*************************************************************************************************/
@@ -100,6 +100,7 @@ typedef struct
 {
   attsCcb_t         ccb[DM_CONN_MAX][ATT_BEARER_MAX];         /* Connection slot control block */
   wsfQueue_t        prepWriteQueue[DM_CONN_MAX];              /* Connection prepare write queue */
+  attsPrepWriteStats_t prepWriteStats[DM_CONN_MAX];           /* Connection prepare write queue usage */
   wsfQueue_t        groupQueue;                               /* Queue of attribute groups */
   attFcnIf_t const  *pInd;                                    /* Indication callback interface */
   attMsgHandler_t   signMsgCback;                             /* Signed data callback interface */
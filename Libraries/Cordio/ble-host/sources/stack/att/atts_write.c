@@ -28,6 +28,7 @@
 #include "wsf_trace.h"
 #include "wsf_buf.h"
 #include "wsf_msg.h"
+#include "wsf_math.h"
 #include "util/bstream.h"
 #include "att_api.h"
 #include "att_main.h"
@@ -42,11 +43,86 @@ typedef struct attsPrepWrite_tag
 {
   struct attsPrepWrite_tag  *pNext;
   uint16_t                  writeLen;
+  uint16_t                  bufLen;
   uint16_t                  handle;
   uint16_t                  offset;
   uint8_t                   packet[1];
 } attsPrepWrite_t;
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Find the queued prepared write that a new prepared write continues.  A prepared
+ *          write continues the last one queued if it is to the same handle, at the offset
+ *          where the last one ended and fits in its buffer.
+ *
+ *  \param  pCcb      Connection control block.
+ *  \param  handle    Attribute handle.
+ *  \param  offset    Value offset.
+ *  \param  writeLen  Value length.
+ *
+ *  \return Queued prepared write or NULL if none is continued.
+ */
+/*************************************************************************************************/
+static attsPrepWrite_t *attsFindPrepWrite(attsCcb_t *pCcb, uint16_t handle, uint16_t offset,
+                                          uint16_t writeLen)
+{
+  attsPrepWrite_t *pPrep = attsCb.prepWriteQueue[pCcb->connId - 1].pTail;
+
+  if ((pPrep != NULL) && (pPrep->handle == handle) &&
+      (offset == (pPrep->offset + pPrep->writeLen)) &&
+      (writeLen <= (pPrep->bufLen - pPrep->writeLen)))
+  {
+    return pPrep;
+  }
+
+  return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Allocate a buffer for a prepared write.  If prepared writes are staged the buffer
+ *          has room for the rest of the attribute value, up to the staging buffer length.
+ *
+ *  \param  pAttr     Attribute.
+ *  \param  handle    Attribute handle.
+ *  \param  offset    Value offset.
+ *  \param  writeLen  Value length.
+ *
+ *  \return Prepared write buffer or NULL if none is available.
+ */
+/*************************************************************************************************/
+static attsPrepWrite_t *attsAllocPrepWrite(attsAttr_t *pAttr, uint16_t handle, uint16_t offset,
+                                           uint16_t writeLen)
+{
+  attsPrepWrite_t *pPrep = NULL;
+  uint16_t        bufLen = writeLen;
+
+  /* leave room for the prepared writes that continue a long write */
+  if ((pAttCfg->prepWriteBufLen > writeLen) && (pAttr->settings & ATTS_SET_ALLOW_OFFSET) &&
+      (pAttr->maxLen > (offset + writeLen)))
+  {
+    bufLen = WSF_MIN(pAttCfg->prepWriteBufLen, pAttr->maxLen - offset);
+    pPrep = WsfBufAlloc(sizeof(attsPrepWrite_t) - 1 + bufLen);
+  }
+
+  /* otherwise or if no buffer that large is free hold this prepared write only */
+  if (pPrep == NULL)
+  {
+    bufLen = writeLen;
+    pPrep = WsfBufAlloc(sizeof(attsPrepWrite_t) - 1 + bufLen);
+  }
+
+  if (pPrep != NULL)
+  {
+    pPrep->writeLen = 0;
+    pPrep->bufLen = bufLen;
+    pPrep->handle = handle;
+    pPrep->offset = offset;
+  }
+
+  return pPrep;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Execute a queued prepared write operation.
@@ -210,6 +286,7 @@ void attsProcWrite(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
     {
       /* set response pending */
       pCcb->pMainCcb->sccb[pCcb->slot].control |= ATT_CCB_STATUS_RSP_PENDING;
+      pCcb->pMainCcb->sccb[pCcb->slot].pendWriteHandle = handle;
     }
     else
     {
@@ -236,10 +313,12 @@ void attsProcPrepWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
   attsAttr_t      *pAttr;
   attsGroup_t     *pGroup;
   attsPrepWrite_t *pPrep = NULL;
+  attsPrepWriteStats_t *pStats = &attsCb.prepWriteStats[pCcb->connId - 1];
   uint16_t        handle;
   uint16_t        offset;
   uint16_t        writeLen;
   uint8_t         err = ATT_SUCCESS;
+  bool_t          newPrep = FALSE;
 
   /* parse handle and offset, calculate write length */
   pPacket += L2C_PAYLOAD_START + ATT_HDR_LEN;
@@ -270,18 +349,28 @@ void attsProcPrepWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
   {
     err = ATT_ERR_LENGTH;
   }
+  /* append to the buffer of the last prepared write if this one continues it */
+  else if ((pPrep = attsFindPrepWrite(pCcb, handle, offset, writeLen)) != NULL)
+  {
+    /* no new buffer needed */
+  }
   /* verify prepare write queue limit not reached */
-  else if (WsfQueueCount(&attsCb.prepWriteQueue[pCcb->connId]) >= pAttCfg->numPrepWrites)
+  else if (WsfQueueCount(&attsCb.prepWriteQueue[pCcb->connId - 1]) >= pAttCfg->numPrepWrites)
   {
     err = ATT_ERR_QUEUE_FULL;
   }
   /* allocate new buffer to hold prepared write */
-  else if ((pPrep = WsfBufAlloc(sizeof(attsPrepWrite_t) - 1 + writeLen)) == NULL)
+  else if ((pPrep = attsAllocPrepWrite(pAttr, handle, offset, writeLen)) == NULL)
   {
     err = ATT_ERR_RESOURCES;
   }
-  else if ((pAttr->settings & ATTS_SET_WRITE_CBACK) &&
-          (pGroup->writeCback != NULL))
+  else
+  {
+    newPrep = TRUE;
+  }
+
+  if ((err == ATT_SUCCESS) && (pAttr->settings & ATTS_SET_WRITE_CBACK) &&
+      (pGroup->writeCback != NULL))
   {
     err = (*pGroup->writeCback)(pCcb->connId, handle, ATT_PDU_PREP_WRITE_REQ, 0, writeLen,
                                 pPacket, pAttr);
@@ -289,12 +378,20 @@ void attsProcPrepWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
 
   if (err == ATT_SUCCESS)
   {
-    /* copy data to new buffer and queue it */
-    pPrep->writeLen = writeLen;
-    pPrep->handle = handle;
-    pPrep->offset = offset;
-    memcpy(pPrep->packet, pPacket, writeLen);
-    WsfQueueEnq(&attsCb.prepWriteQueue[pCcb->connId], pPrep);
+    /* queue new buffer */
+    if (newPrep)
+    {
+      WsfQueueEnq(&attsCb.prepWriteQueue[pCcb->connId - 1], pPrep);
+
+      pStats->numWrites++;
+      pStats->bufLen += pPrep->bufLen;
+      pStats->peakBufLen = WSF_MAX(pStats->peakBufLen, pStats->bufLen);
+    }
+
+    /* copy data to buffer */
+    memcpy(pPrep->packet + pPrep->writeLen, pPacket, writeLen);
+    pPrep->writeLen += writeLen;
+    pStats->valueLen += writeLen;
 
     /* allocate response buffer */
     if ((pBuf = attMsgAlloc(L2C_PAYLOAD_START + ATT_PREP_WRITE_RSP_LEN + writeLen)) != NULL)
@@ -310,6 +407,11 @@ void attsProcPrepWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
     }
   }
 
+  else if (newPrep)
+  {
+    WsfBufFree(pPrep);
+  }
+
   if (err)
   {
     attsErrRsp(pCcb->pMainCcb, pCcb->slot, ATT_PDU_PREP_WRITE_REQ, handle, err);
@@ -348,7 +450,7 @@ void attsProcExecWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
   else if (*pPacket == ATT_EXEC_WRITE_ALL)
   {
     /* iterate over prepare write queue and verify offset and length */
-    for (pPrep = attsCb.prepWriteQueue[pCcb->connId].pHead; pPrep != NULL; pPrep = pPrep->pNext)
+    for (pPrep = attsCb.prepWriteQueue[pCcb->connId - 1].pHead; pPrep != NULL; pPrep = pPrep->pNext)
     {
       /* find attribute */
       if ((pAttr = attsFindByHandle(pPrep->handle, &pGroup)) != NULL)
@@ -377,7 +479,7 @@ void attsProcExecWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
     if (err == ATT_SUCCESS)
     {
       /* for each buffer */
-      while ((pPrep = WsfQueueDeq(&attsCb.prepWriteQueue[pCcb->connId])) != NULL)
+      while ((pPrep = WsfQueueDeq(&attsCb.prepWriteQueue[pCcb->connId - 1])) != NULL)
       {
         /* write buffer */
         if ((err = attsExecPrepWrite(pCcb, pPrep)) != ATT_SUCCESS)
@@ -389,6 +491,9 @@ void attsProcExecWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
         /* free buffer */
         WsfBufFree(pPrep);
       }
+
+      /* reset queue usage */
+      attsClearPrepWrites(pCcb);
     }
   }
   /* else unknown operation */
@@ -417,7 +522,8 @@ void attsProcExecWriteReq(attsCcb_t *pCcb, uint16_t len, uint8_t *pPacket)
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a response to a pending write request.  For use with ATT_RSP_PENDING.
+ *  \brief  Send a response to a pending write request.  For use with ATT_RSP_PENDING.  The
+ *          response is sent on the bearer the write request was received on.
  *
  *  \param  connId      Connection ID.
  *  \param  handle      Attribute handle.
@@ -435,6 +541,7 @@ void AttsContinueWriteReq(dmConnId_t connId, uint16_t handle, uint8_t status)
   attCcb_t *pCcb;
   uint8_t  *pBuf;
   uint8_t  *p;
+  uint8_t  slot;
 
   /* get connection cb for this handle */
   if ((pCcb = attCcbByConnId(connId)) == NULL)
@@ -442,12 +549,22 @@ void AttsContinueWriteReq(dmConnId_t connId, uint16_t handle, uint8_t status)
     return;
   }
 
+  /* find the bearer the write was received on; writes on other bearers may be pending too */
+  for (slot = ATT_BEARER_MAX - 1; slot > ATT_BEARER_SLOT_ID; slot--)
+  {
+    if ((pCcb->sccb[slot].control & ATT_CCB_STATUS_RSP_PENDING) &&
+        (pCcb->sccb[slot].pendWriteHandle == handle))
+    {
+      break;
+    }
+  }
+
   /* clear response pending */
-  pCcb->sccb[ATT_BEARER_SLOT_ID].control &= ~ATT_CCB_STATUS_RSP_PENDING;
+  pCcb->sccb[slot].control &= ~ATT_CCB_STATUS_RSP_PENDING;
 
   if (status)
   {
-    attsErrRsp(pCcb, ATT_BEARER_SLOT_ID, ATT_PDU_WRITE_REQ, handle, status);
+    attsErrRsp(pCcb, slot, ATT_PDU_WRITE_REQ, handle, status);
   }
   else
   {
@@ -457,7 +574,24 @@ void AttsContinueWriteReq(dmConnId_t connId, uint16_t handle, uint8_t status)
       p = pBuf + L2C_PAYLOAD_START;
       UINT8_TO_BSTREAM(p, ATT_PDU_WRITE_RSP);
 
-      attL2cDataReq(pCcb, ATT_BEARER_SLOT_ID, ATT_WRITE_RSP_LEN, pBuf);
+      attL2cDataReq(pCcb, slot, ATT_WRITE_RSP_LEN, pBuf);
     }
   }
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the prepare write queue usage of a connection.
+ *
+ *  \param  connId      Connection ID.
+ *  \param  pStats      Returns the queue usage.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AttsGetPrepWriteStats(dmConnId_t connId, attsPrepWriteStats_t *pStats)
+{
+  WSF_ASSERT((connId > 0) && (connId <= DM_CONN_MAX));
+
+  *pStats = attsCb.prepWriteStats[connId - 1];
+}
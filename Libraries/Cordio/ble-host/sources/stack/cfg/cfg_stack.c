@@ -71,7 +71,8 @@ const attCfg_t attCfg =
   15,                               /* ATT server service discovery connection idle timeout in seconds */
   ATT_DEFAULT_MTU,                  /* desired ATT MTU */
   ATT_MAX_TRANS_TIMEOUT,            /* transcation timeout in seconds */
-  4                                 /* number of queued prepare writes supported by server */
+  4,                                /* number of queued prepare writes supported by server */
+  0                                 /* prepare write staging buffer length, 0 for none */
 };
 
 /* Configuration pointer */
@@ -120,6 +120,31 @@ extern "C" {
 /*! \brief Maximum number of isochronous data paths, it is shared by CISes and BISes */
 #define DM_ISO_DATA_PATH_MAX    (DM_CIS_MAX + DM_BIS_MAX)
 
+/*! \brief Maximum number of 16-bit UUIDs and of company IDs matched by the scan report filter */
+#ifndef DM_SCAN_FILT_MAX_IDS
+#define DM_SCAN_FILT_MAX_IDS    8
+#endif
+
+/*! \brief Maximum number of 128-bit UUIDs matched by the scan report filter */
+#ifndef DM_SCAN_FILT_MAX_UUID128
+#define DM_SCAN_FILT_MAX_UUID128 2
+#endif
+
+/*! \brief Number of devices tracked by scan report aggregation, a power of two */
+#ifndef DM_SCAN_FILT_TABLE_LEN
+#define DM_SCAN_FILT_TABLE_LEN  32
+#endif
+
+/*! \brief Send extended advertising data changes with the Packetcraft vendor specific patch
+ *  command, which the single-chip controller always supports */
+#ifndef DM_ADV_VS_PATCH_DATA
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+#define DM_ADV_VS_PATCH_DATA    TRUE
+#else
+#define DM_ADV_VS_PATCH_DATA    FALSE
+#endif
+#endif
+
 /**@}*/
 
 /**************************************************************************************************
@@ -167,6 +167,62 @@ void DmAdvSetData(uint8_t advHandle, uint8_t op, uint8_t location, uint8_t len,
   }
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Send a change to advertising or scan response data already set.  With extended
+ *          advertising only the changed bytes are sent to the controller if it supports the
+ *          vendor specific patch command, otherwise the complete data is set again.
+ *
+ *  \param  advHandle     Advertising handle.
+ *  \param  location      Data location.
+ *  \param  offset        Offset of the changed bytes in the data.
+ *  \param  len           Number of changed bytes.
+ *  \param  dataLen       Length of the data.
+ *  \param  pData         Pointer to the data, already changed.
+ *
+ *  \return TRUE if the change is sent, FALSE if the data must be set again with DmAdvSetData().
+ */
+/*************************************************************************************************/
+bool_t DmAdvPatchData(uint8_t advHandle, uint8_t location, uint16_t offset, uint8_t len,
+                      uint16_t dataLen, uint8_t *pData)
+{
+  dmAdvApiPatchData_t *pMsg;
+
+  WSF_ASSERT((location == DM_DATA_LOC_SCAN) || (location == DM_DATA_LOC_ADV));
+  WSF_ASSERT(advHandle < DM_NUM_ADV_SETS);
+  WSF_ASSERT((offset + len) <= dataLen);
+
+  /* legacy advertising data is only set while advertising is stopped; legacy DM has no patch action */
+  if (DmAdvModeLeg())
+  {
+    return FALSE;
+  }
+
+  /* the complete data is set again in one command, and the controller stages a change made
+     during an advertising event in a copy of the complete data of that size */
+  if ((dataLen > HCI_EXT_ADV_DATA_LEN) ||
+      (DM_ADV_VS_PATCH_DATA && (HCI_LEN_VS_PATCH_EXT_ADV_DATA(len) > UINT8_MAX)))
+  {
+    return FALSE;
+  }
+
+  if ((pMsg = WsfMsgAlloc(sizeof(dmAdvApiPatchData_t))) != NULL)
+  {
+    pMsg->hdr.event = DM_ADV_MSG_API_PATCH_DATA;
+    pMsg->advHandle = advHandle;
+    pMsg->location = location;
+    pMsg->offset = offset;
+    pMsg->len = len;
+    pMsg->dataLen = dataLen;
+    pMsg->pData = pData;
+    WsfMsgSend(dmCb.handlerId, pMsg);
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Start advertising using the given advertising set and duration.
@@ -46,7 +46,8 @@ enum
   DM_ADV_MSG_API_REMOVE,
   DM_ADV_MSG_API_CLEAR,
   DM_ADV_MSG_API_SET_RAND_ADDR,
-  DM_ADV_MSG_TIMEOUT
+  DM_ADV_MSG_TIMEOUT,
+  DM_ADV_MSG_API_PATCH_DATA
 };
 
 /* DM adv periodic event handler messages */
@@ -109,6 +110,18 @@ typedef struct
   uint8_t                 *pData;
 } dmAdvApiSetData_t;
 
+/* Data structure for DM_ADV_MSG_API_PATCH_DATA */
+typedef struct
+{
+  wsfMsgHdr_t             hdr;
+  uint8_t                 advHandle;
+  uint8_t                 location;
+  uint8_t                 len;
+  uint16_t                offset;
+  uint16_t                dataLen;
+  uint8_t                 *pData;
+} dmAdvApiPatchData_t;
+
 /* Data structure for DM_ADV_MSG_API_START */
 typedef struct
 {
@@ -179,6 +192,7 @@ typedef union
   wsfMsgHdr_t             hdr;
   dmAdvApiConfig_t        apiConfig;
   dmAdvApiSetData_t       apiSetData;
+  dmAdvApiPatchData_t     apiPatchData;
   dmAdvApiStart_t         apiStart;
   dmAdvApiStop_t          apiStop;
   dmAdvApiRemove_t        apiRemove;
@@ -238,6 +252,7 @@ void dmExtAdvReset(void);
 /* extended adv action functions */
 void dmExtAdvActConfig(dmAdvMsg_t *pMsg);
 void dmExtAdvActSetData(dmAdvMsg_t *pMsg);
+void dmExtAdvActPatchData(dmAdvMsg_t *pMsg);
 void dmExtAdvActStart(dmAdvMsg_t *pMsg);
 void dmExtAdvActStop(dmAdvMsg_t *pMsg);
 void dmExtAdvActRemoveSet(dmAdvMsg_t *pMsg);
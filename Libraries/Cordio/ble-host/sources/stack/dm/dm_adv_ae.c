@@ -105,7 +105,8 @@ static const dmAdvAct_t dmAdvAct[] =
   dmExtAdvActRemoveSet,
   dmExtAdvActClearSets,
   dmExtAdvActSetRandAddr,
-  dmExtAdvActTimeout
+  dmExtAdvActTimeout,
+  dmExtAdvActPatchData
 };
 
 /* extended advertising component function interface */
@@ -851,6 +852,54 @@ void dmExtAdvActSetData(dmAdvMsg_t *pMsg)
   }
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Patch the extended advertising or extended scan response data action function.
+ *
+ *  \param  pMsg    WSF message.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void dmExtAdvActPatchData(dmAdvMsg_t *pMsg)
+{
+  dmAdvApiPatchData_t *pPatch = &pMsg->apiPatchData;
+  uint8_t advHandle = pPatch->advHandle;
+
+  /* ignore if data was never set */
+  if (((pPatch->location == DM_DATA_LOC_ADV) && !dmExtAdvCb[advHandle].advDataSet) ||
+      ((pPatch->location == DM_DATA_LOC_SCAN) && !dmExtAdvCb[advHandle].scanDataSet))
+  {
+    DM_TRACE_WARN1("DmAdvPatchData ignored, no data set for handle: %d", advHandle);
+    return;
+  }
+
+  DM_TRACE_INFO3("dmExtAdvActPatchData: handle: %d, len: %d of %d", advHandle, pPatch->len,
+                 pPatch->dataLen);
+
+#if DM_ADV_VS_PATCH_DATA == TRUE
+  /* send only the changed bytes, unless legacy PDUs are used */
+  if (!dmExtAdvCb[advHandle].useLegacyPdu)
+  {
+    HciVsPatchExtAdvDataCmd(advHandle, (pPatch->location == DM_DATA_LOC_SCAN), pPatch->offset,
+                            pPatch->len, pPatch->pData + pPatch->offset);
+    return;
+  }
+#endif
+
+  /* set the complete data again */
+  if (pPatch->location == DM_DATA_LOC_ADV)
+  {
+    HciLeSetExtAdvDataCmd(advHandle, HCI_ADV_DATA_OP_COMP_FRAG, dmExtAdvCb[advHandle].fragPref,
+                          (uint8_t) pPatch->dataLen, pPatch->pData);
+  }
+  else
+  {
+    HciLeSetExtScanRespDataCmd(advHandle, HCI_ADV_DATA_OP_COMP_FRAG, dmExtAdvCb[advHandle].fragPref,
+                               (uint8_t) pPatch->dataLen, pPatch->pData);
+  }
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Start extended advertising action function.
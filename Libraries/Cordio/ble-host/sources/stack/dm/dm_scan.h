@@ -122,6 +122,14 @@ typedef union
 /* Action function */
 typedef void (*dmScanAct_t)(dmScanMsg_t *pMsg);
 
+/* Scan report filter interface */
+typedef struct
+{
+  void   (*reset)(void);                                  /* Forget tracked devices */
+  bool_t (*check)(uint8_t addrType, const uint8_t *pAddr, int8_t rssi, bool_t scanRsp,
+                  uint16_t len, const uint8_t *pData);    /* TRUE if report is passed */
+} dmScanFiltIf_t;
+
 /* Control block for scan module */
 typedef struct
 {
@@ -132,6 +140,7 @@ typedef struct
   uint16_t                scanDuration;
   bool_t                  filterNextScanRsp;
   uint8_t                 discFilter;
+  const dmScanFiltIf_t    *pFiltIf;
 } dmScanCb_t;
 
 /* Control block for periodic advertising sync module */
@@ -118,6 +118,12 @@ void dmExtScanActStart(dmScanMsg_t *pMsg)
 
     dmScanCb.filterNextScanRsp = FALSE;
 
+    /* forget devices seen by the report filter */
+    if (dmScanCb.pFiltIf != NULL)
+    {
+      (*dmScanCb.pFiltIf->reset)();
+    }
+
     /* enable scan */
     dmScanCb.scanState = DM_SCAN_STATE_STARTING;
     HciLeExtScanEnableCmd(TRUE, pMsg->apiStart.filterDup, (pMsg->apiStart.duration / 10), pMsg->apiStart.period);
@@ -175,39 +181,54 @@ static void dmExtScanActHciReport(hciEvt_t *pEvent)
   /* ignore if not scanning */
   if (dmScanCb.scanState == DM_SCAN_STATE_SCANNING)
   {
-    /* if filtering results for limited or general discovery, and first fragment */
-    if ((dmScanCb.discFilter != 0) && firstFrag)
+    /* if first fragment */
+    if (firstFrag)
     {
-      /* if this is a scan response */
-      if (DM_ADV_RPT_SCAN_RSP(pEvent->leExtAdvReport.eventType))
-      {
-        /* check if filtering next scan response */
-        if (dmScanCb.filterNextScanRsp)
-        {
-          filtered = TRUE;
-          dmScanCb.filterNextScanRsp = FALSE;
-        }
-      }
-      /* else it's an advertising response */
-      else
+      /* if filtering results for limited or general discovery */
+      if (dmScanCb.discFilter != 0)
       {
-        /* find flags in advertising data */
-        p = DmFindAdType(DM_ADV_TYPE_FLAGS, pEvent->leExtAdvReport.len, pEvent->leExtAdvReport.pData);
-        if (p == NULL)
+        /* if this is a scan response */
+        if (DM_ADV_RPT_SCAN_RSP(pEvent->leExtAdvReport.eventType))
         {
-          /* flags not found */
-          filtered = TRUE;
-          dmScanCb.filterNextScanRsp = TRUE;
+          /* check if filtering next scan response */
+          if (dmScanCb.filterNextScanRsp)
+          {
+            filtered = TRUE;
+            dmScanCb.filterNextScanRsp = FALSE;
+          }
         }
-        /* else flags found; check them */
-        else if ((p[DM_AD_DATA_IDX] & dmScanCb.discFilter) == 0)
+        /* else it's an advertising response */
+        else
         {
-          /* flags do not match discovery mode */
-          filtered = TRUE;
-          dmScanCb.filterNextScanRsp = TRUE;
+          /* find flags in advertising data */
+          p = DmFindAdType(DM_ADV_TYPE_FLAGS, pEvent->leExtAdvReport.len, pEvent->leExtAdvReport.pData);
+          if (p == NULL)
+          {
+            /* flags not found */
+            filtered = TRUE;
+            dmScanCb.filterNextScanRsp = TRUE;
+          }
+          /* else flags found; check them */
+          else if ((p[DM_AD_DATA_IDX] & dmScanCb.discFilter) == 0)
+          {
+            /* flags do not match discovery mode */
+            filtered = TRUE;
+            dmScanCb.filterNextScanRsp = TRUE;
+          }
         }
       }
 
+      /* if report filter is in use */
+      if (!filtered && (dmScanCb.pFiltIf != NULL))
+      {
+        filtered = !(*dmScanCb.pFiltIf->check)(pEvent->leExtAdvReport.addrType,
+                                               pEvent->leExtAdvReport.addr,
+                                               pEvent->leExtAdvReport.rssi,
+                                               DM_ADV_RPT_SCAN_RSP(pEvent->leExtAdvReport.eventType),
+                                               pEvent->leExtAdvReport.len,
+                                               pEvent->leExtAdvReport.pData);
+      }
+
       firstFrag = FALSE;
     }
 
@@ -217,9 +238,8 @@ static void dmExtScanActHciReport(hciEvt_t *pEvent)
       (*dmCb.cback)((dmEvt_t *) pEvent);
     }
 
-    /* if filtering results for limited or general discovery, and no more fragmented data to come */
-    if ((dmScanCb.discFilter != 0) &&
-        (DM_ADV_RPT_DATA_STATUS(pEvent->leExtAdvReport.eventType) != HCI_ADV_RPT_DATA_INCMPL_MORE))
+    /* if no more fragmented data to come */
+    if (DM_ADV_RPT_DATA_STATUS(pEvent->leExtAdvReport.eventType) != HCI_ADV_RPT_DATA_INCMPL_MORE)
     {
       /* reset our flags */
       filtered = FALSE;
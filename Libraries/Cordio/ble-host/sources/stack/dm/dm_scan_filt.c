@@ -0,0 +1,546 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Device manager scan report filter module.
+ *
+ *  Copyright (c) 2016-2018 Arm Ltd. All Rights Reserved.
+ *
+ *  Copyright (c) 2019 Packetcraft, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_assert.h"
+#include "wsf_trace.h"
+#include "wsf_os.h"
+#include "util/bstream.h"
+#include "dm_api.h"
+#include "dm_scan.h"
+#include "dm_main.h"
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Aggregation table entries probed for a device */
+#define DM_SCAN_FILT_PROBE_LEN        4
+
+/* Address type of an unused aggregation table entry */
+#define DM_SCAN_FILT_ADDR_TYPE_NONE   0xFF
+
+/* RSSI value when RSSI is not available */
+#define DM_SCAN_FILT_RSSI_NONE        127
+
+/* Length of 128-bit UUID */
+#define DM_SCAN_FILT_UUID128_LEN      16
+
+WSF_CT_ASSERT((DM_SCAN_FILT_TABLE_LEN & (DM_SCAN_FILT_TABLE_LEN - 1)) == 0);
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Aggregation table entry */
+typedef struct
+{
+  uint32_t                dataHash;       /* Hash of last data passed */
+  uint16_t                lastSeen;       /* Report count when last seen */
+  bdAddr_t                addr;           /* Device address */
+  uint8_t                 addrType;       /* Address type, or DM_SCAN_FILT_ADDR_TYPE_NONE */
+  bool_t                  scanRsp;        /* TRUE if tracking scan responses */
+  int8_t                  rssi;           /* RSSI of last report passed */
+} dmScanFiltDev_t;
+
+/* Control block */
+typedef struct
+{
+  uint8_t                 adTypeMask[32];                                   /* AD types matched */
+  uint16_t                uuid16[DM_SCAN_FILT_MAX_IDS];                     /* Sorted 16-bit UUIDs */
+  uint16_t                mfrId[DM_SCAN_FILT_MAX_IDS];                      /* Sorted company IDs */
+  uint8_t                 uuid128[DM_SCAN_FILT_MAX_UUID128][DM_SCAN_FILT_UUID128_LEN];
+  uint8_t                 numUuid16;
+  uint8_t                 numMfrId;
+  uint8_t                 numUuid128;
+  bool_t                  matchAll;       /* TRUE if there are no rules */
+  int8_t                  rssiMin;
+  uint8_t                 rssiDelta;
+  bool_t                  aggregate;
+  uint16_t                rptCount;       /* Reports aggregated */
+  dmScanFiltDev_t         dev[DM_SCAN_FILT_TABLE_LEN];
+} dmScanFiltCb_t;
+
+/**************************************************************************************************
+  Local Declarations
+**************************************************************************************************/
+
+static void dmScanFiltReset(void);
+static bool_t dmScanFiltCheck(uint8_t addrType, const uint8_t *pAddr, int8_t rssi, bool_t scanRsp,
+                              uint16_t len, const uint8_t *pData);
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Scan report filter interface */
+static const dmScanFiltIf_t dmScanFiltIf =
+{
+  dmScanFiltReset,
+  dmScanFiltCheck
+};
+
+/* Control block */
+static dmScanFiltCb_t dmScanFiltCb;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add an ID to a sorted table.
+ *
+ *  \param  pTbl    Table.
+ *  \param  pNum    Number of IDs in table.
+ *  \param  id      ID.
+ *
+ *  \return TRUE if successful, FALSE if the table is full.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltAddId(uint16_t *pTbl, uint8_t *pNum, uint16_t id)
+{
+  uint8_t i;
+
+  for (i = *pNum; (i > 0) && (pTbl[i - 1] >= id); i--)
+  {
+    if (pTbl[i - 1] == id)
+    {
+      return TRUE;
+    }
+  }
+
+  if (*pNum == DM_SCAN_FILT_MAX_IDS)
+  {
+    return FALSE;
+  }
+
+  memmove(&pTbl[i + 1], &pTbl[i], (*pNum - i) * sizeof(uint16_t));
+  pTbl[i] = id;
+  (*pNum)++;
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find an ID in a sorted table.
+ *
+ *  \param  pTbl    Table.
+ *  \param  num     Number of IDs in table.
+ *  \param  p       ID, little endian.
+ *
+ *  \return TRUE if found.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltFindId(const uint16_t *pTbl, uint8_t num, const uint8_t *p)
+{
+  uint16_t id;
+  uint8_t  lo = 0;
+  uint8_t  hi = num;
+  uint8_t  mid;
+
+  BYTES_TO_UINT16(id, p);
+
+  while (lo < hi)
+  {
+    mid = (lo + hi) / 2;
+
+    if (pTbl[mid] == id)
+    {
+      return TRUE;
+    }
+    else if (pTbl[mid] < id)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find a 128-bit UUID.
+ *
+ *  \param  pUuid   UUID, little endian.
+ *
+ *  \return TRUE if found.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltFindUuid128(const uint8_t *pUuid)
+{
+  uint8_t i;
+
+  for (i = 0; i < dmScanFiltCb.numUuid128; i++)
+  {
+    if (memcmp(dmScanFiltCb.uuid128[i], pUuid, DM_SCAN_FILT_UUID128_LEN) == 0)
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Match advertising data against the rules.
+ *
+ *  \param  len     Data length.
+ *  \param  pData   Advertising data.
+ *
+ *  \return TRUE if any rule matches.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltMatch(uint16_t len, const uint8_t *pData)
+{
+  const uint8_t *p;
+  uint8_t       elemLen;
+  uint8_t       adType;
+  uint8_t       dataLen;
+
+  /* for each AD element */
+  while ((len > DM_AD_TYPE_IDX) && ((elemLen = pData[DM_AD_LEN_IDX]) != 0) && (elemLen < len))
+  {
+    adType = pData[DM_AD_TYPE_IDX];
+    p = &pData[DM_AD_DATA_IDX];
+    dataLen = elemLen - 1;
+
+    if (dmScanFiltCb.adTypeMask[adType >> 3] & (1 << (adType & 0x07)))
+    {
+      return TRUE;
+    }
+
+    switch (adType)
+    {
+      case DM_ADV_TYPE_16_UUID_PART:
+      case DM_ADV_TYPE_16_UUID:
+        for (; dataLen >= 2; dataLen -= 2, p += 2)
+        {
+          if (dmScanFiltFindId(dmScanFiltCb.uuid16, dmScanFiltCb.numUuid16, p))
+          {
+            return TRUE;
+          }
+        }
+        break;
+
+      case DM_ADV_TYPE_128_UUID_PART:
+      case DM_ADV_TYPE_128_UUID:
+        for (; dataLen >= DM_SCAN_FILT_UUID128_LEN;
+             dataLen -= DM_SCAN_FILT_UUID128_LEN, p += DM_SCAN_FILT_UUID128_LEN)
+        {
+          if (dmScanFiltFindUuid128(p))
+          {
+            return TRUE;
+          }
+        }
+        break;
+
+      case DM_ADV_TYPE_SERVICE_DATA:
+        if ((dataLen >= 2) && dmScanFiltFindId(dmScanFiltCb.uuid16, dmScanFiltCb.numUuid16, p))
+        {
+          return TRUE;
+        }
+        break;
+
+      case DM_ADV_TYPE_SVC_DATA_128:
+        if ((dataLen >= DM_SCAN_FILT_UUID128_LEN) && dmScanFiltFindUuid128(p))
+        {
+          return TRUE;
+        }
+        break;
+
+      case DM_ADV_TYPE_MANUFACTURER:
+        if ((dataLen >= 2) && dmScanFiltFindId(dmScanFiltCb.mfrId, dmScanFiltCb.numMfrId, p))
+        {
+          return TRUE;
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    pData += elemLen + 1;
+    len -= elemLen + 1;
+  }
+
+  return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Hash advertising data.
+ *
+ *  \param  len     Data length.
+ *  \param  pData   Advertising data.
+ *
+ *  \return Hash value.
+ */
+/*************************************************************************************************/
+static uint32_t dmScanFiltHashData(uint16_t len, const uint8_t *pData)
+{
+  uint32_t hash = 2166136261u;
+
+  /* FNV-1a */
+  while (len-- > 0)
+  {
+    hash = (hash ^ *pData++) * 16777619u;
+  }
+
+  return hash;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Aggregate a report with earlier reports from the same device.
+ *
+ *  \param  addrType  Address type.
+ *  \param  pAddr     Address.
+ *  \param  rssi      RSSI.
+ *  \param  scanRsp   TRUE if scan response.
+ *  \param  len       Data length.
+ *  \param  pData     Advertising data.
+ *
+ *  \return TRUE if the report is from a new device or has changed.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltAggregate(uint8_t addrType, const uint8_t *pAddr, int8_t rssi,
+                                  bool_t scanRsp, uint16_t len, const uint8_t *pData)
+{
+  dmScanFiltDev_t *pDev;
+  dmScanFiltDev_t *pFree = NULL;
+  uint32_t        dataHash = dmScanFiltHashData(len, pData);
+  uint16_t        idx = addrType ^ (scanRsp << 7);
+  uint8_t         i;
+  bool_t          changed;
+
+  dmScanFiltCb.rptCount++;
+
+  for (i = 0; i < BDA_ADDR_LEN; i++)
+  {
+    idx = (idx * 31) + pAddr[i];
+  }
+
+  /* probe the entries the device can be in */
+  for (i = 0; i < DM_SCAN_FILT_PROBE_LEN; i++)
+  {
+    pDev = &dmScanFiltCb.dev[(idx + i) & (DM_SCAN_FILT_TABLE_LEN - 1)];
+
+    if (pDev->addrType == DM_SCAN_FILT_ADDR_TYPE_NONE)
+    {
+      if ((pFree == NULL) || (pFree->addrType != DM_SCAN_FILT_ADDR_TYPE_NONE))
+      {
+        pFree = pDev;
+      }
+    }
+    else if ((pDev->addrType == addrType) && (pDev->scanRsp == scanRsp) &&
+             BdaCmp(pDev->addr, pAddr))
+    {
+      /* pass if data changed or RSSI moved far enough */
+      changed = (pDev->dataHash != dataHash) ||
+                ((dmScanFiltCb.rssiDelta != 0) &&
+                 (((pDev->rssi > rssi) ? (pDev->rssi - rssi) : (rssi - pDev->rssi)) >=
+                   dmScanFiltCb.rssiDelta));
+
+      pDev->lastSeen = dmScanFiltCb.rptCount;
+
+      if (changed)
+      {
+        pDev->dataHash = dataHash;
+        pDev->rssi = rssi;
+      }
+
+      return changed;
+    }
+    /* else replace the device seen longest ago if no entry is free */
+    else if ((pFree == NULL) ||
+             ((pFree->addrType != DM_SCAN_FILT_ADDR_TYPE_NONE) &&
+              ((uint16_t)(dmScanFiltCb.rptCount - pDev->lastSeen) >
+               (uint16_t)(dmScanFiltCb.rptCount - pFree->lastSeen))))
+    {
+      pFree = pDev;
+    }
+  }
+
+  /* track new device */
+  BdaCpy(pFree->addr, pAddr);
+  pFree->addrType = addrType;
+  pFree->scanRsp = scanRsp;
+  pFree->dataHash = dataHash;
+  pFree->rssi = rssi;
+  pFree->lastSeen = dmScanFiltCb.rptCount;
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Forget tracked devices.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void dmScanFiltReset(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < DM_SCAN_FILT_TABLE_LEN; i++)
+  {
+    dmScanFiltCb.dev[i].addrType = DM_SCAN_FILT_ADDR_TYPE_NONE;
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check if a scan report is passed to the client.
+ *
+ *  \param  addrType  Address type.
+ *  \param  pAddr     Address.
+ *  \param  rssi      RSSI.
+ *  \param  scanRsp   TRUE if scan response.
+ *  \param  len       Data length.
+ *  \param  pData     Advertising data.
+ *
+ *  \return TRUE if the report is passed.
+ */
+/*************************************************************************************************/
+static bool_t dmScanFiltCheck(uint8_t addrType, const uint8_t *pAddr, int8_t rssi, bool_t scanRsp,
+                              uint16_t len, const uint8_t *pData)
+{
+  /* check RSSI if available */
+  if ((rssi != DM_SCAN_FILT_RSSI_NONE) && (rssi < dmScanFiltCb.rssiMin))
+  {
+    return FALSE;
+  }
+
+  if (!dmScanFiltCb.matchAll && !dmScanFiltMatch(len, pData))
+  {
+    return FALSE;
+  }
+
+  if (dmScanFiltCb.aggregate)
+  {
+    return dmScanFiltAggregate(addrType, pAddr, rssi, scanRsp, len, pData);
+  }
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Filter scan reports before they are passed to the client.  The rules are compiled
+ *          into tables matched in one pass over the advertising data.  With aggregation only the
+ *          first report from a device and reports with changed data or RSSI are passed.  Each
+ *          device is tracked again when scanning starts.
+ *
+ *  \param  pCfg      Filter configuration.
+ *
+ *  \return TRUE if successful, FALSE if the rules do not fit in the filter tables.
+ *
+ *  \note   Fragmented extended reports are matched by their first fragment.
+ */
+/*************************************************************************************************/
+bool_t DmScanFiltSet(const dmScanFiltCfg_t *pCfg)
+{
+  const dmScanFiltRule_t *pRule;
+  bool_t                 ok = TRUE;
+  uint8_t                i;
+
+  WsfTaskLock();
+
+  dmScanCb.pFiltIf = NULL;
+
+  /* compile rules */
+  memset(&dmScanFiltCb, 0, sizeof(dmScanFiltCb));
+
+  for (i = 0, pRule = pCfg->pRules; (i < pCfg->numRules) && ok; i++, pRule++)
+  {
+    switch (pRule->type)
+    {
+      case DM_SCAN_FILT_RULE_AD_TYPE:
+        dmScanFiltCb.adTypeMask[pRule->adType >> 3] |= (1 << (pRule->adType & 0x07));
+        break;
+
+      case DM_SCAN_FILT_RULE_UUID16:
+        ok = dmScanFiltAddId(dmScanFiltCb.uuid16, &dmScanFiltCb.numUuid16, pRule->id);
+        break;
+
+      case DM_SCAN_FILT_RULE_MFR_ID:
+        ok = dmScanFiltAddId(dmScanFiltCb.mfrId, &dmScanFiltCb.numMfrId, pRule->id);
+        break;
+
+      case DM_SCAN_FILT_RULE_UUID128:
+        if (dmScanFiltCb.numUuid128 < DM_SCAN_FILT_MAX_UUID128)
+        {
+          memcpy(dmScanFiltCb.uuid128[dmScanFiltCb.numUuid128++], pRule->pUuid128,
+                 DM_SCAN_FILT_UUID128_LEN);
+        }
+        else
+        {
+          ok = FALSE;
+        }
+        break;
+
+      default:
+        ok = FALSE;
+        break;
+    }
+  }
+
+  if (ok)
+  {
+    dmScanFiltCb.matchAll = (pCfg->numRules == 0);
+    dmScanFiltCb.rssiMin = pCfg->rssiMin;
+    dmScanFiltCb.rssiDelta = pCfg->rssiDelta;
+    dmScanFiltCb.aggregate = pCfg->aggregate;
+    dmScanFiltReset();
+
+    dmScanCb.pFiltIf = &dmScanFiltIf;
+  }
+  else
+  {
+    DM_TRACE_WARN0("DmScanFiltSet: rules do not fit");
+  }
+
+  WsfTaskUnlock();
+
+  return ok;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Stop filtering scan reports.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void DmScanFiltClear(void)
+{
+  WsfTaskLock();
+  dmScanCb.pFiltIf = NULL;
+  WsfTaskUnlock();
+}
@@ -86,6 +86,12 @@ void dmScanActStart(dmScanMsg_t *pMsg)
     }
     dmScanCb.filterNextScanRsp = FALSE;
 
+    /* forget devices seen by the report filter */
+    if (dmScanCb.pFiltIf != NULL)
+    {
+      (*dmScanCb.pFiltIf->reset)();
+    }
+
     /* enable scan */
     dmScanCb.scanDuration = pMsg->apiStart.duration;
     dmScanCb.scanState = DM_SCAN_STATE_STARTING;
@@ -177,6 +183,17 @@ static void dmScanActHciReport(hciEvt_t *pEvent)
       }
     }
 
+    /* if report filter is in use */
+    if (!filtered && (dmScanCb.pFiltIf != NULL))
+    {
+      filtered = !(*dmScanCb.pFiltIf->check)(pEvent->leAdvReport.addrType,
+                                             pEvent->leAdvReport.addr,
+                                             pEvent->leAdvReport.rssi,
+                                             (pEvent->leAdvReport.eventType == DM_RPT_SCAN_RESPONSE),
+                                             pEvent->leAdvReport.len,
+                                             pEvent->leAdvReport.pData);
+    }
+
     if (!filtered)
     {
       pEvent->hdr.event = DM_SCAN_REPORT_IND;
@@ -47,9 +47,11 @@ C_FILES += \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/plxpc/plxpc_main.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/plxps/plxps_db.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/plxps/plxps_main.c \
+	$(ROOT_DIR)/ble-profiles/sources/profiles/racp/racp_store.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/rscp/rscps_main.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/scpps/scpps_main.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/sensor/gyro_main.c \
+	$(ROOT_DIR)/ble-profiles/sources/profiles/sensor/sensor_batch.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/sensor/temp_main.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/tipc/tipc_main.c \
 	$(ROOT_DIR)/ble-profiles/sources/profiles/udsc/udsc_main.c \
@@ -493,6 +493,9 @@ void AppExtAdvStop(uint8_t numSets, uint8_t *pAdvHandles);
  *          with the new value.  If the element does not exist in the data it is appended
  *          to it, space permitting.
  *
+ *          A value of the same length is changed in place.  While advertising only the
+ *          changed bytes are then sent to the controller, if it supports patching the data.
+ *
  *          There is special handling for the device name (AD type DM_ADV_TYPE_LOCAL_NAME).
  *          If the name can only fit in the data if it is shortened, the name is shortened
  *          and the AD type is changed to DM_ADV_TYPE_SHORT_NAME.
@@ -597,6 +600,46 @@ void AppPerAdvStop(uint8_t advHandle);
 /*************************************************************************************************/
 bool_t AppPerAdvSetAdValue(uint8_t advHandle, uint8_t adType, uint8_t len, uint8_t *pValue);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Set the double buffer used to stream periodic advertising data.  The Application
+ *          fills one buffer while the other holds the data last sent.
+ *
+ *  \param  advHandle Advertising handle.
+ *  \param  pBuf0     First stream buffer.
+ *  \param  pBuf1     Second stream buffer.
+ *  \param  bufLen    Length of each stream buffer.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppPerAdvStreamInit(uint8_t advHandle, uint8_t *pBuf0, uint8_t *pBuf1, uint16_t bufLen);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the stream buffer to fill with the next periodic advertising data.
+ *
+ *  \param  advHandle Advertising handle.
+ *
+ *  \return Stream buffer.
+ */
+/*************************************************************************************************/
+uint8_t *AppPerAdvStreamBuf(uint8_t advHandle);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send the filled stream buffer as the periodic advertising data and swap buffers.
+ *          While periodic advertising is enabled the data is sent with a single complete data
+ *          command and the Controller applies it at the next periodic advertising event.
+ *
+ *  \param  advHandle Advertising handle.
+ *  \param  len       Length of the data, at most HCI_PER_ADV_DATA_LEN bytes.
+ *
+ *  \return TRUE if the data was sent, FALSE otherwise.
+ */
+/*************************************************************************************************/
+bool_t AppPerAdvStreamSend(uint8_t advHandle, uint16_t len);
+
 /**@}*/
 
 /** \name App Scan Functions
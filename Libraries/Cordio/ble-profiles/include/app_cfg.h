@@ -56,6 +56,17 @@ extern "C" {
 #define APP_DB_HDL_LIST_LEN 21
 #endif
 
+/*! \brief Number of peer database hashes with a cached handle list, shared by all peers with the
+ *  same database */
+#ifndef APP_DB_HASH_CACHE_LEN
+#define APP_DB_HASH_CACHE_LEN 4
+#endif
+
+/*! \brief Longest time in ms a changed device record waits to be written to NVM */
+#ifndef APP_DB_NVM_FLUSH_MS
+#define APP_DB_NVM_FLUSH_MS 2000
+#endif
+
 /*! \} */    /* APP_FRAMEWORK_DB_API */
 
 /*! \addtogroup APP_FRAMEWORK_API
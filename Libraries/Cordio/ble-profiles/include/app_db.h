@@ -402,6 +402,31 @@ uint16_t *AppDbGetHdlList(appDbHdl_t hdl);
 /*************************************************************************************************/
 void AppDbSetHdlList(appDbHdl_t hdl, uint16_t *pHdlList);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the handle list cached for a peer database hash.  Peers with the same database
+ *          hash have the same attribute handles.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *
+ *  \return Pointer to handle list or NULL if the hash is not cached.
+ */
+/*************************************************************************************************/
+uint16_t *AppDbGetHashHdlList(const uint8_t *pDbHash);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Cache the handle list for a peer database hash.  When the cache is full the entries
+ *          are overwritten in turn.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *  \param  pHdlList  Pointer to handle list.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSetHashHdlList(const uint8_t *pDbHash, uint16_t *pHdlList);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get the device name.
@@ -616,6 +641,17 @@ void AppDbNvmStoreCacheByHash(appDbHdl_t hdl);
 /*************************************************************************************************/
 void AppDbNvmStoreDbHash(appDbHdl_t hdl);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the handle list cached for a peer database hash in NVM.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmStoreHashHdlList(const uint8_t *pDbHash);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Store bonding information for device record in NVM.
@@ -627,6 +663,18 @@ void AppDbNvmStoreDbHash(appDbHdl_t hdl);
 /*************************************************************************************************/
 void AppDbNvmStoreBond(appDbHdl_t hdl);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Write all changed device database records to NVM.  The AppDbNvmStore functions other
+ *          than AppDbNvmStoreBond() and AppDbNvmStoreHashHdlList() only mark a record changed.
+ *          Changed records are written when a connection closes or APP_DB_NVM_FLUSH_MS after the
+ *          first change, one NVM write per record.  Call before a reset to write them now.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmFlush(void);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Read all device database records from NVM.
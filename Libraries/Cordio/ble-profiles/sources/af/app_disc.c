@@ -490,6 +490,7 @@ void AppDiscProcAttMsg(attEvt_t *pMsg)
       else
       {
         appDbHdl_t hdl;
+        uint16_t   *pHdlList;
 
         pAppDiscCb->inProgress = APP_DISC_IDLE;
 
@@ -520,8 +521,22 @@ void AppDiscProcAttMsg(attEvt_t *pMsg)
            */
           AppDbSetCacheByHash(hdl, TRUE);
 
-          /* notify application to start discovery */
-          (*appDiscCback)(connId, APP_DISC_START);
+          /* A server with the same database was discovered before, reuse its handles. */
+          if ((pAppDiscCb->pHdlList != NULL) &&
+              ((pHdlList = AppDbGetHashHdlList(pMsg->pValue + 3)) != NULL))
+          {
+            memcpy(pAppDiscCb->pHdlList, pHdlList, (pAppDiscCb->hdlListLen * sizeof(uint16_t)));
+            AppDbSetHdlList(hdl, pAppDiscCb->pHdlList);
+            AppDbSetDiscStatus(hdl, APP_DISC_CMPL);
+            pAppDiscCb->cmplStatus = APP_DISC_CMPL;
+
+            appDiscCfgStart(connId, APP_DISC_CMPL);
+          }
+          else
+          {
+            /* notify application to start discovery */
+            (*appDiscCback)(connId, APP_DISC_START);
+          }
         }
         else
         {
@@ -721,6 +736,12 @@ void AppDiscComplete(dmConnId_t connId, uint8_t status)
       if (status == APP_DISC_CMPL)
       {
         AppDbSetHdlList(hdl, pAppDiscCb->pHdlList);
+
+        /* share handles with other servers with the same database */
+        if (AppDbIsCacheCheckedByHash(hdl))
+        {
+          AppDbSetHashHdlList(AppDbGetPeerDbHash(hdl), pAppDiscCb->pHdlList);
+        }
       }
     }
   }
@@ -108,6 +108,10 @@ static void appProcMsg(wsfMsgHdr_t *pMsg)
       appUiTimerExpired(pMsg);
       break;
 
+    case APP_DB_NVM_FLUSH_IND:
+      AppDbNvmFlush();
+      break;
+
     default:
       break;
   }
@@ -61,7 +61,8 @@ extern "C" {
 enum
 {
   APP_BTN_POLL_IND = APP_MSG_START,       /*! Button poll timer expired */
-  APP_UI_TIMER_IND                        /*! UI timer expired */
+  APP_UI_TIMER_IND,                       /*! UI timer expired */
+  APP_DB_NVM_FLUSH_IND                    /*! Device database NVM flush timer expired */
 };
 
 /*! App slave WSF message event enumeration */
@@ -320,6 +320,9 @@ static void appMasterSecConnClose(dmEvt_t *pMsg, appConnCb_t *pCb)
   {
     AppDbCheckValidRecord(pCb->dbHdl);
   }
+
+  /* write device record changes made during the connection */
+  AppDbNvmFlush();
 }
 
 /*************************************************************************************************/
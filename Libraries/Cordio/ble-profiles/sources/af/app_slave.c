@@ -681,6 +681,9 @@ void appSecConnClose(dmEvt_t *pMsg, appConnCb_t *pCb)
   {
     AppDbCheckValidRecord(pCb->dbHdl);
   }
+
+  /* write device record changes made during the connection */
+  AppDbNvmFlush();
 }
 
 /*************************************************************************************************/
@@ -1330,6 +1333,49 @@ void appSlaveAdvStart(uint8_t numSets, uint8_t *pAdvHandles, uint16_t *pInterval
   appAdvStart(numSets, pAdvHandles, pInterval, pDuration, pMaxEaEvents, TRUE);
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Change an advertising data element value in place, sending only the changed bytes
+ *          if the data is already with the controller.
+ *
+ *  \param  advHandle Advertising handle.
+ *  \param  location  Data location.
+ *  \param  pDest     Pointer to the element value in the advertising data.
+ *  \param  len       Length of the value.
+ *  \param  pValue    Pointer to the new value.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appAdvPatchAdValue(uint8_t advHandle, uint8_t location, uint8_t *pDest, uint8_t len,
+                               const uint8_t *pValue)
+{
+  uint8_t  *pAdvData = appSlaveCb.pAdvData[advHandle][location];
+  uint16_t advDataLen = appSlaveCb.advDataLen[advHandle][location];
+
+  /* nothing to send if the value is unchanged */
+  if (memcmp(pDest, pValue, len) == 0)
+  {
+    return;
+  }
+
+  memcpy(pDest, pValue, len);
+
+  /* if the data has been sent for the current mode, send the change only */
+  if ((appSlaveCb.advState[advHandle] != APP_ADV_STOPPED) &&
+      (APP_LOC_2_MODE(location) == appSlaveCb.discMode) &&
+      (appSlaveCb.advDataOffset[advHandle][location] >= advDataLen) &&
+      DmAdvPatchData(advHandle, APP_LOC_2_DM_LOC(location), (uint16_t) (pDest - pAdvData), len,
+                     advDataLen, pAdvData))
+  {
+    return;
+  }
+
+  /* else set the complete data */
+  appAdvSetData(advHandle, location, advDataLen, pAdvData,
+                appSlaveCb.advDataBufLen[advHandle][location], appSlaveCb.maxAdvDataLen[advHandle]);
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Set the value of an advertising data element in the advertising or scan
@@ -1354,6 +1400,7 @@ bool_t appAdvSetAdValue(uint8_t advHandle, uint8_t location, uint8_t adType, uin
                         uint8_t *pValue)
 {
   uint8_t *pAdvData;
+  uint8_t *pElem;
   uint16_t advDataLen;
   uint16_t advDataBufLen;
   bool_t  valueSet;
@@ -1367,6 +1414,16 @@ bool_t appAdvSetAdValue(uint8_t advHandle, uint8_t location, uint8_t adType, uin
 
   if (pAdvData != NULL)
   {
+    /* if the element keeps its length, change its value in place */
+    if ((adType != DM_ADV_TYPE_LOCAL_NAME) &&
+        ((pElem = DmFindAdType(adType, advDataLen, pAdvData)) != NULL) &&
+        (pElem[DM_AD_LEN_IDX] == (len + 1)))
+    {
+      appAdvPatchAdValue(advHandle, location, &pElem[DM_AD_DATA_IDX], len, pValue);
+
+      return TRUE;
+    }
+
     /* set the new element value in the advertising data */
     if (adType == DM_ADV_TYPE_LOCAL_NAME)
     {
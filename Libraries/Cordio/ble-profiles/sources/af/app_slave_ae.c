@@ -44,6 +44,9 @@ typedef struct
   bool_t      perAdvDataSynced[DM_NUM_ADV_SETS]; /*! TRUE if periodic advertising data is synced */
   bool_t      perAdvParamsCfg[DM_NUM_ADV_SETS];  /*! TRUE if periodic advertising parameters are configured */
   uint8_t     perAdvState[DM_NUM_ADV_SETS];      /*! Periodic advertising state */
+  uint8_t     *pPerAdvStreamBuf[DM_NUM_ADV_SETS][2]; /*! Periodic advertising stream buffers */
+  uint16_t    perAdvStreamBufLen[DM_NUM_ADV_SETS];   /*! Length of each stream buffer */
+  uint8_t     perAdvStreamIdx[DM_NUM_ADV_SETS];      /*! Stream buffer being filled by Application */
 } appExtSlaveCb_t;
 
 /**************************************************************************************************
@@ -529,6 +532,9 @@ void AppExtAdvStop(uint8_t numSets, uint8_t *pAdvHandles)
  *          with the new value.  If the element does not exist in the data it is appended
  *          to it, space permitting.
  *
+ *          A value of the same length is changed in place.  While advertising only the
+ *          changed bytes are then sent to the controller, if it supports patching the data.
+ *
  *          There is special handling for the device name (AD type DM_ADV_TYPE_LOCAL_NAME).
  *          If the name can only fit in the data if it is shortened, the name is shortened
  *          and the AD type is changed to DM_ADV_TYPE_SHORT_NAME.
@@ -717,6 +723,85 @@ void AppPerAdvStop(uint8_t advHandle)
   }
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Set the double buffer used to stream periodic advertising data.  The Application
+ *          fills one buffer while the other holds the data last sent.
+ *
+ *  \param  advHandle Advertising handle.
+ *  \param  pBuf0     First stream buffer.
+ *  \param  pBuf1     Second stream buffer.
+ *  \param  bufLen    Length of each stream buffer.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppPerAdvStreamInit(uint8_t advHandle, uint8_t *pBuf0, uint8_t *pBuf1, uint16_t bufLen)
+{
+  WSF_ASSERT(advHandle < DM_NUM_ADV_SETS);
+  WSF_ASSERT((pBuf0 != NULL) && (pBuf1 != NULL) && (pBuf0 != pBuf1));
+
+  appExtSlaveCb.pPerAdvStreamBuf[advHandle][0] = pBuf0;
+  appExtSlaveCb.pPerAdvStreamBuf[advHandle][1] = pBuf1;
+  appExtSlaveCb.perAdvStreamBufLen[advHandle] = bufLen;
+  appExtSlaveCb.perAdvStreamIdx[advHandle] = 0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the stream buffer to fill with the next periodic advertising data.
+ *
+ *  \param  advHandle Advertising handle.
+ *
+ *  \return Stream buffer.
+ */
+/*************************************************************************************************/
+uint8_t *AppPerAdvStreamBuf(uint8_t advHandle)
+{
+  WSF_ASSERT(advHandle < DM_NUM_ADV_SETS);
+
+  return appExtSlaveCb.pPerAdvStreamBuf[advHandle][appExtSlaveCb.perAdvStreamIdx[advHandle]];
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send the filled stream buffer as the periodic advertising data and swap buffers.
+ *          While periodic advertising is enabled the data is sent with a single complete data
+ *          command and the Controller applies it at the next periodic advertising event.
+ *
+ *  \param  advHandle Advertising handle.
+ *  \param  len       Length of the data, at most HCI_PER_ADV_DATA_LEN bytes.
+ *
+ *  \return TRUE if the data was sent, FALSE otherwise.
+ */
+/*************************************************************************************************/
+bool_t AppPerAdvStreamSend(uint8_t advHandle, uint16_t len)
+{
+  uint8_t idx;
+
+  WSF_ASSERT(advHandle < DM_NUM_ADV_SETS);
+
+  idx = appExtSlaveCb.perAdvStreamIdx[advHandle];
+
+  if (!appSlaveExtAdvMode() ||
+      (appExtSlaveCb.pPerAdvStreamBuf[advHandle][idx] == NULL) ||
+      (len > appExtSlaveCb.perAdvStreamBufLen[advHandle]) ||
+      (len > HCI_PER_ADV_DATA_LEN))
+  {
+    return FALSE;
+  }
+
+  /* the filled buffer becomes the periodic advertising data; DM reads it until the command
+   * is sent so the Application fills the other buffer next
+   */
+  appPerAdvSetData(advHandle, len, appExtSlaveCb.pPerAdvStreamBuf[advHandle][idx],
+                   appExtSlaveCb.perAdvStreamBufLen[advHandle]);
+
+  appExtSlaveCb.perAdvStreamIdx[advHandle] = idx ^ 1;
+
+  return TRUE;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Set the value of an advertising data element in the periodic advertising data.
@@ -33,6 +33,7 @@
 #include "wsf_types.h"
 #include "wsf_assert.h"
 #include "wsf_trace.h"
+#include "wsf_buf.h"
 #include "wsf_bufio.h"
 #include "util/bstream.h"
 
@@ -48,6 +49,9 @@ static uint8_t appTerminalCommandBtnHandler(uint32_t argc, char **argv);
 /*! \brief    Security Pin Code Command Handler. */
 static uint8_t appTerminalPinCodeHandler(uint32_t argc, char **argv);
 
+/*! \brief    Buffer Statistics Command Handler. */
+static uint8_t appTerminalBufHandler(uint32_t argc, char **argv);
+
 /**************************************************************************************************
   Local Variables
 **************************************************************************************************/
@@ -58,6 +62,9 @@ static terminalCommand_t appTerminalButtonPress = { NULL, "btn", "btn <ID> <s|m|
 /*! \brief    Security Pin Code commands. */
 static terminalCommand_t appTerminalPinCode = { NULL, "pin", "pin <ConnID> <Pin Code>", appTerminalPinCodeHandler };
 
+/*! \brief    Buffer statistics command. */
+static terminalCommand_t appTerminalBuf = { NULL, "buf", "buf [clear]", appTerminalBufHandler };
+
 /*************************************************************************************************/
 /*!
  *  \brief  Initialize terminal.
@@ -78,6 +85,7 @@ void AppTerminalInit(void)
   /* Register commands. */
   TerminalRegisterCommand(&appTerminalButtonPress);
   TerminalRegisterCommand(&appTerminalPinCode);
+  TerminalRegisterCommand(&appTerminalBuf);
 }
 
 /*************************************************************************************************/
@@ -202,3 +210,66 @@ static uint8_t appTerminalPinCodeHandler(uint32_t argc, char **argv)
 
   return TERMINAL_ERROR_OK;
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handler for a buffer statistics terminal command.
+ *
+ *  Prints one "wsfbuf pool" line per pool and one "wsfbuf bin" line per used request length
+ *  histogram bin, for script/wsf_buf_pools.py.
+ *
+ *  \param  argc      The number of arguments passed to the command.
+ *  \param  argv      The array of arguments; the 0th argument is the command.
+ *
+ *  \return Error code.
+ */
+/*************************************************************************************************/
+static uint8_t appTerminalBufHandler(uint32_t argc, char **argv)
+{
+  WsfBufPoolStat_t stat;
+  uint8_t *pOverflow;
+  uint32_t *pHist;
+  uint8_t i;
+
+  if (argc == 2)
+  {
+    if (strcmp(argv[1], "clear") != 0)
+    {
+      return TERMINAL_ERROR_BAD_ARGUMENTS;
+    }
+
+    WsfBufClearStats();
+    return TERMINAL_ERROR_OK;
+  }
+  else if (argc > 2)
+  {
+    return TERMINAL_ERROR_TOO_MANY_ARGUMENTS;
+  }
+
+  pOverflow = WsfBufGetPoolOverFlowStats();
+
+  /* id len num maxAlloc maxReqLen overflow numReq sumAlloc */
+  for (i = 0; i < WsfBufGetNumPool(); i++)
+  {
+    WsfBufGetPoolStats(&stat, i);
+    TerminalTxPrint("wsfbuf pool %u %u %u %u %u %u %u %u" TERMINAL_STRING_NEW_LINE, i, stat.bufSize,
+                    stat.numBuf, stat.maxAlloc, stat.maxReqLen,
+                    (pOverflow != NULL) ? pOverflow[i] : 0, stat.numReq, stat.sumAlloc);
+  }
+
+  /* binLen index count */
+  if ((pHist = WsfBufGetReqHist()) != NULL)
+  {
+    for (i = 0; i < WSF_BUF_STATS_MAX_BIN; i++)
+    {
+      if (pHist[i] != 0)
+      {
+        TerminalTxPrint("wsfbuf bin %u %u %u" TERMINAL_STRING_NEW_LINE, WSF_BUF_STATS_BIN_LEN, i, pHist[i]);
+      }
+    }
+  }
+
+  TerminalTxPrint("wsfbuf end" TERMINAL_STRING_NEW_LINE);
+
+  return TERMINAL_ERROR_OK;
+}
@@ -26,7 +26,9 @@
 #include "wsf_types.h"
 #include "wsf_assert.h"
 #include "wsf_nvm.h"
+#include "wsf_timer.h"
 #include "util/bda.h"
+#include "util/bstream.h"
 #include "app_api.h"
 #include "app_main.h"
 #include "app_db.h"
@@ -37,11 +39,14 @@
 **************************************************************************************************/
 
 /*! App DB NVM version id. */
-#define APP_DB_NVM_VERSION                    0x0001
+#define APP_DB_NVM_VERSION                    0x0002
 
-/*! App DB NVM base identifiers. */
+/*! App DB NVM base identifiers.  Records stored one parameter per entry by earlier versions
+ *  take up to 0x4000 identifiers from the record base. */
 #define APP_DB_NVM_BASE                       0x1000
 #define APP_DB_NVM_RECORD_BASE                (APP_DB_NVM_BASE)
+#define APP_DB_NVM_HASH_CACHE_BASE            (APP_DB_NVM_BASE + 0x7000)
+#define APP_DB_NVM_PACKED_BASE                (APP_DB_NVM_BASE + 0x8000)
 
 /*! App DB NVM record parameter indicies. */
 #define APP_DB_NVM_IN_USE_ID                  0
@@ -72,9 +77,15 @@
 /*! Macro to generate NVM id from a record parameter index and record index. */
 #define DBNV_ID(p, i)                         (APP_DB_NVM_RECORD_BASE + (APP_DB_NVM_HDL_MAX * i) + p)
 
+/*! Macro to generate NVM id of a packed record from a record index and slot. */
+#define APP_DB_NVM_PACKED_ID(i, slot)         (APP_DB_NVM_PACKED_BASE + (2 * (i)) + (slot))
+
 /*! Invalid index */
 #define APP_DB_INDEX_INVALID                  0xFF
 
+/*! Hash index link to no record; links hold the record index plus one */
+#define APP_DB_IDX_NONE                       0
+
 /**************************************************************************************************
   Data Types
 **************************************************************************************************/
@@ -115,15 +126,53 @@ typedef struct
   uint8_t      discStatus;                    /*! Service discovery and configuration status */
 } appDbRec_t;
 
+/*! Handle list cached for a peer database hash */
+typedef struct
+{
+  uint8_t      dbHash[ATT_DATABASE_HASH_LEN]; /*! Peer database hash */
+  uint16_t     hdlList[APP_DB_HDL_LIST_LEN];  /*! Cached handle list */
+  bool_t       valid;                         /*! TRUE if entry is valid */
+} appDbHashCache_t;
+
+/*! Record index by a hash of a key, chaining records in the same hash bucket */
+typedef struct
+{
+  uint8_t     head[APP_DB_NUM_RECS];              /*! Link to first record in each bucket */
+  uint8_t     next[APP_DB_NUM_RECS];              /*! Link to next record in the same bucket */
+} appDbIdx_t;
+
 /*! Database type */
 typedef struct
 {
   appDbRec_t  rec[APP_DB_NUM_RECS];               /*! Device database records */
+  appDbIdx_t  addrIdx;                            /*! Records in use by peer address */
+  appDbIdx_t  ltkIdx;                             /*! Records in use by local LTK EDIV and Rand */
+  appDbHashCache_t hashCache[APP_DB_HASH_CACHE_LEN]; /*! Handle lists by peer database hash */
+  uint8_t     hashCacheNext;                      /*! Hash cache entry to overwrite next */
   char        devName[ATT_DEFAULT_PAYLOAD_LEN];   /*! Device name */
   uint8_t     devNameLen;                         /*! Device name length */
   uint8_t     dbHash[ATT_DATABASE_HASH_LEN];      /*! Device GATT database hash */
 } appDb_t;
 
+/*! Device record as stored in NVM */
+typedef struct
+{
+  uint16_t    version;                            /*! NVM version id */
+  uint16_t    seq;                                /*! Incremented on each write of the record */
+  appDbRec_t  rec;                                /*! Device database record */
+} appDbNvmRec_t;
+
+/*! NVM control */
+typedef struct
+{
+  appDbNvmRec_t buf;                              /*! Packed record buffer */
+  wsfTimer_t  flushTimer;                         /*! Timer to write changed records */
+  uint16_t    seq[APP_DB_NUM_RECS];               /*! Sequence number of latest stored version */
+  uint8_t     slot[APP_DB_NUM_RECS];              /*! NVM slot of latest stored version */
+  bool_t      dirty[APP_DB_NUM_RECS];             /*! TRUE if record changed since it was stored */
+  bool_t      legacy[APP_DB_NUM_RECS];            /*! TRUE if record is stored by an earlier version */
+} appDbNvm_t;
+
 /**************************************************************************************************
   Local Variables
 **************************************************************************************************/
@@ -134,6 +183,9 @@ static appDb_t appDb;
 /*! When all records are allocated use this index to determine which to overwrite */
 static appDbRec_t *pAppDbNewRec = appDb.rec;
 
+/*! NVM control block */
+static appDbNvm_t appDbNvmCb;
+
 /*************************************************************************************************/
 /*!
  *  \brief  Find the index of the record in the app DB.
@@ -148,15 +200,13 @@ static uint8_t appDbFindIndx(appDbHdl_t hdl)
   appDbRec_t  *pRec = (appDbRec_t *) hdl;
   uint8_t     i;
 
-  if (pRec && pRec->inUse)
+  if ((pRec >= appDb.rec) && (pRec < &appDb.rec[APP_DB_NUM_RECS]))
   {
-    /* Find record index. */
-    for (i = 0; i < APP_DB_NUM_RECS; i++)
+    i = (uint8_t) (pRec - appDb.rec);
+
+    if ((&appDb.rec[i] == pRec) && pRec->inUse)
     {
-      if (&appDb.rec[i] == pRec)
-      {
-        return i;
-      }
+      return i;
     }
   }
 
@@ -164,6 +214,164 @@ static uint8_t appDbFindIndx(appDbHdl_t hdl)
   return APP_DB_INDEX_INVALID;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Hash a key, FNV-1a.
+ *
+ *  \param  pKey      Key.
+ *  \param  len       Key length.
+ *  \param  hash      Hash of the preceding part of the key.
+ *
+ *  \return Hash.
+ */
+/*************************************************************************************************/
+static uint32_t appDbHash(const uint8_t *pKey, uint8_t len, uint32_t hash)
+{
+  while (len-- > 0)
+  {
+    hash = (hash ^ *pKey++) * 16777619;
+  }
+
+  return hash;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the address index bucket of a peer address.
+ *
+ *  \param  addrType  Host address type.
+ *  \param  pAddr     Peer device address.
+ *
+ *  \return Bucket.
+ */
+/*************************************************************************************************/
+static uint8_t appDbAddrBucket(uint8_t addrType, const uint8_t *pAddr)
+{
+  uint32_t hash = appDbHash(&addrType, 1, 2166136261u);
+
+  return appDbHash(pAddr, BDA_ADDR_LEN, hash) % APP_DB_NUM_RECS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the LTK index bucket of an EDIV and Rand.
+ *
+ *  \param  encDiversifier  Encryption diversifier.
+ *  \param  pRandNum        Random number.
+ *
+ *  \return Bucket.
+ */
+/*************************************************************************************************/
+static uint8_t appDbLtkBucket(uint16_t encDiversifier, const uint8_t *pRandNum)
+{
+  uint8_t  ediv[2] = {UINT16_TO_BYTES(encDiversifier)};
+  uint32_t hash = appDbHash(ediv, sizeof(ediv), 2166136261u);
+
+  return appDbHash(pRandNum, SMP_RAND8_LEN, hash) % APP_DB_NUM_RECS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add a record to an index.
+ *
+ *  \param  pIdx      Index.
+ *  \param  bucket    Bucket.
+ *  \param  i         Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbIdxInsert(appDbIdx_t *pIdx, uint8_t bucket, uint8_t i)
+{
+  pIdx->next[i] = pIdx->head[bucket];
+  pIdx->head[bucket] = i + 1;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Remove a record from an index.
+ *
+ *  \param  pIdx      Index.
+ *  \param  bucket    Bucket the record was added to.
+ *  \param  i         Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbIdxRemove(appDbIdx_t *pIdx, uint8_t bucket, uint8_t i)
+{
+  uint8_t *pLink = &pIdx->head[bucket];
+
+  while (*pLink != APP_DB_IDX_NONE)
+  {
+    if (*pLink == (i + 1))
+    {
+      *pLink = pIdx->next[i];
+      return;
+    }
+
+    pLink = &pIdx->next[*pLink - 1];
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add a record in use to the address and LTK indexes.
+ *
+ *  \param  i         Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbIdxAdd(uint8_t i)
+{
+  appDbRec_t *pRec = &appDb.rec[i];
+
+  appDbIdxInsert(&appDb.addrIdx, appDbAddrBucket(pRec->addrType, pRec->peerAddr), i);
+  appDbIdxInsert(&appDb.ltkIdx, appDbLtkBucket(pRec->localLtk.ediv, pRec->localLtk.rand), i);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Remove a record from the address and LTK indexes.  Called before the keys of the
+ *          record change.
+ *
+ *  \param  i         Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbIdxDel(uint8_t i)
+{
+  appDbRec_t *pRec = &appDb.rec[i];
+
+  appDbIdxRemove(&appDb.addrIdx, appDbAddrBucket(pRec->addrType, pRec->peerAddr), i);
+  appDbIdxRemove(&appDb.ltkIdx, appDbLtkBucket(pRec->localLtk.ediv, pRec->localLtk.rand), i);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Rebuild the address and LTK indexes from the records in use.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbIdxRebuild(void)
+{
+  uint8_t i;
+
+  memset(&appDb.addrIdx, APP_DB_IDX_NONE, sizeof(appDb.addrIdx));
+  memset(&appDb.ltkIdx, APP_DB_IDX_NONE, sizeof(appDb.ltkIdx));
+
+  for (i = 0; i < APP_DB_NUM_RECS; i++)
+  {
+    if (appDb.rec[i].inUse)
+    {
+      appDbIdxAdd(i);
+    }
+  }
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Initialize the device database.
@@ -173,7 +381,7 @@ static uint8_t appDbFindIndx(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbInit(void)
 {
-  return;
+  appDbIdxRebuild();
 }
 
 /*************************************************************************************************/
@@ -205,6 +413,7 @@ appDbHdl_t AppDbNewRecord(uint8_t addrType, uint8_t *pAddr)
   {
     /* overwrite a record */
     pRec = pAppDbNewRec;
+    appDbIdxDel((uint8_t) (pRec - appDb.rec));
 
     /* get next record to overwrite */
     pAppDbNewRec++;
@@ -222,6 +431,8 @@ appDbHdl_t AppDbNewRecord(uint8_t addrType, uint8_t *pAddr)
   pRec->peerAddedToRl = FALSE;
   pRec->peerRpao = FALSE;
 
+  appDbIdxAdd((uint8_t) (pRec - appDb.rec));
+
   return (appDbHdl_t) pRec;
 }
 
@@ -285,6 +496,13 @@ appDbHdl_t AppDbGetNextRecord(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbDeleteRecord(appDbHdl_t hdl)
 {
+  uint8_t i = appDbFindIndx(hdl);
+
+  if (i != APP_DB_INDEX_INVALID)
+  {
+    appDbIdxDel(i);
+  }
+
   ((appDbRec_t *) hdl)->inUse = FALSE;
 }
 
@@ -334,19 +552,10 @@ void AppDbCheckValidRecord(appDbHdl_t hdl)
 /*************************************************************************************************/
 bool_t AppDbRecordInUse(appDbHdl_t hdl)
 {
-  appDbRec_t  *pRec = appDb.rec;
-  uint8_t     i;
+  uint8_t i = appDbFindIndx(hdl);
 
   /* see if record is in database record list */
-  for (i = APP_DB_NUM_RECS; i > 0; i--, pRec++)
-  {
-    if (pRec->inUse && pRec->valid && (pRec == ((appDbRec_t *)hdl)))
-    {
-      return TRUE;
-    }
-  }
-
-  return FALSE;
+  return (i != APP_DB_INDEX_INVALID) && appDb.rec[i].valid;
 }
 
 /*************************************************************************************************/
@@ -392,6 +601,8 @@ void AppDbDeleteAllRecords(void)
   {
     pRec->inUse = FALSE;
   }
+
+  appDbIdxRebuild();
 }
 
 /*************************************************************************************************/
@@ -406,14 +617,17 @@ void AppDbDeleteAllRecords(void)
 /*************************************************************************************************/
 appDbHdl_t AppDbFindByAddr(uint8_t addrType, uint8_t *pAddr)
 {
-  appDbRec_t  *pRec = appDb.rec;
+  appDbRec_t  *pRec;
   uint8_t     peerAddrType = DmHostAddrType(addrType);
-  uint8_t     i;
+  uint8_t     link;
 
-  /* find matching record */
-  for (i = APP_DB_NUM_RECS; i > 0; i--, pRec++)
+  /* find matching record in the address bucket */
+  for (link = appDb.addrIdx.head[appDbAddrBucket(peerAddrType, pAddr)]; link != APP_DB_IDX_NONE;
+       link = appDb.addrIdx.next[link - 1])
   {
-    if (pRec->inUse && (pRec->addrType == peerAddrType) && BdaCmp(pRec->peerAddr, pAddr))
+    pRec = &appDb.rec[link - 1];
+
+    if ((pRec->addrType == peerAddrType) && BdaCmp(pRec->peerAddr, pAddr))
     {
       return (appDbHdl_t) pRec;
     }
@@ -434,13 +648,16 @@ appDbHdl_t AppDbFindByAddr(uint8_t addrType, uint8_t *pAddr)
 /*************************************************************************************************/
 appDbHdl_t AppDbFindByLtkReq(uint16_t encDiversifier, uint8_t *pRandNum)
 {
-  appDbRec_t  *pRec = appDb.rec;
-  uint8_t     i;
+  appDbRec_t  *pRec;
+  uint8_t     link;
 
-  /* find matching record */
-  for (i = APP_DB_NUM_RECS; i > 0; i--, pRec++)
+  /* find matching record in the LTK bucket */
+  for (link = appDb.ltkIdx.head[appDbLtkBucket(encDiversifier, pRandNum)]; link != APP_DB_IDX_NONE;
+       link = appDb.ltkIdx.next[link - 1])
   {
-    if (pRec->inUse && (pRec->localLtk.ediv == encDiversifier) &&
+    pRec = &appDb.rec[link - 1];
+
+    if ((pRec->localLtk.ediv == encDiversifier) &&
         (memcmp(pRec->localLtk.rand, pRandNum, SMP_RAND8_LEN) == 0))
     {
       return (appDbHdl_t) pRec;
@@ -508,6 +725,14 @@ dmSecKey_t *AppDbGetKey(appDbHdl_t hdl, uint8_t type, uint8_t *pSecLevel)
 /*************************************************************************************************/
 void AppDbSetKey(appDbHdl_t hdl, dmSecKeyIndEvt_t *pKey)
 {
+  uint8_t i = appDbFindIndx(hdl);
+
+  /* the LTK and IRK change the keys the record is indexed by */
+  if (i != APP_DB_INDEX_INVALID)
+  {
+    appDbIdxDel(i);
+  }
+
   switch(pKey->type)
   {
     case DM_KEY_LOCAL_LTK:
@@ -538,6 +763,11 @@ void AppDbSetKey(appDbHdl_t hdl, dmSecKeyIndEvt_t *pKey)
     default:
       break;
   }
+
+  if (i != APP_DB_INDEX_INVALID)
+  {
+    appDbIdxAdd(i);
+  }
 }
 
 /*************************************************************************************************/
@@ -786,6 +1016,77 @@ void AppDbSetHdlList(appDbHdl_t hdl, uint16_t *pHdlList)
   memcpy(((appDbRec_t *) hdl)->hdlList, pHdlList, sizeof(((appDbRec_t *) hdl)->hdlList));
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Find the hash cache entry for a peer database hash.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *
+ *  \return Pointer to entry or NULL if the hash is not cached.
+ */
+/*************************************************************************************************/
+static appDbHashCache_t *appDbFindHashCache(const uint8_t *pDbHash)
+{
+  uint8_t i;
+
+  for (i = 0; i < APP_DB_HASH_CACHE_LEN; i++)
+  {
+    if (appDb.hashCache[i].valid &&
+        (memcmp(appDb.hashCache[i].dbHash, pDbHash, ATT_DATABASE_HASH_LEN) == 0))
+    {
+      return &appDb.hashCache[i];
+    }
+  }
+
+  return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the handle list cached for a peer database hash.  Peers with the same database
+ *          hash have the same attribute handles.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *
+ *  \return Pointer to handle list or NULL if the hash is not cached.
+ */
+/*************************************************************************************************/
+uint16_t *AppDbGetHashHdlList(const uint8_t *pDbHash)
+{
+  appDbHashCache_t *pEntry = appDbFindHashCache(pDbHash);
+
+  return (pEntry != NULL) ? pEntry->hdlList : NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Cache the handle list for a peer database hash.  When the cache is full the entries
+ *          are overwritten in turn.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *  \param  pHdlList  Pointer to handle list.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSetHashHdlList(const uint8_t *pDbHash, uint16_t *pHdlList)
+{
+  appDbHashCache_t *pEntry;
+
+  WSF_ASSERT(pDbHash != NULL);
+
+  if ((pEntry = appDbFindHashCache(pDbHash)) == NULL)
+  {
+    pEntry = &appDb.hashCache[appDb.hashCacheNext];
+    appDb.hashCacheNext = (appDb.hashCacheNext + 1) % APP_DB_HASH_CACHE_LEN;
+
+    memcpy(pEntry->dbHash, pDbHash, ATT_DATABASE_HASH_LEN);
+    pEntry->valid = TRUE;
+  }
+
+  memcpy(pEntry->hdlList, pHdlList, sizeof(pEntry->hdlList));
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get the device name.
@@ -946,72 +1247,208 @@ void AppDbSetPeerRpao(appDbHdl_t hdl, bool_t peerRpao)
 
 /*************************************************************************************************/
 /*!
- *  \brief  Store the resolvable private address only attribute flag for a device record in NVM.
+ *  \brief  Read a packed device record from an NVM slot into the read buffer.
  *
- *  \param  hdl        Database record handle.
+ *  \param  i         Record index.
+ *  \param  slot      NVM slot.
  *
- *  \return None.
+ *  \return TRUE if a valid bond record was read, FALSE otherwise.
  */
 /*************************************************************************************************/
-void AppDbNvmStorePeerRpao(appDbHdl_t hdl)
+static bool_t appDbNvmReadSlot(uint8_t i, uint8_t slot)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
+  return WsfNvmReadData(APP_DB_NVM_PACKED_ID(i, slot), (uint8_t *) &appDbNvmCb.buf,
+                        sizeof(appDbNvmRec_t), NULL) &&
+         (appDbNvmCb.buf.version == APP_DB_NVM_VERSION) &&
+         appDbNvmCb.buf.rec.inUse && appDbNvmCb.buf.rec.valid;
+}
 
-  if (recIndex != APP_DB_INDEX_INVALID)
+/*************************************************************************************************/
+/*!
+ *  \brief  Write a device record to NVM as one packed record.  The record is written to the slot
+ *          not holding its latest version, so a write cut short leaves the latest version intact.
+ *          Nothing is written if the latest version holds the same record.
+ *
+ *  \param  i         Record index.
+ *
+ *  \return TRUE if successful, FALSE otherwise.
+ */
+/*************************************************************************************************/
+static bool_t appDbNvmWriteRec(uint8_t i)
+{
+  uint8_t slot = appDbNvmCb.slot[i] ^ 1;
+
+  /* Skip the write if the record is unchanged. */
+  if (!appDbNvmCb.legacy[i] && appDbNvmReadSlot(i, appDbNvmCb.slot[i]) &&
+      (appDbNvmCb.buf.seq == appDbNvmCb.seq[i]) &&
+      (memcmp(&appDbNvmCb.buf.rec, &appDb.rec[i], sizeof(appDbRec_t)) == 0))
   {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_PEER_RAPO_ID, recIndex);
+    appDbNvmCb.dirty[i] = FALSE;
+    return TRUE;
+  }
+
+  appDbNvmCb.buf.version = APP_DB_NVM_VERSION;
+  appDbNvmCb.buf.seq = appDbNvmCb.seq[i] + 1;
+  memcpy(&appDbNvmCb.buf.rec, &appDb.rec[i], sizeof(appDbRec_t));
 
-    WsfNvmWriteData(nvmId, &pRec->peerRpao, sizeof(bool_t), NULL);
+  if (!WsfNvmWriteData(APP_DB_NVM_PACKED_ID(i, slot), (uint8_t *) &appDbNvmCb.buf,
+                       sizeof(appDbNvmRec_t), NULL))
+  {
+    return FALSE;
   }
+
+  appDbNvmCb.seq[i] = appDbNvmCb.buf.seq;
+  appDbNvmCb.slot[i] = slot;
+  appDbNvmCb.dirty[i] = FALSE;
+
+  /* The record stored by an earlier version is replaced. */
+  if (appDbNvmCb.legacy[i])
+  {
+    WsfNvmEraseData(DBNV_ID(APP_DB_NVM_VALID_ID, i), NULL);
+    appDbNvmCb.legacy[i] = FALSE;
+  }
+
+  return TRUE;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Store the client characteristic configuration table for a device record in NVM.
+ *  \brief  Read a device record stored one parameter per NVM entry by an earlier version.
  *
- *  \param  hdl       Database record handle.
+ *  \param  i         Record index.
  *
- *  \return None.
+ *  \return TRUE if a valid bond record was read, FALSE otherwise.
  */
 /*************************************************************************************************/
-void AppDbNvmStoreCccTbl(appDbHdl_t hdl)
+static bool_t appDbNvmReadLegacy(uint8_t i)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
+  bool_t valid = FALSE;
+  appDbRec_t *pRec = &appDb.rec[i];
 
-  if (recIndex != APP_DB_INDEX_INVALID)
+  /* Verify record is valid. */
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_VALID_ID, i), &valid, sizeof(bool_t), NULL);
+
+  if (!valid || valid == 0xFF)
   {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_CCC_TBL_ID, recIndex);
+    return FALSE;
+  }
+
+  pRec->inUse = TRUE;
+  pRec->valid = TRUE;
+
+  /* Read bonding parameters. */
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_ADDR_ID, i), pRec->peerAddr, sizeof(bdAddr_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_ADDR_TYPE_ID, i), &pRec->addrType, sizeof(uint8_t), NULL);
 
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->cccTbl, sizeof(uint16_t) * APP_DB_NUM_CCCD, NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_KV_MASK_ID, i), &pRec->keyValidMask, sizeof(uint8_t), NULL);
+
+  if (pRec->keyValidMask & DM_KEY_LOCAL_LTK)
+  {
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_LOCAL_LTK_ID, i), (uint8_t*) &pRec->localLtk, sizeof(dmSecLtk_t), NULL);
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_LOCAL_SEC_LVL_ID, i), &pRec->localLtkSecLevel, sizeof(uint8_t), NULL);
+  }
+
+  if (pRec->keyValidMask & DM_KEY_PEER_LTK)
+  {
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_LTK_ID, i), (uint8_t*) &pRec->peerLtk, sizeof(dmSecLtk_t), NULL);
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_SEC_LVL_ID, i), &pRec->peerLtkSecLevel, sizeof(uint8_t), NULL);
   }
+
+  if (pRec->keyValidMask & DM_KEY_IRK)
+  {
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_IRK_ID, i), (uint8_t*) &pRec->peerIrk, sizeof(dmSecIrk_t), NULL);
+  }
+
+  if (pRec->keyValidMask & DM_KEY_CSRK)
+  {
+    WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_CSRK_ID, i), (uint8_t*) &pRec->peerCsrk, sizeof(dmSecCsrk_t), NULL);
+  }
+
+  /* Read additional parameters. */
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_RAPO_ID, i), &pRec->peerRpao, sizeof(bool_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_CCC_TBL_ID, i), (uint8_t*) pRec->cccTbl, sizeof(uint16_t) * APP_DB_NUM_CCCD, NULL);
+
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_HDL_LIST_ID, i), (uint8_t*) &pRec->hdlList, sizeof(uint16_t) * APP_DB_HDL_LIST_LEN, NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_DISC_STATUS_ID, i), &pRec->discStatus, sizeof(uint8_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_ADDR_RES_ID, i), &pRec->peerAddrRes, sizeof(bool_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_SIGN_CTR_ID, i), (uint8_t*) &pRec->peerSignCounter, sizeof(uint32_t), NULL);
+
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_CAS_ID, i), &pRec->changeAwareState, sizeof(uint8_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_CSF_ID, i), pRec->csf, ATT_CSF_LEN, NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_CACHE_HASH_ID, i), &pRec->cacheByHash, sizeof(bool_t), NULL);
+  WsfNvmReadData(DBNV_ID(APP_DB_NVM_HASH_ID, i), pRec->dbHash, ATT_DATABASE_HASH_LEN, NULL);
+
+  return TRUE;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Store the cached attribute handle list for a device record in NVM.
+ *  \brief  Mark a device record changed.  Changed records are written to NVM when the connection
+ *          closes or when the flush timer expires, whichever is first.
  *
  *  \param  hdl       Database record handle.
  *
  *  \return None.
  */
 /*************************************************************************************************/
-void AppDbNvmStoreHdlList(appDbHdl_t hdl)
+static void appDbNvmSetDirty(appDbHdl_t hdl)
 {
   uint8_t recIndex = appDbFindIndx(hdl);
 
   if (recIndex != APP_DB_INDEX_INVALID)
   {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_HDL_LIST_ID, recIndex);
+    appDbNvmCb.dirty[recIndex] = TRUE;
 
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->hdlList, sizeof(uint16_t) * APP_DB_HDL_LIST_LEN, NULL);
+    /* Start the timer on the first change only so a stream of changes is written in time. */
+    if (!appDbNvmCb.flushTimer.isStarted)
+    {
+      appDbNvmCb.flushTimer.handlerId = appHandlerId;
+      appDbNvmCb.flushTimer.msg.event = APP_DB_NVM_FLUSH_IND;
+      WsfTimerStartMs(&appDbNvmCb.flushTimer, APP_DB_NVM_FLUSH_MS);
+    }
+  }
+}
 
-    nvmId = DBNV_ID(APP_DB_NVM_DISC_STATUS_ID, recIndex);
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the resolvable private address only attribute flag for a device record in NVM.
+ *
+ *  \param  hdl        Database record handle.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmStorePeerRpao(appDbHdl_t hdl)
+{
+  appDbNvmSetDirty(hdl);
+}
 
-    WsfNvmWriteData(nvmId, &pRec->discStatus, sizeof(uint8_t), NULL);
-  }
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the client characteristic configuration table for a device record in NVM.
+ *
+ *  \param  hdl       Database record handle.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmStoreCccTbl(appDbHdl_t hdl)
+{
+  appDbNvmSetDirty(hdl);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the cached attribute handle list for a device record in NVM.
+ *
+ *  \param  hdl       Database record handle.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmStoreHdlList(appDbHdl_t hdl)
+{
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1025,15 +1462,7 @@ void AppDbNvmStoreHdlList(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStorePeerSignCounter(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
-
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_PEER_SIGN_CTR_ID, recIndex);
-
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->peerSignCounter, sizeof(uint32_t), NULL);
-  }
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1047,15 +1476,7 @@ void AppDbNvmStorePeerSignCounter(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStorePeerAddrRes(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
-
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_PEER_ADDR_RES_ID, recIndex);
-
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->peerAddrRes, sizeof(bool_t), NULL);
-  }
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1069,15 +1490,7 @@ void AppDbNvmStorePeerAddrRes(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStoreChangeAwareState(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
-
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_CAS_ID, recIndex);
-
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->changeAwareState, sizeof(uint8_t), NULL);
-  }
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1091,15 +1504,7 @@ void AppDbNvmStoreChangeAwareState(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStoreCsfRecord(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
-
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_CSF_ID, recIndex);
-
-    WsfNvmWriteData(nvmId, (uint8_t*) pRec->csf, ATT_CSF_LEN, NULL);
-  }
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1113,15 +1518,7 @@ void AppDbNvmStoreCsfRecord(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStoreCacheByHash(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
-
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_CACHE_HASH_ID, recIndex);
-
-    WsfNvmWriteData(nvmId, (uint8_t*) &pRec->cacheByHash, sizeof(bool_t), NULL);
-  }
+  appDbNvmSetDirty(hdl);
 }
 
 /*************************************************************************************************/
@@ -1135,20 +1532,33 @@ void AppDbNvmStoreCacheByHash(appDbHdl_t hdl)
 /*************************************************************************************************/
 void AppDbNvmStoreDbHash(appDbHdl_t hdl)
 {
-  uint8_t recIndex = appDbFindIndx(hdl);
+  appDbNvmSetDirty(hdl);
+}
 
-  if (recIndex != APP_DB_INDEX_INVALID)
-  {
-    appDbRec_t *pRec = &appDb.rec[recIndex];
-    uint32_t nvmId = DBNV_ID(APP_DB_NVM_HASH_ID, recIndex);
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the handle list cached for a peer database hash in NVM.
+ *
+ *  \param  pDbHash   Peer database hash.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmStoreHashHdlList(const uint8_t *pDbHash)
+{
+  appDbHashCache_t *pEntry = appDbFindHashCache(pDbHash);
 
-    WsfNvmWriteData(nvmId, pRec->dbHash, ATT_DATABASE_HASH_LEN, NULL);
+  if (pEntry != NULL)
+  {
+    WsfNvmWriteData(APP_DB_NVM_HASH_CACHE_BASE + (pEntry - appDb.hashCache), (uint8_t *) pEntry,
+                    sizeof(appDbHashCache_t), NULL);
   }
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Store bonding information for device record in NVM.
+ *  \brief  Store bonding information for device record in NVM.  The record is written now with
+ *          any other changes to it.
  *
  *  \param  hdl       Database record handle.
  *
@@ -1161,50 +1571,48 @@ void AppDbNvmStoreBond(appDbHdl_t hdl)
 
   if (i != APP_DB_INDEX_INVALID)
   {
-    appDbRec_t *pRec = &appDb.rec[i];
-
-    if (pRec->inUse && pRec->valid)
+    if (appDb.rec[i].inUse && appDb.rec[i].valid)
     {
-      bool_t valid = FALSE;
-
-      /* Protect against corrupt bond state due to incomplete writes (power failure, crash, etc.). */
-      /*  - First ensure valid FALSE before writing parameters. */
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_VALID_ID, i), &valid, sizeof(bool_t), NULL);
+      appDbNvmWriteRec(i);
+    }
+  }
+}
 
-      /* Write record parameters. */
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_KV_MASK_ID, i), &pRec->keyValidMask, sizeof(uint8_t), NULL);
+/*************************************************************************************************/
+/*!
+ *  \brief  Write all changed device database records to NVM.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbNvmFlush(void)
+{
+  uint8_t i;
+  bool_t  pending = FALSE;
 
-      if (pRec->keyValidMask & DM_KEY_LOCAL_LTK)
-      {
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_LOCAL_LTK_ID, i), (uint8_t*) &pRec->localLtk, sizeof(dmSecLtk_t), NULL);
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_LOCAL_SEC_LVL_ID, i), &pRec->localLtkSecLevel, sizeof(uint8_t), NULL);
-      }
+  WsfTimerStop(&appDbNvmCb.flushTimer);
 
-      if (pRec->keyValidMask & DM_KEY_PEER_LTK)
-      {
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_PEER_LTK_ID, i), (uint8_t*) &pRec->peerLtk, sizeof(dmSecLtk_t), NULL);
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_PEER_SEC_LVL_ID, i), &pRec->peerLtkSecLevel, sizeof(uint8_t), NULL);
-      }
-
-      if (pRec->keyValidMask & DM_KEY_IRK)
+  for (i = 0; i < APP_DB_NUM_RECS; i++)
+  {
+    if (appDbNvmCb.dirty[i])
+    {
+      /* Records not bonded are not stored. */
+      if (!appDb.rec[i].inUse || !appDb.rec[i].valid)
       {
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_PEER_IRK_ID, i), (uint8_t*) &pRec->peerIrk, sizeof(dmSecIrk_t), NULL);
+        appDbNvmCb.dirty[i] = FALSE;
       }
-
-      if (pRec->keyValidMask & DM_KEY_CSRK)
+      else if (!appDbNvmWriteRec(i))
       {
-        WsfNvmWriteData(DBNV_ID(APP_DB_NVM_PEER_CSRK_ID, i), (uint8_t*) &pRec->peerCsrk, sizeof(dmSecCsrk_t), NULL);
+        pending = TRUE;
       }
-
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_PEER_ADDR_ID, i), pRec->peerAddr, sizeof(bdAddr_t), NULL);
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_ADDR_TYPE_ID, i), &pRec->addrType, sizeof(uint8_t), NULL);
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_CACHE_HASH_ID, i), &pRec->cacheByHash, sizeof(bool_t), NULL);
-
-      /* Protect against corrupt bond state due to incomplete writes (power failure, crash, etc.). */
-      /*  - Second set valid TRUE after writing parameters. */
-      WsfNvmWriteData(DBNV_ID(APP_DB_NVM_VALID_ID, i), &pRec->valid, sizeof(bool_t), NULL);
     }
   }
+
+  /* Retry failed writes later. */
+  if (pending)
+  {
+    WsfTimerStartMs(&appDbNvmCb.flushTimer, APP_DB_NVM_FLUSH_MS);
+  }
 }
 
 /*************************************************************************************************/
@@ -1221,59 +1629,85 @@ void AppDbNvmReadAll(void)
   /* Read all records. */
   for (i = 0; i < APP_DB_NUM_RECS; i++)
   {
-    bool_t valid = FALSE;
     appDbRec_t *pRec = &appDb.rec[i];
+    bool_t found = FALSE;
 
-    /* Verify record is valid. */
-    WsfNvmReadData(DBNV_ID(APP_DB_NVM_VALID_ID, i), &valid, sizeof(bool_t), NULL);
+    appDbNvmCb.seq[i] = 0;
+    appDbNvmCb.slot[i] = 1;
+    appDbNvmCb.dirty[i] = FALSE;
+    appDbNvmCb.legacy[i] = FALSE;
 
-    if (valid && valid != 0xFF)
+    /* Take the latest version of the record from its two slots. */
+    if (appDbNvmReadSlot(i, 0))
     {
-      pRec->inUse = TRUE;
-      pRec->valid = TRUE;
-
-      /* Read bonding parameters. */
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_ADDR_ID, i), pRec->peerAddr, sizeof(bdAddr_t), NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_ADDR_TYPE_ID, i), &pRec->addrType, sizeof(uint8_t), NULL);
-
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_KV_MASK_ID, i), &pRec->keyValidMask, sizeof(uint8_t), NULL);
+      *pRec = appDbNvmCb.buf.rec;
+      appDbNvmCb.seq[i] = appDbNvmCb.buf.seq;
+      appDbNvmCb.slot[i] = 0;
+      found = TRUE;
+    }
 
-      if (pRec->keyValidMask & DM_KEY_LOCAL_LTK)
-      {
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_LOCAL_LTK_ID, i), (uint8_t*) &pRec->localLtk, sizeof(dmSecLtk_t), NULL);
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_LOCAL_SEC_LVL_ID, i), &pRec->localLtkSecLevel, sizeof(uint8_t), NULL);
-      }
+    if (appDbNvmReadSlot(i, 1) &&
+        (!found || ((int16_t) (appDbNvmCb.buf.seq - appDbNvmCb.seq[i]) > 0)))
+    {
+      *pRec = appDbNvmCb.buf.rec;
+      appDbNvmCb.seq[i] = appDbNvmCb.buf.seq;
+      appDbNvmCb.slot[i] = 1;
+      found = TRUE;
+    }
 
-      if (pRec->keyValidMask & DM_KEY_PEER_LTK)
-      {
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_LTK_ID, i), (uint8_t*) &pRec->peerLtk, sizeof(dmSecLtk_t), NULL);
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_SEC_LVL_ID, i), &pRec->peerLtkSecLevel, sizeof(uint8_t), NULL);
-      }
+    if (found)
+    {
+      /* Resolving list is rebuilt after reset. */
+      pRec->peerAddedToRl = FALSE;
+    }
+    /* Convert a record stored by an earlier version, or retry on the next flush. */
+    else if (appDbNvmReadLegacy(i))
+    {
+      appDbNvmCb.legacy[i] = TRUE;
+      appDbNvmCb.dirty[i] = !appDbNvmWriteRec(i);
+    }
+  }
 
-      if (pRec->keyValidMask & DM_KEY_IRK)
-      {
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_IRK_ID, i), (uint8_t*) &pRec->peerIrk, sizeof(dmSecIrk_t), NULL);
-      }
+  appDbIdxRebuild();
 
-      if (pRec->keyValidMask & DM_KEY_CSRK)
-      {
-        WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_CSRK_ID, i), (uint8_t*) &pRec->peerCsrk, sizeof(dmSecCsrk_t), NULL);
-      }
+  /* Read handle lists cached by peer database hash. */
+  for (i = 0; i < APP_DB_HASH_CACHE_LEN; i++)
+  {
+    appDbHashCache_t *pEntry = &appDb.hashCache[i];
 
-      /* Read additional parameters. */
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_RAPO_ID, i), &pRec->peerRpao, sizeof(bool_t), NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_CCC_TBL_ID, i), (uint8_t*) pRec->cccTbl, sizeof(uint16_t) * APP_DB_NUM_CCCD, NULL);
+    if (!WsfNvmReadData(APP_DB_NVM_HASH_CACHE_BASE + i, (uint8_t *) pEntry, sizeof(appDbHashCache_t), NULL) ||
+        (pEntry->valid != TRUE))
+    {
+      memset(pEntry, 0, sizeof(appDbHashCache_t));
+    }
+    else
+    {
+      appDb.hashCacheNext = (i + 1) % APP_DB_HASH_CACHE_LEN;
+    }
+  }
+}
 
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_HDL_LIST_ID, i), (uint8_t*) &pRec->hdlList, sizeof(uint16_t) * APP_DB_HDL_LIST_LEN, NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_DISC_STATUS_ID, i), &pRec->discStatus, sizeof(uint8_t), NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_PEER_ADDR_RES_ID, i), &pRec->peerAddrRes, sizeof(bool_t), NULL);
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase a device database record from NVM.
+ *
+ *  \param  i         Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbNvmEraseRec(uint8_t i)
+{
+  WsfNvmEraseData(APP_DB_NVM_PACKED_ID(i, 0), NULL);
+  WsfNvmEraseData(APP_DB_NVM_PACKED_ID(i, 1), NULL);
 
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_CAS_ID, i), &pRec->changeAwareState, sizeof(uint8_t), NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_CSF_ID, i), pRec->csf, ATT_CSF_LEN, NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_CACHE_HASH_ID, i), &pRec->cacheByHash, sizeof(bool_t), NULL);
-      WsfNvmReadData(DBNV_ID(APP_DB_NVM_HASH_ID, i), pRec->dbHash, ATT_DATABASE_HASH_LEN, NULL);
-    }
+  if (appDbNvmCb.legacy[i])
+  {
+    WsfNvmEraseData(DBNV_ID(APP_DB_NVM_VALID_ID, i), NULL);
+    appDbNvmCb.legacy[i] = FALSE;
   }
+
+  appDbNvmCb.dirty[i] = FALSE;
 }
 
 /*************************************************************************************************/
@@ -1291,7 +1725,7 @@ void AppDbNvmDeleteRec(appDbHdl_t hdl)
 
   if (recIndex != APP_DB_INDEX_INVALID)
   {
-    WsfNvmEraseData(DBNV_ID(APP_DB_NVM_VALID_ID, recIndex), NULL);
+    appDbNvmEraseRec(recIndex);
   }
 }
 
@@ -1306,9 +1740,11 @@ void AppDbNvmDeleteAll(void)
 {
   uint8_t i;
 
+  WsfTimerStop(&appDbNvmCb.flushTimer);
+
   /* Delete all records. */
   for (i = 0; i < APP_DB_NUM_RECS; i++)
   {
-    WsfNvmEraseData(DBNV_ID(APP_DB_NVM_VALID_ID, i), NULL);
+    appDbNvmEraseRec(i);
   }
 }
@@ -24,6 +24,8 @@
 #ifndef GLPS_API_H
 #define GLPS_API_H
 
+#include "wsf_efs.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +49,18 @@ extern "C" {
 /*************************************************************************************************/
 void GlpsInit(void);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Set the media holding glucose records.  Call before GlpsInit().  Records are kept in
+ *          RAM when no media is set.
+ *
+ *  \param  pMedia      Record media, such as a flash region reserved for records.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void GlpsSetRecordMedia(const wsfEfsMedia_t *pMedia);
+
 /*************************************************************************************************/
 /*!
  *  \brief  This function is called by the application when a message that requires
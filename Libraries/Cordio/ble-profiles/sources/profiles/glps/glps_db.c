@@ -2,7 +2,7 @@
 /*!
  *  \file
  *
- *  \brief  Glucose profile example record database and access functions.
+ *  \brief  Glucose profile record database and access functions.
  *
  *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
  *
@@ -22,6 +22,7 @@
  */
 /*************************************************************************************************/
 
+#include <string.h>
 #include "wsf_types.h"
 #include "wsf_assert.h"
 #include "wsf_trace.h"
@@ -32,13 +33,27 @@
 #include "app_api.h"
 #include "glps_api.h"
 #include "glps_main.h"
+#include "racp/racp_store.h"
 
 /**************************************************************************************************
   Macros
 **************************************************************************************************/
 
-/*! Number of records in example database */
-#define GLPS_DB_NUM_RECORDS     3
+/*! Number of example records */
+#define GLPS_DB_NUM_SAMPLES     3
+
+/*! Maximum number of stored records */
+#ifndef GLPS_DB_MAX_RECORDS
+#define GLPS_DB_MAX_RECORDS     50
+#endif
+
+/*! Size of the RAM record log used when no record media is set */
+#ifndef GLPS_DB_RAM_SIZE
+#define GLPS_DB_RAM_SIZE        4096
+#endif
+
+/*! Page size of the RAM record log */
+#define GLPS_DB_RAM_PAGE_SIZE   512
 
 /**************************************************************************************************
   Local Variables
@@ -47,11 +62,20 @@
 /*! Control block */
 static struct
 {
-  uint8_t     numRec;
+  racpStore_t         store;                          /*! Record store */
+  racpStoreSel_t      sel;                            /*! Records being reported */
+  const wsfEfsMedia_t *pMedia;                        /*! Record media set by the application */
+  wsfEfsMedia_t       ramMedia;                       /*! RAM record media */
+  racpStoreIdx_t      idx[GLPS_DB_MAX_RECORDS];       /*! Record index */
+  glpsRec_t           buf;                            /*! Record store buffer */
+  glpsRec_t           rec;                            /*! Record being reported */
 } glpsDbCb;
 
-/*! Example record database */
-static glpsRec_t glpsDb[GLPS_DB_NUM_RECORDS] =
+/*! RAM record log */
+static uint32_t glpsDbRam[GLPS_DB_RAM_SIZE / sizeof(uint32_t)];
+
+/*! Example records, stored at startup when the store is empty */
+static glpsRec_t glpsDbSample[GLPS_DB_NUM_SAMPLES] =
 {
   /* record 1 */
   {
@@ -156,116 +180,124 @@ static glpsRec_t glpsDb[GLPS_DB_NUM_RECORDS] =
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get last database record.
+ *  \brief  Get the time key of a glucose measurement, its user facing time.
  *
- *  \return Pointer to record or NULL if no record.
+ *  \param  pMeas       Glucose measurement.
+ *
+ *  \return Time key.
  */
 /*************************************************************************************************/
-static glpsRec_t *glpsDbGetEnd(void)
+static uint32_t glpsDbTime(const glpsGlm_t *pMeas)
 {
-  if (glpsDbCb.numRec == 0)
+  uint32_t time = RacpStoreTime(pMeas->baseTime.year, pMeas->baseTime.month, pMeas->baseTime.day,
+                                pMeas->baseTime.hour, pMeas->baseTime.min, pMeas->baseTime.sec);
+
+  if (pMeas->flags & CH_GLM_FLAG_TIME_OFFSET)
   {
-    return NULL;
+    time += (int32_t) pMeas->timeOffset * 60;
   }
 
-  return (glpsRec_t *) &glpsDb[glpsDbCb.numRec - 1];
+  return time;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next database record after the given current record.
+ *  \brief  Parse a date and time filter value.
  *
- *  \param  pCurrRec    Pointer to current record.
+ *  \param  pFilter     Filter value.
  *
- *  \return Pointer to record or NULL if no record.
+ *  \return Time key.
  */
 /*************************************************************************************************/
-static glpsRec_t *glpsDbGetNext(glpsRec_t *pCurrRec)
+static uint32_t glpsDbParseTime(uint8_t *pFilter)
 {
-  if (glpsDbCb.numRec == 0 || pCurrRec == glpsDbGetEnd())
-  {
-    return NULL;
-  }
-  else if (pCurrRec == NULL)
-  {
-    return (glpsRec_t *) glpsDb;
-  }
-  else
-  {
-    return (pCurrRec + 1);
-  }
+  uint16_t year;
+
+  BYTES_TO_UINT16(year, pFilter);
+
+  return RacpStoreTime(year, pFilter[2], pFilter[3], pFilter[4], pFilter[5], pFilter[6]);
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next record filtered for "all".
+ *  \brief  Select the records matching the given filter parameters.
  *
- *  \param  pCurrRec    Pointer to current record.
- *  \param  pRec        Return pointer to next record, if found.
+ *  \param  oper        Operator.
+ *  \param  pFilter     Glucose service RACP filter parameters.
+ *  \param  pSel        Returns the selection.
  *
- *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
+ *  \return RACP status.
  */
 /*************************************************************************************************/
-static uint8_t glpsDbOpAll(glpsRec_t *pCurrRec,  glpsRec_t **pRec)
+static uint8_t glpsDbSelect(uint8_t oper, uint8_t *pFilter, racpStoreSel_t *pSel)
 {
-  *pRec = glpsDbGetNext(pCurrRec);
-  return (*pRec != NULL) ? CH_RACP_RSP_SUCCESS : CH_RACP_RSP_NO_RECORDS;
+  uint32_t  lo = 0;
+  uint32_t  hi = 0;
+  uint8_t   key = RACP_STORE_KEY_SEQ;
+
+  if (oper == CH_RACP_OPERATOR_LTEQ || oper == CH_RACP_OPERATOR_GTEQ ||
+      oper == CH_RACP_OPERATOR_RANGE)
+  {
+    /* parse filter; for LTEQ the single value is the upper bound */
+    if (*pFilter == CH_RACP_GLS_FILTER_SEQ)
+    {
+      BYTES_TO_UINT16(lo, pFilter + 1);
+      BYTES_TO_UINT16(hi, pFilter + 1 + CH_RACP_GLS_FILTER_SEQ_LEN);
+    }
+    else if (*pFilter == CH_RACP_GLS_FILTER_TIME)
+    {
+      key = RACP_STORE_KEY_TIME;
+      lo = glpsDbParseTime(pFilter + 1);
+
+      if (oper == CH_RACP_OPERATOR_RANGE)
+      {
+        hi = glpsDbParseTime(pFilter + 1 + CH_RACP_GLS_FILTER_TIME_LEN);
+      }
+    }
+    else
+    {
+      return CH_RACP_RSP_OPERAND_NOT_SUP;
+    }
+
+    if (oper == CH_RACP_OPERATOR_LTEQ)
+    {
+      hi = lo;
+    }
+  }
+
+  return RacpStoreSelect(&glpsDbCb.store, oper, key, lo, hi, pSel);
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next record filtered for "greater than or equal to sequence number".
+ *  \brief  Store a record.
  *
- *  \param  pFilter     Glucose service RACP filter parameters.
- *  \param  pCurrRec    Pointer to current record.
- *  \param  pRec        Return pointer to next record, if found.
+ *  \param  pRec        Record.
  *
- *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
+ *  \return None.
  */
 /*************************************************************************************************/
-static uint8_t glpsDbOpGteqSeqNum(uint8_t *pFilter, glpsRec_t *pCurrRec,  glpsRec_t **pRec)
+static void glpsDbPut(const glpsRec_t *pRec)
 {
-  uint16_t seqNum;
-
-  /* parse seq number */
-  pFilter++;
-  BYTES_TO_UINT16(seqNum, pFilter);
-
-  /* find record */
-  while ((*pRec = glpsDbGetNext(pCurrRec)) != NULL)
+  if (!RacpStorePut(&glpsDbCb.store, pRec->meas.seqNum, glpsDbTime(&pRec->meas), pRec))
   {
-    if ((*pRec)->meas.seqNum >= seqNum)
-    {
-      return CH_RACP_RSP_SUCCESS;
-    }
-    pCurrRec = *pRec;
+    APP_TRACE_WARN1("glpsDbPut failed seqNum=%d", pRec->meas.seqNum);
   }
-
-  return CH_RACP_RSP_NO_RECORDS;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next record filtered for "last".
+ *  \brief  Set the media holding glucose records.  Call before GlpsInit().  Records are kept in
+ *          RAM when no media is set.
  *
- *  \param  pCurrRec    Pointer to current record.
- *  \param  pRec        Return pointer to next record, if found.
+ *  \param  pMedia      Record media.
  *
- *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
+ *  \return None.
  */
 /*************************************************************************************************/
-static uint8_t glpsDbOpLast(glpsRec_t *pCurrRec, glpsRec_t **pRec)
+void GlpsSetRecordMedia(const wsfEfsMedia_t *pMedia)
 {
-  /* if current record is already last return failure */
-  *pRec = glpsDbGetEnd();
-  if (*pRec != NULL && *pRec != pCurrRec)
-  {
-    return CH_RACP_RSP_SUCCESS;
-  }
-  else
-  {
-    return CH_RACP_RSP_NO_RECORDS;
-  }
+  glpsDbCb.pMedia = pMedia;
 }
 
 /*************************************************************************************************/
@@ -277,7 +309,36 @@ static uint8_t glpsDbOpLast(glpsRec_t *pCurrRec, glpsRec_t **pRec)
 /*************************************************************************************************/
 void glpsDbInit(void)
 {
-  glpsDbCb.numRec = GLPS_DB_NUM_RECORDS;
+  racpStoreCfg_t  cfg;
+  uint8_t         i;
+
+  if (glpsDbCb.pMedia == NULL)
+  {
+    RacpStoreRamMedia(&glpsDbCb.ramMedia, (uint8_t *) glpsDbRam, sizeof(glpsDbRam),
+                      GLPS_DB_RAM_PAGE_SIZE);
+    glpsDbCb.pMedia = &glpsDbCb.ramMedia;
+  }
+
+  cfg.pMedia = glpsDbCb.pMedia;
+  cfg.pIdx = glpsDbCb.idx;
+  cfg.pBuf = (uint8_t *) &glpsDbCb.buf;
+  cfg.maxRec = GLPS_DB_MAX_RECORDS;
+  cfg.recLen = sizeof(glpsRec_t);
+
+  if (!RacpStoreInit(&glpsDbCb.store, &cfg))
+  {
+    APP_TRACE_ERR0("glpsDbInit record media too small");
+    return;
+  }
+
+  /* store the example records in a new store */
+  if (glpsDbCb.store.lastSeq == 0)
+  {
+    for (i = 0; i < GLPS_DB_NUM_SAMPLES; i++)
+    {
+      glpsDbPut(&glpsDbSample[i]);
+    }
+  }
 }
 
 /*************************************************************************************************/
@@ -287,7 +348,7 @@ void glpsDbInit(void)
  *
  *  \param  oper        Operator.
  *  \param  pFilter     Glucose service RACP filter parameters.
- *  \param  pCurrRec    Pointer to current record.
+ *  \param  pCurrRec    Pointer to current record, NULL to start a new report.
  *  \param  pRec        Return pointer to next record, if found.
  *
  *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
@@ -295,41 +356,29 @@ void glpsDbInit(void)
 /*************************************************************************************************/
 uint8_t glpsDbGetNextRecord(uint8_t oper, uint8_t *pFilter, glpsRec_t *pCurrRec,  glpsRec_t **pRec)
 {
-  uint8_t status;
+  uint8_t   status;
+  uint16_t  pos;
 
-  switch (oper)
+  /* a new report selects records; the selection continues by sequence number */
+  if (pCurrRec == NULL)
   {
-    case CH_RACP_OPERATOR_ALL:
-      status = glpsDbOpAll(pCurrRec, pRec);
-      break;
-
-    case CH_RACP_OPERATOR_GTEQ:
-      /* check filter type */
-      if (*pFilter == CH_RACP_GLS_FILTER_SEQ)
-      {
-        status = glpsDbOpGteqSeqNum(pFilter, pCurrRec, pRec);
-      }
-      else
-      {
-        status = CH_RACP_RSP_OPERAND_NOT_SUP;
-      }
-      break;
-
-    case CH_RACP_OPERATOR_LAST:
-      status = glpsDbOpLast(pCurrRec, pRec);
-      break;
-
-    case CH_RACP_OPERATOR_NULL:
-      status = CH_RACP_RSP_INV_OPERATOR;
-      break;
-
-    default:
-      status = CH_RACP_RSP_OPERATOR_NOT_SUP;
-      break;
+    if ((status = glpsDbSelect(oper, pFilter, &glpsDbCb.sel)) != CH_RACP_RSP_SUCCESS)
+    {
+      return status;
+    }
+  }
 
+  if (!RacpStoreNext(&glpsDbCb.store, &glpsDbCb.sel, &pos))
+  {
+    *pRec = NULL;
+    return CH_RACP_RSP_NO_RECORDS;
   }
 
-  return status;
+  /* copy the record, which may move when records are stored during the report */
+  memcpy(&glpsDbCb.rec, RacpStoreGet(&glpsDbCb.store, pos), sizeof(glpsRec_t));
+  *pRec = &glpsDbCb.rec;
+
+  return CH_RACP_RSP_SUCCESS;
 }
 
 /*************************************************************************************************/
@@ -344,17 +393,15 @@ uint8_t glpsDbGetNextRecord(uint8_t oper, uint8_t *pFilter, glpsRec_t *pCurrRec,
 /*************************************************************************************************/
 uint8_t glpsDbDeleteRecords(uint8_t oper, uint8_t *pFilter)
 {
-  /* only 'all records' is supported */
-  if (oper == CH_RACP_OPERATOR_ALL)
-  {
-    glpsDbCb.numRec = 0;
+  racpStoreSel_t  sel;
+  uint8_t         status;
 
-    return CH_RACP_RSP_SUCCESS;
-  }
-  else
+  if ((status = glpsDbSelect(oper, pFilter, &sel)) == CH_RACP_RSP_SUCCESS)
   {
-    return CH_RACP_RSP_OPERATOR_NOT_SUP;
+    RacpStoreDelete(&glpsDbCb.store, &sel);
   }
+
+  return status;
 }
 
 /*************************************************************************************************/
@@ -364,23 +411,23 @@ uint8_t glpsDbDeleteRecords(uint8_t oper, uint8_t *pFilter)
  *  \param  oper        Operator.
  *  \param  pFilter     Glucose service RACP filter parameters.
  *  \param  pNumRec     Returns number of records which match filter parameters.
-
  *
  *  \return RACP status.
  */
 /*************************************************************************************************/
-uint8_t glpsDbGetNumRecords(uint8_t oper, uint8_t *pFilter, uint8_t *pNumRec)
+uint8_t glpsDbGetNumRecords(uint8_t oper, uint8_t *pFilter, uint16_t *pNumRec)
 {
-  glpsRec_t *pCurrRec = NULL;
-  uint8_t   status;
+  racpStoreSel_t  sel;
+  uint8_t         status;
 
   *pNumRec = 0;
-  while ((status = glpsDbGetNextRecord(oper, pFilter, pCurrRec, &pCurrRec)) == CH_RACP_RSP_SUCCESS)
+  status = glpsDbSelect(oper, pFilter, &sel);
+
+  if (status == CH_RACP_RSP_SUCCESS)
   {
-    (*pNumRec)++;
+    *pNumRec = RacpStoreCount(&glpsDbCb.store, &sel);
   }
-
-  if (status == CH_RACP_RSP_NO_RECORDS)
+  else if (status == CH_RACP_RSP_NO_RECORDS)
   {
     status = CH_RACP_RSP_SUCCESS;
   }
@@ -397,10 +444,15 @@ uint8_t glpsDbGetNumRecords(uint8_t oper, uint8_t *pFilter, uint8_t *pNumRec)
 /*************************************************************************************************/
 void glpsDbGenerateRecord(void)
 {
-  if (glpsDbCb.numRec < GLPS_DB_NUM_RECORDS)
-  {
-    glpsDbCb.numRec++;
-  }
+  glpsRec_t rec;
+  uint16_t  seqNum = glpsDbCb.store.lastSeq + 1;
+
+  /* copy an example record */
+  memcpy(&rec, &glpsDbSample[(seqNum - 1) % GLPS_DB_NUM_SAMPLES], sizeof(glpsRec_t));
+  rec.meas.seqNum = seqNum;
+  rec.context.seqNum = seqNum;
+
+  glpsDbPut(&rec);
 }
 
 /*************************************************************************************************/
@@ -413,18 +465,28 @@ void glpsDbGenerateRecord(void)
  /*************************************************************************************************/
 void glpsDbToggleMedicationUnits(void)
 {
-  if (glpsDb[1].context.flags & CH_GLMC_FLAG_MED_L)
+  racpStoreSel_t  sel;
+
+  if (glpsDbSample[1].context.flags & CH_GLMC_FLAG_MED_L)
   {
     /* Change medication quantity to Kilograms. */
-    glpsDb[1].context.flags &= ~CH_GLMC_FLAG_MED_L;
-    glpsDb[1].context.flags |= CH_GLMC_FLAG_MED_KG;
-    glpsDb[1].context.medication = SFLT_TO_UINT16(50, -6);
+    glpsDbSample[1].context.flags &= ~CH_GLMC_FLAG_MED_L;
+    glpsDbSample[1].context.flags |= CH_GLMC_FLAG_MED_KG;
+    glpsDbSample[1].context.medication = SFLT_TO_UINT16(50, -6);
   }
   else
   {
     /* Change medication quantiy to Liters. */
-    glpsDb[1].context.flags &= ~CH_GLMC_FLAG_MED_KG;
-    glpsDb[1].context.flags |= CH_GLMC_FLAG_MED_L;
-    glpsDb[1].context.medication = SFLT_TO_UINT16(10, -3);
+    glpsDbSample[1].context.flags &= ~CH_GLMC_FLAG_MED_KG;
+    glpsDbSample[1].context.flags |= CH_GLMC_FLAG_MED_L;
+    glpsDbSample[1].context.medication = SFLT_TO_UINT16(10, -3);
+  }
+
+  /* replace record 2 if still stored */
+  if (RacpStoreSelect(&glpsDbCb.store, CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ,
+                      glpsDbSample[1].meas.seqNum, glpsDbSample[1].meas.seqNum,
+                      &sel) == CH_RACP_RSP_SUCCESS)
+  {
+    glpsDbPut(&glpsDbSample[1]);
   }
 }
@@ -399,7 +399,6 @@ static uint8_t glpsRacpOperCheck(uint8_t oper, uint16_t len, uint8_t *pOperand)
     else
     {
       filterType = *pOperand;
-      len--;
 
       /* operand length depends on filter type */
       if (filterType == CH_RACP_GLS_FILTER_SEQ)
@@ -423,8 +422,8 @@ static uint8_t glpsRacpOperCheck(uint8_t oper, uint16_t len, uint8_t *pOperand)
           filterLen *= 2;
         }
 
-        /* verify length */
-        if (len != filterLen)
+        /* verify length, including the filter type */
+        if (len != filterLen + 1)
         {
           status = CH_RACP_RSP_INV_OPERAND;
         }
@@ -540,8 +539,8 @@ static void glpsRacpAbort(dmConnId_t connId)
 /*************************************************************************************************/
 static void glpsRacpReportNum(dmConnId_t connId, uint8_t oper, uint8_t *pOperand)
 {
-  uint8_t status;
-  uint8_t numRec = 0;
+  uint8_t   status;
+  uint16_t  numRec = 0;
 
   /* get number of records */
   status = glpsDbGetNumRecords(oper, pOperand, &numRec);
@@ -137,7 +137,7 @@ uint8_t glpsDbDeleteRecords(uint8_t oper, uint8_t *pFilter);
  *  \return RACP status.
  */
 /*************************************************************************************************/
-uint8_t glpsDbGetNumRecords(uint8_t oper, uint8_t *pFilter, uint8_t *pNumRec);
+uint8_t glpsDbGetNumRecords(uint8_t oper, uint8_t *pFilter, uint16_t *pNumRec);
 
 /*************************************************************************************************/
 /*!
@@ -25,6 +25,7 @@
 #define PLXPS_API_H
 
 #include "app_hw.h"
+#include "wsf_efs.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +62,18 @@ typedef appPlxScm_t plxpScm_t;
 /*************************************************************************************************/
 void PlxpsInit(wsfHandlerId_t handlerId, plxpsCfg_t *pCfg);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Set the media holding pulse oximeter records.  Call before PlxpsInit().  Records are
+ *          kept in RAM when no media is set.
+ *
+ *  \param  pMedia      Record media, such as a flash region reserved for records.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void PlxpsSetRecordMedia(const wsfEfsMedia_t *pMedia);
+
 /*************************************************************************************************/
 /*!
  *  \brief  This function is called by the application when a message that requires
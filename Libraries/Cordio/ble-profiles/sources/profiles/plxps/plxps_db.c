@@ -2,7 +2,7 @@
 /*!
  *  \file
  *
- *  \brief  Pulse Oximeter profile example record database and access functions.
+ *  \brief  Pulse Oximeter profile record database and access functions.
  *
  *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
  *
@@ -22,6 +22,7 @@
  */
 /*************************************************************************************************/
 
+#include <string.h>
 #include "wsf_types.h"
 #include "wsf_assert.h"
 #include "wsf_trace.h"
@@ -32,13 +33,27 @@
 #include "app_api.h"
 #include "plxps_api.h"
 #include "plxps_main.h"
+#include "racp/racp_store.h"
 
 /**************************************************************************************************
   Macros
 **************************************************************************************************/
 
-/*! Number of records in example database */
-#define PLXPS_DB_NUM_RECORDS     3
+/*! Number of example records */
+#define PLXPS_DB_NUM_SAMPLES     3
+
+/*! Maximum number of stored records */
+#ifndef PLXPS_DB_MAX_RECORDS
+#define PLXPS_DB_MAX_RECORDS     50
+#endif
+
+/*! Size of the RAM record log used when no record media is set */
+#ifndef PLXPS_DB_RAM_SIZE
+#define PLXPS_DB_RAM_SIZE        2048
+#endif
+
+/*! Page size of the RAM record log */
+#define PLXPS_DB_RAM_PAGE_SIZE   256
 
 /**************************************************************************************************
   Local Variables
@@ -47,11 +62,20 @@
 /*! Control block */
 static struct
 {
-  uint8_t     numRec;
+  racpStore_t         store;                          /*! Record store */
+  racpStoreSel_t      sel;                            /*! Records being reported */
+  const wsfEfsMedia_t *pMedia;                        /*! Record media set by the application */
+  wsfEfsMedia_t       ramMedia;                       /*! RAM record media */
+  racpStoreIdx_t      idx[PLXPS_DB_MAX_RECORDS];      /*! Record index */
+  plxpsRec_t          buf;                            /*! Record store buffer */
+  plxpsRec_t          rec;                            /*! Record being reported */
 } plxpsDbCb;
 
-/*! Example record database */
-static const plxpsRec_t plxpsDb[PLXPS_DB_NUM_RECORDS] =
+/*! RAM record log */
+static uint32_t plxpsDbRam[PLXPS_DB_RAM_SIZE / sizeof(uint32_t)];
+
+/*! Example records, stored at startup when the store is empty */
+static const plxpsRec_t plxpsDbSample[PLXPS_DB_NUM_SAMPLES] =
 {
   /* record 1 */
   {
@@ -97,58 +121,38 @@ static const plxpsRec_t plxpsDb[PLXPS_DB_NUM_RECORDS] =
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next database record after the given current record.
+ *  \brief  Store a record.  Records are numbered in the order stored.
  *
- *  \param  pCurrRec    Pointer to current record.
+ *  \param  pRec        Record.
  *
- *  \return Pointer to record or NULL if no record.
+ *  \return None.
  */
 /*************************************************************************************************/
-static const plxpsRec_t *plxpsDbGetEnd()
+static void plxpsDbPut(const plxpsRec_t *pRec)
 {
-  return plxpsDb + plxpsDbCb.numRec;
-}
+  const appDateTime_t *pTime = &pRec->spotCheck.timestamp;
 
-/*************************************************************************************************/
-/*!
- *  \brief  Get the next database record after the given current record.
- *
- *  \param  pCurrRec    Pointer to current record.
- *
- *  \return Pointer to record or NULL if no record.
- */
-/*************************************************************************************************/
-static plxpsRec_t *plxpsDbGetNext(plxpsRec_t *pCurrRec)
-{
-  if (plxpsDbCb.numRec == 0 || pCurrRec == plxpsDbGetEnd())
+  if (!RacpStorePut(&plxpsDbCb.store, plxpsDbCb.store.lastSeq + 1,
+                    RacpStoreTime(pTime->year, pTime->month, pTime->day, pTime->hour, pTime->min,
+                                  pTime->sec), pRec))
   {
-    plxpsDbCb.numRec = 0;
-    return NULL;
-  }
-  else if (pCurrRec == NULL)
-  {
-    return (plxpsRec_t *) plxpsDb;
-  }
-  else
-  {
-    return (pCurrRec + 1);
+    APP_TRACE_WARN0("plxpsDbPut failed");
   }
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Get the next record filtered for "all".
+ *  \brief  Set the media holding pulse oximeter records.  Call before PlxpsInit().  Records are
+ *          kept in RAM when no media is set.
  *
- *  \param  pCurrRec    Pointer to current record.
- *  \param  pRec        Return pointer to next record, if found.
+ *  \param  pMedia      Record media.
  *
- *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
+ *  \return None.
  */
 /*************************************************************************************************/
-static uint8_t plxpsDbOpAll(plxpsRec_t *pCurrRec,  plxpsRec_t **pRec)
+void PlxpsSetRecordMedia(const wsfEfsMedia_t *pMedia)
 {
-  *pRec = plxpsDbGetNext(pCurrRec);
-  return (*pRec != NULL) ? CH_RACP_RSP_SUCCESS : CH_RACP_RSP_NO_RECORDS;
+  plxpsDbCb.pMedia = pMedia;
 }
 
 /*************************************************************************************************/
@@ -160,7 +164,36 @@ static uint8_t plxpsDbOpAll(plxpsRec_t *pCurrRec,  plxpsRec_t **pRec)
 /*************************************************************************************************/
 void plxpsDbInit(void)
 {
-  plxpsDbCb.numRec = PLXPS_DB_NUM_RECORDS;
+  racpStoreCfg_t  cfg;
+  uint8_t         i;
+
+  if (plxpsDbCb.pMedia == NULL)
+  {
+    RacpStoreRamMedia(&plxpsDbCb.ramMedia, (uint8_t *) plxpsDbRam, sizeof(plxpsDbRam),
+                      PLXPS_DB_RAM_PAGE_SIZE);
+    plxpsDbCb.pMedia = &plxpsDbCb.ramMedia;
+  }
+
+  cfg.pMedia = plxpsDbCb.pMedia;
+  cfg.pIdx = plxpsDbCb.idx;
+  cfg.pBuf = (uint8_t *) &plxpsDbCb.buf;
+  cfg.maxRec = PLXPS_DB_MAX_RECORDS;
+  cfg.recLen = sizeof(plxpsRec_t);
+
+  if (!RacpStoreInit(&plxpsDbCb.store, &cfg))
+  {
+    APP_TRACE_ERR0("plxpsDbInit record media too small");
+    return;
+  }
+
+  /* store the example records in a new store */
+  if (plxpsDbCb.store.lastSeq == 0)
+  {
+    for (i = 0; i < PLXPS_DB_NUM_SAMPLES; i++)
+    {
+      plxpsDbPut(&plxpsDbSample[i]);
+    }
+  }
 }
 
 /*************************************************************************************************/
@@ -169,7 +202,7 @@ void plxpsDbInit(void)
  *          the given current record.
  *
  *  \param  oper        Operator.
- *  \param  pCurrRec    Pointer to current record.
+ *  \param  pCurrRec    Pointer to current record, NULL to start a new report.
  *  \param  pRec        Return pointer to next record, if found.
  *
  *  \return CH_RACP_RSP_SUCCESS if a record is found, otherwise an error status is returned.
@@ -177,18 +210,30 @@ void plxpsDbInit(void)
 /*************************************************************************************************/
 uint8_t plxpsDbGetNextRecord(uint8_t oper, plxpsRec_t *pCurrRec,  plxpsRec_t **pRec)
 {
-  uint8_t status;
+  uint16_t  pos;
 
-  if (oper == CH_RACP_OPERATOR_ALL)
+  /* only 'all records' is supported */
+  if (oper != CH_RACP_OPERATOR_ALL)
   {
-    status = plxpsDbOpAll(pCurrRec, pRec);
+    return CH_RACP_RSP_INV_OPERATOR;
   }
-  else
+
+  if (pCurrRec == NULL)
+  {
+    RacpStoreSelect(&plxpsDbCb.store, oper, RACP_STORE_KEY_SEQ, 0, 0, &plxpsDbCb.sel);
+  }
+
+  if (!RacpStoreNext(&plxpsDbCb.store, &plxpsDbCb.sel, &pos))
   {
-    status = CH_RACP_RSP_INV_OPERATOR;
+    *pRec = NULL;
+    return CH_RACP_RSP_NO_RECORDS;
   }
 
-  return status;
+  /* copy the record, which may move when records are stored during the report */
+  memcpy(&plxpsDbCb.rec, RacpStoreGet(&plxpsDbCb.store, pos), sizeof(plxpsRec_t));
+  *pRec = &plxpsDbCb.rec;
+
+  return CH_RACP_RSP_SUCCESS;
 }
 
 /*************************************************************************************************/
@@ -202,10 +247,16 @@ uint8_t plxpsDbGetNextRecord(uint8_t oper, plxpsRec_t *pCurrRec,  plxpsRec_t **p
 /*************************************************************************************************/
 uint8_t plxpsDbDeleteRecords(uint8_t oper)
 {
+  racpStoreSel_t  sel;
+
   /* only 'all records' is supported */
   if (oper == CH_RACP_OPERATOR_ALL)
   {
-    plxpsDbCb.numRec = 0;
+    if (RacpStoreSelect(&plxpsDbCb.store, oper, RACP_STORE_KEY_SEQ, 0, 0,
+                        &sel) == CH_RACP_RSP_SUCCESS)
+    {
+      RacpStoreDelete(&plxpsDbCb.store, &sel);
+    }
 
     return CH_RACP_RSP_SUCCESS;
   }
@@ -221,28 +272,22 @@ uint8_t plxpsDbDeleteRecords(uint8_t oper)
  *
  *  \param  oper        Operator.
  *  \param  pNumRec     Returns number of records which match filter parameters.
-
  *
  *  \return RACP status.
  */
 /*************************************************************************************************/
-uint8_t plxpsDbGetNumRecords(uint8_t oper, uint8_t *pNumRec)
+uint8_t plxpsDbGetNumRecords(uint8_t oper, uint16_t *pNumRec)
 {
-  plxpsRec_t *pCurrRec = NULL;
-  uint8_t   status;
-
-  *pNumRec = 0;
-  while ((status = plxpsDbGetNextRecord(oper, pCurrRec, &pCurrRec)) == CH_RACP_RSP_SUCCESS)
+  /* only 'all records' is supported */
+  if (oper != CH_RACP_OPERATOR_ALL)
   {
-    (*pNumRec)++;
+    *pNumRec = 0;
+    return CH_RACP_RSP_INV_OPERATOR;
   }
 
-  if (status == CH_RACP_RSP_NO_RECORDS)
-  {
-    status = CH_RACP_RSP_SUCCESS;
-  }
+  *pNumRec = plxpsDbCb.store.numRec;
 
-  return status;
+  return CH_RACP_RSP_SUCCESS;
 }
 
 /*************************************************************************************************/
@@ -254,8 +299,5 @@ uint8_t plxpsDbGetNumRecords(uint8_t oper, uint8_t *pNumRec)
 /*************************************************************************************************/
 void plxpsDbGenerateRecord(void)
 {
-  if (plxpsDbCb.numRec < PLXPS_DB_NUM_RECORDS)
-  {
-    plxpsDbCb.numRec++;
-  }
+  plxpsDbPut(&plxpsDbSample[plxpsDbCb.store.lastSeq % PLXPS_DB_NUM_SAMPLES]);
 }
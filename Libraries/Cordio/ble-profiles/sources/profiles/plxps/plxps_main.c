@@ -452,8 +452,8 @@ static void plxpsRacpAbort(dmConnId_t connId)
 /*************************************************************************************************/
 static void plxpsRacpReportNum(dmConnId_t connId, uint8_t oper)
 {
-  uint8_t status;
-  uint8_t numRec;
+  uint8_t   status;
+  uint16_t  numRec;
 
   /* get number of records */
   status = plxpsDbGetNumRecords(oper, &numRec);
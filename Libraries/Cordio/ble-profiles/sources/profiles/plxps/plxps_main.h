@@ -105,7 +105,7 @@ uint8_t plxpsDbDeleteRecords(uint8_t oper);
  *  \return RACP status.
  */
 /*************************************************************************************************/
-uint8_t plxpsDbGetNumRecords(uint8_t oper, uint8_t *pNumRec);
+uint8_t plxpsDbGetNumRecords(uint8_t oper, uint16_t *pNumRec);
 
 /*************************************************************************************************/
 /*!
@@ -0,0 +1,1097 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Record access control point record store.
+ *
+ *  Records are appended to a log of media pages.  Deleting records appends a delete entry, and
+ *  the oldest page is reclaimed when the log wraps, copying its live records forward.  A RAM
+ *  index in sequence number order, rebuilt from the log at startup, locates records.  Sequence
+ *  numbers are ordered from a base, which moves to the oldest record when they wrap.
+ *
+ *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
+ *
+ *  Copyright (c) 2019 Packetcraft, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_assert.h"
+#include "wsf_trace.h"
+#include "wsf_efs.h"
+#include "wsf_math.h"
+#include "util/bstream.h"
+#include "util/crc32.h"
+#include "svc_ch.h"
+#include "racp_store.h"
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! Page header magic number */
+#define RACP_STORE_MAGIC            0x50434152
+
+/*! Entry types */
+#define RACP_STORE_TYPE_REC         0x01      /*! Record */
+#define RACP_STORE_TYPE_DEL         0x02      /*! Delete a sequence number range */
+#define RACP_STORE_TYPE_BASE        0x03      /*! Move the sequence number base */
+#define RACP_STORE_TYPE_FREE        0xFF      /*! Erased */
+
+/*! CRC initial value */
+#define RACP_STORE_CRC_INIT         0xFFFFFFFF
+
+/*! Highest key value, no upper bound */
+#define RACP_STORE_KEY_MAX          0xFFFFFFFF
+
+/*! Selection next value when no records are left */
+#define RACP_STORE_SEL_DONE         0xFFFFFFFF
+
+/**************************************************************************************************
+  Local Functions
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the address of a log page.
+ *
+ *  \param  pStore   Record store.
+ *  \param  page     Page.
+ *
+ *  \return Media address.
+ */
+/*************************************************************************************************/
+static uint8_t *racpStorePageAddr(racpStore_t *pStore, uint16_t page)
+{
+  return (uint8_t *) (pStore->cfg.pMedia->startAddress + (uint32_t) page * pStore->cfg.pMedia->pageSize);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the address of a log entry.
+ *
+ *  \param  pStore   Record store.
+ *  \param  slot     Entry.
+ *
+ *  \return Media address.
+ */
+/*************************************************************************************************/
+static uint8_t *racpStoreSlotAddr(racpStore_t *pStore, uint16_t slot)
+{
+  return racpStorePageAddr(pStore, slot / pStore->pageEntries) + RACP_STORE_PAGE_HDR_LEN +
+         (uint32_t) (slot % pStore->pageEntries) * pStore->entryLen;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the position of a sequence number in index order.
+ *
+ *  \param  pStore   Record store.
+ *  \param  seqNum   Sequence number.
+ *
+ *  \return Sequence number key.
+ */
+/*************************************************************************************************/
+static uint32_t racpStoreSeqKey(racpStore_t *pStore, uint16_t seqNum)
+{
+  return (uint16_t) (seqNum - pStore->seqBase);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the key of an index entry.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pIdx     Index entry.
+ *  \param  key      RACP_STORE_KEY_SEQ or RACP_STORE_KEY_TIME.
+ *
+ *  \return Key value.
+ */
+/*************************************************************************************************/
+static uint32_t racpStoreKey(racpStore_t *pStore, const racpStoreIdx_t *pIdx, uint8_t key)
+{
+  return (key == RACP_STORE_KEY_TIME) ? pIdx->time : racpStoreSeqKey(pStore, pIdx->seqNum);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find the first index position with a key at or above a value.  The index must be
+ *          sorted by the key.
+ *
+ *  \param  pStore   Record store.
+ *  \param  key      RACP_STORE_KEY_SEQ or RACP_STORE_KEY_TIME.
+ *  \param  value    Key value.
+ *
+ *  \return Index position, numRec if none.
+ */
+/*************************************************************************************************/
+static uint16_t racpStoreLowerBound(racpStore_t *pStore, uint8_t key, uint32_t value)
+{
+  uint16_t lo = 0;
+  uint16_t hi = pStore->numRec;
+  uint16_t mid;
+
+  while (lo < hi)
+  {
+    mid = lo + (hi - lo) / 2;
+
+    if (racpStoreKey(pStore, &pStore->cfg.pIdx[mid], key) < value)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether time keys rise with sequence numbers.
+ *
+ *  \param  pStore   Record store.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreCheckSorted(racpStore_t *pStore)
+{
+  uint16_t i;
+
+  pStore->timeSorted = TRUE;
+
+  for (i = 1; i < pStore->numRec; i++)
+  {
+    if (pStore->cfg.pIdx[i].time < pStore->cfg.pIdx[i - 1].time)
+    {
+      pStore->timeSorted = FALSE;
+      break;
+    }
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add a record to the index, replacing one with the same sequence number.
+ *
+ *  \param  pStore   Record store.
+ *  \param  seqNum   Sequence number.
+ *  \param  time     Time key.
+ *  \param  slot     Log entry.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreIdxInsert(racpStore_t *pStore, uint16_t seqNum, uint32_t time, uint16_t slot)
+{
+  racpStoreIdx_t *pIdx = pStore->cfg.pIdx;
+  uint16_t       pos = racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, seqNum));
+
+  if ((pos == pStore->numRec) || (pIdx[pos].seqNum != seqNum))
+  {
+    /* drop the oldest record when full */
+    if (pStore->numRec == pStore->cfg.maxRec)
+    {
+      if (pos == 0)
+      {
+        return;
+      }
+
+      memmove(pIdx, pIdx + 1, (pos - 1) * sizeof(racpStoreIdx_t));
+      pos--;
+    }
+    else
+    {
+      memmove(pIdx + pos + 1, pIdx + pos, (pStore->numRec - pos) * sizeof(racpStoreIdx_t));
+      pStore->numRec++;
+    }
+  }
+
+  pIdx[pos].seqNum = seqNum;
+  pIdx[pos].time = time;
+  pIdx[pos].slot = slot;
+
+  /* a record out of time order turns time selections into scans */
+  if (((pos > 0) && (time < pIdx[pos - 1].time)) ||
+      ((pos + 1 < pStore->numRec) && (time > pIdx[pos + 1].time)))
+  {
+    pStore->timeSorted = FALSE;
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Remove a sequence number range from the index.
+ *
+ *  \param  pStore   Record store.
+ *  \param  lo       Lowest sequence number.
+ *  \param  hi       Highest sequence number.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreIdxRemove(racpStore_t *pStore, uint16_t lo, uint16_t hi)
+{
+  uint16_t first = racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, lo));
+  uint16_t end = racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, hi) + 1);
+
+  if (first < end)
+  {
+    memmove(pStore->cfg.pIdx + first, pStore->cfg.pIdx + end,
+            (pStore->numRec - end) * sizeof(racpStoreIdx_t));
+    pStore->numRec -= end - first;
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start writing a log page, erasing it if needed.
+ *
+ *  \param  pStore   Record store.
+ *  \param  page     Page.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreOpenPage(racpStore_t *pStore, uint16_t page)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+  uint8_t             hdr[RACP_STORE_PAGE_HDR_LEN];
+  uint8_t             *pAddr = racpStorePageAddr(pStore, page);
+  uint8_t             *p = hdr;
+  uint32_t            magic;
+
+  pMedia->read(hdr, pAddr, sizeof(magic));
+  BYTES_TO_UINT32(magic, hdr);
+
+  if (magic != 0xFFFFFFFF)
+  {
+    pMedia->erase(pAddr, pMedia->pageSize);
+  }
+
+  memset(hdr, 0xFF, sizeof(hdr));
+  UINT32_TO_BSTREAM(p, RACP_STORE_MAGIC);
+  UINT32_TO_BSTREAM(p, pStore->gen);
+  UINT16_TO_BSTREAM(p, pStore->cfg.recLen);
+  UINT16_TO_BSTREAM(p, pStore->lastSeq);
+  UINT16_TO_BSTREAM(p, pStore->seqBase);
+  pMedia->write(hdr, pAddr, sizeof(hdr));
+
+  pStore->wrPage = page;
+  pStore->wrEntry = 0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase the log.
+ *
+ *  \param  pStore   Record store.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreFormat(racpStore_t *pStore)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+
+  pMedia->erase((uint8_t *) pMedia->startAddress, (uint32_t) pStore->numPages * pMedia->pageSize);
+
+  pStore->numRec = 0;
+  pStore->oldest = 0;
+  pStore->gen++;
+  pStore->timeSorted = TRUE;
+
+  racpStoreOpenPage(pStore, 0);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write a log entry.
+ *
+ *  \param  pStore   Record store.
+ *  \param  type     Entry type.
+ *  \param  seqNum   Sequence number, or lowest sequence number deleted.
+ *  \param  value    Time key, or highest sequence number deleted.
+ *  \param  pRec     Record, or NULL.
+ *  \param  pSlot    Returns the entry.
+ *
+ *  \return TRUE if successful.
+ */
+/*************************************************************************************************/
+static bool_t racpStoreWrite(racpStore_t *pStore, uint8_t type, uint16_t seqNum, uint32_t value,
+                             const uint8_t *pRec, uint16_t *pSlot);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Reclaim the oldest log page.  Its live records are copied to the page being
+ *          written.  maxRec leaves a page of the log to entries no longer live, so they fit.
+ *
+ *  \param  pStore   Record store.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpStoreReclaim(racpStore_t *pStore)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+  racpStoreIdx_t      *pIdx = pStore->cfg.pIdx;
+  uint16_t            page = pStore->oldest;
+  uint16_t            i;
+
+  for (i = 0; i < pStore->numRec; i++)
+  {
+    if (pIdx[i].slot / pStore->pageEntries == page)
+    {
+      pMedia->read(pStore->cfg.pBuf, racpStoreSlotAddr(pStore, pIdx[i].slot) + RACP_STORE_ENTRY_HDR_LEN,
+                   pStore->cfg.recLen);
+      racpStoreWrite(pStore, RACP_STORE_TYPE_REC, pIdx[i].seqNum, pIdx[i].time, pStore->cfg.pBuf,
+                     &pIdx[i].slot);
+    }
+  }
+
+  pMedia->erase(racpStorePageAddr(pStore, page), pMedia->pageSize);
+  pStore->oldest = (page + 1) % pStore->numPages;
+}
+
+/*************************************************************************************************/
+static bool_t racpStoreWrite(racpStore_t *pStore, uint8_t type, uint16_t seqNum, uint32_t value,
+                             const uint8_t *pRec, uint16_t *pSlot)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+  uint8_t             hdr[RACP_STORE_ENTRY_HDR_LEN];
+  uint8_t             *p = hdr;
+  uint8_t             *pAddr;
+  uint32_t            crc;
+  uint16_t            next;
+
+  /* move to the next page, keeping one erased page ahead of the oldest; a page of live
+   * records copied forward fills the new page, so the next oldest page is reclaimed too */
+  while (pStore->wrEntry == pStore->pageEntries)
+  {
+    next = (pStore->wrPage + 1) % pStore->numPages;
+
+    pStore->gen++;
+    racpStoreOpenPage(pStore, next);
+
+    if ((next + 1) % pStore->numPages == pStore->oldest)
+    {
+      racpStoreReclaim(pStore);
+    }
+  }
+
+  UINT8_TO_BSTREAM(p, type);
+  UINT8_TO_BSTREAM(p, 0xFF);
+  UINT16_TO_BSTREAM(p, seqNum);
+  UINT32_TO_BSTREAM(p, value);
+
+  crc = CalcCrc32(RACP_STORE_CRC_INIT, (uint32_t) (p - hdr), hdr);
+  if (pRec != NULL)
+  {
+    crc = CalcCrc32(crc ^ 0xFFFFFFFF, pStore->cfg.recLen, pRec);
+  }
+  UINT32_TO_BSTREAM(p, crc);
+
+  *pSlot = pStore->wrPage * pStore->pageEntries + pStore->wrEntry++;
+  pAddr = racpStoreSlotAddr(pStore, *pSlot);
+
+  if (pMedia->write(hdr, pAddr, sizeof(hdr)) != WSF_EFS_SUCCESS)
+  {
+    return FALSE;
+  }
+
+  if ((pRec != NULL) &&
+      (pMedia->write(pRec, pAddr + RACP_STORE_ENTRY_HDR_LEN, pStore->cfg.recLen) != WSF_EFS_SUCCESS))
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Rebuild the index from a log page.
+ *
+ *  \param  pStore   Record store.
+ *  \param  page     Page.
+ *
+ *  \return First free entry of the page.
+ */
+/*************************************************************************************************/
+static uint16_t racpStoreReplayPage(racpStore_t *pStore, uint16_t page)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+  uint8_t             hdr[RACP_STORE_ENTRY_HDR_LEN];
+  uint8_t             *p;
+  uint8_t             *pAddr;
+  uint8_t             type;
+  uint16_t            seqNum;
+  uint16_t            slot;
+  uint16_t            i;
+  uint32_t            value;
+  uint32_t            crc;
+  uint32_t            entryCrc;
+
+  for (i = 0; i < pStore->pageEntries; i++)
+  {
+    slot = page * pStore->pageEntries + i;
+    pAddr = racpStoreSlotAddr(pStore, slot);
+
+    pMedia->read(hdr, pAddr, sizeof(hdr));
+
+    p = hdr;
+    BSTREAM_TO_UINT8(type, p);
+    p++;
+    BSTREAM_TO_UINT16(seqNum, p);
+    BSTREAM_TO_UINT32(value, p);
+    BSTREAM_TO_UINT32(entryCrc, p);
+
+    if (type == RACP_STORE_TYPE_FREE)
+    {
+      break;
+    }
+
+    crc = CalcCrc32(RACP_STORE_CRC_INIT, RACP_STORE_ENTRY_HDR_LEN - sizeof(crc), hdr);
+
+    if (type == RACP_STORE_TYPE_REC)
+    {
+      pMedia->read(pStore->cfg.pBuf, pAddr + RACP_STORE_ENTRY_HDR_LEN, pStore->cfg.recLen);
+      crc = CalcCrc32(crc ^ 0xFFFFFFFF, pStore->cfg.recLen, pStore->cfg.pBuf);
+    }
+
+    /* skip entries cut short by a reset */
+    if (crc != entryCrc)
+    {
+      continue;
+    }
+
+    if (type == RACP_STORE_TYPE_REC)
+    {
+      racpStoreIdxInsert(pStore, seqNum, value, slot);
+
+      if (racpStoreSeqKey(pStore, seqNum) > racpStoreSeqKey(pStore, pStore->lastSeq))
+      {
+        pStore->lastSeq = seqNum;
+      }
+    }
+    else if (type == RACP_STORE_TYPE_DEL)
+    {
+      racpStoreIdxRemove(pStore, seqNum, (uint16_t) value);
+    }
+    else if (type == RACP_STORE_TYPE_BASE)
+    {
+      pStore->seqBase = seqNum;
+    }
+  }
+
+  return i;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether an index position is selected.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *  \param  pos      Index position.
+ *
+ *  \return TRUE if selected.
+ */
+/*************************************************************************************************/
+static bool_t racpStoreMatch(racpStore_t *pStore, const racpStoreSel_t *pSel, uint16_t pos)
+{
+  uint32_t value = racpStoreKey(pStore, &pStore->cfg.pIdx[pos], pSel->key);
+
+  return (racpStoreSeqKey(pStore, pStore->cfg.pIdx[pos].seqNum) <= racpStoreSeqKey(pStore, pSel->last)) &&
+         (value >= pSel->lo) && (value <= pSel->hi);
+}
+
+/**************************************************************************************************
+  Global Functions
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Open a record store, rebuilding the index from the log on the media.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pCfg     Configuration.
+ *
+ *  \return TRUE if successful, FALSE if the media cannot hold the log.
+ */
+/*************************************************************************************************/
+bool_t RacpStoreInit(racpStore_t *pStore, const racpStoreCfg_t *pCfg)
+{
+  const wsfEfsMedia_t *pMedia = pCfg->pMedia;
+  uint8_t             hdr[RACP_STORE_PAGE_HDR_LEN];
+  uint8_t             *p;
+  uint32_t            magic;
+  uint32_t            gen;
+  uint32_t            minGen = 0;
+  uint16_t            recLen;
+  uint16_t            lastSeq;
+  uint16_t            seqBase;
+  uint16_t            page;
+  uint16_t            i;
+  bool_t              found = FALSE;
+
+  memset(pStore, 0, sizeof(racpStore_t));
+  pStore->cfg = *pCfg;
+  pStore->timeSorted = TRUE;
+
+  pStore->entryLen = (RACP_STORE_ENTRY_HDR_LEN + pCfg->recLen + RACP_STORE_ENTRY_ALIGN - 1) &
+                     ~(RACP_STORE_ENTRY_ALIGN - 1);
+  pStore->pageEntries = (uint16_t) ((pMedia->pageSize - RACP_STORE_PAGE_HDR_LEN) / pStore->entryLen);
+  pStore->numPages = (uint16_t) ((pMedia->endAddress - pMedia->startAddress) / pMedia->pageSize);
+
+  if ((pStore->numPages < 3) || (pStore->pageEntries == 0) ||
+      ((uint32_t) pStore->numPages * pStore->pageEntries > 0xFFFF))
+  {
+    return FALSE;
+  }
+
+  /* leave a page of the log for entries no longer live, so that reclaiming pages gains space */
+  pStore->cfg.maxRec = WSF_MIN(pCfg->maxRec, (pStore->numPages - 2) * pStore->pageEntries);
+
+  /* the pages in use run on from the oldest, with one generation more each */
+  for (page = 0; page < pStore->numPages; page++)
+  {
+    pMedia->read(hdr, racpStorePageAddr(pStore, page), sizeof(hdr));
+
+    p = hdr;
+    BSTREAM_TO_UINT32(magic, p);
+    BSTREAM_TO_UINT32(gen, p);
+    BSTREAM_TO_UINT16(recLen, p);
+
+    if ((magic == RACP_STORE_MAGIC) && (recLen == pCfg->recLen) && (!found || (gen < minGen)))
+    {
+      pStore->oldest = page;
+      minGen = gen;
+      found = TRUE;
+    }
+  }
+
+  if (!found)
+  {
+    racpStoreFormat(pStore);
+    return TRUE;
+  }
+
+  for (i = 0; i < pStore->numPages; i++)
+  {
+    page = (pStore->oldest + i) % pStore->numPages;
+
+    pMedia->read(hdr, racpStorePageAddr(pStore, page), sizeof(hdr));
+
+    p = hdr;
+    BSTREAM_TO_UINT32(magic, p);
+    BSTREAM_TO_UINT32(gen, p);
+    BSTREAM_TO_UINT16(recLen, p);
+    BSTREAM_TO_UINT16(lastSeq, p);
+    BSTREAM_TO_UINT16(seqBase, p);
+
+    if ((magic != RACP_STORE_MAGIC) || (recLen != pCfg->recLen) || (gen != minGen + i))
+    {
+      break;
+    }
+
+    /* the header holds the sequence numbers when the page was opened, later than any replayed */
+    pStore->lastSeq = lastSeq;
+    pStore->seqBase = seqBase;
+    pStore->gen = gen;
+    pStore->wrPage = page;
+    pStore->wrEntry = racpStoreReplayPage(pStore, page);
+  }
+
+  /* a reset while reclaiming leaves no erased page ahead, finish the reclaim */
+  if ((pStore->wrPage + 1) % pStore->numPages == pStore->oldest)
+  {
+    racpStoreReclaim(pStore);
+  }
+
+  racpStoreCheckSorted(pStore);
+
+  APP_TRACE_INFO2("RACP store: %d records, last seq=%d", pStore->numRec, pStore->lastSeq);
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store a record.  A record with the same sequence number is replaced.  When the
+ *          store is full the oldest record is deleted.  Sequence numbers may wrap to 0.
+ *
+ *  \param  pStore   Record store.
+ *  \param  seqNum   Sequence number, after the last used for a new record.
+ *  \param  time     Time key.
+ *  \param  pRec     Record, recLen bytes, not the record buffer.
+ *
+ *  \return TRUE if successful.
+ */
+/*************************************************************************************************/
+bool_t RacpStorePut(racpStore_t *pStore, uint16_t seqNum, uint32_t time, const void *pRec)
+{
+  racpStoreSel_t sel;
+  uint16_t       pos = racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, seqNum));
+  uint16_t       slot;
+  uint16_t       base;
+  bool_t         found = (pos < pStore->numRec) && (pStore->cfg.pIdx[pos].seqNum == seqNum);
+
+  WSF_ASSERT(pRec != pStore->cfg.pBuf);
+
+  if (!found)
+  {
+    if (racpStoreSeqKey(pStore, seqNum) <= racpStoreSeqKey(pStore, pStore->lastSeq))
+    {
+      /* sequence numbers wrapped, order them from the oldest record instead */
+      base = (pStore->numRec > 0) ? pStore->cfg.pIdx[0].seqNum : pStore->lastSeq;
+
+      if (((uint16_t) (seqNum - pStore->lastSeq) >= 0x8000) || (base == pStore->seqBase) ||
+          ((uint16_t) (seqNum - base) <= (uint16_t) (pStore->lastSeq - base)))
+      {
+        return FALSE;
+      }
+
+      if (!racpStoreWrite(pStore, RACP_STORE_TYPE_BASE, base, 0, NULL, &slot))
+      {
+        return FALSE;
+      }
+
+      pStore->seqBase = base;
+    }
+
+    if (pStore->numRec == pStore->cfg.maxRec)
+    {
+      RacpStoreSelect(pStore, CH_RACP_OPERATOR_FIRST, RACP_STORE_KEY_SEQ, 0, 0, &sel);
+      RacpStoreDelete(pStore, &sel);
+    }
+
+    pStore->lastSeq = seqNum;
+  }
+
+  if (!racpStoreWrite(pStore, RACP_STORE_TYPE_REC, seqNum, time, pRec, &slot))
+  {
+    return FALSE;
+  }
+
+  racpStoreIdxInsert(pStore, seqNum, time, slot);
+
+  return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get a record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pos      Index position.
+ *
+ *  \return Record in place on media that can be mapped, else in the record buffer.
+ */
+/*************************************************************************************************/
+const uint8_t *RacpStoreGet(racpStore_t *pStore, uint16_t pos)
+{
+  const wsfEfsMedia_t *pMedia = pStore->cfg.pMedia;
+  uint8_t             *pAddr = racpStoreSlotAddr(pStore, pStore->cfg.pIdx[pos].slot) +
+                               RACP_STORE_ENTRY_HDR_LEN;
+  const uint8_t       *pRec;
+
+  if ((pMedia->map != NULL) && ((pRec = pMedia->map(pAddr, pStore->cfg.recLen)) != NULL))
+  {
+    return pRec;
+  }
+
+  pMedia->read(pStore->cfg.pBuf, pAddr, pStore->cfg.recLen);
+
+  return pStore->cfg.pBuf;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Select records with a RACP operator.  Sequence number and sorted time selections
+ *          are found by binary search.  Once sequence numbers wrap, they compare in the order
+ *          stored from the oldest record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  oper     RACP operator.
+ *  \param  key      RACP_STORE_KEY_SEQ or RACP_STORE_KEY_TIME, for LTEQ, GTEQ and RANGE.
+ *  \param  lo       Lowest key, for GTEQ and RANGE.
+ *  \param  hi       Highest key, for LTEQ and RANGE.
+ *  \param  pSel     Returns the selection.
+ *
+ *  \return RACP status.
+ */
+/*************************************************************************************************/
+uint8_t RacpStoreSelect(racpStore_t *pStore, uint8_t oper, uint8_t key, uint32_t lo, uint32_t hi,
+                        racpStoreSel_t *pSel)
+{
+  racpStoreIdx_t *pIdx = pStore->cfg.pIdx;
+  uint16_t       first = 0;
+  uint16_t       end = pStore->numRec;
+
+  pSel->key = RACP_STORE_KEY_SEQ;
+  pSel->lo = 0;
+  pSel->hi = RACP_STORE_KEY_MAX;
+
+  switch (oper)
+  {
+    case CH_RACP_OPERATOR_ALL:
+      break;
+
+    case CH_RACP_OPERATOR_LTEQ:
+      pSel->key = key;
+      pSel->hi = (key == RACP_STORE_KEY_SEQ) ? racpStoreSeqKey(pStore, (uint16_t) hi) : hi;
+      break;
+
+    case CH_RACP_OPERATOR_GTEQ:
+      pSel->key = key;
+      pSel->lo = (key == RACP_STORE_KEY_SEQ) ? racpStoreSeqKey(pStore, (uint16_t) lo) : lo;
+      break;
+
+    case CH_RACP_OPERATOR_RANGE:
+      pSel->key = key;
+      pSel->lo = (key == RACP_STORE_KEY_SEQ) ? racpStoreSeqKey(pStore, (uint16_t) lo) : lo;
+      pSel->hi = (key == RACP_STORE_KEY_SEQ) ? racpStoreSeqKey(pStore, (uint16_t) hi) : hi;
+      if (pSel->lo > pSel->hi)
+      {
+        return CH_RACP_RSP_INV_OPERAND;
+      }
+      break;
+
+    case CH_RACP_OPERATOR_FIRST:
+      end = (end > 0) ? 1 : 0;
+      break;
+
+    case CH_RACP_OPERATOR_LAST:
+      first = (end > 0) ? end - 1 : 0;
+      break;
+
+    case CH_RACP_OPERATOR_NULL:
+      return CH_RACP_RSP_INV_OPERATOR;
+
+    default:
+      return CH_RACP_RSP_OPERATOR_NOT_SUP;
+  }
+
+  /* binary search where the index is sorted by the key, else check each record */
+  if ((pSel->key == RACP_STORE_KEY_SEQ) || pStore->timeSorted)
+  {
+    first = WSF_MAX(first, racpStoreLowerBound(pStore, pSel->key, pSel->lo));
+
+    if (pSel->hi < RACP_STORE_KEY_MAX)
+    {
+      end = WSF_MIN(end, racpStoreLowerBound(pStore, pSel->key, pSel->hi + 1));
+    }
+  }
+  else
+  {
+    pSel->last = pStore->lastSeq;
+
+    while ((first < end) && !racpStoreMatch(pStore, pSel, first))
+    {
+      first++;
+    }
+
+    while ((end > first) && !racpStoreMatch(pStore, pSel, end - 1))
+    {
+      end--;
+    }
+  }
+
+  if (first >= end)
+  {
+    pSel->next = RACP_STORE_SEL_DONE;
+    pSel->last = 0;
+    return CH_RACP_RSP_NO_RECORDS;
+  }
+
+  /* continue by sequence number, records stored meanwhile do not move the selection */
+  pSel->next = pIdx[first].seqNum;
+  pSel->last = pIdx[end - 1].seqNum;
+
+  /* sequence number keys move with the base, the bounds are kept as sequence numbers */
+  if (pSel->key == RACP_STORE_KEY_SEQ)
+  {
+    pSel->lo = 0;
+    pSel->hi = RACP_STORE_KEY_MAX;
+  }
+
+  return CH_RACP_RSP_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the next selected record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *  \param  pPos     Returns the index position.
+ *
+ *  \return TRUE if a record is found.
+ */
+/*************************************************************************************************/
+bool_t RacpStoreNext(racpStore_t *pStore, racpStoreSel_t *pSel, uint16_t *pPos)
+{
+  uint32_t last = racpStoreSeqKey(pStore, pSel->last);
+  uint16_t seqNum;
+  uint16_t pos;
+
+  if (pSel->next == RACP_STORE_SEL_DONE)
+  {
+    return FALSE;
+  }
+
+  for (pos = racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, (uint16_t) pSel->next));
+       pos < pStore->numRec; pos++)
+  {
+    seqNum = pStore->cfg.pIdx[pos].seqNum;
+
+    if (racpStoreSeqKey(pStore, seqNum) > last)
+    {
+      break;
+    }
+
+    if (racpStoreMatch(pStore, pSel, pos))
+    {
+      pSel->next = (seqNum == pSel->last) ? RACP_STORE_SEL_DONE : (uint16_t) (seqNum + 1);
+      *pPos = pos;
+      return TRUE;
+    }
+  }
+
+  pSel->next = RACP_STORE_SEL_DONE;
+
+  return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Count selected records.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *
+ *  \return Number of records.
+ */
+/*************************************************************************************************/
+uint16_t RacpStoreCount(racpStore_t *pStore, const racpStoreSel_t *pSel)
+{
+  racpStoreSel_t sel = *pSel;
+  uint16_t       count = 0;
+  uint16_t       pos;
+
+  if (sel.next == RACP_STORE_SEL_DONE)
+  {
+    return 0;
+  }
+
+  /* a sorted selection is one run */
+  if ((sel.key == RACP_STORE_KEY_SEQ) || pStore->timeSorted)
+  {
+    return racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, sel.last) + 1) -
+           racpStoreLowerBound(pStore, RACP_STORE_KEY_SEQ, racpStoreSeqKey(pStore, (uint16_t) sel.next));
+  }
+
+  while (RacpStoreNext(pStore, &sel, &pos))
+  {
+    count++;
+  }
+
+  return count;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Delete selected records.  Each run of consecutive records is deleted with one log
+ *          entry, and deleting all records erases the log.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void RacpStoreDelete(racpStore_t *pStore, const racpStoreSel_t *pSel)
+{
+  racpStoreSel_t sel = *pSel;
+  uint16_t       first;
+  uint16_t       end;
+  uint16_t       lo;
+  uint16_t       hi;
+  uint16_t       slot;
+
+  while (RacpStoreNext(pStore, &sel, &first))
+  {
+    for (end = first + 1; (end < pStore->numRec) && racpStoreMatch(pStore, &sel, end); end++)
+    {
+    }
+
+    if ((first == 0) && (end == pStore->numRec))
+    {
+      racpStoreFormat(pStore);
+      return;
+    }
+
+    lo = pStore->cfg.pIdx[first].seqNum;
+    hi = pStore->cfg.pIdx[end - 1].seqNum;
+
+    /* the entry may reclaim a page and move the index, so remove by sequence number after */
+    racpStoreWrite(pStore, RACP_STORE_TYPE_DEL, lo, hi, NULL, &slot);
+    racpStoreIdxRemove(pStore, lo, hi);
+
+    sel.next = (hi == sel.last) ? RACP_STORE_SEL_DONE : (uint16_t) (hi + 1);
+  }
+
+  if (pStore->numRec == 0)
+  {
+    pStore->timeSorted = TRUE;
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Convert a date and time to a time key, in seconds since 1970.
+ *
+ *  \param  year     Year.
+ *  \param  month    Month, 1 to 12.
+ *  \param  day      Day, 1 to 31.
+ *  \param  hour     Hour.
+ *  \param  min      Minutes.
+ *  \param  sec      Seconds.
+ *
+ *  \return Time key, 0 for dates before 1970.
+ */
+/*************************************************************************************************/
+uint32_t RacpStoreTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min,
+                       uint8_t sec)
+{
+  int32_t y = year;
+  int32_t era;
+  int32_t doy;
+  int32_t days;
+  uint32_t m = month;
+
+  if ((year < 1970) || (month < 1) || (month > 12))
+  {
+    return 0;
+  }
+
+  /* days from civil, with the year starting in March */
+  if (m <= 2)
+  {
+    y--;
+  }
+
+  era = y / 400;
+  y -= era * 400;
+  doy = (153 * (int32_t) ((m > 2) ? m - 3 : m + 9) + 2) / 5 + day - 1;
+  days = era * 146097 + y * 365 + y / 4 - y / 100 + doy - 719468;
+
+  return (uint32_t) days * 86400 + (uint32_t) hour * 3600 + (uint32_t) min * 60 + sec;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase RAM media.
+ *
+ *  \param  pAddress Address in media to start erasing.
+ *  \param  size     Number of bytes to erase.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpStoreRamErase(uint8_t *pAddress, uint32_t size)
+{
+  memset(pAddress, 0xFF, size);
+  return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Read RAM media.
+ *
+ *  \param  pBuf     Buffer to hold data.
+ *  \param  pAddress Address in media to read from.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpStoreRamRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+  memcpy(pBuf, pAddress, size);
+  return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write RAM media.
+ *
+ *  \param  pBuf     Buffer with data to be written.
+ *  \param  pAddress Address in media to write to.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpStoreRamWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+  memcpy(pAddress, pBuf, size);
+  return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Map RAM media.
+ *
+ *  \param  pAddress Address in media to map.
+ *  \param  size     Number of bytes to map.
+ *
+ *  \return pAddress.
+ */
+/*************************************************************************************************/
+static const uint8_t *racpStoreRamMap(uint8_t *pAddress, uint32_t size)
+{
+  return pAddress;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Set up a RAM buffer as record store media, for records that need not survive a reset.
+ *
+ *  \param  pMedia   Media to set up.
+ *  \param  pBuf     Buffer.
+ *  \param  size     Buffer size, a multiple of pageSize.
+ *  \param  pageSize Log page size.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void RacpStoreRamMedia(wsfEfsMedia_t *pMedia, uint8_t *pBuf, uint32_t size, uint32_t pageSize)
+{
+  memset(pMedia, 0, sizeof(wsfEfsMedia_t));
+
+  pMedia->startAddress = (uint32_t) pBuf;
+  pMedia->endAddress = (uint32_t) pBuf + size;
+  pMedia->pageSize = pageSize;
+  pMedia->erase = racpStoreRamErase;
+  pMedia->read = racpStoreRamRead;
+  pMedia->write = racpStoreRamWrite;
+  pMedia->map = racpStoreRamMap;
+}
@@ -0,0 +1,245 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Record access control point record store.
+ *
+ *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
+ *
+ *  Copyright (c) 2019 Packetcraft, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*************************************************************************************************/
+#ifndef RACP_STORE_H
+#define RACP_STORE_H
+
+#include "wsf_efs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \addtogroup RACP_RECORD_STORE
+ *  \{ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/** \name Record Keys
+ *
+ */
+/**@{*/
+#define RACP_STORE_KEY_SEQ          0         /*!< \brief Sequence number */
+#define RACP_STORE_KEY_TIME         1         /*!< \brief Time */
+/**@}*/
+
+/*! \brief Bytes of log page used by the page header */
+#define RACP_STORE_PAGE_HDR_LEN     16
+
+/*! \brief Bytes of log entry used by the entry header */
+#define RACP_STORE_ENTRY_HDR_LEN    12
+
+/*! \brief Log entry alignment, the flash program width */
+#define RACP_STORE_ENTRY_ALIGN      16
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief Index entry, one per stored record in sequence number order */
+typedef struct
+{
+  uint32_t            time;           /*!< \brief Time key */
+  uint16_t            seqNum;         /*!< \brief Sequence number */
+  uint16_t            slot;           /*!< \brief Log entry holding the record */
+} racpStoreIdx_t;
+
+/*! \brief Record store configuration */
+typedef struct
+{
+  const wsfEfsMedia_t *pMedia;        /*!< \brief Media holding the log, three pages at least */
+  racpStoreIdx_t      *pIdx;          /*!< \brief Index, maxRec entries */
+  uint8_t             *pBuf;          /*!< \brief Record buffer, recLen bytes */
+  uint16_t            maxRec;         /*!< \brief Maximum number of records, at most the log
+                                           entries of all but two pages */
+  uint16_t            recLen;         /*!< \brief Record length in bytes */
+} racpStoreCfg_t;
+
+/*! \brief Record store */
+typedef struct
+{
+  racpStoreCfg_t      cfg;            /*!< \brief Configuration */
+  uint32_t            gen;            /*!< \brief Generation of the page being written */
+  uint16_t            numRec;         /*!< \brief Number of stored records */
+  uint16_t            lastSeq;        /*!< \brief Latest sequence number used */
+  uint16_t            seqBase;        /*!< \brief Sequence number the index order starts from */
+  uint16_t            entryLen;       /*!< \brief Log entry length */
+  uint16_t            pageEntries;    /*!< \brief Log entries per page */
+  uint16_t            numPages;       /*!< \brief Log pages */
+  uint16_t            oldest;         /*!< \brief Oldest page in use */
+  uint16_t            wrPage;         /*!< \brief Page being written */
+  uint16_t            wrEntry;        /*!< \brief Next free entry of the page being written */
+  bool_t              timeSorted;     /*!< \brief TRUE if time keys rise with sequence numbers */
+} racpStore_t;
+
+/*! \brief Record selection, for reporting, counting or deleting records */
+typedef struct
+{
+  uint32_t            lo;             /*!< \brief Lowest key selected */
+  uint32_t            hi;             /*!< \brief Highest key selected */
+  uint32_t            next;           /*!< \brief Sequence number to continue from, above
+                                           0xFFFF when done */
+  uint16_t            last;           /*!< \brief Last sequence number selected */
+  uint8_t             key;            /*!< \brief Key compared */
+} racpStoreSel_t;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Open a record store, rebuilding the index from the log on the media.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pCfg     Configuration.
+ *
+ *  \return TRUE if successful, FALSE if the media cannot hold the log.
+ */
+/*************************************************************************************************/
+bool_t RacpStoreInit(racpStore_t *pStore, const racpStoreCfg_t *pCfg);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store a record.  A record with the same sequence number is replaced.  When the
+ *          store is full the oldest record is deleted.  Sequence numbers may wrap to 0.
+ *
+ *  \param  pStore   Record store.
+ *  \param  seqNum   Sequence number, after the last used for a new record.
+ *  \param  time     Time key.
+ *  \param  pRec     Record, recLen bytes.
+ *
+ *  \return TRUE if successful.
+ */
+/*************************************************************************************************/
+bool_t RacpStorePut(racpStore_t *pStore, uint16_t seqNum, uint32_t time, const void *pRec);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get a record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pos      Index position.
+ *
+ *  \return Record in place on media that can be mapped, else in the record buffer.
+ */
+/*************************************************************************************************/
+const uint8_t *RacpStoreGet(racpStore_t *pStore, uint16_t pos);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Select records with a RACP operator.  Sequence number and sorted time selections
+ *          are found by binary search.  Once sequence numbers wrap, they compare in the order
+ *          stored from the oldest record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  oper     RACP operator.
+ *  \param  key      RACP_STORE_KEY_SEQ or RACP_STORE_KEY_TIME, for LTEQ, GTEQ and RANGE.
+ *  \param  lo       Lowest key, for GTEQ and RANGE.
+ *  \param  hi       Highest key, for LTEQ and RANGE.
+ *  \param  pSel     Returns the selection.
+ *
+ *  \return RACP status.
+ */
+/*************************************************************************************************/
+uint8_t RacpStoreSelect(racpStore_t *pStore, uint8_t oper, uint8_t key, uint32_t lo, uint32_t hi,
+                        racpStoreSel_t *pSel);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the next selected record.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *  \param  pPos     Returns the index position.
+ *
+ *  \return TRUE if a record is found.
+ */
+/*************************************************************************************************/
+bool_t RacpStoreNext(racpStore_t *pStore, racpStoreSel_t *pSel, uint16_t *pPos);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Count selected records.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *
+ *  \return Number of records.
+ */
+/*************************************************************************************************/
+uint16_t RacpStoreCount(racpStore_t *pStore, const racpStoreSel_t *pSel);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Delete selected records.  Each run of consecutive records is deleted with one log
+ *          entry, and deleting all records erases the log.
+ *
+ *  \param  pStore   Record store.
+ *  \param  pSel     Selection.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void RacpStoreDelete(racpStore_t *pStore, const racpStoreSel_t *pSel);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Convert a date and time to a time key, in seconds since 1970.
+ *
+ *  \param  year     Year.
+ *  \param  month    Month, 1 to 12.
+ *  \param  day      Day, 1 to 31.
+ *  \param  hour     Hour.
+ *  \param  min      Minutes.
+ *  \param  sec      Seconds.
+ *
+ *  \return Time key, 0 for dates before 1970.
+ */
+/*************************************************************************************************/
+uint32_t RacpStoreTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min,
+                       uint8_t sec);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Set up a RAM buffer as record store media, for records that need not survive a reset.
+ *
+ *  \param  pMedia   Media to set up.
+ *  \param  pBuf     Buffer.
+ *  \param  size     Buffer size, a multiple of pageSize.
+ *  \param  pageSize Log page size.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void RacpStoreRamMedia(wsfEfsMedia_t *pMedia, uint8_t *pBuf, uint32_t size, uint32_t pageSize);
+
+/*! \} */    /* RACP_RECORD_STORE */
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* RACP_STORE_H */
@@ -34,6 +34,7 @@ extern "C" {
 
 #include "wsf_types.h"
 #include "wsf_os.h"
+#include "att_api.h"
 
 /*************************************************************************************************/
 /*!
@@ -88,6 +89,17 @@ void GyroMeasStart(void);
 /*************************************************************************************************/
 void GyroMeasComplete(dmConnId_t connId, int16_t x, int16_t y, int16_t z);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle value confirm handler, sending the next batched samples if due.
+ *
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void GyroHandleValueCnf(attEvt_t *pMsg);
+
 /*! \} */    /* GYROSCOPE_SERVICE_PROFILE */
 
 #ifdef __cplusplus
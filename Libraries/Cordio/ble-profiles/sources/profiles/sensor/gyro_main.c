@@ -32,6 +32,21 @@
 
 #include "gyro_api.h"
 #include "svc_gyro.h"
+#include "sensor_batch.h"
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! Samples held for batched notifications */
+#ifndef GYRO_BATCH_MAX_SAMPLES
+#define GYRO_BATCH_MAX_SAMPLES    64
+#endif
+
+/*! Longest time in ms a batched sample waits to be sent */
+#ifndef GYRO_BATCH_LATENCY_MS
+#define GYRO_BATCH_LATENCY_MS     1000
+#endif
 
 /**************************************************************************************************
   Global Variables
@@ -40,8 +55,13 @@
 /*! Control block. */
 static struct
 {
-  wsfTimer_t  measTimer;
-  bool_t      measTimerStarted;
+  wsfTimer_t    measTimer;
+  bool_t        measTimerStarted;
+  uint8_t       config;         /*! Measurement configuration */
+  uint8_t       period;         /*! Measurement period in 10 ms units */
+  uint32_t      sampleTime;     /*! Time of last sample in ms */
+  sensorBatch_t batch;          /*! Batched samples */
+  uint8_t       batchBuf[SENSOR_BATCH_BUF_LEN(GYRO_BATCH_MAX_SAMPLES, GYRO_SIZE_DATA_ATT)];
 } gyroCb;
 
 /*************************************************************************************************/
@@ -79,7 +99,10 @@ static void gyroUpdateTimer(void)
     period = GYRO_ATT_PERIOD_MIN;
   }
 
-  if (config == GYRO_ATT_CONFIG_ENABLE)
+  gyroCb.config = config;
+  gyroCb.period = period;
+
+  if (config != GYRO_ATT_CONFIG_DISABLE)
   {
     if (!gyroCb.measTimerStarted)
     {
@@ -120,7 +143,8 @@ static uint8_t gyroWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
         return ATT_ERR_LENGTH;
       }
       config = *pValue;
-      if ((config != GYRO_ATT_CONFIG_DISABLE) && (config != GYRO_ATT_CONFIG_ENABLE))
+      if ((config != GYRO_ATT_CONFIG_DISABLE) && (config != GYRO_ATT_CONFIG_ENABLE) &&
+          (config != GYRO_ATT_CONFIG_BATCH))
       {
         return ATT_ERR_RANGE;
       }
@@ -128,6 +152,12 @@ static uint8_t gyroWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
       /* Save value. */
       AttsSetAttr(GYRO_HANDLE_CONFIG, len, pValue);
 
+      /* Send batched samples if no longer batching. */
+      if (config != GYRO_ATT_CONFIG_BATCH)
+      {
+        SensorBatchFlush(&gyroCb.batch, connId);
+      }
+
       /* Enable or disable timer. */
       gyroUpdateTimer();
       return ATT_SUCCESS;
@@ -164,12 +194,26 @@ static uint8_t gyroWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
 /*************************************************************************************************/
 void GyroStart(wsfHandlerId_t handlerId, uint8_t timerEvt)
 {
+  sensorBatchCfg_t batchCfg;
+  uint8_t          batchFmt[SENSOR_BATCH_FMT_LEN];
+
   SvcGyroAddGroup();
   SvcGyroCbackRegister(gyroWriteCback);
 
   gyroCb.measTimer.handlerId = handlerId;
   gyroCb.measTimer.msg.event = timerEvt;
   gyroCb.measTimerStarted    = FALSE;
+
+  /* Set up sample batching and publish its format. */
+  batchCfg.pBuf = gyroCb.batchBuf;
+  batchCfg.maxSamples = GYRO_BATCH_MAX_SAMPLES;
+  batchCfg.handle = GYRO_HANDLE_DATA;
+  batchCfg.latency = GYRO_BATCH_LATENCY_MS;
+  batchCfg.sampleLen = GYRO_SIZE_DATA_ATT;
+  SensorBatchInit(&gyroCb.batch, &batchCfg);
+
+  SensorBatchFormat(&gyroCb.batch, batchFmt);
+  AttsSetAttr(GYRO_HANDLE_BATCH_FMT, sizeof(batchFmt), batchFmt);
 }
 
 /*************************************************************************************************/
@@ -198,6 +242,8 @@ void GyroMeasStop(void)
 {
   gyroCb.measTimerStarted = FALSE;
   WsfTimerStop(&gyroCb.measTimer);
+
+  SensorBatchClear(&gyroCb.batch);
 }
 
 /*************************************************************************************************/
@@ -230,7 +276,31 @@ void GyroMeasComplete(dmConnId_t connId, int16_t x, int16_t y, int16_t z)
 
   uint8_t gyroData[6] = {UINT16_TO_BYTES(x), UINT16_TO_BYTES(y), UINT16_TO_BYTES(z)};
   AttsSetAttr(GYRO_HANDLE_DATA, sizeof(gyroData), gyroData);
-  AttsHandleValueNtf(connId, GYRO_HANDLE_DATA, sizeof(gyroData), gyroData);
+
+  /* Batch sample or send it now. */
+  gyroCb.sampleTime += gyroCb.period * 10u;
+  if (gyroCb.config == GYRO_ATT_CONFIG_BATCH)
+  {
+    SensorBatchPut(&gyroCb.batch, connId, gyroCb.sampleTime, gyroData);
+  }
+  else
+  {
+    AttsHandleValueNtf(connId, GYRO_HANDLE_DATA, sizeof(gyroData), gyroData);
+  }
 
   gyroUpdateTimer();
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle value confirm handler, sending the next batched samples if due.
+ *
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void GyroHandleValueCnf(attEvt_t *pMsg)
+{
+  SensorBatchValueCnf(&gyroCb.batch, pMsg);
+}
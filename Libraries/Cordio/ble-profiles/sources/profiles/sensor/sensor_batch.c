@@ -0,0 +1,326 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Sensor sample batching.
+ *
+ *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
+ *
+ *  Copyright (c) 2019 Packetcraft, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  Samples are held with their time in a ring buffer and sent in packed notifications:
+ *
+ *    number of first sample (2 bytes), sample count (1 byte), time of first sample (4 bytes),
+ *    then for each sample its time after the first sample (2 bytes) and the sample.
+ *
+ *  All fields are little endian and times are in ms.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_assert.h"
+#include "wsf_trace.h"
+#include "wsf_math.h"
+#include "util/bstream.h"
+#include "att_api.h"
+#include "att_defs.h"
+#include "sensor_batch.h"
+
+/**************************************************************************************************
+  Local Functions
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get a ring buffer entry.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  i         Sample, 0 for the oldest.
+ *
+ *  \return Entry holding the sample time followed by the sample.
+ */
+/*************************************************************************************************/
+static uint8_t *sensorBatchEntry(const sensorBatch_t *pBatch, uint16_t i)
+{
+  uint16_t entry = (pBatch->head + i) % pBatch->cfg.maxSamples;
+
+  return pBatch->cfg.pBuf + (entry * (SENSOR_BATCH_TIME_LEN + pBatch->cfg.sampleLen));
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the number of samples that fit in a notification.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *
+ *  \return Number of samples.
+ */
+/*************************************************************************************************/
+static uint16_t sensorBatchNtfSamples(const sensorBatch_t *pBatch, dmConnId_t connId)
+{
+  uint16_t len = AttGetMtu(connId) - ATT_VALUE_NTF_LEN - SENSOR_BATCH_HDR_LEN;
+
+  /* sample count is one byte */
+  return WSF_MIN(len / (SENSOR_BATCH_DELTA_LEN + pBatch->cfg.sampleLen), UINT8_MAX);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check if a notification is due.
+ *
+ *  \param  pBatch      Batch.
+ *  \param  ntfSamples  Number of samples that fit in a notification.
+ *
+ *  \return TRUE if due.
+ */
+/*************************************************************************************************/
+static bool_t sensorBatchDue(const sensorBatch_t *pBatch, uint16_t ntfSamples)
+{
+  uint32_t time;
+
+  if (pBatch->count == 0)
+  {
+    return FALSE;
+  }
+
+  if (pBatch->flush || (pBatch->count >= ntfSamples) || (pBatch->count == pBatch->cfg.maxSamples))
+  {
+    return TRUE;
+  }
+
+  /* check if the oldest sample has waited long enough */
+  BYTES_TO_UINT32(time, sensorBatchEntry(pBatch, 0));
+
+  return ((pBatch->lastTime - time) >= pBatch->cfg.latency);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send a notification with the oldest samples if one is due.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void sensorBatchSend(sensorBatch_t *pBatch, dmConnId_t connId)
+{
+  uint8_t   *pBuf;
+  uint8_t   *p;
+  uint8_t   *pEntry;
+  uint32_t  firstTime;
+  uint32_t  time;
+  uint16_t  num;
+  uint16_t  len;
+  uint16_t  i;
+
+  num = sensorBatchNtfSamples(pBatch, connId);
+
+  if (pBatch->ntfPending || (num == 0) || !sensorBatchDue(pBatch, num))
+  {
+    return;
+  }
+
+  num = WSF_MIN(num, pBatch->count);
+
+  /* end the notification at a sample too late for its time to be sent */
+  BYTES_TO_UINT32(firstTime, sensorBatchEntry(pBatch, 0));
+  for (i = 1; i < num; i++)
+  {
+    BYTES_TO_UINT32(time, sensorBatchEntry(pBatch, i));
+
+    if ((time - firstTime) > UINT16_MAX)
+    {
+      num = i;
+      break;
+    }
+  }
+
+  len = SENSOR_BATCH_HDR_LEN + (num * (SENSOR_BATCH_DELTA_LEN + pBatch->cfg.sampleLen));
+
+  if ((pBuf = AttMsgAlloc(len, ATT_PDU_VALUE_NTF)) == NULL)
+  {
+    return;
+  }
+
+  p = pBuf;
+  UINT16_TO_BSTREAM(p, pBatch->sampleNum);
+  UINT8_TO_BSTREAM(p, num);
+  UINT32_TO_BSTREAM(p, firstTime);
+
+  for (i = 0; i < num; i++)
+  {
+    pEntry = sensorBatchEntry(pBatch, i);
+    BYTES_TO_UINT32(time, pEntry);
+
+    UINT16_TO_BSTREAM(p, (time - firstTime));
+    memcpy(p, pEntry + SENSOR_BATCH_TIME_LEN, pBatch->cfg.sampleLen);
+    p += pBatch->cfg.sampleLen;
+  }
+
+  AttsHandleValueNtfZeroCpy(connId, pBatch->cfg.handle, len, pBuf);
+  pBatch->ntfPending = TRUE;
+
+  /* remove samples from ring buffer */
+  pBatch->head = (pBatch->head + num) % pBatch->cfg.maxSamples;
+  pBatch->count -= num;
+  pBatch->sampleNum += num;
+
+  if (pBatch->count == 0)
+  {
+    pBatch->flush = FALSE;
+  }
+}
+
+/**************************************************************************************************
+  Global Functions
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize a batch.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pCfg      Configuration.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchInit(sensorBatch_t *pBatch, const sensorBatchCfg_t *pCfg)
+{
+  WSF_ASSERT((pCfg->pBuf != NULL) && (pCfg->maxSamples > 0));
+
+  pBatch->cfg = *pCfg;
+  pBatch->sampleNum = 0;
+  SensorBatchClear(pBatch);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Discard all samples of a batch.
+ *
+ *  \param  pBatch    Batch.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchClear(sensorBatch_t *pBatch)
+{
+  pBatch->sampleNum += pBatch->count;
+  pBatch->head = 0;
+  pBatch->count = 0;
+  pBatch->dropped = 0;
+  pBatch->ntfPending = FALSE;
+  pBatch->flush = FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add a sample to a batch.  Samples are sent when they fill a notification, when the
+ *          oldest has waited the latency or when the ring buffer is full.  If the ring buffer is
+ *          full the oldest sample is overwritten.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *  \param  time      Sample time in ms.
+ *  \param  pSample   Sample, sampleLen bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchPut(sensorBatch_t *pBatch, dmConnId_t connId, uint32_t time,
+                    const uint8_t *pSample)
+{
+  uint8_t *pEntry;
+
+  /* overwrite the oldest sample if the previous notification is still being sent */
+  if (pBatch->count == pBatch->cfg.maxSamples)
+  {
+    pBatch->head = (pBatch->head + 1) % pBatch->cfg.maxSamples;
+    pBatch->count--;
+    pBatch->sampleNum++;
+    pBatch->dropped++;
+
+    APP_TRACE_WARN1("sensor batch: sample dropped, total=%d", pBatch->dropped);
+  }
+
+  pEntry = sensorBatchEntry(pBatch, pBatch->count);
+  UINT32_TO_BUF(pEntry, time);
+  memcpy(pEntry + SENSOR_BATCH_TIME_LEN, pSample, pBatch->cfg.sampleLen);
+
+  pBatch->count++;
+  pBatch->lastTime = time;
+
+  sensorBatchSend(pBatch, connId);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send all samples of a batch.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchFlush(sensorBatch_t *pBatch, dmConnId_t connId)
+{
+  pBatch->flush = (pBatch->count > 0);
+
+  sensorBatchSend(pBatch, connId);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle a notification sent event, sending the next notification if due.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchValueCnf(sensorBatch_t *pBatch, attEvt_t *pMsg)
+{
+  if ((pMsg->handle == pBatch->cfg.handle) && pBatch->ntfPending)
+  {
+    pBatch->ntfPending = FALSE;
+
+    sensorBatchSend(pBatch, (dmConnId_t) pMsg->hdr.param);
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Build the batch format characteristic value.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pValue    Returns the value, SENSOR_BATCH_FMT_LEN bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchFormat(const sensorBatch_t *pBatch, uint8_t *pValue)
+{
+  UINT8_TO_BSTREAM(pValue, SENSOR_BATCH_FMT_VER);
+  UINT8_TO_BSTREAM(pValue, SENSOR_BATCH_HDR_LEN);
+  UINT8_TO_BSTREAM(pValue, SENSOR_BATCH_DELTA_LEN + pBatch->cfg.sampleLen);
+  UINT8_TO_BSTREAM(pValue, pBatch->cfg.sampleLen);
+  UINT16_TO_BSTREAM(pValue, pBatch->cfg.latency);
+}
@@ -0,0 +1,175 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Sensor sample batching.
+ *
+ *  Copyright (c) 2012-2018 Arm Ltd. All Rights Reserved.
+ *
+ *  Copyright (c) 2019 Packetcraft, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+/*************************************************************************************************/
+#ifndef SENSOR_BATCH_H
+#define SENSOR_BATCH_H
+
+#include "wsf_types.h"
+#include "att_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \addtogroup SENSOR_SAMPLE_BATCHING
+ *  \{ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! \brief Batch format version */
+#define SENSOR_BATCH_FMT_VER        1
+
+/*! \brief Length of batch format characteristic value: version, header length, sample record
+ *  length, sample length and latency in ms */
+#define SENSOR_BATCH_FMT_LEN        6
+
+/*! \brief Length of packed notification header: number of first sample, sample count and time
+ *  of first sample in ms */
+#define SENSOR_BATCH_HDR_LEN        7
+
+/*! \brief Length of sample time in packed notification, in ms after the first sample */
+#define SENSOR_BATCH_DELTA_LEN      2
+
+/*! \brief Length of sample time in ring buffer */
+#define SENSOR_BATCH_TIME_LEN       4
+
+/*! \brief Ring buffer length for a number of samples */
+#define SENSOR_BATCH_BUF_LEN(numSamples, sampleLen) \
+  ((numSamples) * (SENSOR_BATCH_TIME_LEN + (sampleLen)))
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief Batch configuration */
+typedef struct
+{
+  uint8_t           *pBuf;          /*!< \brief Ring buffer, SENSOR_BATCH_BUF_LEN() bytes */
+  uint16_t          maxSamples;     /*!< \brief Samples held by ring buffer */
+  uint16_t          handle;         /*!< \brief Attribute handle notified */
+  uint16_t          latency;        /*!< \brief Longest time in ms a sample waits to be sent */
+  uint8_t           sampleLen;      /*!< \brief Sample length */
+} sensorBatchCfg_t;
+
+/*! \brief Batch */
+typedef struct
+{
+  sensorBatchCfg_t  cfg;            /*!< \brief Configuration */
+  uint32_t          lastTime;       /*!< \brief Time of newest sample */
+  uint16_t          head;           /*!< \brief Ring buffer entry of oldest sample */
+  uint16_t          count;          /*!< \brief Samples in ring buffer */
+  uint16_t          sampleNum;      /*!< \brief Number of oldest sample */
+  uint16_t          dropped;        /*!< \brief Samples overwritten before they were sent */
+  bool_t            ntfPending;     /*!< \brief TRUE if waiting for a notification to be sent */
+  bool_t            flush;          /*!< \brief TRUE to send all samples now */
+} sensorBatch_t;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize a batch.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pCfg      Configuration.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchInit(sensorBatch_t *pBatch, const sensorBatchCfg_t *pCfg);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Discard all samples of a batch.
+ *
+ *  \param  pBatch    Batch.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchClear(sensorBatch_t *pBatch);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Add a sample to a batch.  Samples are sent when they fill a notification, when the
+ *          oldest has waited the latency or when the ring buffer is full.  If the ring buffer is
+ *          full the oldest sample is overwritten.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *  \param  time      Sample time in ms.
+ *  \param  pSample   Sample, sampleLen bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchPut(sensorBatch_t *pBatch, dmConnId_t connId, uint32_t time,
+                    const uint8_t *pSample);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send all samples of a batch.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  connId    Connection ID.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchFlush(sensorBatch_t *pBatch, dmConnId_t connId);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle a notification sent event, sending the next notification if due.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchValueCnf(sensorBatch_t *pBatch, attEvt_t *pMsg);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Build the batch format characteristic value.
+ *
+ *  \param  pBatch    Batch.
+ *  \param  pValue    Returns the value, SENSOR_BATCH_FMT_LEN bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void SensorBatchFormat(const sensorBatch_t *pBatch, uint8_t *pValue);
+
+/*! \} */    /* SENSOR_SAMPLE_BATCHING */
+
+#ifdef __cplusplus
+};
+#endif
+
+#endif /* SENSOR_BATCH_H */
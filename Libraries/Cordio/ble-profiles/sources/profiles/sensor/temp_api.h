@@ -34,6 +34,7 @@ extern "C" {
 
 #include "wsf_types.h"
 #include "wsf_os.h"
+#include "att_api.h"
 
 /*************************************************************************************************/
 /*!
@@ -86,6 +87,17 @@ void TempMeasStart(void);
 /*************************************************************************************************/
 void TempMeasComplete(dmConnId_t connId, int16_t temp);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle value confirm handler, sending the next batched samples if due.
+ *
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void TempHandleValueCnf(attEvt_t *pMsg);
+
 /*! \} */    /* TEMPERATURE_SERVICE_PROFILE */
 
 #ifdef __cplusplus
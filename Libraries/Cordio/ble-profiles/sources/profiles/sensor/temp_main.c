@@ -32,6 +32,24 @@
 
 #include "temp_api.h"
 #include "svc_temp.h"
+#include "sensor_batch.h"
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! Length of a temperature sample */
+#define TEMP_BATCH_SAMPLE_LEN     2
+
+/*! Samples held for batched notifications */
+#ifndef TEMP_BATCH_MAX_SAMPLES
+#define TEMP_BATCH_MAX_SAMPLES    64
+#endif
+
+/*! Longest time in ms a batched sample waits to be sent */
+#ifndef TEMP_BATCH_LATENCY_MS
+#define TEMP_BATCH_LATENCY_MS     1000
+#endif
 
 /**************************************************************************************************
   Global Variables
@@ -40,8 +58,13 @@
 /*! Control block. */
 static struct
 {
-  wsfTimer_t  measTimer;
-  bool_t      measTimerStarted;
+  wsfTimer_t    measTimer;
+  bool_t        measTimerStarted;
+  uint8_t       config;         /*! Measurement configuration */
+  uint8_t       period;         /*! Measurement period in 10 ms units */
+  uint32_t      sampleTime;     /*! Time of last sample in ms */
+  sensorBatch_t batch;          /*! Batched samples */
+  uint8_t       batchBuf[SENSOR_BATCH_BUF_LEN(TEMP_BATCH_MAX_SAMPLES, TEMP_BATCH_SAMPLE_LEN)];
 } tempCb;
 
 /*************************************************************************************************/
@@ -79,7 +102,10 @@ static void tempUpdateTimer(void)
     period = TEMP_ATT_PERIOD_MIN;
   }
 
-  if (config == TEMP_ATT_CONFIG_ENABLE)
+  tempCb.config = config;
+  tempCb.period = period;
+
+  if (config != TEMP_ATT_CONFIG_DISABLE)
   {
     if (!tempCb.measTimerStarted)
     {
@@ -120,7 +146,8 @@ static uint8_t tempWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
         return ATT_ERR_LENGTH;
       }
       config = *pValue;
-      if ((config != TEMP_ATT_CONFIG_DISABLE) && (config != TEMP_ATT_CONFIG_ENABLE))
+      if ((config != TEMP_ATT_CONFIG_DISABLE) && (config != TEMP_ATT_CONFIG_ENABLE) &&
+          (config != TEMP_ATT_CONFIG_BATCH))
       {
         return ATT_ERR_RANGE;
       }
@@ -128,6 +155,12 @@ static uint8_t tempWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
       /* Save value. */
       AttsSetAttr(TEMP_HANDLE_CONFIG, len, pValue);
 
+      /* Send batched samples if no longer batching. */
+      if (config != TEMP_ATT_CONFIG_BATCH)
+      {
+        SensorBatchFlush(&tempCb.batch, connId);
+      }
+
       /* Enable or disable timer. */
       tempUpdateTimer();
       return ATT_SUCCESS;
@@ -164,12 +197,26 @@ static uint8_t tempWriteCback(dmConnId_t connId, uint16_t handle, uint8_t operat
 /*************************************************************************************************/
 void TempStart(wsfHandlerId_t handlerId, uint8_t timerEvt)
 {
+  sensorBatchCfg_t batchCfg;
+  uint8_t          batchFmt[SENSOR_BATCH_FMT_LEN];
+
   SvcTempAddGroup();
   SvcTempCbackRegister(tempWriteCback);
 
   tempCb.measTimer.handlerId = handlerId;
   tempCb.measTimer.msg.event = timerEvt;
   tempCb.measTimerStarted    = FALSE;
+
+  /* Set up sample batching and publish its format. */
+  batchCfg.pBuf = tempCb.batchBuf;
+  batchCfg.maxSamples = TEMP_BATCH_MAX_SAMPLES;
+  batchCfg.handle = TEMP_HANDLE_DATA;
+  batchCfg.latency = TEMP_BATCH_LATENCY_MS;
+  batchCfg.sampleLen = TEMP_BATCH_SAMPLE_LEN;
+  SensorBatchInit(&tempCb.batch, &batchCfg);
+
+  SensorBatchFormat(&tempCb.batch, batchFmt);
+  AttsSetAttr(TEMP_HANDLE_BATCH_FMT, sizeof(batchFmt), batchFmt);
 }
 
 /*************************************************************************************************/
@@ -196,6 +243,8 @@ void TempMeasStop(void)
 {
   tempCb.measTimerStarted = FALSE;
   WsfTimerStop(&tempCb.measTimer);
+
+  SensorBatchClear(&tempCb.batch);
 }
 
 /*************************************************************************************************/
@@ -226,7 +275,31 @@ void TempMeasComplete(dmConnId_t connId, int16_t temp)
 
   uint8_t tempData[2] = {UINT16_TO_BYTES(temp)};
   AttsSetAttr(TEMP_HANDLE_DATA, sizeof(tempData), tempData);
-  AttsHandleValueNtf(connId, TEMP_HANDLE_DATA, sizeof(tempData), tempData);
+
+  /* Batch sample or send it now. */
+  tempCb.sampleTime += tempCb.period * 10u;
+  if (tempCb.config == TEMP_ATT_CONFIG_BATCH)
+  {
+    SensorBatchPut(&tempCb.batch, connId, tempCb.sampleTime, tempData);
+  }
+  else
+  {
+    AttsHandleValueNtf(connId, TEMP_HANDLE_DATA, sizeof(tempData), tempData);
+  }
 
   tempUpdateTimer();
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handle value confirm handler, sending the next batched samples if due.
+ *
+ *  \param  pMsg      ATTS_HANDLE_VALUE_CNF event.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void TempHandleValueCnf(attEvt_t *pMsg)
+{
+  SensorBatchValueCnf(&tempCb.batch, pMsg);
+}
@@ -47,6 +47,18 @@ extern "C" {
 #define WDXS_DEVICE_MODEL               "WDXS App"
 #endif
 
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief Link configuration for large file transfers */
+typedef struct
+{
+  hciConnSpec_t     bulkSpec;         /*!< \brief Connection parameters while a transfer runs */
+  hciConnSpec_t     idleSpec;         /*!< \brief Connection parameters restored afterwards */
+  uint32_t          minLen;           /*!< \brief Shortest get or put that switches to bulk mode */
+} wdxsBulkCfg_t;
+
 /*************************************************************************************************/
 /*!
  *  \brief  Called at startup to configure WDXS authentication.
@@ -59,6 +71,22 @@ extern "C" {
 /*************************************************************************************************/
 void WdxsAuthenticationCfg(bool_t reqLevel, uint8_t *pKey);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Called at startup to configure link parameters for large file transfers.
+ *
+ *  When a get or put of at least minLen bytes starts, WDXS requests the 2M PHY, the largest
+ *  data length and bulkSpec. When it ends or is aborted, idleSpec is requested. Goodput of
+ *  each connection is traced once a second with the interval and PHY it was measured on. Call after
+ *  WdxsHandlerInit().
+ *
+ *  \param  pCfg     Bulk transfer configuration, NULL to disable.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WdxsBulkCfg(const wdxsBulkCfg_t *pCfg);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Handle WSF events for WDXS.
@@ -59,6 +59,7 @@ void wdxsAuSend(dmConnId_t connId)
     /* send notification */
     AttsHandleValueNtf(connId, WDXS_AU_HDL, wdxsAuCb.auMsgLen, wdxsAuCb.auMsgBuf);
     wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_AU_BIT | WDXS_TX_MASK_READY_BIT);
+    wdxsCb.txConnId = connId;
 
     wdxsAuCb.authState = WDXS_AU_STATE_WAIT_REPLY;
   }
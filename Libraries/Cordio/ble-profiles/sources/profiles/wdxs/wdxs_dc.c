@@ -58,6 +58,7 @@ void wdxsDcSend(dmConnId_t connId)
     /* send notification */
     AttsHandleValueNtf(connId, WDXS_DC_HDL, wdxsDcCb.dcMsgLen, wdxsDcCb.dcMsgBuf);
     wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_DC_BIT | WDXS_TX_MASK_READY_BIT);
+    wdxsCb.txConnId = connId;
   }
 }
 
@@ -28,6 +28,7 @@
 #include "wsf_trace.h"
 #include "wsf_assert.h"
 #include "wsf_efs.h"
+#include "wsf_timer.h"
 #include "util/bstream.h"
 #include "svc_wdxs.h"
 #include "wdxs_api.h"
@@ -35,10 +36,329 @@
 #include "dm_api.h"
 #include "app_api.h"
 
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! Bulk transfer data length, the largest LL payload and its time on the 1M PHY */
+#define WDXS_BULK_DATA_LEN          251
+#define WDXS_BULK_DATA_TIME         2120
+
+/*! Bulk transfer goodput measurement window in milliseconds */
+#ifndef WDXS_BULK_WINDOW_MS
+#define WDXS_BULK_WINDOW_MS         1000
+#endif
+
 /**************************************************************************************************
   Local Variables
 **************************************************************************************************/
 
+/*! Bulk transfer mode control block */
+static struct
+{
+  const wdxsBulkCfg_t *pCfg;          /*!< Configuration, NULL when disabled */
+  wsfTimer_t          timer;          /*!< Goodput measurement timer */
+  uint32_t            connMask;       /*!< Connections in bulk mode */
+  uint32_t            bytes[DM_CONN_MAX];     /*!< Bytes transferred in the current window */
+  uint16_t            interval[DM_CONN_MAX];  /*!< Connection interval */
+  uint8_t             txPhy[DM_CONN_MAX];     /*!< Transmitter PHY */
+} wdxsBulkCb;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find the transfer context of a connection for an operation.
+ *
+ *  \param  connId   DM connection identifier.
+ *  \param  op       WDX_FTC_OP_GET_REQ or WDX_FTC_OP_PUT_REQ.
+ *
+ *  \return Context or NULL if none.
+ */
+/*************************************************************************************************/
+static wdxsFtCtx_t *wdxsFtFind(dmConnId_t connId, uint8_t op)
+{
+  wdxsFtCtx_t *pCtx = wdxsCb.ft;
+  uint8_t     i;
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
+  {
+    if ((pCtx->connId == connId) &&
+        ((pCtx->op == op) || ((op == WDX_FTC_OP_GET_REQ) && (pCtx->op == WDX_FTC_OP_ABORT))))
+    {
+      return pCtx;
+    }
+  }
+
+  return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether a file is being transferred on any connection.
+ *
+ *  \param  handle   File handle.
+ *
+ *  \return TRUE if busy.
+ */
+/*************************************************************************************************/
+static bool_t wdxsFtHandleBusy(uint16_t handle)
+{
+  wdxsFtCtx_t *pCtx = wdxsCb.ft;
+  uint8_t     i;
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
+  {
+    if ((pCtx->op != WDX_FTC_OP_NONE) && (pCtx->handle == handle))
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Allocate a transfer context.  A connection has at most one get and one put, since
+ *          file transfer data carries no file handle.
+ *
+ *  \param  connId   DM connection identifier.
+ *  \param  handle   File handle.
+ *  \param  op       WDX_FTC_OP_GET_REQ or WDX_FTC_OP_PUT_REQ.
+ *  \param  pStatus  Returns WDX_FTC_ST_IN_PROGRESS if busy, WDX_FTC_ST_INVALID_OP_DATA if full.
+ *
+ *  \return Context or NULL if none available.
+ */
+/*************************************************************************************************/
+static wdxsFtCtx_t *wdxsFtAlloc(dmConnId_t connId, uint16_t handle, uint8_t op, uint8_t *pStatus)
+{
+  wdxsFtCtx_t *pCtx = wdxsCb.ft;
+  uint8_t     i;
+
+  if ((wdxsFtFind(connId, op) != NULL) || wdxsFtHandleBusy(handle))
+  {
+    *pStatus = WDX_FTC_ST_IN_PROGRESS;
+    return NULL;
+  }
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
+  {
+    if (pCtx->op == WDX_FTC_OP_NONE)
+    {
+      memset(pCtx, 0, sizeof(wdxsFtCtx_t));
+      pCtx->connId = connId;
+      pCtx->handle = handle;
+      return pCtx;
+    }
+  }
+
+  APP_TRACE_WARN0("WDXS: no free transfer context");
+
+  *pStatus = WDX_FTC_ST_INVALID_OP_DATA;
+  return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Update the FTD ready bit from the get transfers in progress.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsFtdUpdateReady(void)
+{
+  wdxsFtCtx_t *pCtx = wdxsCb.ft;
+  uint8_t     i;
+
+  wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_FTD_BIT);
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
+  {
+    if ((pCtx->op == WDX_FTC_OP_GET_REQ) || (pCtx->op == WDX_FTC_OP_ABORT))
+    {
+      wdxsCb.txReadyMask |= WDXS_TX_MASK_FTD_BIT;
+      break;
+    }
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Restart the goodput measurement window.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsBulkRestart(void)
+{
+  memset(wdxsBulkCb.bytes, 0, sizeof(wdxsBulkCb.bytes));
+  WsfTimerStartMs(&wdxsBulkCb.timer, WDXS_BULK_WINDOW_MS);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Request bulk link parameters for a transfer.
+ *
+ *  \param  pCtx     Transfer context.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsBulkStart(wdxsFtCtx_t *pCtx)
+{
+  dmConnId_t connId = pCtx->connId;
+
+  if ((wdxsBulkCb.pCfg == NULL) || (wdxsBulkCb.connMask & WDXS_CONN_BIT(connId)) ||
+      (pCtx->len < wdxsBulkCb.pCfg->minLen))
+  {
+    return;
+  }
+
+  APP_TRACE_INFO2("WDXS: bulk start connId=%d len=%d", connId, pCtx->len);
+
+  DmSetPhy(connId, HCI_ALL_PHY_ALL_PREFERENCES, HCI_PHY_LE_2M_BIT, HCI_PHY_LE_2M_BIT, HCI_PHY_OPTIONS_NONE);
+  DmConnSetDataLen(connId, WDXS_BULK_DATA_LEN, WDXS_BULK_DATA_TIME);
+  DmConnUpdate(connId, (hciConnSpec_t *) &wdxsBulkCb.pCfg->bulkSpec);
+
+  if (wdxsBulkCb.connMask == 0)
+  {
+    wdxsBulkRestart();
+  }
+
+  wdxsBulkCb.connMask |= WDXS_CONN_BIT(connId);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Restore idle link parameters after the last transfer of a connection ends or is aborted.
+ *
+ *  \param  connId   DM connection identifier.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsBulkStop(dmConnId_t connId)
+{
+  if (((wdxsBulkCb.connMask & WDXS_CONN_BIT(connId)) == 0) ||
+      (wdxsFtFind(connId, WDX_FTC_OP_GET_REQ) != NULL) ||
+      (wdxsFtFind(connId, WDX_FTC_OP_PUT_REQ) != NULL))
+  {
+    return;
+  }
+
+  APP_TRACE_INFO1("WDXS: bulk stop connId=%d", connId);
+
+  /* the 2M PHY and longer packets also save power, only the interval goes back */
+  DmConnUpdate(connId, (hciConnSpec_t *) &wdxsBulkCb.pCfg->idleSpec);
+
+  wdxsBulkCb.connMask &= ~WDXS_CONN_BIT(connId);
+
+  if (wdxsBulkCb.connMask == 0)
+  {
+    WsfTimerStop(&wdxsBulkCb.timer);
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Log goodput of each connection in bulk mode for the window that ended, with the link
+ *          parameters it ran on.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsBulkTimerExp(void)
+{
+  uint8_t i;
+
+  if (wdxsBulkCb.connMask == 0)
+  {
+    return;
+  }
+
+  for (i = 0; i < DM_CONN_MAX; i++)
+  {
+    if (wdxsBulkCb.connMask & WDXS_CONN_BIT(i + 1))
+    {
+      APP_TRACE_INFO4("WDXS: bulk connId=%d goodput=%d B/s interval=%d phy=%d", i + 1,
+                      wdxsBulkCb.bytes[i] * 1000 / WDXS_BULK_WINDOW_MS, wdxsBulkCb.interval[i],
+                      wdxsBulkCb.txPhy[i]);
+    }
+  }
+
+  wdxsBulkRestart();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Track link parameters for the goodput trace and link changes while in bulk mode.
+ *
+ *  \param  pEvt   Pointer to the DM Event
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsBulkProcDmMsg(dmEvt_t *pEvt)
+{
+  uint8_t idx = (uint8_t) pEvt->hdr.param - 1;
+
+  switch (pEvt->hdr.event)
+  {
+    case DM_CONN_OPEN_IND:
+      wdxsBulkCb.interval[idx] = pEvt->connOpen.connInterval;
+      wdxsBulkCb.txPhy[idx] = HCI_PHY_LE_1M_BIT;
+      /* fall through */
+
+    case DM_CONN_CLOSE_IND:
+      wdxsBulkCb.connMask &= ~WDXS_CONN_BIT(pEvt->hdr.param);
+      if (wdxsBulkCb.connMask == 0)
+      {
+        WsfTimerStop(&wdxsBulkCb.timer);
+      }
+      break;
+
+    case DM_CONN_UPDATE_IND:
+    case DM_PHY_UPDATE_IND:
+      if (pEvt->hdr.status == HCI_SUCCESS)
+      {
+        if (pEvt->hdr.event == DM_CONN_UPDATE_IND)
+        {
+          wdxsBulkCb.interval[idx] = pEvt->connUpdate.connInterval;
+        }
+        else
+        {
+          wdxsBulkCb.txPhy[idx] = pEvt->phyUpdate.txPhy;
+        }
+      }
+
+      /* each window measures one configuration */
+      if (wdxsBulkCb.connMask & WDXS_CONN_BIT(pEvt->hdr.param))
+      {
+        wdxsBulkRestart();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Called at startup to configure link parameters for large file transfers.
+ *
+ *  \param  pCfg     Bulk transfer configuration, NULL to disable.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WdxsBulkCfg(const wdxsBulkCfg_t *pCfg)
+{
+  wdxsBulkCb.pCfg = pCfg;
+  wdxsBulkCb.connMask = 0;
+  wdxsBulkCb.timer.handlerId = wdxsCb.handlerId;
+  wdxsBulkCb.timer.msg.event = WDXS_MSG_BULK_TIMER;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Read data from file.
@@ -50,6 +370,8 @@ static bool_t wdxsFileRead(uint16_t handle, uint32_t offset, uint32_t *pReadLen,
 {
   bool_t eof = FALSE;
   uint32_t fileSize = WsfEfsGetFileSize(handle);
+  const uint8_t *pMap;
+  uint16_t mapLen;
 
   if (fileSize && (offset + *pReadLen > fileSize))
   {
@@ -57,7 +379,17 @@ static bool_t wdxsFileRead(uint16_t handle, uint32_t offset, uint32_t *pReadLen,
     eof = TRUE;
   }
 
-  WsfEfsGet(handle, offset, pData, (uint16_t) *pReadLen);
+  /* copy straight from media that can be read in place, else through the media read function */
+  mapLen = (uint16_t) *pReadLen;
+
+  if ((pMap = WsfEfsMap(handle, offset, &mapLen)) != NULL)
+  {
+    memcpy(pData, pMap, mapLen);
+  }
+  else
+  {
+    WsfEfsGet(handle, offset, pData, (uint16_t) *pReadLen);
+  }
 
   return eof;
 }
@@ -69,49 +401,60 @@ static bool_t wdxsFileRead(uint16_t handle, uint32_t offset, uint32_t *pReadLen,
  *  \return None.
  */
 /*************************************************************************************************/
-static uint8_t wdxsInitializeForPut(dmConnId_t connId, uint16_t handle)
+static uint8_t wdxsInitializeForPut(wdxsFtCtx_t *pCtx)
 {
-  uint32_t availableSize = WsfEfsGetFileMaxSize(handle);
+  uint32_t availableSize = WsfEfsGetFileMaxSize(pCtx->handle);
 
   /* verify file total length
    * verify offset+length is not more than total length
    */
-  if ((wdxsCb.ftTotalLen > availableSize) ||
-      ((wdxsCb.ftOffset + wdxsCb.ftLen) > wdxsCb.ftTotalLen))
+  if ((pCtx->totalLen > availableSize) ||
+      ((pCtx->offset + pCtx->len) > pCtx->totalLen))
   {
     return WDX_FTC_ST_INVALID_OP_DATA;
   }
 
   /* Erase on offset of zero */
-  if (wdxsCb.ftOffset == 0)
+  if (pCtx->offset == 0)
   {
-    WsfEfsErase(handle);
+    WsfEfsErase(pCtx->handle);
   }
 
   /* set up file put operation */
-  wdxsCb.ftHandle = handle;
-  wdxsCb.ftInProgress = WDX_FTC_OP_PUT_REQ;
+  pCtx->op = WDX_FTC_OP_PUT_REQ;
+  wdxsCb.ftPutLen[pCtx->handle] = pCtx->totalLen;
 
   return WDX_FTC_ST_SUCCESS;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a file transfer control characteristic notification.
+ *  \brief  Send the oldest queued file transfer control characteristic notification.
  *
  *  \return None.
  */
 /*************************************************************************************************/
-void wdxsFtcSend(dmConnId_t connId)
+void wdxsFtcSend(void)
 {
-  APP_TRACE_INFO0("WDXS: FTC Send");
+  wdxsFtcMsg_t *pMsg = &wdxsCb.ftcMsg[wdxsCb.ftcHead];
+
+  APP_TRACE_INFO1("WDXS: FTC Send connId=%d", pMsg->connId);
 
   /* if notification enabled */
-  if (AttsCccEnabled(connId, wdxsCb.ftcCccIdx))
+  if (AttsCccEnabled(pMsg->connId, wdxsCb.ftcCccIdx))
   {
     /* send notification */
-    AttsHandleValueNtf(connId, WDXS_FTC_HDL, wdxsCb.ftcMsgLen, wdxsCb.ftcMsgBuf);
-    wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_FTC_BIT | WDXS_TX_MASK_READY_BIT);
+    AttsHandleValueNtf(pMsg->connId, WDXS_FTC_HDL, pMsg->len, pMsg->buf);
+    wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_READY_BIT);
+    wdxsCb.txConnId = pMsg->connId;
+  }
+
+  /* a client without notifications does not hold up the others */
+  wdxsCb.ftcHead = (wdxsCb.ftcHead + 1) % WDXS_FTC_QUEUE_LEN;
+
+  if (--wdxsCb.ftcCount == 0)
+  {
+    wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_FTC_BIT);
   }
 }
 
@@ -124,10 +467,11 @@ void wdxsFtcSend(dmConnId_t connId)
 /*************************************************************************************************/
 void wdxsFtcSendRsp(dmConnId_t connId, uint8_t op, uint16_t handle, uint8_t status)
 {
+  wdxsFtcMsg_t *pMsg;
   uint8_t *p;
 
-  /* there should not be another response message set up */
-  if (wdxsCb.txReadyMask & WDXS_TX_MASK_FTC_BIT)
+  /* drop the response if the queue is full */
+  if (wdxsCb.ftcCount == WDXS_FTC_QUEUE_LEN)
   {
     APP_TRACE_WARN0("WDXS: FTC message overflow");
     return;
@@ -136,7 +480,10 @@ void wdxsFtcSendRsp(dmConnId_t connId, uint8_t op, uint16_t handle, uint8_t stat
   APP_TRACE_INFO3("WDXS: FTC SendRsp op=%d handle=%d status=%d", op, handle, status);
 
   /* build message */
-  p = wdxsCb.ftcMsgBuf;
+  pMsg = &wdxsCb.ftcMsg[(wdxsCb.ftcHead + wdxsCb.ftcCount) % WDXS_FTC_QUEUE_LEN];
+  pMsg->connId = connId;
+
+  p = pMsg->buf;
   UINT8_TO_BSTREAM(p, op);
   UINT16_TO_BSTREAM(p, handle);
 
@@ -151,7 +498,8 @@ void wdxsFtcSendRsp(dmConnId_t connId, uint8_t op, uint16_t handle, uint8_t stat
     UINT16_TO_BSTREAM(p, WDX_FTC_TRANSPORT_ID);
   }
 
-  wdxsCb.ftcMsgLen = (uint16_t) (p - wdxsCb.ftcMsgBuf);
+  pMsg->len = (uint16_t) (p - pMsg->buf);
+  wdxsCb.ftcCount++;
 
   /* Indicate TX Ready */
   wdxsCb.txReadyMask |= WDXS_TX_MASK_FTC_BIT;
@@ -167,20 +515,17 @@ void wdxsFtcSendRsp(dmConnId_t connId, uint8_t op, uint16_t handle, uint8_t stat
 /*************************************************************************************************/
 static void wdxsFtcProcGetReq(dmConnId_t connId, uint16_t handle, uint16_t len, uint8_t *pValue)
 {
-  uint8_t status;
+  wdxsFtCtx_t *pCtx;
+  uint8_t     status;
 
   APP_TRACE_INFO2("WDXS: FTC GetReq handle=%d len=%d", handle, len);
 
-  /* verify operation not already in progress */
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_NONE)
-  {
-    status = WDX_FTC_ST_IN_PROGRESS;
-  }
-  else if ((WsfEfsGetFilePermissions(handle) & WSF_EFS_REMOTE_GET_PERMITTED) == 0)
+  if ((WsfEfsGetFilePermissions(handle) & WSF_EFS_REMOTE_GET_PERMITTED) == 0)
   {
     status = WDX_FTC_ST_INVALID_OP_FILE;
   }
-  else
+  /* verify operation not already in progress */
+  else if ((pCtx = wdxsFtAlloc(connId, handle, WDX_FTC_OP_GET_REQ, &status)) != NULL)
   {
     if (handle == WDX_FLIST_HANDLE)
     {
@@ -188,18 +533,19 @@ static void wdxsFtcProcGetReq(dmConnId_t connId, uint16_t handle, uint16_t len,
     }
 
     /* parse operation data */
-    BSTREAM_TO_UINT32(wdxsCb.ftOffset, pValue);
-    BSTREAM_TO_UINT32(wdxsCb.ftLen, pValue);
-    BSTREAM_TO_UINT8(wdxsCb.ftPrefXferType, pValue);
+    BSTREAM_TO_UINT32(pCtx->offset, pValue);
+    BSTREAM_TO_UINT32(pCtx->len, pValue);
+    BSTREAM_TO_UINT8(pCtx->prefXferType, pValue);
 
     /* set up file get operation */
-    wdxsCb.ftHandle = handle;
-    wdxsCb.ftInProgress = WDX_FTC_OP_GET_REQ;
+    pCtx->op = WDX_FTC_OP_GET_REQ;
 
     wdxsCb.txReadyMask |= WDXS_TX_MASK_FTD_BIT;
     WsfSetEvent(wdxsCb.handlerId, WDXS_EVT_TX_PATH);
 
     status = WDX_FTC_ST_SUCCESS;
+
+    wdxsBulkStart(pCtx);
   }
 
   /* send response */
@@ -215,31 +561,32 @@ static void wdxsFtcProcGetReq(dmConnId_t connId, uint16_t handle, uint16_t len,
 /*************************************************************************************************/
 static void wdxsFtcProcPutReq(dmConnId_t connId, uint16_t handle, uint16_t len, uint8_t *pValue)
 {
-  uint8_t status;
+  wdxsFtCtx_t *pCtx;
+  uint8_t     status;
 
-  /* verify operation not already in progress */
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_NONE)
-  {
-    status = WDX_FTC_ST_IN_PROGRESS;
-  }
   /* verify permissions */
-  else if ((WsfEfsGetFilePermissions(handle) & WSF_EFS_REMOTE_PUT_PERMITTED) == 0)
+  if ((WsfEfsGetFilePermissions(handle) & WSF_EFS_REMOTE_PUT_PERMITTED) == 0)
   {
     status = WDX_FTC_ST_INVALID_HANDLE;
   }
-  else
+  /* verify operation not already in progress */
+  else if ((pCtx = wdxsFtAlloc(connId, handle, WDX_FTC_OP_PUT_REQ, &status)) != NULL)
   {
     /* parse operation data */
-    wdxsCb.ftHandle = handle;
-    BSTREAM_TO_UINT32(wdxsCb.ftOffset, pValue);
-    BSTREAM_TO_UINT32(wdxsCb.ftLen, pValue);
-    BSTREAM_TO_UINT32(wdxsCb.ftTotalLen, pValue);
-    BSTREAM_TO_UINT8(wdxsCb.ftPrefXferType, pValue);
+    BSTREAM_TO_UINT32(pCtx->offset, pValue);
+    BSTREAM_TO_UINT32(pCtx->len, pValue);
+    BSTREAM_TO_UINT32(pCtx->totalLen, pValue);
+    BSTREAM_TO_UINT8(pCtx->prefXferType, pValue);
 
-    APP_TRACE_INFO3("WDXS: FTC PutReq handle=%d offset=%d, len=%d", handle, wdxsCb.ftOffset, wdxsCb.ftLen);
+    APP_TRACE_INFO3("WDXS: FTC PutReq handle=%d offset=%d, len=%d", handle, pCtx->offset, pCtx->len);
 
     /* Initialize transfer*/
-    status = wdxsInitializeForPut(connId, handle);
+    status = wdxsInitializeForPut(pCtx);
+
+    if (status == WDX_FTC_ST_SUCCESS)
+    {
+      wdxsBulkStart(pCtx);
+    }
   }
 
   APP_TRACE_INFO2("WDXS: FTC PutReq handle=%d status=%d", handle, status);
@@ -261,8 +608,8 @@ static void wdxsFtcProcVerifyReq(dmConnId_t connId, uint16_t handle)
 
   APP_TRACE_INFO1("WDXS: FTC VerifyReq: handle=%d", handle);
 
-  /* verify operation not already in progress */
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_NONE)
+  /* verify operation not already in progress on the file */
+  if (wdxsFtHandleBusy(handle))
   {
     status = WDX_FTC_ST_IN_PROGRESS;
   }
@@ -273,7 +620,7 @@ static void wdxsFtcProcVerifyReq(dmConnId_t connId, uint16_t handle)
   else
   {
     /* Call the media specific validate command */
-    status = WsfEfsMediaSpecificCommand(handle, WSF_EFS_VALIDATE_CMD, wdxsCb.ftTotalLen);
+    status = WsfEfsMediaSpecificCommand(handle, WSF_EFS_VALIDATE_CMD, wdxsCb.ftPutLen[handle]);
   }
 
   /* send response */
@@ -293,8 +640,8 @@ static void wdxsFtcProcEraseReq(dmConnId_t connId, uint16_t handle)
 
   APP_TRACE_INFO1("WDXS: FTC EraseReq: handle=%d", handle);
 
-  /* verify operation not already in progress */
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_NONE)
+  /* verify operation not already in progress on the file */
+  if (wdxsFtHandleBusy(handle))
   {
     status = WDX_FTC_ST_IN_PROGRESS;
   }
@@ -322,22 +669,31 @@ static void wdxsFtcProcEraseReq(dmConnId_t connId, uint16_t handle)
 /*************************************************************************************************/
 static void wdxsFtcProcAbort(dmConnId_t connId, uint16_t handle)
 {
+  wdxsFtCtx_t *pCtx = wdxsCb.ft;
+  uint8_t     i;
+
   APP_TRACE_INFO1("WDXS: FTC AbortReq: handle=%d", handle);
 
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_NONE)
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
   {
-    /* abort operation */
-    if (WsfEfsGetFileType(handle) == WSF_EFS_FILE_TYPE_STREAM)
+    if ((pCtx->op != WDX_FTC_OP_NONE) && (pCtx->connId == connId) && (pCtx->handle == handle))
     {
-      wdxsCb.ftInProgress = WDX_FTC_OP_ABORT;
-    }
-    else
-    {
-      wdxsCb.ftInProgress = WDX_FTC_OP_NONE;
-    }
+      /* abort operation, a stream get ends with an EOF from the data path */
+      if ((pCtx->op == WDX_FTC_OP_GET_REQ) && (WsfEfsGetFileType(handle) == WSF_EFS_FILE_TYPE_STREAM))
+      {
+        pCtx->op = WDX_FTC_OP_ABORT;
+      }
+      else
+      {
+        pCtx->op = WDX_FTC_OP_NONE;
+      }
+
+      pCtx->len = 0;
+      pCtx->offset = 0;
 
-    wdxsCb.ftLen = 0;
-    wdxsCb.ftOffset = 0;
+      wdxsFtdUpdateReady();
+      wdxsBulkStop(connId);
+    }
   }
 }
 
@@ -350,8 +706,10 @@ static void wdxsFtcProcAbort(dmConnId_t connId, uint16_t handle)
 /*************************************************************************************************/
 uint8_t wdxsFtdWrite(dmConnId_t connId, uint16_t len, uint8_t *pValue)
 {
+  wdxsFtCtx_t *pCtx;
+
   /* verify put operation in progress */
-  if (wdxsCb.ftInProgress != WDX_FTC_OP_PUT_REQ)
+  if ((pCtx = wdxsFtFind(connId, WDX_FTC_OP_PUT_REQ)) == NULL)
   {
     return ATT_ERR_UNLIKELY;
   }
@@ -363,28 +721,30 @@ uint8_t wdxsFtdWrite(dmConnId_t connId, uint16_t len, uint8_t *pValue)
   }
 
   /* verify more data is expected */
-  if (wdxsCb.ftLen >= len)
+  if (pCtx->len >= len)
   {
-    WsfEfsPut(wdxsCb.ftHandle, wdxsCb.ftOffset, pValue, len);
+    WsfEfsPut(pCtx->handle, pCtx->offset, pValue, len);
 
     /* update remaining length of put request */
-    wdxsCb.ftOffset += len;
-    wdxsCb.ftLen -= len;
+    pCtx->offset += len;
+    pCtx->len -= len;
+    wdxsBulkCb.bytes[connId - 1] += len;
 
     /* if end of put req reached */
-    if (wdxsCb.ftLen == 0)
+    if (pCtx->len == 0)
     {
-      if (wdxsCb.ftOffset == wdxsCb.ftTotalLen)
+      if (pCtx->offset == pCtx->totalLen)
       {
         /* Call the media specific WDXS Put Complete command */
-        WsfEfsMediaSpecificCommand(wdxsCb.ftHandle, WSF_EFS_WDXS_PUT_COMPLETE_CMD, wdxsCb.ftTotalLen);
+        WsfEfsMediaSpecificCommand(pCtx->handle, WSF_EFS_WDXS_PUT_COMPLETE_CMD, pCtx->totalLen);
       }
 
       /* put req done */
-      wdxsCb.ftInProgress = WDX_FTC_OP_NONE;
+      pCtx->op = WDX_FTC_OP_NONE;
+      wdxsBulkStop(connId);
 
       /* send eof */
-      wdxsFtcSendRsp(connId, WDX_FTC_OP_EOF, wdxsCb.ftHandle, 0);
+      wdxsFtcSendRsp(connId, WDX_FTC_OP_EOF, pCtx->handle, 0);
     }
   }
 
@@ -450,23 +810,27 @@ uint8_t wdxsFtcWrite(dmConnId_t connId, uint16_t len, uint8_t *pValue)
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a file transfer data characteristic notification.
+ *  \brief  Send a file transfer data characteristic notification for a get transfer.
+ *
+ *  \param  pCtx     Transfer context.
  *
  *  \return None.
  */
 /*************************************************************************************************/
-void wdxsFtdSend(dmConnId_t connId)
+static void wdxsFtdSend(wdxsFtCtx_t *pCtx)
 {
+  dmConnId_t connId = pCtx->connId;
+
   /* if notification enabled */
   if (AttsCccEnabled(connId, wdxsCb.ftdCccIdx))
   {
     uint8_t   *pBuf;
     uint32_t  readLen = AttGetMtu(connId) - ATT_VALUE_NTF_LEN;
     bool_t    eof;
-    uint8_t   fileType = WsfEfsGetFileType(wdxsCb.ftHandle);
+    uint8_t   fileType = WsfEfsGetFileType(pCtx->handle);
 
     /* Check for abort when Streaming */
-    if ((fileType == WSF_EFS_FILE_TYPE_STREAM) && (wdxsCb.ftInProgress == WDX_FTC_OP_ABORT))
+    if ((fileType == WSF_EFS_FILE_TYPE_STREAM) && (pCtx->op == WDX_FTC_OP_ABORT))
     {
       eof = TRUE;
       readLen = 0;
@@ -476,25 +840,26 @@ void wdxsFtdSend(dmConnId_t connId)
       eof = FALSE;
     }
 
-    readLen = (readLen < wdxsCb.ftLen) ? readLen : wdxsCb.ftLen;
+    readLen = (readLen < pCtx->len) ? readLen : pCtx->len;
 
     if (readLen && (pBuf = AttMsgAlloc((uint16_t)readLen, ATT_PDU_VALUE_NTF)) != NULL)
     {
       /* read data from file */
-      eof = wdxsFileRead(wdxsCb.ftHandle, wdxsCb.ftOffset, &readLen, pBuf);
+      eof = wdxsFileRead(pCtx->handle, pCtx->offset, &readLen, pBuf);
 
       if (readLen > 0)
       {
         /* update stored offset and length (non-streaming file) */
         if (fileType == WSF_EFS_FILE_TYPE_BULK)
         {
-          wdxsCb.ftLen -= readLen;
-          wdxsCb.ftOffset += readLen;
+          pCtx->len -= readLen;
+          pCtx->offset += readLen;
         }
 
         /* send notification */
         AttsHandleValueNtfZeroCpy(connId, WDXS_FTD_HDL, (uint16_t)readLen, pBuf);
-        wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_READY_BIT);
+        wdxsBulkCb.bytes[connId - 1] += readLen;
+        wdxsCb.ftdBusyMask |= WDXS_CONN_BIT(connId);
       }
       else
       {
@@ -503,16 +868,99 @@ void wdxsFtdSend(dmConnId_t connId)
     }
 
     /* check if end of transfer reached */
-    if (wdxsCb.ftLen == 0 || readLen == 0 || eof || wdxsCb.ftInProgress == WDX_FTC_OP_ABORT)
+    if (pCtx->len == 0 || readLen == 0 || eof || pCtx->op == WDX_FTC_OP_ABORT)
     {
-      wdxsCb.ftInProgress = WDX_FTC_OP_NONE;
-      wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_FTD_BIT);
+      pCtx->op = WDX_FTC_OP_NONE;
+      wdxsFtdUpdateReady();
+      wdxsBulkStop(connId);
     }
 
     if (eof)
     {
       /* send EOF */
-      wdxsFtcSendRsp(connId, WDX_FTC_OP_EOF, wdxsCb.ftHandle, 0);
+      wdxsFtcSendRsp(connId, WDX_FTC_OP_EOF, pCtx->handle, 0);
+    }
+  }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send file transfer data characteristic notifications, one for each get transfer
+ *          whose connection has no notification in flight, in round robin order.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsFtdSched(void)
+{
+  wdxsFtCtx_t *pCtx;
+  uint8_t     i;
+  uint8_t     idx = wdxsCb.ftNext;
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++)
+  {
+    pCtx = &wdxsCb.ft[idx];
+    idx = (idx + 1) % WDXS_FT_MAX_CTX;
+
+    if (((pCtx->op == WDX_FTC_OP_GET_REQ) || (pCtx->op == WDX_FTC_OP_ABORT)) &&
+        ((wdxsCb.ftdBusyMask & WDXS_CONN_BIT(pCtx->connId)) == 0))
+    {
+      wdxsFtdSend(pCtx);
+    }
+  }
+
+  /* the next pass starts after this one's first transfer, so none is always served first */
+  wdxsCb.ftNext = (wdxsCb.ftNext + 1) % WDXS_FT_MAX_CTX;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  End the file transfers of a connection and drop its queued control responses.
+ *
+ *  \param  connId   DM connection identifier.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsFtConnReset(dmConnId_t connId)
+{
+  wdxsFtCtx_t  *pCtx = wdxsCb.ft;
+  wdxsFtcMsg_t *pMsg;
+  uint8_t      count = wdxsCb.ftcCount;
+  uint8_t      i;
+
+  for (i = 0; i < WDXS_FT_MAX_CTX; i++, pCtx++)
+  {
+    if (pCtx->connId == connId)
+    {
+      pCtx->op = WDX_FTC_OP_NONE;
     }
   }
+
+  /* compact the response queue, keeping the order of the other connections */
+  wdxsCb.ftcCount = 0;
+
+  for (i = 0; i < count; i++)
+  {
+    pMsg = &wdxsCb.ftcMsg[(wdxsCb.ftcHead + i) % WDXS_FTC_QUEUE_LEN];
+
+    if (pMsg->connId != connId)
+    {
+      if (i != wdxsCb.ftcCount)
+      {
+        memcpy(&wdxsCb.ftcMsg[(wdxsCb.ftcHead + wdxsCb.ftcCount) % WDXS_FTC_QUEUE_LEN], pMsg,
+               sizeof(wdxsFtcMsg_t));
+      }
+
+      wdxsCb.ftcCount++;
+    }
+  }
+
+  if (wdxsCb.ftcCount == 0)
+  {
+    wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_FTC_BIT);
+  }
+
+  wdxsCb.ftdBusyMask &= ~WDXS_CONN_BIT(connId);
+  wdxsFtdUpdateReady();
 }
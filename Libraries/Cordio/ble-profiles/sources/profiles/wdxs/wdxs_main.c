@@ -60,6 +60,7 @@ wdxsCb_t wdxsCb;
 static uint8_t WdxsRamErase(uint8_t *pAddress, uint32_t size);
 static uint8_t WdxsRamRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
 static uint8_t WdxsRamWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
+static const uint8_t *WdxsRamMap(uint8_t *pAddress, uint32_t size);
 
 /**************************************************************************************************
   Function Prototypes
@@ -83,7 +84,8 @@ static wsfEfsMedia_t WDXS_RamMediaCtrl =
   WdxsRamErase,
   WdxsRamRead,
   WdxsRamWrite,
-  NULL
+  NULL,
+  WdxsRamMap
 };
 
 /*************************************************************************************************/
@@ -128,6 +130,19 @@ static uint8_t WdxsRamWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t siz
   return TRUE;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Map function for the EFS RAM media.
+ *
+ *  \return Pointer to the data in RAM.
+ *
+ */
+/*************************************************************************************************/
+static const uint8_t *WdxsRamMap(uint8_t *pAddress, uint32_t size)
+{
+  return pAddress;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Format file list information for the given file.
@@ -283,45 +298,42 @@ static void wdxsProcTxPath(void)
 {
   dmConnId_t  connId;
 
-  /* Check for a connection */
-  if ((connId = AppConnIsOpen()) != DM_CONN_ID_NONE)
+  /* Check if ready to transmit a message */
+  if (wdxsCb.txReadyMask & WDXS_TX_MASK_READY_BIT)
   {
-    /* Check if ready to transmit a message */
-    if (wdxsCb.txReadyMask & WDXS_TX_MASK_READY_BIT)
-    {
+    /* Check for a connection */
+    connId = AppConnIsOpen();
 
 #if WDXS_DC_ENABLED == TRUE
-      /* Device configuration */
-      if (wdxsCb.txReadyMask & WDXS_TX_MASK_DC_BIT)
-      {
-        wdxsDcSend(connId);
-        return;
-      }
+    /* Device configuration */
+    if ((connId != DM_CONN_ID_NONE) && (wdxsCb.txReadyMask & WDXS_TX_MASK_DC_BIT))
+    {
+      wdxsDcSend(connId);
+      return;
+    }
 #endif /* WDXS_DC_ENABLED */
 
-      /* File Transfer Control */
-      if (wdxsCb.txReadyMask & WDXS_TX_MASK_FTC_BIT)
-      {
-        wdxsFtcSend(connId);
-        return;
-      }
+    /* File Transfer Control, queued with the connection of each response */
+    if (wdxsCb.txReadyMask & WDXS_TX_MASK_FTC_BIT)
+    {
+      wdxsFtcSend();
+      return;
+    }
 
 #if WDXS_AU_ENABLED == TRUE
-      /* Authentication */
-      if (wdxsCb.txReadyMask & WDXS_TX_MASK_AU_BIT)
-      {
-        wdxsAuSend(connId);
-        return;
-      }
+    /* Authentication */
+    if ((connId != DM_CONN_ID_NONE) && (wdxsCb.txReadyMask & WDXS_TX_MASK_AU_BIT))
+    {
+      wdxsAuSend(connId);
+      return;
+    }
 #endif /* WDXS_AU_ENABLED */
+  }
 
-      /* File Transfer Data */
-      if (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT)
-      {
-        wdxsFtdSend(connId);
-        return;
-      }
-    }
+  /* File Transfer Data, flow controlled per connection */
+  if (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT)
+  {
+    wdxsFtdSched();
   }
 }
 
@@ -344,6 +356,11 @@ void WdxsHandler(wsfEventMask_t event, wsfMsgHdr_t *pMsg)
     wdxsProcTxPath();
   }
 
+  if ((pMsg != NULL) && (pMsg->event == WDXS_MSG_BULK_TIMER))
+  {
+    wdxsBulkTimerExp();
+  }
+
 #if WDXS_AU_ENABLED == TRUE
 
   if (event & WDXS_EVT_AU_SEC_COMPLETE)
@@ -365,9 +382,18 @@ void WdxsHandler(wsfEventMask_t event, wsfMsgHdr_t *pMsg)
 /*************************************************************************************************/
 void WdxsProcDmMsg(dmEvt_t *pEvt)
 {
+  wdxsBulkProcDmMsg(pEvt);
+
   switch (pEvt->hdr.event)
   {
     case DM_CONN_CLOSE_IND:
+      /* the confirm of a notification in flight on this connection will not come */
+      if (wdxsCb.txConnId == (dmConnId_t) pEvt->hdr.param)
+      {
+        wdxsCb.txConnId = DM_CONN_ID_NONE;
+        wdxsCb.txReadyMask |= WDXS_TX_MASK_READY_BIT;
+      }
+      wdxsFtConnReset((dmConnId_t) pEvt->hdr.param);
       if (wdxsDcCb.doReset)
       {
         WdxsResetSystem();
@@ -375,11 +401,9 @@ void WdxsProcDmMsg(dmEvt_t *pEvt)
       break;
 
     case DM_CONN_OPEN_IND:
-      /* Initialize connection parameters */
-      wdxsCb.txReadyMask = WDXS_TX_MASK_READY_BIT;
-      wdxsCb.ftInProgress = WDX_FTC_OP_NONE;
-      wdxsCb.ftLen = 0;
-      wdxsCb.ftOffset = 0;
+      /* Initialize connection parameters, other connections may have notifications in flight */
+      wdxsCb.txReadyMask &= ~(WDXS_TX_MASK_DC_BIT | WDXS_TX_MASK_AU_BIT);
+      wdxsFtConnReset((dmConnId_t) pEvt->hdr.param);
 #if WDXS_AU_ENABLED == TRUE
       wdxsAuCb.authLevel = WDX_AU_LVL_NONE;
       wdxsAuCb.authState = WDXS_AU_STATE_UNAUTHORIZED;
@@ -437,7 +461,17 @@ uint8_t WdxsAttCback(attEvt_t *pEvt)
   if (pEvt->hdr.event == ATTS_HANDLE_VALUE_CNF &&
       pEvt->hdr.status == ATT_SUCCESS)
   {
-    wdxsCb.txReadyMask |= WDXS_TX_MASK_READY_BIT;
+    /* file data is flow controlled per connection, the rest shares the ready bit */
+    if (pEvt->handle == WDXS_FTD_HDL)
+    {
+      wdxsCb.ftdBusyMask &= ~WDXS_CONN_BIT(pEvt->hdr.param);
+    }
+    else
+    {
+      wdxsCb.txConnId = DM_CONN_ID_NONE;
+      wdxsCb.txReadyMask |= WDXS_TX_MASK_READY_BIT;
+    }
+
     WsfSetEvent(wdxsCb.handlerId, WDXS_EVT_TX_PATH);
   }
 
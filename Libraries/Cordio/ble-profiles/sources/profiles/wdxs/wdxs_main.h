@@ -56,6 +56,19 @@ extern "C" {
 /*! \brief Special length for streaming file */
 #define WDXS_STREAM_FILE_LEN        0xFFFFFFFF
 
+/*! \brief Connection bit in a connection mask */
+#define WDXS_CONN_BIT(connId)       (1UL << ((connId) - 1))
+
+/*! \brief Number of concurrent file transfers, one get and one put per connection at most */
+#ifndef WDXS_FT_MAX_CTX
+#define WDXS_FT_MAX_CTX             4
+#endif
+
+/*! \brief Number of file transfer control responses queued for transmission */
+#ifndef WDXS_FTC_QUEUE_LEN
+#define WDXS_FTC_QUEUE_LEN          4
+#endif
+
 /** \name WSF event types for application event handler
  *
  */
@@ -64,6 +77,9 @@ extern "C" {
 #define WDXS_EVT_AU_SEC_COMPLETE    0x02      /*!< \brief AU encryption of challenge ready */
 /**@}*/
 
+/*! \brief Bulk transfer goodput timer message */
+#define WDXS_MSG_BULK_TIMER         0x10
+
 /** \name TX Ready Mask Bits
  *
  */
@@ -94,6 +110,26 @@ extern "C" {
 typedef uint8_t (*wdxsDcPhyWriteCback_t)(dmConnId_t connId, uint8_t op, uint8_t id, uint16_t len,
                                          uint8_t *pValue);
 
+/*! \brief WDXS file transfer context */
+typedef struct
+{
+  uint32_t          offset;           /*!< \brief file data offset */
+  uint32_t          len;              /*!< \brief remaining data length for current operation */
+  uint32_t          totalLen;         /*!< \brief file total length */
+  uint16_t          handle;           /*!< \brief file handle */
+  dmConnId_t        connId;           /*!< \brief connection of the transfer */
+  uint8_t           op;               /*!< \brief operation in progress, WDX_FTC_OP_NONE if free */
+  uint8_t           prefXferType;     /*!< \brief Preferred transport type */
+} wdxsFtCtx_t;
+
+/*! \brief WDXS file transfer control response */
+typedef struct
+{
+  uint16_t          len;                          /*!< \brief message length */
+  dmConnId_t        connId;                       /*!< \brief connection to send on */
+  uint8_t           buf[ATT_DEFAULT_PAYLOAD_LEN]; /*!< \brief message buffer */
+} wdxsFtcMsg_t;
+
 /**************************************************************************************************
   Local Variables
 **************************************************************************************************/
@@ -103,6 +139,7 @@ typedef struct
 {
   wsfHandlerId_t    handlerId;        /*!< \brief WSF handler ID */
   uint8_t           txReadyMask;      /*!< \brief Bits indicate DC, FTC, FTD, and/or AU wish to transmit */
+  dmConnId_t        txConnId;         /*!< \brief connection with a DC, FTC or AU notification in flight */
 
   /* connection parameters */
   uint16_t          connInterval;     /*!< \brief connection interval */
@@ -114,14 +151,13 @@ typedef struct
   uint8_t           rxPhy;            /*!< \brief receiver PHY */
 
   /* for file transfer */
-  uint32_t          ftOffset;         /*!< \brief file data offset */
-  uint32_t          ftLen;            /*!< \brief remaining data length for current operation */
-  uint32_t          ftTotalLen;       /*!< \brief file total length */
-  uint16_t          ftHandle;         /*!< \brief file handle */
-  uint16_t          ftcMsgLen;        /*!< \brief message length */
-  uint8_t           ftcMsgBuf[ATT_DEFAULT_PAYLOAD_LEN]; /*!< \brief message buffer */
-  uint8_t           ftInProgress;     /*!< \brief operation in progress */
-  uint8_t           ftPrefXferType;   /*!< \brief Preferred transport type */
+  wdxsFtCtx_t       ft[WDXS_FT_MAX_CTX];            /*!< \brief file transfer contexts */
+  wdxsFtcMsg_t      ftcMsg[WDXS_FTC_QUEUE_LEN];     /*!< \brief file transfer control response queue */
+  uint32_t          ftPutLen[WSF_EFS_MAX_FILES];    /*!< \brief total length of the last put to each file, for verify */
+  uint32_t          ftdBusyMask;      /*!< \brief connections with a data notification in flight */
+  uint8_t           ftNext;           /*!< \brief context the data scheduler starts from */
+  uint8_t           ftcHead;          /*!< \brief oldest queued control response */
+  uint8_t           ftcCount;         /*!< \brief number of queued control responses */
 
   /* ccc index */
   uint8_t          dcCccIdx;          /*!< \brief device configuration ccc index */
@@ -191,25 +227,33 @@ void wdxsDcSend(dmConnId_t connId);
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a file transfer control characteristic notification.
+ *  \brief  Send the oldest queued file transfer control characteristic notification.
  *
- *  \param  connId   DM connection identifier.
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsFtcSend(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send file transfer data characteristic notifications, one for each get transfer
+ *          whose connection has no notification in flight, in round robin order.
  *
  *  \return None.
  */
 /*************************************************************************************************/
-void wdxsFtcSend(dmConnId_t connId);
+void wdxsFtdSched(void);
 
 /*************************************************************************************************/
 /*!
- *  \brief  Send a file transfer data characteristic notification.
+ *  \brief  End the file transfers of a connection and drop its queued control responses.
  *
  *  \param  connId   DM connection identifier.
  *
  *  \return None.
  */
 /*************************************************************************************************/
-void wdxsFtdSend(dmConnId_t connId);
+void wdxsFtConnReset(dmConnId_t connId);
 
 /*************************************************************************************************/
 /*!
@@ -298,6 +342,27 @@ uint8_t wdxsDcUpdateConnParam(dmConnId_t connId, uint8_t status);
 /*************************************************************************************************/
 uint8_t wdxsDcUpdatePhy(dmConnId_t connId, uint8_t status);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Log goodput of each connection in bulk mode for the window that ended, with the link
+ *          parameters it ran on.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsBulkTimerExp(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Track link parameters for the goodput trace and link changes while in bulk mode.
+ *
+ *  \param  pEvt   Pointer to the DM Event
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void wdxsBulkProcDmMsg(dmEvt_t *pEvt);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Register a PHY write callback for the device configuration characteristic.
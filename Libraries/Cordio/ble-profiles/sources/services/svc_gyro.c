@@ -35,11 +35,12 @@
  Macros
 **************************************************************************************************/
 
-#define GYRO_UUID_SVC          0x3000
-#define GYRO_UUID_CHR_DATA     0x3001
-#define GYRO_UUID_CHR_TEMPDATA 0x3002
-#define GYRO_UUID_CHR_CONFIG   0x3003
-#define GYRO_UUID_CHR_PERIOD   0x3004
+#define GYRO_UUID_SVC           0x3000
+#define GYRO_UUID_CHR_DATA      0x3001
+#define GYRO_UUID_CHR_TEMPDATA  0x3002
+#define GYRO_UUID_CHR_CONFIG    0x3003
+#define GYRO_UUID_CHR_PERIOD    0x3004
+#define GYRO_UUID_CHR_BATCH_FMT 0x3005
 
 /**************************************************************************************************
  Service variables
@@ -117,6 +118,17 @@ static const uint16_t gyroLenPeriod    = sizeof(gyroValPeriod);
 static const uint8_t  gyroValPeriodChrUsrDescr[] = "SMD Gyro Period";
 static const uint16_t gyroLenPeriodChrUsrDescr   = sizeof(gyroValPeriodChrUsrDescr) - 1u;
 
+/* Gyro batch format characteristic. */
+static const uint8_t  gyroValBatchFmtChr[] = {ATT_PROP_READ,
+                                              UINT16_TO_BYTES(GYRO_HANDLE_BATCH_FMT),
+                                              UINT16_TO_BYTES(GYRO_UUID_CHR_BATCH_FMT)};
+static const uint16_t gyroLenBatchFmtChr   = sizeof(gyroValBatchFmtChr);
+
+/* Gyro batch format, set by the profile. */
+static const uint8_t  gyroUuidBatchFmt[] = {UINT16_TO_BYTES(GYRO_UUID_CHR_BATCH_FMT)};
+static       uint8_t  gyroValBatchFmt[GYRO_SIZE_BATCH_FMT_ATT] = {0};
+static const uint16_t gyroLenBatchFmt    = sizeof(gyroValBatchFmt);
+
 /* Attribute list for gyro group. */
 static const attsAttr_t gyroList[] =
 {
@@ -254,6 +266,24 @@ static const attsAttr_t gyroList[] =
     sizeof(gyroValPeriodChrUsrDescr),
     0,
     ATTS_PERMIT_READ
+  },
+  /* Characteristic declaration. */
+  {
+    attChUuid,
+    (uint8_t *) gyroValBatchFmtChr,
+    (uint16_t *) &gyroLenBatchFmtChr,
+    sizeof(gyroValBatchFmtChr),
+    0,
+    ATTS_PERMIT_READ
+  },
+  /* Characteristic value. */
+  {
+    gyroUuidBatchFmt,
+    (uint8_t *) gyroValBatchFmt,
+    (uint16_t *) &gyroLenBatchFmt,
+    sizeof(gyroValBatchFmt),
+    0,
+    ATTS_PERMIT_READ
   }
 };
 
@@ -70,6 +70,9 @@ enum
   GYRO_HANDLE_PERIOD,                     /*!< \brief Period characteristic value. */
   GYRO_HANDLE_PERIOD_CHR_USR_DESCR,       /*!< \brief Period characteristic user description. */
 
+  GYRO_HANDLE_BATCH_FMT_CHR,              /*!< \brief Batch format characteristic declaration. */
+  GYRO_HANDLE_BATCH_FMT,                  /*!< \brief Batch format characteristic value. */
+
   GYRO_HANDLE_END_PLUS_ONE                /*!< \brief Maximum handle. */
 };
 /**@}*/
@@ -84,6 +87,7 @@ enum
 /**@{*/
 #define GYRO_ATT_CONFIG_DISABLE  0x00u /*!< \brief Disable */
 #define GYRO_ATT_CONFIG_ENABLE   0x01u /*!< \brief Enable */
+#define GYRO_ATT_CONFIG_BATCH    0x02u /*!< \brief Enable with batched samples */
 /**@}*/
 
 /** \name Values for Period Attributes.
@@ -98,6 +102,7 @@ enum
 /*! \brief Sizes of attributes. */
 #define GYRO_SIZE_CONFIG_ATT       1u /*!< \brief Configuration attribute size */
 #define GYRO_SIZE_PERIOD_ATT       1u /*!< \brief Period attribute size */
+#define GYRO_SIZE_BATCH_FMT_ATT    6u /*!< \brief Batch format attribute size */
 #define GYRO_SIZE_DATA_ATT         6u /*!< \brief Data attribute size */
 #define GYRO_SIZE_TEMPDATA_ATT     2u /*!< \brief Temp data attribute size */
 /**@}*/
@@ -39,6 +39,7 @@
 #define TEMP_UUID_CHR_DATA      0x3011
 #define TEMP_UUID_CHR_CONFIG    0x3012
 #define TEMP_UUID_CHR_PERIOD    0x3013
+#define TEMP_UUID_CHR_BATCH_FMT 0x3014
 
 /**************************************************************************************************
  Service variables
@@ -97,6 +98,17 @@ static const uint16_t tempLenPeriod    = sizeof(tempValPeriod);
 static const uint8_t  tempValPeriodChrUsrDescr[] = "SMD Temp Period";
 static const uint16_t tempLenPeriodChrUsrDescr   = sizeof(tempValPeriodChrUsrDescr) - 1u;
 
+/* Temp batch format characteristic. */
+static const uint8_t  tempValBatchFmtChr[] = {ATT_PROP_READ,
+                                              UINT16_TO_BYTES(TEMP_HANDLE_BATCH_FMT),
+                                              UINT16_TO_BYTES(TEMP_UUID_CHR_BATCH_FMT)};
+static const uint16_t tempLenBatchFmtChr   = sizeof(tempValBatchFmtChr);
+
+/* Temp batch format, set by the profile. */
+static const uint8_t  tempUuidBatchFmt[] = {UINT16_TO_BYTES(TEMP_UUID_CHR_BATCH_FMT)};
+static       uint8_t  tempValBatchFmt[TEMP_SIZE_BATCH_FMT_ATT] = {0};
+static const uint16_t tempLenBatchFmt    = sizeof(tempValBatchFmt);
+
 /* Attribute list for temp group. */
 static const attsAttr_t tempList[] =
 {
@@ -198,6 +210,24 @@ static const attsAttr_t tempList[] =
     sizeof(tempValPeriodChrUsrDescr),
     0,
     ATTS_PERMIT_READ
+  },
+  /* Characteristic declaration. */
+  {
+    attChUuid,
+    (uint8_t *) tempValBatchFmtChr,
+    (uint16_t *) &tempLenBatchFmtChr,
+    sizeof(tempValBatchFmtChr),
+    0,
+    ATTS_PERMIT_READ
+  },
+  /* Characteristic value. */
+  {
+    tempUuidBatchFmt,
+    (uint8_t *) tempValBatchFmt,
+    (uint16_t *) &tempLenBatchFmt,
+    sizeof(tempValBatchFmt),
+    0,
+    ATTS_PERMIT_READ
   }
 };
 
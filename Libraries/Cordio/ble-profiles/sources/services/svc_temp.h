@@ -65,6 +65,9 @@ enum
   TEMP_HANDLE_PERIOD,                  /*!< \brief Period characteristc value. */
   TEMP_HANDLE_PERIOD_CHR_USR_DESCR,    /*!< \brief Period characteristc user description. */
 
+  TEMP_HANDLE_BATCH_FMT_CHR,           /*!< \brief Batch format characteristic declaration. */
+  TEMP_HANDLE_BATCH_FMT,               /*!< \brief Batch format characteristic value. */
+
   TEMP_HANDLE_END_PLUS_ONE             /*!< \brief Maximum handle. */
 };
 /**@}*/
@@ -79,6 +82,7 @@ enum
 /**@{*/
 #define TEMP_ATT_CONFIG_DISABLE  0x00u  /*!< \brief Disable */
 #define TEMP_ATT_CONFIG_ENABLE   0x01u  /*!< \brief Enable */
+#define TEMP_ATT_CONFIG_BATCH    0x02u  /*!< \brief Enable with batched samples */
 /**@}*/
 
 /** \name Values for Period Attributes
@@ -94,9 +98,10 @@ enum
  *
  */
 /**@{*/
-#define TEMP_SIZE_CONFIG_ATT  1u  /*!< \brief Config Attribute size */
-#define TEMP_SIZE_PERIOD_ATT  1u  /*!< \brief Period Attribute size */
-#define TEMP_SIZE_DATA_ATT    6u  /*!< \brief Data Attribute size */
+#define TEMP_SIZE_CONFIG_ATT    1u  /*!< \brief Config Attribute size */
+#define TEMP_SIZE_PERIOD_ATT    1u  /*!< \brief Period Attribute size */
+#define TEMP_SIZE_BATCH_FMT_ATT 6u  /*!< \brief Batch format Attribute size */
+#define TEMP_SIZE_DATA_ATT      6u  /*!< \brief Data Attribute size */
 /**@}*/
 
 /**************************************************************************************************
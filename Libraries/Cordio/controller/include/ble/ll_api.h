@@ -396,6 +396,14 @@ typedef struct
   uint16_t      perAdvProp;         /*!< Periodic Advertising Properties. */
 } LlPerAdvParam_t;
 
+/*! \brief      Periodic advertising data statistics. */
+typedef struct
+{
+  uint32_t      numEvt;             /*!< Number of periodic advertising events. */
+  uint32_t      numUpd;             /*!< Number of data updates applied at an event. */
+  uint32_t      numMissedUpd;       /*!< Number of data updates replaced before an event applied them. */
+} LlPerAdvDataStats_t;
+
 /*! \brief       Advertising data operation. */
 enum
 {
@@ -2548,6 +2556,22 @@ uint8_t LlSetPeriodicAdvParam(uint8_t handle, LlPerAdvParam_t *pPerAdvParam);
 /*************************************************************************************************/
 uint8_t LlSetPeriodicAdvData(uint8_t handle, uint8_t op, uint8_t len, const uint8_t *pData);
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Get periodic advertising data statistics.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      pStats      Statistics.
+ *
+ *  \return     Status error code.
+ *
+ *  Get the number of periodic advertising events since periodic advertising was enabled, the
+ *  number of complete data updates applied at an event and the number of updates replaced by a
+ *  newer update before an event applied them.
+ */
+/*************************************************************************************************/
+uint8_t LlGetPeriodicAdvDataStats(uint8_t handle, LlPerAdvDataStats_t *pStats);
+
 /*************************************************************************************************/
 /*!
  *  \brief      Set periodic advertising enable.
@@ -2591,6 +2615,26 @@ uint8_t LlSetAuxOffsetDelay(uint8_t handle, uint32_t delayUsec);
 /*************************************************************************************************/
 uint8_t LlSetExtAdvDataFragLen(uint8_t handle, uint8_t fragLen);
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Patch extended advertising or scan response data.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      scanRsp     TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset      Offset of the changed bytes in the data buffer.
+ *  \param      len         Number of changed bytes.
+ *  \param      pData       Changed bytes.
+ *
+ *  \return     Status error code.
+ *
+ *  Replace bytes of complete Advertising Data or Scan Response Data, which may be longer than one
+ *  HCI command, without resending the rest of the data.  While an advertising event is in progress
+ *  data longer than one HCI command cannot be patched and LL_ERROR_CODE_CONTROLLER_BUSY is returned.
+ */
+/*************************************************************************************************/
+uint8_t LlPatchExtAdvData(uint8_t handle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                          const uint8_t *pData);
+
 /*************************************************************************************************/
 /*!
  *  \brief      Set extended advertising transmit PHY options.
@@ -3465,6 +3509,18 @@ uint8_t LlGetAclTxBufs(void);
 /*************************************************************************************************/
 uint8_t LlGetAclRxBufs(void);
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Get the ACL buffer usage.
+ *
+ *  \param      pTxUsed     Transmit buffers in use.
+ *  \param      pTxPeak     Most transmit buffers in use at once.
+ *  \param      pRxUsed     Receive buffers in use.
+ *  \param      pRxPeak     Most receive buffers in use at once.
+ */
+/*************************************************************************************************/
+void LlGetAclBufUsage(uint8_t *pTxUsed, uint8_t *pTxPeak, uint8_t *pRxUsed, uint8_t *pRxPeak);
+
 /*************************************************************************************************/
 /*!
  *  \brief      Get the maximum ISO buffers size between host and controller.
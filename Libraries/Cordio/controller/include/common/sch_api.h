@@ -64,6 +64,7 @@ bool_t SchInsertLateAsPossible(BbOpDesc_t *pBod, uint32_t min, uint32_t max);
 bool_t SchRemove(BbOpDesc_t *pBod);
 void SchReload(BbOpDesc_t *pBod);
 bool_t SchIsBodCancellable(BbOpDesc_t *pBod);
+uint32_t SchGetIdleTimeUsec(void);
 
 #ifdef __cplusplus
 };
@@ -142,12 +142,15 @@ uint8_t LctrRemoveAdvSet(uint8_t handle);
 uint8_t LctrClearAdvSets(void);
 uint8_t LctrSetAuxOffsetDelay(uint8_t handle, uint32_t delayUsec);
 uint8_t LctrSetExtAdvDataFragLen(uint8_t handle, uint8_t fragLen);
+uint8_t LctrPatchExtAdvData(uint8_t handle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                            const uint8_t *pData);
 uint8_t LctrSetExtAdvTxPhyOptions(uint8_t handle, uint8_t priPhyOpts, uint8_t secPhyOpts);
 uint8_t LctrSetPeriodicAdvParam(uint8_t handle, LlPerAdvParam_t *pPerAdvParam);
 uint8_t LctrPeriodicAdvSetInfoTransfer(uint16_t connHandle, uint16_t serviceData, uint8_t advHandle);
 uint8_t LctrSetPeriodicAdvSyncTransParams(uint16_t connHandle, uint8_t mode, uint16_t skip, uint16_t syncTimeout, uint8_t cteType);
 void LctrSetPeriodicAdvEnable(uint8_t handle, bool_t enable);
 uint8_t LctrSetPeriodicAdvData(uint8_t handle, uint8_t op, uint8_t len, const uint8_t *pData);
+uint8_t LctrGetPeriodicAdvDataStats(uint8_t handle, LlPerAdvDataStats_t *pStats);
 
 #ifdef __cplusplus
 };
@@ -45,6 +45,8 @@ typedef struct
 {
   uint8_t       availTxBuf;             /*!< Available number of transmit buffers. */
   uint8_t       availRxBuf;             /*!< Available number of receive buffers. */
+  uint8_t       minAvailTxBuf;          /*!< Fewest available transmit buffers. */
+  uint8_t       minAvailRxBuf;          /*!< Fewest available receive buffers. */
 
   uint16_t      maxTxLen;               /*!< Default maximum number of Data PDU bytes. */
   uint16_t      maxTxTime;              /*!< Default maximum microseconds for a Data PDU. */
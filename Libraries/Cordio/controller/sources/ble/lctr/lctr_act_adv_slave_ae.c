@@ -511,6 +511,7 @@ void lctrPeriodicAdvActStart(lctrAdvSet_t *pAdvSet)
   pAdvSet->perParam.shutdown = FALSE;
   pAdvSet->perParam.perAccessAddr = lctrComputeAccessAddr();
   pAdvSet->perParam.perEventCounter = 0;
+  memset(&pAdvSet->perParam.dataStats, 0, sizeof(pAdvSet->perParam.dataStats));
   pAdvSet->perParam.perChanParam.chanMask = lmgrCb.chanClass;
   LmgrBuildRemapTable(&pAdvSet->perParam.perChanParam);
   pAdvSet->perParam.perChanParam.usedChSel = LL_CH_SEL_2;
@@ -146,6 +146,8 @@ typedef struct
   /* Channel parameters */
   lmgrChanParam_t   perChanParam;   /*!< Periodic Advertising Channel parameter. */
   uint64_t          updChanMask;    /*!< Last updated channel mask */
+
+  LlPerAdvDataStats_t dataStats;    /*!< Periodic advertising data statistics. */
 } lctrPerAdvParam_t;
 
 /*! \brief      Advertising data buffer descriptor. */
@@ -35,6 +35,7 @@
 #include "bb_ble_api.h"
 #include "bb_ble_api_op.h"
 #include "wsf_cs.h"
+#include "wsf_math.h"
 #include "wsf_msg.h"
 #include "wsf_timer.h"
 
@@ -888,6 +889,7 @@ static inline void lctrDataTxDecAvailBuf(void)
 
   WSF_CS_ENTER();
   lmgrConnCb.availTxBuf--;
+  lmgrConnCb.minAvailTxBuf = WSF_MIN(lmgrConnCb.minAvailTxBuf, lmgrConnCb.availTxBuf);
   WSF_CS_EXIT();
 }
 
@@ -1102,11 +1102,14 @@ void lctrSlvPeriodicAdvEndOp(BbOpDesc_t *pOp)
 
   /*** Update advertising data ***/
 
+  pAdvSet->perParam.dataStats.numEvt++;
+
   if (pAdvSet->perAdvData.alt.ext.modified)
   {
     pAdvSet->perAdvData.alt.ext.modified = FALSE;
     memcpy(pAdvSet->perAdvData.pBuf, pAdvSet->perAdvData.alt.ext.buf, pAdvSet->perAdvData.alt.ext.len);
     pAdvSet->perAdvData.len = pAdvSet->perAdvData.alt.ext.len;
+    pAdvSet->perParam.dataStats.numUpd++;
   }
 
   /*** Update operation ***/
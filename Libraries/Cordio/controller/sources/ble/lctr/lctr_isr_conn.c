@@ -158,6 +158,7 @@ uint8_t *lctrProcessRxAck(lctrConnCtx_t *pCtx)
             return NULL;                    /* flow control Rx */
           }
           lmgrConnCb.availRxBuf--;
+          lmgrConnCb.minAvailRxBuf = WSF_MIN(lmgrConnCb.minAvailRxBuf, lmgrConnCb.availRxBuf);
           break;
         default:
           /* Invalid LLID value; ack PDU but drop it (don't process it). */
@@ -627,9 +627,19 @@ static uint8_t lctrSetPerAdvDataSm(lctrAdvSet_t *pAdvSet, lctrAdvDataBuf_t *pDat
       /*** Complete single fragment buffer (no reassembly required) while advertising is enabled. ***/
       if (pAdvSet->perParam.perState == LCTR_PER_ADV_STATE_ENABLED)
       {
+        WSF_CS_INIT(cs);
+
+        /* Stage the update as a whole; the end callback of the BOD applies it at the next event. */
+        WSF_CS_ENTER(cs);
+        if (pDataBuf->alt.ext.modified)
+        {
+          /* Previous update replaced before an event applied it. */
+          pAdvSet->perParam.dataStats.numMissedUpd++;
+        }
         pDataBuf->alt.ext.len = fragLen;
         memcpy(pDataBuf->alt.ext.buf, pFragBuf, fragLen);
         pDataBuf->alt.ext.modified = TRUE;
+        WSF_CS_EXIT(cs);
 
         return LL_SUCCESS;
       }
@@ -2200,6 +2210,34 @@ uint8_t LctrSetPeriodicAdvData(uint8_t handle, uint8_t op, uint8_t len, const ui
   return result;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Get periodic advertising data statistics.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      pStats      Statistics.
+ *
+ *  \return     Status error code.
+ */
+/*************************************************************************************************/
+uint8_t LctrGetPeriodicAdvDataStats(uint8_t handle, LlPerAdvDataStats_t *pStats)
+{
+  WSF_CS_INIT(cs);
+
+  lctrAdvSet_t *pAdvSet;
+
+  if ((pAdvSet = lctrFindAdvSet(handle)) == NULL)
+  {
+    return LL_ERROR_CODE_UNKNOWN_ADV_ID;
+  }
+
+  WSF_CS_ENTER(cs);
+  *pStats = pAdvSet->perParam.dataStats;
+  WSF_CS_EXIT(cs);
+
+  return LL_SUCCESS;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Enable/disable periodic advertising.
@@ -2444,6 +2482,143 @@ uint8_t LctrSetExtAdvDataFragLen(uint8_t handle, uint8_t fragLen)
   return LL_SUCCESS;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Patch extended advertising or scan response data.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      scanRsp     TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset      Offset of the changed bytes in the data buffer.
+ *  \param      len         Number of changed bytes.
+ *  \param      pData       Changed bytes.
+ *
+ *  \return     Status error code.
+ *
+ *  Replace bytes of a complete data buffer without resending the rest of the buffer.  While
+ *  advertising is enabled the change is applied between advertising events.  During an advertising
+ *  event only data of up to LCTR_COMP_EXT_ADV_DATA_MAX_LEN bytes can be staged, longer data fails
+ *  with LL_ERROR_CODE_CONTROLLER_BUSY.
+ */
+/*************************************************************************************************/
+uint8_t LctrPatchExtAdvData(uint8_t handle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                            const uint8_t *pData)
+{
+  WSF_CS_INIT(cs);
+
+  lctrAdvSet_t *pAdvSet;
+  lctrAdvDataBuf_t *pDataBuf;
+  bool_t isCancelled = FALSE;
+  uint8_t result = LL_SUCCESS;
+
+  if ((pAdvSet = lctrFindAdvSet(handle)) == NULL)
+  {
+    return LL_ERROR_CODE_UNKNOWN_ADV_ID;
+  }
+
+  if (pAdvSet->param.advEventProp & LL_ADV_EVT_PROP_LEGACY_ADV_BIT)
+  {
+    LL_TRACE_WARN1("Cannot patch legacy advertising data, handle=%u", pAdvSet->handle);
+    return LL_ERROR_CODE_CMD_DISALLOWED;
+  }
+
+  pDataBuf = scanRsp ? &pAdvSet->scanRspData : &pAdvSet->advData;
+
+  if (!pDataBuf->ready || (len == 0) || ((offset + len) > pDataBuf->len))
+  {
+    LL_TRACE_WARN2("Patch outside of data buffer, offset=%u, handle=%u", offset, pAdvSet->handle);
+    return LL_ERROR_CODE_INVALID_HCI_CMD_PARAMS;
+  }
+
+  switch (pAdvSet->state)
+  {
+    case LCTR_EXT_ADV_STATE_DISABLED:
+      memcpy(pDataBuf->pBuf + offset, pData, len);
+      pAdvSet->param.advDID = lctrCalcDID(pDataBuf->pBuf, pDataBuf->len);
+      break;
+
+    case LCTR_EXT_ADV_STATE_ENABLED:
+      WSF_CS_ENTER(cs);
+      /* Renew BOD's to make the data updated immediately if possible. */
+      if (SchIsBodCancellable(&pAdvSet->advBod) &&
+          ((pAdvSet->auxBodUsed == FALSE) || SchIsBodCancellable(&pAdvSet->auxAdvBod)))
+      {
+        /* Temporarily disable abort callbacks. */
+        pAdvSet->advBod.abortCback = NULL;
+        pAdvSet->auxAdvBod.abortCback = NULL;
+
+        /* Remove BOD's */
+        SchRemove(&pAdvSet->advBod);
+        if (pAdvSet->auxBodUsed)
+        {
+          SchRemove(&pAdvSet->auxAdvBod);
+        }
+
+        isCancelled = TRUE;
+      }
+      /* Else stage the patch in the alternate buffer applied in the end callback of the BOD's. */
+      else if (pDataBuf->alt.ext.modified ||
+               (pDataBuf->len <= sizeof(pDataBuf->alt.ext.buf)))
+      {
+        if (!pDataBuf->alt.ext.modified)
+        {
+          memcpy(pDataBuf->alt.ext.buf, pDataBuf->pBuf, pDataBuf->len);
+          pDataBuf->alt.ext.len = pDataBuf->len;
+          pDataBuf->alt.ext.fragPref = pDataBuf->fragPref;
+        }
+
+        if ((offset + len) <= pDataBuf->alt.ext.len)
+        {
+          memcpy(pDataBuf->alt.ext.buf + offset, pData, len);
+          pDataBuf->alt.ext.did = lctrCalcDID(pDataBuf->alt.ext.buf, pDataBuf->alt.ext.len);
+          pDataBuf->alt.ext.modified = TRUE;
+        }
+        else
+        {
+          result = LL_ERROR_CODE_INVALID_HCI_CMD_PARAMS;
+        }
+      }
+      else
+      {
+        /* Data too long to stage; the patch is not applied and the host must set the data again. */
+        result = LL_ERROR_CODE_CONTROLLER_BUSY;
+      }
+      WSF_CS_EXIT(cs);
+
+      if (isCancelled)
+      {
+        memcpy(pDataBuf->pBuf + offset, pData, len);
+        pAdvSet->param.advDID = lctrCalcDID(pDataBuf->pBuf, pDataBuf->len);
+
+        /* Keep a pending update from undoing the patch. */
+        if (pDataBuf->alt.ext.modified && ((offset + len) <= pDataBuf->alt.ext.len))
+        {
+          memcpy(pDataBuf->alt.ext.buf + offset, pData, len);
+        }
+
+        /* Update superior PDU. */
+        BbBleSlvAdvEvent_t * const pAdv = &pAdvSet->bleData.op.slvAdv;
+        pAdv->txAdvLen = lctrPackAdvExtIndPdu(pAdvSet, pAdvSet->advHdrBuf, FALSE);
+
+        /* Re-insert BOD's */
+        pAdvSet->advBod.abortCback = lctrSlvExtAdvAbortOp;
+        (void)SchInsertAtDueTime(&pAdvSet->advBod, NULL);
+
+        if (pAdvSet->auxBodUsed)
+        {
+          pAdvSet->auxAdvBod.abortCback = lctrSlvAuxAdvEndOp;
+          (void)SchInsertAtDueTime(&pAdvSet->auxAdvBod, NULL);
+        }
+      }
+      break;
+
+    default:
+      result = LL_ERROR_CODE_CMD_DISALLOWED;
+      break;
+  }
+
+  return result;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      Set extended advertising transmit PHY options.
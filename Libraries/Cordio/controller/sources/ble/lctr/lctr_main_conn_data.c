@@ -50,6 +50,11 @@
 /*! \brief      Fragment trailer maximum length. */
 #define LCTR_FRAG_TRL_MAX_LEN           LL_DATA_MIC_LEN
 
+#ifdef LCTR_CONN_RX_ACL_AGGREGATION
+/*! \brief      L2CAP basic header length. */
+#define LCTR_L2C_HDR_LEN                4
+#endif
+
 /**************************************************************************************************
   Data Types
 **************************************************************************************************/
@@ -989,6 +994,123 @@ void lctrRxConnEnq(lctrConnCtx_t *pCtx, uint8_t *pBuf)
   pCtx->numRxPend++;
 }
 
+#ifdef LCTR_CONN_RX_ACL_AGGREGATION
+/*************************************************************************************************/
+/*!
+ *  \brief  Dequeue a fragmented L2CAP SDU as a single ACL message.
+ *
+ *  \param  pCtx            Connection context.
+ *  \param  pWaitFrag       Set to TRUE if the SDU is incomplete and delivery should be deferred.
+ *
+ *  \return Pointer to the start of the aggregated ACL message or NULL if not aggregated.
+ *
+ *  When the head of the receive queue is a start PDU whose L2CAP length spans subsequent
+ *  continuation PDUs already in the queue, the fragments are copied into one message carrying the
+ *  complete SDU. The host then receives a single start ACL packet which needs no reassembly.
+ *  Delivery is deferred while the outstanding fragments fit in the free receive buffers; otherwise
+ *  the fragments are delivered individually.
+ */
+/*************************************************************************************************/
+static uint8_t *lctrRxConnDeqAggrAcl(lctrConnCtx_t *pCtx, bool_t *pWaitFrag)
+{
+  uint8_t *pBuf;
+  uint8_t *pAggrBuf;
+  wsfHandlerId_t connHandle;
+  lctrAclHdr_t aclHdr;
+  uint32_t sduLen;
+  uint32_t rxLen;
+  uint8_t numPdu = 1;
+
+  *pWaitFrag = FALSE;
+
+  if ((pBuf = WsfMsgPeek(&pCtx->rxDataQ, &connHandle)) == NULL)
+  {
+    return NULL;
+  }
+
+  pBuf += LCTR_DATA_PDU_START_OFFSET;
+
+  if (((pBuf[LCTR_DATA_PDU_FC_OFFSET] & LL_DATA_HDR_LLID_MSK) != LL_LLID_START_PDU) ||
+      (pBuf[LCTR_DATA_PDU_LEN_OFFSET] < LCTR_L2C_HDR_LEN))
+  {
+    return NULL;
+  }
+
+  BYTES_TO_UINT16(sduLen, pBuf + LL_DATA_HDR_LEN);
+  sduLen += LCTR_L2C_HDR_LEN;
+  rxLen = pBuf[LCTR_DATA_PDU_LEN_OFFSET];
+
+  if ((rxLen >= sduLen) ||
+      ((sduLen + HCI_ACL_HDR_LEN) > UINT16_MAX))
+  {
+    /* Unfragmented or too large to aggregate. */
+    return NULL;
+  }
+
+  /*** Locate remaining fragments. ***/
+
+  while (rxLen < sduLen)
+  {
+    if (numPdu == UINT8_MAX)
+    {
+      return NULL;
+    }
+
+    if ((pBuf = WsfMsgNPeek(&pCtx->rxDataQ, numPdu, &connHandle)) == NULL)
+    {
+      /* Only wait if the remaining fragments fit in the free receive buffers. */
+      *pWaitFrag = ((lmgrConnCb.availRxBuf * (uint32_t)pCtx->effDataPdu.maxRxLen) >=
+                    (sduLen - rxLen));
+      return NULL;
+    }
+
+    pBuf += LCTR_DATA_PDU_START_OFFSET;
+
+    if ((pBuf[LCTR_DATA_PDU_FC_OFFSET] & LL_DATA_HDR_LLID_MSK) != LL_LLID_CONT_PDU)
+    {
+      /* Truncated SDU; leave it to the host. */
+      return NULL;
+    }
+
+    rxLen += pBuf[LCTR_DATA_PDU_LEN_OFFSET];
+    numPdu++;
+  }
+
+  if ((rxLen != sduLen) ||
+      ((pAggrBuf = WsfMsgAlloc(HCI_ACL_HDR_LEN + sduLen)) == NULL))
+  {
+    return NULL;
+  }
+
+  /*** Assemble ACL packet. ***/
+
+  uint8_t *pDst = pAggrBuf + HCI_ACL_HDR_LEN;
+
+  for (unsigned int i = 0; i < numPdu; i++)
+  {
+    pBuf = WsfMsgDeq(&pCtx->rxDataQ, &connHandle);
+
+    uint8_t * const pDataBuf = pBuf + LCTR_DATA_PDU_START_OFFSET;
+    uint8_t len = pDataBuf[LCTR_DATA_PDU_LEN_OFFSET];
+
+    memcpy(pDst, pDataBuf + LL_DATA_HDR_LEN, len);
+    pDst += len;
+
+    WsfMsgFree(pBuf);
+  }
+
+  /* Only the aggregated buffer is returned by LctrRxAclComplete(). */
+  lctrDataRxIncAvailBuf(numPdu - 1);
+
+  aclHdr.connHandle = connHandle;
+  aclHdr.pktBound = LCTR_PB_START_AUTO_FLUSH;
+  aclHdr.len = sduLen;
+  lctrPackAclHdr(pAggrBuf, &aclHdr);
+
+  return pAggrBuf;
+}
+#endif
+
 /*************************************************************************************************/
 /*!
  *  \brief  Dequeue a receive data PDU buffer for a connection as a ACL message.
@@ -1005,6 +1127,21 @@ uint8_t *lctrRxConnDeqAcl(lctrConnCtx_t *pCtx)
   uint8_t *pAclBuf;
   wsfHandlerId_t connHandle;
 
+#ifdef LCTR_CONN_RX_ACL_AGGREGATION
+  bool_t waitFrag;
+
+  if ((pAclBuf = lctrRxConnDeqAggrAcl(pCtx, &waitFrag)) != NULL)
+  {
+    return pAclBuf;
+  }
+
+  if (waitFrag)
+  {
+    /* Remaining fragments still in flight; hold SDU until complete. */
+    return NULL;
+  }
+#endif
+
   if ((pAclBuf = WsfMsgDeq(&pCtx->rxDataQ, &connHandle)) != NULL)
   {
     /* lctrRxPduFree(pRxBuf); */        /* Freed in LHCI, etc. */
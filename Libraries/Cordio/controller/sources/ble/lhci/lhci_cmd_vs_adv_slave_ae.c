@@ -54,6 +54,9 @@ bool_t lhciSlvExtAdvVsStdDecodeCmdPkt(LhciHdr_t *pHdr, uint8_t *pBuf)
   uint16_t advHandle = 0;
   bool_t   isAdv = FALSE;
 
+  /* Variables used for VS_GET_PER_ADV_DATA_STATS. */
+  LlPerAdvDataStats_t perDataStats = { 0 };
+
   /* Decode and consume command packet. */
   switch (pHdr->opCode)
   {
@@ -71,6 +74,24 @@ bool_t lhciSlvExtAdvVsStdDecodeCmdPkt(LhciHdr_t *pHdr, uint8_t *pBuf)
     case LHCI_OPCODE_VS_SET_EXT_ADV_FRAG_LEN:
       status = LlSetExtAdvDataFragLen(pBuf[0], pBuf[1]);
       break;
+    case LHCI_OPCODE_VS_PATCH_EXT_ADV_DATA:
+    {
+      uint8_t handle;
+      uint8_t location;
+      uint16_t offset;
+      uint8_t len;
+      BSTREAM_TO_UINT8(handle, pBuf);
+      BSTREAM_TO_UINT8(location, pBuf);
+      BSTREAM_TO_UINT16(offset, pBuf);
+      BSTREAM_TO_UINT8(len, pBuf);
+      if ((len + 5) > pHdr->len)
+      {
+        status = HCI_ERR_INVALID_PARAM;
+        break;
+      }
+      status = LlPatchExtAdvData(handle, (location != 0), offset, len, pBuf);
+      break;
+    }
     case LHCI_OPCODE_VS_SET_EXT_ADV_PHY_OPTS:
       status = LlSetExtAdvTxPhyOptions(pBuf[0], pBuf[1], pBuf[2]);
       break;
@@ -84,6 +105,10 @@ bool_t lhciSlvExtAdvVsStdDecodeCmdPkt(LhciHdr_t *pHdr, uint8_t *pBuf)
       LlSetDefaultExtAdvTxPhyOptions(phyOptions);
       break;
     }
+    case LHCI_OPCODE_VS_GET_PER_ADV_DATA_STATS:
+      status = LlGetPeriodicAdvDataStats(pBuf[0], &perDataStats);
+      evtParamLen += sizeof(LlPerAdvDataStats_t);
+      break;
     case LHCI_OPCODE_VS_GET_PER_CHAN_MAP:
     {
       BSTREAM_TO_UINT16(advHandle, pBuf);
@@ -118,6 +143,10 @@ bool_t lhciSlvExtAdvVsStdDecodeCmdPkt(LhciHdr_t *pHdr, uint8_t *pBuf)
         break;
       }
 
+      case LHCI_OPCODE_VS_GET_PER_ADV_DATA_STATS:
+        memcpy(pBuf, (uint8_t *)&perDataStats, sizeof(perDataStats));
+        break;
+
       case LHCI_OPCODE_VS_GET_PER_CHAN_MAP:
       {
        /* Note: this function is also used by master. */
@@ -215,6 +215,8 @@ extern "C" {
 
 #define LHCI_OPCODE_VS_SET_DIAG_MODE             HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3F9)  /*!< Set Diagnostic Mode opcode. */
 #define LHCI_OPCODE_VS_SET_SNIFFER_ENABLE        HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3CD)  /*!< Enable sniffer packet forwarding. */
+#define LHCI_OPCODE_VS_PATCH_EXT_ADV_DATA        HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3CE)  /*!< Patch extended advertising data. */
+#define LHCI_OPCODE_VS_GET_PER_ADV_DATA_STATS    HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3CF)  /*!< Get periodic advertising data statistics. */
 
 #define LHCI_OPCODE_VS_GET_PDU_FILT_STATS        HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3F4)  /*!< Get PDU Filter Statistics opcode. */
 #define LHCI_OPCODE_VS_GET_SYS_STATS             HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3FA)  /*!< Get Memory Statistics opcode. */
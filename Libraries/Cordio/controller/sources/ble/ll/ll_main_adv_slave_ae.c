@@ -570,6 +570,33 @@ uint8_t LlSetPeriodicAdvData(uint8_t handle, uint8_t op, uint8_t len, const uint
   return LctrSetPeriodicAdvData(handle, op, len, pData);
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Get periodic advertising data statistics.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      pStats      Statistics.
+ *
+ *  \return     Status error code.
+ *
+ *  Get the number of periodic advertising events since periodic advertising was enabled, the
+ *  number of complete data updates applied at an event and the number of updates replaced by a
+ *  newer update before an event applied them.
+ */
+/*************************************************************************************************/
+uint8_t LlGetPeriodicAdvDataStats(uint8_t handle, LlPerAdvDataStats_t *pStats)
+{
+  WSF_ASSERT(pStats);
+
+  if ((LL_API_PARAM_CHECK == 1) &&
+      (handle > LL_MAX_ADV_HANDLE))
+  {
+    return LL_ERROR_CODE_PARAM_OUT_OF_MANDATORY_RANGE;
+  }
+
+  return LctrGetPeriodicAdvDataStats(handle, pStats);
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      Set periodic advertising enable.
@@ -641,6 +668,30 @@ uint8_t LlSetExtAdvDataFragLen(uint8_t handle, uint8_t fragLen)
   return LctrSetExtAdvDataFragLen(handle, fragLen);
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Patch extended advertising or scan response data.
+ *
+ *  \param      handle      Advertising handle.
+ *  \param      scanRsp     TRUE to patch scan response data, FALSE for advertising data.
+ *  \param      offset      Offset of the changed bytes in the data buffer.
+ *  \param      len         Number of changed bytes.
+ *  \param      pData       Changed bytes.
+ *
+ *  \return     Status error code.
+ *
+ *  Replace bytes of complete Advertising Data or Scan Response Data, which may be longer than one
+ *  HCI command, without resending the rest of the data.
+ */
+/*************************************************************************************************/
+uint8_t LlPatchExtAdvData(uint8_t handle, bool_t scanRsp, uint16_t offset, uint8_t len,
+                          const uint8_t *pData)
+{
+  LL_TRACE_INFO2("### LlApi ###  LlPatchExtAdvData: handle=%u, len=%u", handle, len);
+
+  return LctrPatchExtAdvData(handle, scanRsp, offset, len, pData);
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      Set extended advertising transmit PHY options.
@@ -908,6 +908,28 @@ uint8_t LlGetAclRxBufs(void)
   return pLctrRtCfg->numRxBufs;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief      Get the ACL buffer usage.
+ *
+ *  \param      pTxUsed     Transmit buffers in use.
+ *  \param      pTxPeak     Most transmit buffers in use at once.
+ *  \param      pRxUsed     Receive buffers in use.
+ *  \param      pRxPeak     Most receive buffers in use at once.
+ */
+/*************************************************************************************************/
+void LlGetAclBufUsage(uint8_t *pTxUsed, uint8_t *pTxPeak, uint8_t *pRxUsed, uint8_t *pRxPeak)
+{
+  WSF_CS_INIT(cs);
+
+  WSF_CS_ENTER(cs);
+  *pTxUsed = pLctrRtCfg->numTxBufs - lmgrConnCb.availTxBuf;
+  *pTxPeak = pLctrRtCfg->numTxBufs - lmgrConnCb.minAvailTxBuf;
+  *pRxUsed = pLctrRtCfg->numRxBufs - lmgrConnCb.availRxBuf;
+  *pRxPeak = pLctrRtCfg->numRxBufs - lmgrConnCb.minAvailRxBuf;
+  WSF_CS_EXIT(cs);
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief      Send an ACL data packet.
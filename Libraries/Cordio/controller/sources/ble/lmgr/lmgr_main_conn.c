@@ -45,6 +45,8 @@ void LmgrConnInit(void)
 
   lmgrConnCb.availTxBuf = pLctrRtCfg->numTxBufs;
   lmgrConnCb.availRxBuf = pLctrRtCfg->numRxBufs;
+  lmgrConnCb.minAvailTxBuf = lmgrConnCb.availTxBuf;
+  lmgrConnCb.minAvailRxBuf = lmgrConnCb.availRxBuf;
 
   lmgrConnCb.maxTxLen = LL_MAX_DATA_LEN_MIN;
   lmgrConnCb.maxTxTime = LL_MAX_DATA_TIME_MIN;
@@ -1157,3 +1157,37 @@ bool_t SchIsBodCancellable(BbOpDesc_t *pBod)
 
   return result;
 }
+
+/*************************************************************************************************/
+/*!
+ *  \brief      Get the time until the next BOD.
+ *
+ *  \return     Time until the head BOD is due in microseconds, zero if it is executing or due,
+ *              or SCH_MAX_SPAN if nothing is scheduled.
+ *
+ *  Lets work that stalls the CPU, e.g. erasing the flash bank code runs from, wait for a gap
+ *  between radio operations.
+ */
+/*************************************************************************************************/
+uint32_t SchGetIdleTimeUsec(void)
+{
+  uint32_t idleUsec = SCH_MAX_SPAN;
+
+  WsfCsEnter();
+
+  if (schCb.pHead != NULL)
+  {
+    if (schCb.state == SCH_STATE_EXEC)
+    {
+      idleUsec = 0;
+    }
+    else
+    {
+      idleUsec = BbGetTargetTimeDelta(schCb.pHead->dueUsec, PalBbGetCurrentTime());
+    }
+  }
+
+  WsfCsExit();
+
+  return idleUsec;
+}
@@ -510,6 +510,8 @@ extern "C" {
  */
 /**@{*/
 #define HCI_OPCODE_LE_VS_ENABLE_READ_FEAT_ON_CONN    ((uint16_t)(0xfff3))
+#define HCI_OPCODE_VS_PATCH_EXT_ADV_DATA             HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3CE)
+#define HCI_OPCODE_VS_GET_PER_ADV_DATA_STATS         HCI_OPCODE(HCI_OGF_VENDOR_SPEC, 0x3CF)
 /**@}*/
 
 /** \name Command parameter lengths
@@ -600,6 +602,7 @@ extern "C" {
 #define HCI_LEN_LE_SET_ADV_SET_RAND_ADDR             7
 #define HCI_LEN_LE_SET_EXT_ADV_PARAM                 25
 #define HCI_LEN_LE_SET_EXT_ADV_DATA(len)             (4 + (len))
+#define HCI_LEN_VS_PATCH_EXT_ADV_DATA(len)           (5 + (len))
 #define HCI_LEN_LE_SET_EXT_SCAN_RESP_DATA(len)       (4 + (len))
 #define HCI_LEN_LE_EXT_ADV_ENABLE(numSets)           (2 + (4 * (numSets)))
 #define HCI_LEN_LE_READ_MAX_ADV_DATA_LEN             0
@@ -65,6 +65,12 @@ extern "C" {
 /*! \brief Max number of pools can allocate */
 #define WSF_BUF_STATS_MAX_POOL      32
 
+/*! \brief Request length histogram bin width */
+#define WSF_BUF_STATS_BIN_LEN       16
+
+/*! \brief Number of request length histogram bins, the last also counts longer requests */
+#define WSF_BUF_STATS_MAX_BIN       64
+
 /*! \brief Failure Codes */
 #define WSF_BUF_ALLOC_FAILED        1
 
@@ -92,6 +98,9 @@ typedef struct
   uint8_t    numAlloc;             /*!< \brief Number of outstanding allocations. */
   uint8_t    maxAlloc;             /*!< \brief High allocation watermark. */
   uint16_t   maxReqLen;            /*!< \brief Maximum requested buffer length. */
+  uint32_t   numReq;               /*!< \brief Number of requests served, stops with sumAlloc. */
+  uint32_t   sumAlloc;             /*!< \brief Sum of outstanding allocations after each request,
+                                        stops before it overflows. */
 } WsfBufPoolStat_t;
 
 /*! \brief WSF buffer diagnostics - buffer allocation failure */
@@ -192,6 +201,27 @@ uint8_t *WsfBufGetAllocStats(void);
 /*************************************************************************************************/
 uint8_t *WsfBufGetPoolOverFlowStats(void);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Diagnostic function to get the request length histogram.
+ *
+ *  Bin n counts requests of length (n * WSF_BUF_STATS_BIN_LEN) + 1 to
+ *  (n + 1) * WSF_BUF_STATS_BIN_LEN, including requests that failed.
+ *
+ *  \return Histogram of WSF_BUF_STATS_MAX_BIN bins or NULL if WSF_BUF_STATS_HIST is disabled.
+ */
+/*************************************************************************************************/
+uint32_t *WsfBufGetReqHist(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Clear the buffer statistics to start a new capture.
+ *
+ *  High allocation watermarks restart from the current number of outstanding allocations.
+ */
+/*************************************************************************************************/
+void WsfBufClearStats(void);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get number of pools.
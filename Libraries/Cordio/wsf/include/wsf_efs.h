@@ -203,6 +203,18 @@ typedef uint8_t wsfMediaWriteFunc_t(const uint8_t *pBuf, uint8_t *pAddress, uint
 /*************************************************************************************************/
 typedef uint8_t wsfMediaHandleCmdFunc_t(uint8_t cmd, uint32_t param);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Media Map function, for media that can be read in place.
+ *
+ *  \param  pAddress Address in media to map.
+ *  \param  size     Number of bytes to map.
+ *
+ *  \return Pointer to read the data directly, or NULL if the range cannot be mapped.
+ */
+/*************************************************************************************************/
+typedef const uint8_t *wsfMediaMapFunc_t(uint8_t *pAddress, uint32_t size);
+
 /*! \brief Media Control data type */
 typedef struct
 {
@@ -214,6 +226,7 @@ typedef struct
   wsfMediaReadFunc_t      *read;         /*!< \brief Media read callback. */
   wsfMediaWriteFunc_t     *write;        /*!< \brief Media write callback. */
   wsfMediaHandleCmdFunc_t *handleCmd;    /*!< \brief Media command handler callback. */
+  wsfMediaMapFunc_t       *map;          /*!< \brief Media direct map callback, optional. */
 } wsfEfsMedia_t;
 
 /*! \brief Pointer to Media Control data type */
@@ -306,6 +319,20 @@ uint8_t WsfEfsSetAttributes(wsfEfsHandle_t handle, wsfEsfAttributes_t *pInfo);
 /*************************************************************************************************/
 uint16_t WsfEfsGet(wsfEfsHandle_t handle, uint32_t offset, uint8_t *pBuffer, uint16_t len);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Maps file data for reading in place, without a copy.
+ *
+ *  \param  handle    Handle identifying the file.
+ *  \param  offset    Offset into the file to map from.
+ *  \param  pLen      Number of bytes to map, set to the number of bytes mapped.
+ *
+ *  \return Pointer to the file data, or NULL if the media cannot be mapped.  Use WsfEfsGet()
+ *          when NULL is returned.
+ */
+/*************************************************************************************************/
+const uint8_t *WsfEfsMap(wsfEfsHandle_t handle, uint32_t offset, uint16_t *pLen);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Writes data to a file.
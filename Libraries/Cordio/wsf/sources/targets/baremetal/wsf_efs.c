@@ -407,6 +407,43 @@ uint16_t WsfEfsGet(wsfEfsHandle_t handle, uint32_t offset, uint8_t *pBuffer, uin
   return 0;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Maps file data for reading in place, without a copy.
+ *
+ *  \param  handle    Handle identifying the file.
+ *  \param  offset    Offset into the file to map from.
+ *  \param  pLen      Number of bytes to map, set to the number of bytes mapped.
+ *
+ *  \return Pointer to the file data, or NULL if the media cannot be mapped.
+ */
+/*************************************************************************************************/
+const uint8_t *WsfEfsMap(wsfEfsHandle_t handle, uint32_t offset, uint16_t *pLen)
+{
+  wsfEfsControl_t *pFile;
+
+  if (((pFile = WsfEfsGetFileByHandle(handle)) != NULL) && pLen)
+  {
+    if (pFile->attributes.permissions & (WSF_EFS_REMOTE_GET_PERMITTED | WSF_EFS_LOCAL_GET_PERMITTED))
+    {
+      uint8_t media = pFile->media;
+
+      if (wsfEfsMediaTbl[media]->map && (pFile->attributes.type != WSF_EFS_FILE_TYPE_STREAM) &&
+          (offset < pFile->size))
+      {
+        if (offset + *pLen > pFile->size)
+        {
+          *pLen = (uint16_t) (pFile->size - offset);
+        }
+
+        return wsfEfsMediaTbl[media]->map((uint8_t *) (pFile->address + offset), *pLen);
+      }
+    }
+  }
+
+  return NULL;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Writes data to a file.
@@ -22,6 +22,8 @@
  */
 /*************************************************************************************************/
 
+#include <string.h>
+
 #include "wsf_types.h"
 #include "wsf_buf.h"
 
@@ -60,6 +62,8 @@ typedef struct {
   uint8_t           numAlloc;       /* Number of buffers currently allocated from pool. */
   uint8_t           maxAlloc;       /* Maximum buffers ever allocated from pool. */
   uint16_t          maxReqLen;      /* Maximum request length from pool. */
+  uint32_t          numReq;         /* Number of requests served from pool. */
+  uint32_t          sumAlloc;       /* Sum of numAlloc after each request, for mean occupancy. */
 #endif
 } wsfBufPool_t;
 
@@ -82,6 +86,9 @@ uint8_t wsfBufAllocCount[WSF_BUF_STATS_MAX_LEN];
 
 /* Pool Overflow counter. */
 uint8_t wsfPoolOverFlowCount[WSF_BUF_STATS_MAX_POOL];
+
+/* Request length histogram. */
+uint32_t wsfBufReqHist[WSF_BUF_STATS_MAX_BIN];
 #endif
 
 #if WSF_OS_DIAG == TRUE
@@ -197,6 +204,8 @@ uint32_t WsfBufInit(uint8_t numPools, wsfBufPoolDesc_t *pDesc)
     pPool->numAlloc = 0;
     pPool->maxAlloc = 0;
     pPool->maxReqLen = 0;
+    pPool->numReq = 0;
+    pPool->sumAlloc = 0;
 #endif
 
     WSF_TRACE_INFO2("Creating pool len=%u num=%u", pPool->desc.len, pPool->desc.num);
@@ -253,6 +262,13 @@ void *WsfBufAlloc(uint16_t len)
 
   WSF_ASSERT(len > 0);
 
+#if WSF_BUF_STATS_HIST == TRUE
+  /* Count every request, whether or not it is served. */
+  WSF_CS_ENTER(cs);
+  wsfBufReqHist[WSF_MIN((len - 1) / WSF_BUF_STATS_BIN_LEN, WSF_BUF_STATS_MAX_BIN - 1)]++;
+  WSF_CS_EXIT(cs);
+#endif
+
   pPool = (wsfBufPool_t *) wsfBufMem;
 
   for (i = wsfBufNumPools; i > 0; i--, pPool++) {
@@ -285,6 +301,11 @@ void *WsfBufAlloc(uint16_t len)
           pPool->maxAlloc = pPool->numAlloc;
         }
         pPool->maxReqLen = WSF_MAX(pPool->maxReqLen, len);
+        /* both stop at the limit so that their ratio is still the mean occupancy */
+        if (pPool->sumAlloc <= UINT32_MAX - pPool->numAlloc) {
+          pPool->numReq++;
+          pPool->sumAlloc += pPool->numAlloc;
+        }
 #endif
         /* Exit critical section. */
         WSF_CS_EXIT(cs);
@@ -422,6 +443,55 @@ uint8_t *WsfBufGetPoolOverFlowStats(void)
 #endif
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Diagnostic function to get the request length histogram.
+ *
+ *  \return Request length histogram array.
+ */
+/*************************************************************************************************/
+uint32_t *WsfBufGetReqHist(void)
+{
+#if WSF_BUF_STATS_HIST == TRUE
+  return wsfBufReqHist;
+#else
+  return NULL;
+#endif
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Clear the buffer statistics to start a new capture.
+ */
+/*************************************************************************************************/
+void WsfBufClearStats(void)
+{
+#if WSF_BUF_STATS == TRUE
+  wsfBufPool_t  *pPool = (wsfBufPool_t *) wsfBufMem;
+  uint8_t       i;
+#endif
+
+  WSF_CS_INIT(cs);
+  WSF_CS_ENTER(cs);
+
+#if WSF_BUF_STATS_HIST == TRUE
+  memset(wsfBufAllocCount, 0, sizeof(wsfBufAllocCount));
+  memset(wsfPoolOverFlowCount, 0, sizeof(wsfPoolOverFlowCount));
+  memset(wsfBufReqHist, 0, sizeof(wsfBufReqHist));
+#endif
+
+#if WSF_BUF_STATS == TRUE
+  for (i = 0; i < wsfBufNumPools; i++) {
+    pPool[i].maxAlloc = pPool[i].numAlloc;
+    pPool[i].maxReqLen = 0;
+    pPool[i].numReq = 0;
+    pPool[i].sumAlloc = 0;
+  }
+#endif
+
+  WSF_CS_EXIT(cs);
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get number of pools.
@@ -462,10 +532,14 @@ void WsfBufGetPoolStats(WsfBufPoolStat_t *pStat, uint8_t poolId)
   pStat->numAlloc = pPool[poolId].numAlloc;
   pStat->maxAlloc = pPool[poolId].maxAlloc;
   pStat->maxReqLen = pPool[poolId].maxReqLen;
+  pStat->numReq = pPool[poolId].numReq;
+  pStat->sumAlloc = pPool[poolId].sumAlloc;
 #else
   pStat->numAlloc = 0;
   pStat->maxAlloc = 0;
   pStat->maxReqLen = 0;
+  pStat->numReq = 0;
+  pStat->sumAlloc = 0;
 #endif
 
   /* Exit critical section. */
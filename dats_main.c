@@ -56,6 +56,7 @@
 #include "wdxs/wdxs_main.h"
 #include "wdxs/wdxs_stream.h"
 #include "wdxs_file.h"
+#include "flash_sched.h"
 #include "board.h"
 #include "pal_led.h"
 #include "led.h"
@@ -141,6 +142,14 @@ static const attCfg_t datsAttCfg = {
     4                                 /* number of queued prepare writes supported by server */
 };
 
+/*! WDXS link parameters for large transfers, and after them */
+static const wdxsBulkCfg_t datsWdxsBulkCfg = {
+    {6, 12, 4, 400, 0, 0},                  /*! 7.5 to 15 ms interval while a transfer runs, with
+                                                latency for flash erase gaps (flash_sched.h) */
+    {24, 40, 0, 600, 0, 0},                 /*! 30 to 50 ms interval afterwards */
+    4096                                    /*! Shortest transfer that switches */
+};
+
 /*! local IRK */
 static uint8_t localIrk[] = {
     0x95, 0xC8, 0xEE, 0x6F, 0xC5, 0x0D, 0xEF, 0x93, 0x35, 0x4E, 0x7C, 0x57, 0x08, 0xE2, 0xA3, 0x85
@@ -311,6 +320,12 @@ static void datsCccCback(attsCccEvt_t *pEvt)
         AppDbSetCccTblValue(dbHdl, pEvt->idx, pEvt->value);
         AppDbNvmStoreCccTbl(dbHdl);
     }
+
+    /* Erase overlaps the rest of the setup once a client subscribes to file transfer */
+    if ((pEvt->handle != ATT_HANDLE_NONE) && (pEvt->idx == WDXS_FTC_CH_CCC_IDX) &&
+            (pEvt->value & ATT_CLIENT_CFG_NOTIFY)) {
+        WdxsFilePreErase();
+    }
 }
 
 /*************************************************************************************************/
@@ -511,6 +526,7 @@ static void datsProcMsg(dmEvt_t *pMsg)
             AppDbNvmReadAll();
             datsRestoreResolvingList(pMsg);
             setAdvTxPower();
+            FlashSchedLinkReset();
             uiEvent = APP_UI_RESET_CMPL;
             break;
 
@@ -929,6 +945,9 @@ void DatsStart(void)
     /* Set the WDXS CCC Identifiers */
     WdxsSetCccIdx(WDXS_DC_CH_CCC_IDX, WDXS_AU_CH_CCC_IDX, WDXS_FTC_CH_CCC_IDX, WDXS_FTD_CH_CCC_IDX);
 
+    /* Speed up the link for file transfers */
+    WdxsBulkCfg(&datsWdxsBulkCfg);
+
 #if (BT_VER > 8)
     WdxsPhyInit();
 #endif /* BT_VER */
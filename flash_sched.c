@@ -0,0 +1,562 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Bank aware flash operation scheduler.
+ *
+ *  The two flash banks have their own controllers. Programming one bank stalls instruction
+ *  fetch from that bank only, so work on the bank code is not running from is started from the
+ *  flash controller interrupt and runs alongside the application and the link layer.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "mxc_device.h"
+#include "mxc_errors.h"
+#include "flc.h"
+#include "gcr_regs.h"
+#include "wsf_types.h"
+#include "wsf_cs.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "flash_sched.h"
+
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+#include "sch_api.h"
+#include "ll_api.h"
+#endif
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Flash line programmed at once */
+#define FLASH_SCHED_LINE_LEN        16
+
+/* Worst case CPU stall for a page erase and for a line write in the running bank */
+#define FLASH_SCHED_ERASE_USEC      30000
+#define FLASH_SCHED_WRITE_USEC      100
+
+/* Longest wait for a gap between radio events, in ticks */
+#define FLASH_SCHED_GAP_WAIT        pdMS_TO_TICKS(100)
+
+/* Operations */
+enum {
+    FLASH_SCHED_OP_ERASE,
+    FLASH_SCHED_OP_WRITE
+};
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Queued operation */
+typedef struct {
+    uint32_t addr;                              /* Next address */
+    uint32_t len;                               /* Bytes left */
+    flashSchedCback_t *cback;                   /* Complete callback */
+    uint8_t op;                                 /* Operation */
+} flashSchedOp_t;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+static struct {
+    flashSchedOp_t queue[FLASH_SCHED_QUEUE_LEN];    /* Operations for the idle bank */
+    uint8_t head;                                   /* Oldest operation */
+    uint8_t count;                                  /* Operations queued */
+    uint8_t data[FLASH_SCHED_DATA_LEN];             /* Write data ring */
+    uint16_t dataHead;                              /* Oldest write data */
+    uint16_t dataUsed;                              /* Write data buffered */
+    uint32_t stepLen;                               /* Bytes covered by the command in progress */
+    volatile bool_t busy;                           /* Controller command in progress */
+    int err;                                        /* First error since the last flush */
+    uint8_t runBank;                                /* Bank code runs from */
+} flashSchedCb;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the bank of a flash address.
+ *
+ *  \param  addr     Address.
+ *
+ *  \return Bank number.
+ */
+/*************************************************************************************************/
+static uint8_t flashSchedBank(uint32_t addr)
+{
+    return (addr < MXC_FLASH1_MEM_BASE) ? 0 : 1;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the controller of a flash bank.
+ *
+ *  \param  addr     Address in the bank.
+ *
+ *  \return Flash controller.
+ */
+/*************************************************************************************************/
+static mxc_flc_regs_t *flashSchedFlc(uint32_t addr)
+{
+    return flashSchedBank(addr) ? MXC_FLC1 : MXC_FLC0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start the next controller command.  Called with interrupts disabled.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedStart(void)
+{
+    flashSchedOp_t *pOp = &flashSchedCb.queue[flashSchedCb.head];
+    mxc_flc_regs_t *pFlc;
+    uint32_t line[FLASH_SCHED_LINE_LEN / 4];
+    uint32_t offset;
+    uint32_t i;
+
+    if(flashSchedCb.busy || (flashSchedCb.count == 0)) {
+        return;
+    }
+
+    pFlc = flashSchedFlc(pOp->addr);
+
+    /* 1 MHz flash clock, clear stale flags and unlock, as the driver does */
+    pFlc->clkdiv = SystemCoreClock / 1000000;
+    pFlc->intr &= ~(MXC_F_FLC_INTR_DONE | MXC_F_FLC_INTR_AF);
+    pFlc->intr |= (MXC_F_FLC_INTR_DONEIE | MXC_F_FLC_INTR_AFIE);
+    pFlc->cn = (pFlc->cn & ~MXC_F_FLC_CN_UNLOCK) | MXC_S_FLC_CN_UNLOCK_UNLOCKED;
+
+    if(pOp->op == FLASH_SCHED_OP_ERASE) {
+        flashSchedCb.stepLen = MXC_FLASH_PAGE_SIZE;
+        pFlc->cn = (pFlc->cn & ~MXC_F_FLC_CN_ERASE_CODE) | MXC_S_FLC_CN_ERASE_CODE_ERASEPAGE;
+        pFlc->addr = pOp->addr & (MXC_FLASH_MEM_SIZE - 1);
+        flashSchedCb.busy = TRUE;
+        pFlc->cn |= MXC_F_FLC_CN_PGE;
+    } else {
+        /* Merge the new bytes into the line, as MXC_FLC_Write32 does */
+        offset = pOp->addr & (FLASH_SCHED_LINE_LEN - 1);
+        flashSchedCb.stepLen = FLASH_SCHED_LINE_LEN - offset;
+        if(flashSchedCb.stepLen > pOp->len) {
+            flashSchedCb.stepLen = pOp->len;
+        }
+
+        memcpy(line, (const void*)(pOp->addr - offset), FLASH_SCHED_LINE_LEN);
+        for(i = 0; i < flashSchedCb.stepLen; i++) {
+            ((uint8_t*)line)[offset + i] = flashSchedCb.data[flashSchedCb.dataHead];
+            flashSchedCb.dataHead = (flashSchedCb.dataHead + 1) % FLASH_SCHED_DATA_LEN;
+        }
+        flashSchedCb.dataUsed -= flashSchedCb.stepLen;
+
+        pFlc->addr = (pOp->addr - offset) & (MXC_FLASH_MEM_SIZE - 1);
+        pFlc->data[0] = line[0];
+        pFlc->data[1] = line[1];
+        pFlc->data[2] = line[2];
+        pFlc->data[3] = line[3];
+        flashSchedCb.busy = TRUE;
+        pFlc->cn |= MXC_F_FLC_CN_WR;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Complete a controller command and start the next one.
+ *
+ *  \param  pFlc     Flash controller.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedIrq(mxc_flc_regs_t *pFlc)
+{
+    flashSchedOp_t *pOp = &flashSchedCb.queue[flashSchedCb.head];
+    flashSchedCback_t *cback = NULL;
+
+    /* Lock flash, check access violations and clear the write zero clear flags */
+    pFlc->cn &= ~MXC_F_FLC_CN_UNLOCK;
+    if((pFlc->intr & MXC_F_FLC_INTR_AF) && (flashSchedCb.err == E_NO_ERROR)) {
+        flashSchedCb.err = E_BAD_STATE;
+    }
+    pFlc->intr &= ~(MXC_F_FLC_INTR_DONE | MXC_F_FLC_INTR_AF |
+                    MXC_F_FLC_INTR_DONEIE | MXC_F_FLC_INTR_AFIE);
+
+    if(!flashSchedCb.busy) {
+        return;
+    }
+    flashSchedCb.busy = FALSE;
+
+    /* Flush the instruction cache so reads see the new contents */
+    MXC_GCR->scon |= MXC_F_GCR_SCON_CCACHE_FLUSH;
+    while(MXC_GCR->scon & MXC_F_GCR_SCON_CCACHE_FLUSH) {}
+
+    pOp->addr += flashSchedCb.stepLen;
+    pOp->len -= flashSchedCb.stepLen;
+
+    if(pOp->len == 0) {
+        cback = pOp->cback;
+        flashSchedCb.head = (flashSchedCb.head + 1) % FLASH_SCHED_QUEUE_LEN;
+        flashSchedCb.count--;
+    }
+
+    flashSchedStart();
+
+    if(cback != NULL) {
+        cback(flashSchedCb.err);
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Flash controller 0 interrupt handler.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FLC0_IRQHandler(void)
+{
+    flashSchedIrq(MXC_FLC0);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Flash controller 1 interrupt handler.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FLC1_IRQHandler(void)
+{
+    flashSchedIrq(MXC_FLC1);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Let queued operations progress.
+ *
+ *  Before the scheduler starts, FreeRTOS masks the flash interrupts, so the controller is
+ *  polled instead.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedWait(void)
+{
+    mxc_flc_regs_t *pFlc;
+
+    if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        vTaskDelay(1);
+        return;
+    }
+
+    WsfCsEnter();
+    if(flashSchedCb.busy) {
+        pFlc = flashSchedFlc(flashSchedCb.queue[flashSchedCb.head].addr);
+        if(pFlc->intr & MXC_F_FLC_INTR_DONE) {
+            flashSchedIrq(pFlc);
+        }
+    }
+    WsfCsExit();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for a gap between radio events before stalling the CPU.
+ *
+ *  \param  usec     Length of the stall.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedWaitGap(uint32_t usec)
+{
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+    TickType_t start = xTaskGetTickCount();
+
+    if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return;
+    }
+
+    /* Give up after a while, a link without slave latency may never leave a page erase gap */
+    while((SchGetIdleTimeUsec() < usec) && ((xTaskGetTickCount() - start) < FLASH_SCHED_GAP_WAIT)) {
+        vTaskDelay(1);
+    }
+#endif
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Allow or hold off slave latency on all connections.
+ *
+ *  Short connection intervals leave no gap for a page erase. Slave latency lets the link layer
+ *  skip events while it has nothing to send, so it is only allowed around running bank erases
+ *  and transfers are not slowed down otherwise.
+ *
+ *  \param  enable   TRUE to allow slave latency.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedSlvLatency(bool_t enable)
+{
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+    uint16_t handle;
+
+    /* New connections take the default, open ones are set one by one */
+    LlSetOpFlags(LL_OP_MODE_FLAG_ENA_SLV_LATENCY, enable);
+    for(handle = 0; handle < LL_MAX_CONN; handle++) {
+        LlSetConnOpFlags(handle, LL_OP_MODE_FLAG_ENA_SLV_LATENCY, enable);
+    }
+#endif
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Queue an operation for the idle bank.
+ *
+ *  \param  op       Operation.
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *  \param  cback    Complete callback.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void flashSchedQueue(uint8_t op, uint32_t addr, uint32_t len, flashSchedCback_t *cback)
+{
+    flashSchedOp_t *pOp;
+
+    pOp = &flashSchedCb.queue[(flashSchedCb.head + flashSchedCb.count) % FLASH_SCHED_QUEUE_LEN];
+    pOp->op = op;
+    pOp->addr = addr;
+    pOp->len = len;
+    pOp->cback = cback;
+    flashSchedCb.count++;
+
+    flashSchedStart();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check a flash range.
+ *
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range is within one bank of main flash.
+ */
+/*************************************************************************************************/
+static bool_t flashSchedValid(uint32_t addr, uint32_t len)
+{
+    return (len != 0) && (addr >= MXC_FLASH0_MEM_BASE) &&
+           ((addr + len) <= (MXC_FLASH0_MEM_BASE + 2 * MXC_FLASH_MEM_SIZE)) &&
+           (flashSchedBank(addr) == flashSchedBank(addr + len - 1));
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize the flash scheduler.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FlashSchedInit(void)
+{
+    memset(&flashSchedCb, 0, sizeof(flashSchedCb));
+    flashSchedCb.err = E_NO_ERROR;
+    flashSchedCb.runBank = flashSchedBank((uint32_t)FlashSchedInit);
+
+    /* Below the radio and the UART, flash commands take tens of microseconds at least */
+    NVIC_SetPriority(FLC0_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    NVIC_SetPriority(FLC1_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+    NVIC_EnableIRQ(FLC0_IRQn);
+    NVIC_EnableIRQ(FLC1_IRQn);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Restore the link layer settings of the scheduler after a reset.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FlashSchedLinkReset(void)
+{
+    flashSchedSlvLatency(FALSE);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase flash pages.
+ *
+ *  \param  addr     Page aligned address.
+ *  \param  len      Number of bytes, multiple of the page size.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued or done, E_BAD_PARAM for a bad range, or the erase error.
+ */
+/*************************************************************************************************/
+int FlashSchedErase(uint32_t addr, uint32_t len, flashSchedCback_t *cback)
+{
+    int err = E_NO_ERROR;
+
+    if(!flashSchedValid(addr, len) || (addr & (MXC_FLASH_PAGE_SIZE - 1)) ||
+       (len & (MXC_FLASH_PAGE_SIZE - 1))) {
+        return E_BAD_PARAM;
+    }
+
+    if(flashSchedBank(addr) != flashSchedCb.runBank) {
+        while(flashSchedCb.count == FLASH_SCHED_QUEUE_LEN) {
+            flashSchedWait();
+        }
+
+        WsfCsEnter();
+        flashSchedQueue(FLASH_SCHED_OP_ERASE, addr, len, cback);
+        WsfCsExit();
+        return E_NO_ERROR;
+    }
+
+    /* Running bank, keep the order and erase a page per radio gap */
+    if((err = FlashSchedFlush()) == E_NO_ERROR) {
+        flashSchedSlvLatency(TRUE);
+        while(len && (err == E_NO_ERROR)) {
+            flashSchedWaitGap(FLASH_SCHED_ERASE_USEC);
+            err = MXC_FLC_PageErase(addr);
+            addr += MXC_FLASH_PAGE_SIZE;
+            len -= MXC_FLASH_PAGE_SIZE;
+        }
+        flashSchedSlvLatency(FALSE);
+    }
+
+    if(cback != NULL) {
+        cback(err);
+    }
+
+    return err;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Program flash.
+ *
+ *  \param  addr     Address, any alignment.
+ *  \param  pBuf     Data to program.
+ *  \param  len      Number of bytes.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued or done, E_BAD_PARAM for a bad range, or the write error.
+ */
+/*************************************************************************************************/
+int FlashSchedWrite(uint32_t addr, const void *pBuf, uint32_t len, flashSchedCback_t *cback)
+{
+    const uint8_t *p = (const uint8_t*)pBuf;
+    uint32_t chunk;
+    uint32_t pos;
+    uint32_t i;
+    int err;
+
+    if(!flashSchedValid(addr, len) || (pBuf == NULL)) {
+        return E_BAD_PARAM;
+    }
+
+    if(flashSchedBank(addr) != flashSchedCb.runBank) {
+        while(len) {
+            chunk = (len < (FLASH_SCHED_DATA_LEN / 2)) ? len : (FLASH_SCHED_DATA_LEN / 2);
+
+            while((flashSchedCb.count == FLASH_SCHED_QUEUE_LEN) ||
+                  ((uint32_t)(FLASH_SCHED_DATA_LEN - flashSchedCb.dataUsed) < chunk)) {
+                flashSchedWait();
+            }
+
+            WsfCsEnter();
+            pos = (flashSchedCb.dataHead + flashSchedCb.dataUsed) % FLASH_SCHED_DATA_LEN;
+            for(i = 0; i < chunk; i++) {
+                flashSchedCb.data[pos] = p[i];
+                pos = (pos + 1) % FLASH_SCHED_DATA_LEN;
+            }
+            flashSchedCb.dataUsed += chunk;
+            flashSchedQueue(FLASH_SCHED_OP_WRITE, addr, chunk, (chunk == len) ? cback : NULL);
+            WsfCsExit();
+
+            addr += chunk;
+            p += chunk;
+            len -= chunk;
+        }
+
+        return E_NO_ERROR;
+    }
+
+    /* Running bank, keep the order and program in a radio gap */
+    if((err = FlashSchedFlush()) == E_NO_ERROR) {
+        flashSchedWaitGap(((len / FLASH_SCHED_LINE_LEN) + 2) * FLASH_SCHED_WRITE_USEC);
+        err = MXC_FLC_Write(addr, len, (uint32_t*)p);
+    }
+
+    if(cback != NULL) {
+        cback(err);
+    }
+
+    return err;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for all queued operations to finish.
+ *
+ *  \return E_NO_ERROR, or the first error since the last call.
+ */
+/*************************************************************************************************/
+int FlashSchedFlush(void)
+{
+    int err;
+
+    while(flashSchedCb.count) {
+        flashSchedWait();
+    }
+
+    WsfCsEnter();
+    err = flashSchedCb.err;
+    flashSchedCb.err = E_NO_ERROR;
+    WsfCsExit();
+
+    return err;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether queued operations still cover a range.
+ *
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range must not be read yet.
+ */
+/*************************************************************************************************/
+bool_t FlashSchedPending(uint32_t addr, uint32_t len)
+{
+    flashSchedOp_t *pOp;
+    bool_t pending = FALSE;
+    uint8_t i;
+
+    WsfCsEnter();
+    for(i = 0; (i < flashSchedCb.count) && !pending; i++) {
+        pOp = &flashSchedCb.queue[(flashSchedCb.head + i) % FLASH_SCHED_QUEUE_LEN];
+        pending = (addr < (pOp->addr + pOp->len)) && (pOp->addr < (addr + len));
+    }
+    WsfCsExit();
+
+    return pending;
+}
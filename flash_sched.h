@@ -0,0 +1,140 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Bank aware flash operation scheduler.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef FLASH_SCHED_H
+#define FLASH_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+  Constant Definitions
+**************************************************************************************************/
+
+/*! \brief Number of queued operations */
+#ifndef FLASH_SCHED_QUEUE_LEN
+#define FLASH_SCHED_QUEUE_LEN     8
+#endif
+
+/*! \brief Bytes of write data buffered for the idle bank */
+#ifndef FLASH_SCHED_DATA_LEN
+#define FLASH_SCHED_DATA_LEN      2048
+#endif
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Operation complete callback, called from the flash controller interrupt.
+ *
+ *  \param  err      E_NO_ERROR, or the first error since the last FlashSchedFlush().
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+typedef void flashSchedCback_t(int err);
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize the flash scheduler.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FlashSchedInit(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Restore the link layer settings of the scheduler after a reset.
+ *
+ *  Slave latency is held off on all connections, so a link configured with latency runs every
+ *  event, until a running bank erase needs a gap. Call when the link layer reset completes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FlashSchedLinkReset(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase flash pages.
+ *
+ *  Pages in the bank code is not running from are erased in the background. Pages in the
+ *  running bank stall the CPU, so they are erased at once, in a gap between radio events
+ *  where possible. Slave latency is allowed meanwhile, so links need some to leave a gap.
+ *
+ *  \param  addr     Page aligned address.
+ *  \param  len      Number of bytes, multiple of the page size.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued or done, E_BAD_PARAM for a bad range, or the erase error.
+ */
+/*************************************************************************************************/
+int FlashSchedErase(uint32_t addr, uint32_t len, flashSchedCback_t *cback);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Program flash.
+ *
+ *  Data for the bank code is not running from is copied and programmed in the background,
+ *  waiting for buffer space if needed. Data for the running bank is programmed at once.
+ *
+ *  \param  addr     Address, any alignment.
+ *  \param  pBuf     Data to program.
+ *  \param  len      Number of bytes.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued or done, E_BAD_PARAM for a bad range, or the write error.
+ */
+/*************************************************************************************************/
+int FlashSchedWrite(uint32_t addr, const void *pBuf, uint32_t len, flashSchedCback_t *cback);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for all queued operations to finish.
+ *
+ *  \return E_NO_ERROR, or the first error since the last call.
+ */
+/*************************************************************************************************/
+int FlashSchedFlush(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether queued operations still cover a range.
+ *
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range must not be read yet.
+ */
+/*************************************************************************************************/
+bool_t FlashSchedPending(uint32_t addr, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_SCHED_H */
@@ -0,0 +1,281 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Memory usage telemetry.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "mxc_device.h"
+#include "wsf_types.h"
+#include "wsf_buf.h"
+#include "wsf_heap.h"
+#include "wsf_math.h"
+#include "util/bstream.h"
+#include "util/terminal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mem_stats.h"
+
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+#include "ll_api.h"
+#endif
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Fill pattern for unused main stack */
+#define MEM_STATS_STACK_FILL      0xDEADBEEF
+
+/* Main stack left unmarked below the stack pointer at init */
+#define MEM_STATS_STACK_MARGIN    64
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+extern uint32_t __StackLimit;
+extern uint32_t __StackTop;
+
+/* Least FreeRTOS heap free, heap_2 does not record it */
+static size_t memStatsHeapMinFree = configTOTAL_HEAP_SIZE;
+
+static uint8_t memStatsTerminalHandler(uint32_t argc, char **argv);
+
+static terminalCommand_t memStatsTerminal = { NULL, "mem", "mem [bin]", memStatsTerminalHandler };
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Record the FreeRTOS heap low-water mark, called from traceMALLOC.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsHeapTrace(void)
+{
+    size_t heapFree = xPortGetFreeHeapSize();
+
+    if(heapFree < memStatsHeapMinFree) {
+        memStatsHeapMinFree = heapFree;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start memory telemetry and register the "mem" terminal command.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsInit(void)
+{
+    volatile uint32_t *pStack = &__StackLimit;
+    uint32_t *pEnd = (uint32_t *)(__get_MSP() - MEM_STATS_STACK_MARGIN);
+
+    /* Mark the unused main stack to find its high-water mark later */
+    while(pStack < pEnd) {
+        *pStack++ = MEM_STATS_STACK_FILL;
+    }
+
+    TerminalRegisterCommand(&memStatsTerminal);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Take a memory usage snapshot.
+ *
+ *  \param  pStats  Snapshot to fill in.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsGet(memStats_t *pStats)
+{
+    TaskStatus_t *pTaskStatus;
+    UBaseType_t numTasks;
+    size_t heapMinFree;
+    WsfBufPoolStat_t poolStat;
+    const uint32_t *pStack = &__StackLimit;
+    uint8_t i;
+
+    memset(pStats, 0, sizeof(memStats_t));
+
+    pStats->rtosHeapSize = configTOTAL_HEAP_SIZE;
+    pStats->rtosHeapFree = xPortGetFreeHeapSize();
+    pStats->rtosHeapMinFree = memStatsHeapMinFree;
+
+    pStats->wsfHeapUsed = WsfHeapCountUsed();
+    pStats->wsfHeapAvail = WsfHeapCountAvailable();
+
+    while((pStack < &__StackTop) && (*pStack == MEM_STATS_STACK_FILL)) {
+        pStack++;
+    }
+    pStats->isrStackSize = (uint32_t)&__StackTop - (uint32_t)&__StackLimit;
+    pStats->isrStackPeak = (uint32_t)&__StackTop - (uint32_t)pStack;
+
+#if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
+    pStats->aclTxBufs = LlGetAclTxBufs();
+    pStats->aclRxBufs = LlGetAclRxBufs();
+    LlGetAclBufUsage(&pStats->aclTxUsed, &pStats->aclTxPeak, &pStats->aclRxUsed, &pStats->aclRxPeak);
+#endif
+
+    pStats->numPools = WSF_MIN(WsfBufGetNumPool(), MEM_STATS_MAX_POOLS);
+    for(i = 0; i < pStats->numPools; i++) {
+        WsfBufGetPoolStats(&poolStat, i);
+        pStats->pool[i].len = poolStat.bufSize;
+        pStats->pool[i].num = poolStat.numBuf;
+        pStats->pool[i].used = poolStat.numAlloc;
+        pStats->pool[i].peak = poolStat.maxAlloc;
+    }
+
+    /* uxTaskGetSystemState() reports nothing into an array shorter than the task list,
+     * size it from the task count with the scheduler held so the count cannot change */
+    vTaskSuspendAll();
+    heapMinFree = memStatsHeapMinFree;
+    numTasks = uxTaskGetNumberOfTasks();
+    pTaskStatus = pvPortMalloc(numTasks * sizeof(TaskStatus_t));
+    if(pTaskStatus != NULL) {
+        pStats->numTasks = (uint8_t)WSF_MIN(uxTaskGetSystemState(pTaskStatus, numTasks, NULL),
+                                            MEM_STATS_MAX_TASKS);
+        for(i = 0; i < pStats->numTasks; i++) {
+            pStats->task[i].pName = pTaskStatus[i].pcTaskName;
+            pStats->task[i].minFree = pTaskStatus[i].usStackHighWaterMark * sizeof(StackType_t);
+        }
+        vPortFree(pTaskStatus);
+    }
+    /* The snapshot's own array does not count towards the heap low-water mark */
+    memStatsHeapMinFree = heapMinFree;
+    (void)xTaskResumeAll();
+
+    pStats->tasksOmitted = (uint8_t)WSF_MIN(numTasks - pStats->numTasks, UINT8_MAX);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Pack a snapshot into a little endian binary record.
+ *
+ *  \param  pBuf    Buffer of at least MEM_STATS_REC_MAX_LEN bytes.
+ *  \param  pStats  Snapshot.
+ *
+ *  \return Record length.
+ */
+/*************************************************************************************************/
+uint16_t MemStatsPack(uint8_t *pBuf, const memStats_t *pStats)
+{
+    uint8_t *p = pBuf;
+    uint8_t i;
+
+    UINT8_TO_BSTREAM(p, MEM_STATS_VERSION);
+    UINT8_TO_BSTREAM(p, pStats->numPools);
+    UINT8_TO_BSTREAM(p, pStats->numTasks);
+    UINT8_TO_BSTREAM(p, pStats->tasksOmitted);
+
+    UINT32_TO_BSTREAM(p, pStats->rtosHeapSize);
+    UINT32_TO_BSTREAM(p, pStats->rtosHeapFree);
+    UINT32_TO_BSTREAM(p, pStats->rtosHeapMinFree);
+    UINT32_TO_BSTREAM(p, pStats->wsfHeapUsed);
+    UINT32_TO_BSTREAM(p, pStats->wsfHeapAvail);
+    UINT32_TO_BSTREAM(p, pStats->isrStackSize);
+    UINT32_TO_BSTREAM(p, pStats->isrStackPeak);
+
+    UINT8_TO_BSTREAM(p, pStats->aclTxBufs);
+    UINT8_TO_BSTREAM(p, pStats->aclTxUsed);
+    UINT8_TO_BSTREAM(p, pStats->aclTxPeak);
+    UINT8_TO_BSTREAM(p, pStats->aclRxBufs);
+    UINT8_TO_BSTREAM(p, pStats->aclRxUsed);
+    UINT8_TO_BSTREAM(p, pStats->aclRxPeak);
+
+    for(i = 0; i < pStats->numPools; i++) {
+        UINT16_TO_BSTREAM(p, pStats->pool[i].len);
+        UINT8_TO_BSTREAM(p, pStats->pool[i].num);
+        UINT8_TO_BSTREAM(p, pStats->pool[i].used);
+        UINT8_TO_BSTREAM(p, pStats->pool[i].peak);
+    }
+
+    for(i = 0; i < pStats->numTasks; i++) {
+        /* Name truncated or zero padded */
+        memset(p, 0, MEM_STATS_NAME_LEN);
+        strncpy((char *)p, pStats->task[i].pName, MEM_STATS_NAME_LEN);
+        p += MEM_STATS_NAME_LEN;
+        UINT32_TO_BSTREAM(p, pStats->task[i].minFree);
+    }
+
+    return (uint16_t)(p - pBuf);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Handler for the memory telemetry terminal command.
+ *
+ *  \param  argc      The number of arguments passed to the command.
+ *  \param  argv      The array of arguments; the 0th argument is the command.
+ *
+ *  \return Error code.
+ */
+/*************************************************************************************************/
+static uint8_t memStatsTerminalHandler(uint32_t argc, char **argv)
+{
+    static memStats_t stats;
+    uint8_t rec[MEM_STATS_REC_MAX_LEN];
+    uint16_t len;
+    uint8_t i;
+
+    if(argc > 2) {
+        return TERMINAL_ERROR_TOO_MANY_ARGUMENTS;
+    }
+
+    MemStatsGet(&stats);
+
+    if(argc == 2) {
+        if(strcmp(argv[1], "bin") != 0) {
+            return TERMINAL_ERROR_BAD_ARGUMENTS;
+        }
+
+        len = MemStatsPack(rec, &stats);
+        TerminalTxStr("mem ");
+        for(i = 0; i < len; i++) {
+            TerminalTxPrint("%02x", rec[i]);
+        }
+        TerminalTxStr(TERMINAL_STRING_NEW_LINE);
+        return TERMINAL_ERROR_OK;
+    }
+
+    TerminalTxPrint("rtos heap: %u free of %u, least %u" TERMINAL_STRING_NEW_LINE,
+                    stats.rtosHeapFree, stats.rtosHeapSize, stats.rtosHeapMinFree);
+    TerminalTxPrint("wsf heap: %u used, %u left" TERMINAL_STRING_NEW_LINE,
+                    stats.wsfHeapUsed, stats.wsfHeapAvail);
+    TerminalTxPrint("isr stack: peak %u of %u" TERMINAL_STRING_NEW_LINE,
+                    stats.isrStackPeak, stats.isrStackSize);
+    TerminalTxPrint("ll acl tx: %u used, peak %u of %u" TERMINAL_STRING_NEW_LINE,
+                    stats.aclTxUsed, stats.aclTxPeak, stats.aclTxBufs);
+    TerminalTxPrint("ll acl rx: %u used, peak %u of %u" TERMINAL_STRING_NEW_LINE,
+                    stats.aclRxUsed, stats.aclRxPeak, stats.aclRxBufs);
+
+    for(i = 0; i < stats.numPools; i++) {
+        TerminalTxPrint("pool %u: len %u, %u used, peak %u of %u" TERMINAL_STRING_NEW_LINE, i,
+                        stats.pool[i].len, stats.pool[i].used, stats.pool[i].peak, stats.pool[i].num);
+    }
+
+    for(i = 0; i < stats.numTasks; i++) {
+        TerminalTxPrint("task %s: stack least free %u" TERMINAL_STRING_NEW_LINE,
+                        stats.task[i].pName, stats.task[i].minFree);
+    }
+    if(stats.tasksOmitted != 0) {
+        TerminalTxPrint("%u more tasks not shown" TERMINAL_STRING_NEW_LINE, stats.tasksOmitted);
+    }
+
+    return TERMINAL_ERROR_OK;
+}
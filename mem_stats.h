@@ -0,0 +1,141 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Memory usage telemetry.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+  Constant Definitions
+**************************************************************************************************/
+
+/*! \brief Binary record format version */
+#define MEM_STATS_VERSION         2
+
+/*! \brief Maximum number of WSF buffer pools reported */
+#define MEM_STATS_MAX_POOLS       8
+
+/*! \brief Maximum number of tasks reported */
+#define MEM_STATS_MAX_TASKS       8
+
+/*! \brief Task name length in the binary record */
+#define MEM_STATS_NAME_LEN        8
+
+/*! \brief Maximum binary record length */
+#define MEM_STATS_REC_MAX_LEN     (4 + 7 * 4 + 6 + (MEM_STATS_MAX_POOLS * 5) + \
+                                   (MEM_STATS_MAX_TASKS * (MEM_STATS_NAME_LEN + 4)))
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief WSF buffer pool usage */
+typedef struct
+{
+    uint16_t  len;                    /*!< \brief Buffer length */
+    uint8_t   num;                    /*!< \brief Number of buffers */
+    uint8_t   used;                   /*!< \brief Buffers allocated */
+    uint8_t   peak;                   /*!< \brief Most buffers allocated at once */
+} memStatsPool_t;
+
+/*! \brief Task stack usage */
+typedef struct
+{
+    const char *pName;                /*!< \brief Task name */
+    uint32_t  minFree;                /*!< \brief Least free stack in bytes */
+} memStatsTask_t;
+
+/*! \brief Memory usage snapshot */
+typedef struct
+{
+    uint32_t  rtosHeapSize;           /*!< \brief FreeRTOS heap size */
+    uint32_t  rtosHeapFree;           /*!< \brief FreeRTOS heap free */
+    uint32_t  rtosHeapMinFree;        /*!< \brief Least FreeRTOS heap free */
+    uint32_t  wsfHeapUsed;            /*!< \brief WSF heap used, allocated once at startup */
+    uint32_t  wsfHeapAvail;           /*!< \brief WSF heap left */
+    uint32_t  isrStackSize;           /*!< \brief Main stack size, used by interrupts */
+    uint32_t  isrStackPeak;           /*!< \brief Most main stack used */
+    uint8_t   aclTxBufs;              /*!< \brief Link layer ACL transmit buffers */
+    uint8_t   aclTxUsed;              /*!< \brief Transmit buffers in use */
+    uint8_t   aclTxPeak;              /*!< \brief Most transmit buffers in use at once */
+    uint8_t   aclRxBufs;              /*!< \brief Link layer ACL receive buffers */
+    uint8_t   aclRxUsed;              /*!< \brief Receive buffers in use */
+    uint8_t   aclRxPeak;              /*!< \brief Most receive buffers in use at once */
+    uint8_t   numPools;               /*!< \brief Number of pools in pool */
+    uint8_t   numTasks;               /*!< \brief Number of tasks in task */
+    uint8_t   tasksOmitted;           /*!< \brief Tasks not reported in task */
+    memStatsPool_t pool[MEM_STATS_MAX_POOLS];   /*!< \brief WSF buffer pools */
+    memStatsTask_t task[MEM_STATS_MAX_TASKS];   /*!< \brief FreeRTOS tasks */
+} memStats_t;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start memory telemetry and register the "mem" terminal command.
+ *
+ *  Must be called before the scheduler starts, to mark the unused main stack.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsInit(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Take a memory usage snapshot.
+ *
+ *  \param  pStats  Snapshot to fill in.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsGet(memStats_t *pStats);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Pack a snapshot into a little endian binary record.
+ *
+ *  \param  pBuf    Buffer of at least MEM_STATS_REC_MAX_LEN bytes.
+ *  \param  pStats  Snapshot.
+ *
+ *  \return Record length.
+ */
+/*************************************************************************************************/
+uint16_t MemStatsPack(uint8_t *pBuf, const memStats_t *pStats);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Record the FreeRTOS heap low-water mark, called from traceMALLOC.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void MemStatsHeapTrace(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MEM_STATS_H */
@@ -0,0 +1,206 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host benchmark of the device database record lookups of app_db.c.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wsf_types.h"
+#include "app_api.h"
+#include "app_cfg.h"
+#include "app_db.h"
+
+/*
+ * All APP_DB_NUM_RECS records are bonded with random addresses and local LTKs, then records are
+ * deleted and created again in random order so the index chains are not in creation order. The
+ * program times AppDbFindByAddr() and AppDbFindByLtkReq() on each record in turn, and
+ * AppDbFindByAddr() on an address not in the database, the lookup made for every new peer.
+ * Odd records are created with a random address type. The fastest of several runs is reported.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Records deleted and created again before timing */
+#define APP_DB_BENCH_CHURN      1000
+
+/* Lookups per timed loop */
+#define APP_DB_BENCH_LOOKUPS    2000000
+
+/* Timed runs */
+#define APP_DB_BENCH_RUNS       5
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Keys of a record */
+typedef struct {
+    uint8_t   addr[BDA_ADDR_LEN];       /* Peer address */
+    uint16_t  ediv;                     /* Local LTK EDIV */
+    uint8_t   rand[SMP_RAND8_LEN];      /* Local LTK Rand */
+} appDbBenchKey_t;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+static appDbBenchKey_t appDbBenchKey[APP_DB_NUM_RECS];
+static appDbHdl_t appDbBenchHdl[APP_DB_NUM_RECS];
+
+/* Keeps the lookups from being optimized out */
+static volatile uintptr_t appDbBenchSink;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the monotonic time.
+ *
+ *  \return Time in nanoseconds.
+ */
+/*************************************************************************************************/
+static double appDbBenchNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create the bonded record of a peer.
+ *
+ *  \param  i        Record index.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbBenchBond(unsigned i)
+{
+    appDbBenchKey_t *pKey = &appDbBenchKey[i];
+    dmSecKeyIndEvt_t keyInd;
+
+    appDbBenchHdl[i] = AppDbNewRecord((i & 1) ? DM_ADDR_RANDOM : DM_ADDR_PUBLIC, pKey->addr);
+
+    memset(&keyInd, 0, sizeof(keyInd));
+    keyInd.type = DM_KEY_LOCAL_LTK;
+    keyInd.keyData.ltk.ediv = pKey->ediv;
+    memcpy(keyInd.keyData.ltk.rand, pKey->rand, SMP_RAND8_LEN);
+    AppDbSetKey(appDbBenchHdl[i], &keyInd);
+    AppDbValidateRecord(appDbBenchHdl[i], DM_KEY_LOCAL_LTK);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check that every record is found by both keys.
+ *
+ *  \return TRUE if all found.
+ */
+/*************************************************************************************************/
+static bool_t appDbBenchCheck(void)
+{
+    unsigned i;
+
+    for(i = 0; i < APP_DB_NUM_RECS; i++) {
+        appDbBenchKey_t *pKey = &appDbBenchKey[i];
+
+        if((AppDbFindByAddr((i & 1) ? DM_ADDR_RANDOM : DM_ADDR_PUBLIC, pKey->addr) != appDbBenchHdl[i]) ||
+           (AppDbFindByLtkReq(pKey->ediv, pKey->rand) != appDbBenchHdl[i])) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the benchmark.
+ */
+/*************************************************************************************************/
+int main(void)
+{
+    static uint8_t missAddr[BDA_ADDR_LEN] = { 0xAA, 0xBB, 0x00, 0x00, 0x00, 0x01 };
+    double addrNs = 0, ltkNs = 0, missNs = 0;
+    double t0, t1, t2, t3;
+    unsigned i, j, n, run;
+
+    srand(1);
+    AppDbInit();
+
+    for(i = 0; i < APP_DB_NUM_RECS; i++) {
+        for(j = 0; j < BDA_ADDR_LEN; j++) {
+            appDbBenchKey[i].addr[j] = (uint8_t)rand();
+        }
+        appDbBenchKey[i].ediv = (uint16_t)rand();
+        for(j = 0; j < SMP_RAND8_LEN; j++) {
+            appDbBenchKey[i].rand[j] = (uint8_t)rand();
+        }
+        appDbBenchBond(i);
+    }
+
+    for(n = 0; n < APP_DB_BENCH_CHURN; n++) {
+        i = (unsigned)rand() % APP_DB_NUM_RECS;
+        AppDbDeleteRecord(appDbBenchHdl[i]);
+        appDbBenchBond(i);
+    }
+
+    if(!appDbBenchCheck() || (AppDbFindByAddr(DM_ADDR_PUBLIC, missAddr) != APP_DB_HDL_NONE)) {
+        fprintf(stderr, "lookup returned the wrong record\n");
+        return 1;
+    }
+
+    for(run = 0; run < APP_DB_BENCH_RUNS; run++) {
+        t0 = appDbBenchNow();
+        for(n = 0; n < APP_DB_BENCH_LOOKUPS; n++) {
+            i = n % APP_DB_NUM_RECS;
+            appDbBenchSink += (uintptr_t)AppDbFindByAddr((i & 1) ? DM_ADDR_RANDOM : DM_ADDR_PUBLIC,
+                                                         appDbBenchKey[i].addr);
+        }
+        t1 = appDbBenchNow();
+        for(n = 0; n < APP_DB_BENCH_LOOKUPS; n++) {
+            i = n % APP_DB_NUM_RECS;
+            appDbBenchSink += (uintptr_t)AppDbFindByLtkReq(appDbBenchKey[i].ediv, appDbBenchKey[i].rand);
+        }
+        t2 = appDbBenchNow();
+        for(n = 0; n < APP_DB_BENCH_LOOKUPS; n++) {
+            appDbBenchSink += (uintptr_t)AppDbFindByAddr(DM_ADDR_PUBLIC, missAddr);
+        }
+        t3 = appDbBenchNow();
+
+        if((run == 0) || (t1 - t0 < addrNs)) {
+            addrNs = t1 - t0;
+        }
+        if((run == 0) || (t2 - t1 < ltkNs)) {
+            ltkNs = t2 - t1;
+        }
+        if((run == 0) || (t3 - t2 < missNs)) {
+            missNs = t3 - t2;
+        }
+    }
+
+    printf("%3u records  address %6.1f ns  LTK %6.1f ns  unknown address %6.1f ns\n",
+           APP_DB_NUM_RECS, addrNs / APP_DB_BENCH_LOOKUPS, ltkNs / APP_DB_BENCH_LOOKUPS,
+           missNs / APP_DB_BENCH_LOOKUPS);
+
+    return 0;
+}
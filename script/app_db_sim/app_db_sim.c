@@ -0,0 +1,278 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  RAM NVM for host tests of the device database.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_nvm.h"
+#include "wsf_os.h"
+#include "wsf_timer.h"
+#include "dm_api.h"
+#include "app_db_sim.h"
+
+/*
+ * WsfNvm on RAM, one entry per identifier, and the few other functions app_db.c calls. A read
+ * only succeeds with the length the entry was written with, as with wsf_nvm.c on flash.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Entries stored */
+#define APP_DB_SIM_MAX_ENTRIES  1024
+
+/* Largest entry */
+#define APP_DB_SIM_MAX_LEN      512
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* NVM entry */
+typedef struct {
+    uint64_t  id;                       /* Identifier */
+    uint16_t  len;                      /* Data length */
+    bool_t    used;                     /* TRUE if stored */
+    uint8_t   data[APP_DB_SIM_MAX_LEN]; /* Data */
+} appDbSimEntry_t;
+
+/**************************************************************************************************
+  Global Variables
+**************************************************************************************************/
+
+/* Handler of the flush timer, app_main.c */
+wsfHandlerId_t appHandlerId;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+static appDbSimEntry_t appDbSimNvm[APP_DB_SIM_MAX_ENTRIES];
+static appDbSimStats_t appDbSimStats;
+static uint32_t appDbSimFailCount;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find a stored entry.
+ *
+ *  \param  id       NVM identifier.
+ *
+ *  \return Entry or NULL.
+ */
+/*************************************************************************************************/
+static appDbSimEntry_t *appDbSimFind(uint64_t id)
+{
+    unsigned i;
+
+    for(i = 0; i < APP_DB_SIM_MAX_ENTRIES; i++) {
+        if(appDbSimNvm[i].used && (appDbSimNvm[i].id == id)) {
+            return &appDbSimNvm[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase the RAM NVM and clear the statistics.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSimReset(void)
+{
+    memset(appDbSimNvm, 0, sizeof(appDbSimNvm));
+    memset(&appDbSimStats, 0, sizeof(appDbSimStats));
+    appDbSimFailCount = 0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Cut the next writes short.
+ *
+ *  \param  count    Number of writes to cut short.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSimFailWrites(uint32_t count)
+{
+    appDbSimFailCount = count;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check if an entry is stored.
+ *
+ *  \param  id       NVM identifier.
+ *
+ *  \return TRUE if stored.
+ */
+/*************************************************************************************************/
+bool_t AppDbSimStored(uint64_t id)
+{
+    return appDbSimFind(id) != NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const appDbSimStats_t *AppDbSimGetStats(void)
+{
+    return &appDbSimStats;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Read an entry.
+ *
+ *  \param  id       NVM identifier.
+ *  \param  pData    Buffer.
+ *  \param  len      Entry length.
+ *  \param  compCback Unused.
+ *
+ *  \return TRUE if read.
+ */
+/*************************************************************************************************/
+bool_t WsfNvmReadData(uint64_t id, uint8_t *pData, uint16_t len, WsfNvmCompEvent_t compCback)
+{
+    appDbSimEntry_t *pEntry = appDbSimFind(id);
+
+    if((pEntry == NULL) || (pEntry->len != len)) {
+        return FALSE;
+    }
+
+    memcpy(pData, pEntry->data, len);
+    return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write an entry, replacing the stored one.
+ *
+ *  \param  id       NVM identifier.
+ *  \param  pData    Data.
+ *  \param  len      Data length.
+ *  \param  compCback Unused.
+ *
+ *  \return TRUE if written.
+ */
+/*************************************************************************************************/
+bool_t WsfNvmWriteData(uint64_t id, const uint8_t *pData, uint16_t len, WsfNvmCompEvent_t compCback)
+{
+    appDbSimEntry_t *pEntry = appDbSimFind(id);
+    unsigned i;
+
+    appDbSimStats.writes++;
+
+    /* The previous data is gone once the write starts */
+    if(pEntry != NULL) {
+        pEntry->used = FALSE;
+    }
+
+    if((appDbSimFailCount > 0) || (len > APP_DB_SIM_MAX_LEN)) {
+        if(appDbSimFailCount > 0) {
+            appDbSimFailCount--;
+        }
+        return FALSE;
+    }
+
+    for(i = 0; i < APP_DB_SIM_MAX_ENTRIES; i++) {
+        if(!appDbSimNvm[i].used) {
+            appDbSimNvm[i].id = id;
+            appDbSimNvm[i].len = len;
+            appDbSimNvm[i].used = TRUE;
+            memcpy(appDbSimNvm[i].data, pData, len);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase an entry.
+ *
+ *  \param  id       NVM identifier.
+ *  \param  compCback Unused.
+ *
+ *  \return TRUE.
+ */
+/*************************************************************************************************/
+bool_t WsfNvmEraseData(uint64_t id, WsfNvmCompEvent_t compCback)
+{
+    appDbSimEntry_t *pEntry = appDbSimFind(id);
+
+    if(pEntry != NULL) {
+        pEntry->used = FALSE;
+        appDbSimStats.erases++;
+    }
+
+    return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start a timer. Timers never expire, the test flushes instead.
+ *
+ *  \param  pTimer   Timer.
+ *  \param  ms       Timeout.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WsfTimerStartMs(wsfTimer_t *pTimer, wsfTimerTicks_t ms)
+{
+    pTimer->isStarted = TRUE;
+    appDbSimStats.timerStarts++;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Stop a timer.
+ *
+ *  \param  pTimer   Timer.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WsfTimerStop(wsfTimer_t *pTimer)
+{
+    pTimer->isStarted = FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Map an address type to a type used by Host, without LL privacy.
+ *
+ *  \param  addrType   Address type used by LL.
+ *
+ *  \return Address type used by Host.
+ */
+/*************************************************************************************************/
+uint8_t DmHostAddrType(uint8_t addrType)
+{
+    return addrType;
+}
@@ -0,0 +1,90 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  RAM NVM for host tests of the device database.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef APP_DB_SIM_H
+#define APP_DB_SIM_H
+
+#include "wsf_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief RAM NVM statistics */
+typedef struct
+{
+    uint32_t  writes;                 /*!< \brief WsfNvmWriteData() calls */
+    uint32_t  erases;                 /*!< \brief WsfNvmEraseData() calls on stored entries */
+    uint32_t  timerStarts;            /*!< \brief WsfTimerStartMs() calls */
+} appDbSimStats_t;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase the RAM NVM and clear the statistics.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSimReset(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Cut the next writes short, as a reset during the write would. The entry written is
+ *          left erased and the write fails.
+ *
+ *  \param  count    Number of writes to cut short.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void AppDbSimFailWrites(uint32_t count);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check if an entry is stored.
+ *
+ *  \param  id       NVM identifier.
+ *
+ *  \return TRUE if stored.
+ */
+/*************************************************************************************************/
+bool_t AppDbSimStored(uint64_t id);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const appDbSimStats_t *AppDbSimGetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_DB_SIM_H */
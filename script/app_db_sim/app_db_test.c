@@ -0,0 +1,420 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host test of the device database NVM storage of app_db.c on a RAM NVM.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_nvm.h"
+#include "app_api.h"
+#include "app_cfg.h"
+#include "app_db.h"
+#include "app_db_sim.h"
+
+/*
+ * A reset is modelled by clearing the records in RAM and reading them back with
+ * AppDbNvmReadAll(). The flush timer never expires, AppDbNvmFlush() is called as the
+ * APP_DB_NVM_FLUSH_IND handler would. The Makefile builds with more records than the 32 that fit
+ * below the hash cache in the NVM layout of earlier versions.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Records stored one parameter per entry by earlier versions, see app_db.c */
+#define APP_DB_TEST_LEGACY_ID(p, i)   (0x1000 + (64 * (i)) + (p))
+#define APP_DB_TEST_PEER_ADDR_ID      1
+#define APP_DB_TEST_ADDR_TYPE_ID      2
+#define APP_DB_TEST_KV_MASK_ID        5
+#define APP_DB_TEST_VALID_ID          6
+#define APP_DB_TEST_CCC_TBL_ID        13
+
+/* Packed records, two slots per record */
+#define APP_DB_TEST_PACKED_ID(i, s)   (0x9000 + (2 * (i)) + (s))
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Tests failed */
+static int appDbTestFailures;
+
+/* Peer addresses */
+static uint8_t appDbTestAddr[][BDA_ADDR_LEN] = {
+    { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 },
+    { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16 },
+    { 0x21, 0x22, 0x23, 0x24, 0x25, 0x26 }
+};
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Clear the records in RAM and read them from NVM, as after a reset.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbTestReset(void)
+{
+    AppDbDeleteAllRecords();
+    AppDbNvmReadAll();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start with an empty NVM and no records.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbTestStart(void)
+{
+    AppDbSimReset();
+    appDbTestReset();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create a bonded record.
+ *
+ *  \param  pAddr    Peer address.
+ *
+ *  \return Record handle.
+ */
+/*************************************************************************************************/
+static appDbHdl_t appDbTestBond(uint8_t *pAddr)
+{
+    appDbHdl_t hdl = AppDbNewRecord(DM_ADDR_PUBLIC, pAddr);
+
+    AppDbValidateRecord(hdl, DM_KEY_LOCAL_LTK);
+    AppDbNvmStoreBond(hdl);
+
+    return hdl;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the first CCCD value of the record of a peer.
+ *
+ *  \param  pAddr    Peer address.
+ *
+ *  \return CCCD value, or 0xFFFF if there is no record.
+ */
+/*************************************************************************************************/
+static uint16_t appDbTestCcc(uint8_t *pAddr)
+{
+    appDbHdl_t hdl = AppDbFindByAddr(DM_ADDR_PUBLIC, pAddr);
+
+    return (hdl == APP_DB_HDL_NONE) ? 0xFFFF : AppDbGetCccTbl(hdl)[0];
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store a record in the NVM layout of earlier versions.
+ *
+ *  \param  i        Record index.
+ *  \param  pAddr    Peer address.
+ *  \param  ccc      First CCCD value.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbTestStoreLegacy(uint8_t i, uint8_t *pAddr, uint16_t ccc)
+{
+    uint16_t cccTbl[APP_DB_NUM_CCCD] = { ccc };
+    bool_t valid = TRUE;
+    uint8_t addrType = DM_ADDR_PUBLIC;
+    uint8_t keyMask = 0;
+
+    WsfNvmWriteData(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_VALID_ID, i), &valid, sizeof(valid), NULL);
+    WsfNvmWriteData(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_PEER_ADDR_ID, i), pAddr, BDA_ADDR_LEN, NULL);
+    WsfNvmWriteData(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_ADDR_TYPE_ID, i), &addrType, 1, NULL);
+    WsfNvmWriteData(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_KV_MASK_ID, i), &keyMask, 1, NULL);
+    WsfNvmWriteData(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_CCC_TBL_ID, i), (uint8_t *) cccTbl,
+                    sizeof(cccTbl), NULL);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Changes to a record between flushes are written once, unchanged records not at all.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *appDbTestCoalesce(void)
+{
+    const appDbSimStats_t *pStats = AppDbSimGetStats();
+    appDbHdl_t hdl;
+
+    appDbTestStart();
+
+    hdl = appDbTestBond(appDbTestAddr[0]);
+    if(pStats->writes != 1) {
+        return "bond not written";
+    }
+
+    AppDbSetCccTblValue(hdl, 0, 1);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbSetPeerSignCounter(hdl, 7);
+    AppDbNvmStorePeerSignCounter(hdl);
+    AppDbSetPeerRpao(hdl, TRUE);
+    AppDbNvmStorePeerRpao(hdl);
+    if((pStats->writes != 1) || (pStats->timerStarts != 1)) {
+        return "changes written before the flush";
+    }
+
+    AppDbNvmFlush();
+    if(pStats->writes != 2) {
+        return "changes not written in one write";
+    }
+
+    AppDbNvmFlush();
+    if(pStats->writes != 2) {
+        return "flush without changes wrote";
+    }
+
+    /* Stores of values that did not change */
+    AppDbSetCccTblValue(hdl, 0, 1);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbNvmStorePeerSignCounter(hdl);
+    AppDbNvmFlush();
+    AppDbNvmStoreBond(hdl);
+    if(pStats->writes != 2) {
+        return "unchanged record written";
+    }
+
+    appDbTestReset();
+    hdl = AppDbFindByAddr(DM_ADDR_PUBLIC, appDbTestAddr[0]);
+    if((hdl == APP_DB_HDL_NONE) || (AppDbGetCccTbl(hdl)[0] != 1) ||
+       (AppDbGetPeerSignCounter(hdl) != 7) || !AppDbGetPeerRpao(hdl)) {
+        return "record not read back";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  A write cut short leaves the previous version of the record, and is retried.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *appDbTestInterrupted(void)
+{
+    appDbHdl_t hdl;
+
+    appDbTestStart();
+
+    hdl = appDbTestBond(appDbTestAddr[0]);
+    AppDbSetCccTblValue(hdl, 0, 1);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbNvmFlush();
+
+    AppDbSetCccTblValue(hdl, 0, 2);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbSimFailWrites(1);
+    AppDbNvmFlush();
+
+    appDbTestReset();
+    if(appDbTestCcc(appDbTestAddr[0]) != 1) {
+        return "previous version lost";
+    }
+
+    /* The change is written by the next flush when the reset does not come */
+    hdl = AppDbFindByAddr(DM_ADDR_PUBLIC, appDbTestAddr[0]);
+    AppDbSetCccTblValue(hdl, 0, 2);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbSimFailWrites(1);
+    AppDbNvmFlush();
+    AppDbNvmFlush();
+
+    appDbTestReset();
+    if(appDbTestCcc(appDbTestAddr[0]) != 2) {
+        return "failed write not retried";
+    }
+
+    /* Both slots in turn */
+    hdl = AppDbFindByAddr(DM_ADDR_PUBLIC, appDbTestAddr[0]);
+    AppDbSetCccTblValue(hdl, 0, 3);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbNvmFlush();
+    AppDbSetCccTblValue(hdl, 0, 4);
+    AppDbNvmStoreCccTbl(hdl);
+    AppDbNvmFlush();
+
+    appDbTestReset();
+    if(appDbTestCcc(appDbTestAddr[0]) != 4) {
+        return "latest version not read";
+    }
+
+    AppDbNvmDeleteAll();
+    appDbTestReset();
+    if(appDbTestCcc(appDbTestAddr[0]) != 0xFFFF) {
+        return "deleted record read";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Records stored by earlier versions are converted, above the 32nd record too.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *appDbTestLegacy(void)
+{
+    appDbTestStart();
+
+    appDbTestStoreLegacy(1, appDbTestAddr[0], 5);
+    appDbTestStoreLegacy(33, appDbTestAddr[1], 6);
+    AppDbNvmReadAll();
+
+    if((appDbTestCcc(appDbTestAddr[0]) != 5) || (appDbTestCcc(appDbTestAddr[1]) != 6)) {
+        return "legacy record not read";
+    }
+    if(AppDbSimStored(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_VALID_ID, 1)) ||
+       AppDbSimStored(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_VALID_ID, 33))) {
+        return "legacy record not erased";
+    }
+    if(!AppDbSimStored(APP_DB_TEST_PACKED_ID(1, 0)) || !AppDbSimStored(APP_DB_TEST_PACKED_ID(33, 0))) {
+        return "legacy record not converted";
+    }
+
+    appDbTestReset();
+    if((appDbTestCcc(appDbTestAddr[0]) != 5) || (appDbTestCcc(appDbTestAddr[1]) != 6)) {
+        return "converted record not read";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  A conversion cut short keeps the legacy record until the next flush converts it.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *appDbTestLegacyInterrupted(void)
+{
+    appDbTestStart();
+
+    appDbTestStoreLegacy(2, appDbTestAddr[2], 7);
+    AppDbSimFailWrites(1);
+    AppDbNvmReadAll();
+
+    if(appDbTestCcc(appDbTestAddr[2]) != 7) {
+        return "legacy record not read";
+    }
+    if(!AppDbSimStored(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_VALID_ID, 2))) {
+        return "legacy record erased before conversion";
+    }
+
+    AppDbNvmFlush();
+    if(AppDbSimStored(APP_DB_TEST_LEGACY_ID(APP_DB_TEST_VALID_ID, 2))) {
+        return "legacy record not converted on flush";
+    }
+
+    appDbTestReset();
+    if(appDbTestCcc(appDbTestAddr[2]) != 7) {
+        return "converted record not read";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Deleting records leaves the hash cache, which earlier versions kept at the identifiers
+ *          of the legacy records from the 32nd on.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *appDbTestHashCache(void)
+{
+    uint8_t hash[APP_DB_HASH_CACHE_LEN][ATT_DATABASE_HASH_LEN];
+    uint16_t hdlList[APP_DB_HDL_LIST_LEN];
+    uint16_t *pList;
+    unsigned i;
+
+    appDbTestStart();
+
+    for(i = 0; i < APP_DB_HASH_CACHE_LEN; i++) {
+        memset(hash[i], 0xA0 + i, ATT_DATABASE_HASH_LEN);
+        memset(hdlList, 0, sizeof(hdlList));
+        hdlList[0] = 0x100 + i;
+        AppDbSetHashHdlList(hash[i], hdlList);
+        AppDbNvmStoreHashHdlList(hash[i]);
+    }
+
+    AppDbNvmDeleteAll();
+    appDbTestReset();
+
+    for(i = 0; i < APP_DB_HASH_CACHE_LEN; i++) {
+        pList = AppDbGetHashHdlList(hash[i]);
+        if((pList == NULL) || (pList[0] != 0x100 + i)) {
+            return "hash cache entry lost";
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run a test and report the result.
+ *
+ *  \param  pName    Test name.
+ *  \param  test     Test.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void appDbTestRun(const char *pName, const char *(*test)(void))
+{
+    const char *pErr = test();
+
+    printf("%-44s %s%s\n", pName, (pErr == NULL) ? "ok" : "FAIL: ", (pErr == NULL) ? "" : pErr);
+
+    if(pErr != NULL) {
+        appDbTestFailures++;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the tests.
+ */
+/*************************************************************************************************/
+int main(void)
+{
+    AppDbInit();
+
+    appDbTestRun("changes coalesced", appDbTestCoalesce);
+    appDbTestRun("interrupted write", appDbTestInterrupted);
+    appDbTestRun("legacy records converted", appDbTestLegacy);
+    appDbTestRun("interrupted legacy conversion", appDbTestLegacyInterrupted);
+    appDbTestRun("record erase keeps the hash cache", appDbTestHashCache);
+
+    printf("%s\n", appDbTestFailures ? "FAILED" : "PASSED");
+    return appDbTestFailures ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host stand-in for the flash controller driver, flash_sched.c is simulated instead.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef FLC_H
+#define FLC_H
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize the flash controller.
+ *
+ *  \return E_NO_ERROR.
+ */
+/*************************************************************************************************/
+static inline int MXC_FLC_Init(void)
+{
+    return 0;
+}
+
+#endif /* FLC_H */
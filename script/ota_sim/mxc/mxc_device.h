@@ -0,0 +1,31 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host stand-in for the MAX32665 device header, for running wdxs_file.c.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef MXC_DEVICE_H
+#define MXC_DEVICE_H
+
+#include "mxc_errors.h"
+
+/*! \brief Flash page size */
+#define MXC_FLASH_PAGE_SIZE       0x00002000UL
+
+/*! \brief Flash bank size */
+#define MXC_FLASH_MEM_SIZE        0x00080000UL
+
+#endif /* MXC_DEVICE_H */
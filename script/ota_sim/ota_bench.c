@@ -0,0 +1,385 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host OTA throughput benchmark, runs the WDXS file transfer code on simulated flash.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "wsf_types.h"
+#include "wsf_os.h"
+#include "wsf_math.h"
+#include "wsf_efs.h"
+#include "wsf_timer.h"
+#include "util/bstream.h"
+#include "att_api.h"
+#include "wdx_defs.h"
+#include "wdxs/wdxs_api.h"
+#include "wdxs/wdxs_main.h"
+#include "ota_sim.h"
+
+/*
+ * Link model: the peer sends one put request, the image in ATT writes of MTU - 3 bytes, the
+ * CRC32 in a write of its own, then a verify request. Up to -p writes go out per connection
+ * event, every -i microseconds, while the link layer has one of its -b receive buffers free.
+ * The handler processes writes in order; each takes -c microseconds plus the time the media
+ * waits on the flash. Responses go out at the next connection event and the peer reacts at
+ * the one after.
+ */
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Connection for the simulated peer */
+#define OTA_BENCH_CONN_ID       1
+
+/* Most link layer receive buffers modeled */
+#define OTA_BENCH_MAX_RX_BUFS   32
+
+wdxsCb_t wdxsCb;
+
+static struct {
+    uint32_t mtu;                       /* ATT MTU */
+    uint32_t ciUs;                      /* Connection interval */
+    uint32_t pktsPerEvt;                /* Writes per connection event */
+    uint32_t rxBufs;                    /* Link layer receive buffers */
+    uint32_t cpuUs;                     /* Handler time per write, without flash waits */
+} otaBenchCfg = { 247, 15000, 4, 4, 0 };
+
+/* Status of the last file transfer control response */
+static uint8_t otaBenchFtcStatus;
+
+/**************************************************************************************************
+  Stack stubs, the benchmark is the only client
+**************************************************************************************************/
+
+void WsfSetEvent(wsfHandlerId_t handlerId, wsfEventMask_t event)
+{
+}
+
+void WsfCsEnter(void)
+{
+}
+
+void WsfCsExit(void)
+{
+}
+
+uint16_t AttsCccEnabled(dmConnId_t connId, uint8_t idx)
+{
+    return TRUE;
+}
+
+uint16_t AttGetMtu(dmConnId_t connId)
+{
+    return (uint16_t)otaBenchCfg.mtu;
+}
+
+void *AttMsgAlloc(uint16_t len, uint8_t opcode)
+{
+    return malloc(len);
+}
+
+void AttMsgFree(void *pMsg, uint8_t opcode)
+{
+    free(pMsg);
+}
+
+void AttsHandleValueNtf(dmConnId_t connId, uint16_t handle, uint16_t valueLen, uint8_t *pValue)
+{
+    /* Only file transfer control responses are sent this way, keep the status */
+    if(valueLen > WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN) {
+        otaBenchFtcStatus = pValue[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN];
+    }
+}
+
+void AttsHandleValueNtfZeroCpy(dmConnId_t connId, uint16_t handle, uint16_t valueLen, uint8_t *pValue)
+{
+    free(pValue);
+}
+
+void WdxsUpdateListing(void)
+{
+}
+
+void DmSetPhy(dmConnId_t connId, uint8_t allPhys, uint8_t txPhys, uint8_t rxPhys, uint16_t phyOptions)
+{
+}
+
+void DmConnSetDataLen(dmConnId_t connId, uint16_t txOctets, uint16_t txTime)
+{
+}
+
+void DmConnUpdate(dmConnId_t connId, hciConnSpec_t *pConnSpec)
+{
+}
+
+void WsfTimerStartMs(wsfTimer_t *pTimer, wsfTimerTicks_t ms)
+{
+}
+
+void WsfTimerStop(wsfTimer_t *pTimer)
+{
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send queued file transfer control responses at once.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaBenchFtcFlush(void)
+{
+    while(wdxsCb.txReadyMask & WDXS_TX_MASK_FTC_BIT) {
+        wdxsFtcSend();
+        wdxsCb.txReadyMask |= WDXS_TX_MASK_READY_BIT;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the handler for a file transfer control write and return the response status.
+ *
+ *  \param  pMsg     Request.
+ *  \param  len      Request length.
+ *
+ *  \return Response status.
+ */
+/*************************************************************************************************/
+static uint8_t otaBenchFtc(uint8_t *pMsg, uint16_t len)
+{
+    wdxsFtcWrite(OTA_BENCH_CONN_ID, len, pMsg);
+    otaSimNow += otaBenchCfg.cpuUs;
+
+    otaBenchFtcFlush();
+    return otaBenchFtcStatus;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Connection event at or after a time.
+ *
+ *  \param  t        Time.
+ *
+ *  \return Event time.
+ */
+/*************************************************************************************************/
+static uint64_t otaBenchEvent(uint64_t t)
+{
+    return (t + otaBenchCfg.ciUs - 1) / otaBenchCfg.ciUs * otaBenchCfg.ciUs;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Print usage.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaBenchUsage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options] image.bin\n"
+            "  -m mtu     ATT MTU (247)\n"
+            "  -i us      connection interval (15000)\n"
+            "  -p n       writes per connection event (4)\n"
+            "  -b n       link layer receive buffers (4)\n"
+            "  -c us      handler time per write, without flash waits (0)\n"
+            "  -e us      page erase time (30000)\n"
+            "  -w us      128-bit program time (40)\n"
+            "  -a n       pages erased ahead of the write, 0 to erase all on put (2)\n"
+            "  -s bytes   update area size (0x80000)\n"
+            "  -f file    file backing the update area, kept between runs\n", pName);
+    exit(2);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the benchmark.
+ */
+/*************************************************************************************************/
+int main(int argc, char **argv)
+{
+    otaSimCfg_t simCfg = { 0x80000, 30000, 40, 2 };
+    const otaSimStats_t *pStats;
+    const char *pFlashPath = NULL;
+    wsfEsfAttributes_t attr;
+    wsfEfsHandle_t handle;
+    uint64_t rxDone[OTA_BENCH_MAX_RX_BUFS];
+    uint64_t putEnd, dataStart, dataEnd, evt, start, stall, maxStall, verifyStart;
+    uint32_t imageLen, totalLen, offset, len, pkt, evtPkts, slowPkts;
+    uint8_t msg[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN + 13];
+    uint8_t *pImage, *p, status;
+    FILE *pFile;
+    long size;
+    int opt;
+
+    while((opt = getopt(argc, argv, "m:i:p:b:c:e:w:a:s:f:")) != -1) {
+        switch(opt) {
+            case 'm': otaBenchCfg.mtu = strtoul(optarg, NULL, 0); break;
+            case 'i': otaBenchCfg.ciUs = strtoul(optarg, NULL, 0); break;
+            case 'p': otaBenchCfg.pktsPerEvt = strtoul(optarg, NULL, 0); break;
+            case 'b': otaBenchCfg.rxBufs = strtoul(optarg, NULL, 0); break;
+            case 'c': otaBenchCfg.cpuUs = strtoul(optarg, NULL, 0); break;
+            case 'e': simCfg.eraseUs = strtoul(optarg, NULL, 0); break;
+            case 'w': simCfg.writeUs = strtoul(optarg, NULL, 0); break;
+            case 'a': simCfg.eraseAhead = strtoul(optarg, NULL, 0); break;
+            case 's': simCfg.size = strtoul(optarg, NULL, 0); break;
+            case 'f': pFlashPath = optarg; break;
+            default: otaBenchUsage(argv[0]);
+        }
+    }
+
+    if((optind != argc - 1) || (otaBenchCfg.mtu < 23) || (otaBenchCfg.mtu > 512) ||
+       (otaBenchCfg.ciUs == 0) || (otaBenchCfg.pktsPerEvt == 0) || (otaBenchCfg.rxBufs == 0) ||
+       (otaBenchCfg.rxBufs > OTA_BENCH_MAX_RX_BUFS) || (simCfg.size % OTA_SIM_PAGE_SIZE)) {
+        otaBenchUsage(argv[0]);
+    }
+
+    /* Image followed by its CRC32 */
+    if(((pFile = fopen(argv[optind], "rb")) == NULL) || (fseek(pFile, 0, SEEK_END) != 0) ||
+       ((size = ftell(pFile)) <= 0)) {
+        perror(argv[optind]);
+        return 1;
+    }
+    imageLen = (uint32_t)size;
+    totalLen = imageLen + 4;
+    if(totalLen > simCfg.size) {
+        fprintf(stderr, "%s: larger than the update area\n", argv[optind]);
+        return 1;
+    }
+    pImage = malloc(totalLen);
+    rewind(pFile);
+    if(fread(pImage, 1, imageLen, pFile) != imageLen) {
+        perror(argv[optind]);
+        return 1;
+    }
+    fclose(pFile);
+    p = pImage + imageLen;
+    UINT32_TO_BSTREAM(p, OtaSimCrc32(pImage, imageLen, 0));
+
+    if(OtaSimInit(&simCfg, pFlashPath) != 0) {
+        return 1;
+    }
+
+    WsfEfsInit();
+    WsfEfsRegisterMedia(OtaSimMedia(), WDX_FLASH_MEDIA);
+
+    memset(&attr, 0, sizeof(attr));
+    attr.permissions = WSF_EFS_REMOTE_GET_PERMITTED | WSF_EFS_REMOTE_PUT_PERMITTED |
+                       WSF_EFS_REMOTE_ERASE_PERMITTED | WSF_EFS_REMOTE_VERIFY_PERMITTED;
+    attr.type = WSF_EFS_FILE_TYPE_BULK;
+    handle = WsfEfsAddFile(simCfg.size, WDX_FLASH_MEDIA, &attr, 0);
+
+    /* Put request at time zero */
+    p = msg;
+    UINT8_TO_BSTREAM(p, WDX_FTC_OP_PUT_REQ);
+    UINT16_TO_BSTREAM(p, handle);
+    UINT32_TO_BSTREAM(p, 0);
+    UINT32_TO_BSTREAM(p, totalLen);
+    UINT32_TO_BSTREAM(p, totalLen);
+    UINT8_TO_BSTREAM(p, 0);
+
+    if((status = otaBenchFtc(msg, (uint16_t)(p - msg))) != WDX_FTC_ST_SUCCESS) {
+        fprintf(stderr, "put request failed, status %u\n", status);
+        return 1;
+    }
+    putEnd = otaSimNow;
+
+    /* Data writes */
+    dataStart = evt = otaBenchEvent(putEnd) + otaBenchCfg.ciUs;
+    evtPkts = 0;
+    maxStall = 0;
+    slowPkts = 0;
+    offset = 0;
+
+    for(pkt = 0; offset < totalLen; pkt++) {
+        len = WSF_MIN(otaBenchCfg.mtu - ATT_WRITE_CMD_LEN, imageLen - offset);
+        if(offset >= imageLen) {
+            len = 4;
+        }
+
+        /* Next event with room, and a receive buffer freed by the handler */
+        if((pkt >= otaBenchCfg.rxBufs) && (evt < rxDone[pkt % otaBenchCfg.rxBufs])) {
+            evt = otaBenchEvent(rxDone[pkt % otaBenchCfg.rxBufs]);
+            evtPkts = 0;
+        }
+        if(evtPkts == otaBenchCfg.pktsPerEvt) {
+            evt += otaBenchCfg.ciUs;
+            evtPkts = 0;
+        }
+        evtPkts++;
+
+        /* Handler picks it up once done with the previous write */
+        if(otaSimNow < evt) {
+            otaSimNow = evt;
+        }
+        start = otaSimNow;
+        OtaSimRun();
+
+        if(wdxsFtdWrite(OTA_BENCH_CONN_ID, (uint16_t)len, pImage + offset) != ATT_SUCCESS) {
+            fprintf(stderr, "write at 0x%08x rejected\n", offset);
+            return 1;
+        }
+        otaBenchFtcFlush();
+        otaSimNow += otaBenchCfg.cpuUs;
+
+        stall = otaSimNow - start - otaBenchCfg.cpuUs;
+        maxStall = WSF_MAX(maxStall, stall);
+        if(otaSimNow - start > otaBenchCfg.ciUs) {
+            slowPkts++;
+        }
+
+        rxDone[pkt % otaBenchCfg.rxBufs] = otaSimNow;
+        offset += len;
+    }
+
+    dataEnd = otaSimNow;
+
+    /* Verify request after the EOF notification */
+    verifyStart = otaBenchEvent(dataEnd) + otaBenchCfg.ciUs;
+    otaSimNow = verifyStart;
+    OtaSimRun();
+
+    p = msg;
+    UINT8_TO_BSTREAM(p, WDX_FTC_OP_VERIFY_REQ);
+    UINT16_TO_BSTREAM(p, handle);
+    status = otaBenchFtc(msg, (uint16_t)(p - msg));
+
+    pStats = OtaSimGetStats();
+
+    printf("image:           %u bytes, mtu %u, interval %u us, %u writes per event, %u rx buffers\n",
+           imageLen, otaBenchCfg.mtu, otaBenchCfg.ciUs, otaBenchCfg.pktsPerEvt, otaBenchCfg.rxBufs);
+    printf("put response:    %.3f ms\n", putEnd / 1000.0);
+    printf("transfer:        %.3f s, %.0f bytes/s, link limit %.0f bytes/s\n",
+           (dataEnd - dataStart) / 1e6, totalLen * 1e6 / (dataEnd - dataStart),
+           (otaBenchCfg.mtu - ATT_WRITE_CMD_LEN) * otaBenchCfg.pktsPerEvt * 1e6 / otaBenchCfg.ciUs);
+    printf("handler stall:   %.3f ms total, %.3f ms max, %u of %u writes over one interval\n",
+           pStats->stallUs / 1000.0, maxStall / 1000.0, slowPkts, pkt);
+    printf("verify:          %.3f ms, status %u, %.3f s from put\n",
+           (otaSimNow - verifyStart) / 1000.0, status, otaSimNow / 1e6);
+    printf("flash:           %u page erases, %u line writes, %u rewrites, %u dirty writes\n",
+           pStats->pageErases, pStats->lineWrites, pStats->lineRewrites, pStats->dirtyWrites);
+
+    OtaSimClose();
+    free(pImage);
+
+    return ((status == WDX_FTC_ST_SUCCESS) && (pStats->dirtyWrites == 0)) ? 0 : 1;
+}
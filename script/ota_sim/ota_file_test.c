@@ -0,0 +1,472 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host test of the wdxs_file.c upload formats on simulated flash.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "wsf_types.h"
+#include "wsf_efs.h"
+#include "util/bstream.h"
+#include "wdx_defs.h"
+#include "wdxs_file.h"
+#include "ota_sim.h"
+
+/*
+ * Uploads go through WsfEfsErase(), WsfEfsPut() in fixed size writes and the validate command,
+ * as wdxs_ft.c does for a put and a verify. wdxs_file.c runs unchanged on the simulated flash:
+ * the update area is at OTA_SIM_BASE and the running image, the delta source, at _text. The
+ * LZ4 and delta uploads are made here from the two images given on the command line.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Running image, _text is placed here by the Makefile */
+#define OTA_TEST_TEXT_BASE      0x10000000
+#define OTA_TEST_TEXT_SIZE      0x80000
+
+/* First file added after WsfEfsInit(), by WdxsFileInit() */
+#define OTA_TEST_HANDLE         0
+
+/* Upload headers, see wdxs_file.c */
+#define OTA_TEST_LZ4_MAGIC      0x5A584457
+#define OTA_TEST_DELTA_MAGIC    0x50584457
+#define OTA_TEST_DELTA_HDR_LEN  16
+#define OTA_TEST_DELTA_COPY     0x01
+#define OTA_TEST_DELTA_INSERT   0x02
+
+/* Shortest delta copy emitted */
+#define OTA_TEST_MIN_COPY       16
+
+/* LZ4 encoder hash table */
+#define OTA_TEST_LZ4_HASH_BITS  14
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Test upload */
+typedef struct {
+    uint8_t   *pBuf;                    /* Upload data */
+    uint32_t  len;                      /* Upload length */
+    uint32_t  mark;                     /* LZ4: first match offset, delta: first copy operation */
+} otaTestUpload_t;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Tests failed */
+static int otaTestFailures;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Read an image file and append its CRC32, the layout of a raw upload.
+ *
+ *  \param  pPath    Image file.
+ *  \param  pLen     Returns the length with the CRC32.
+ *
+ *  \return Image, or NULL on error.
+ */
+/*************************************************************************************************/
+static uint8_t *otaTestLoad(const char *pPath, uint32_t *pLen)
+{
+    FILE *pFile;
+    uint8_t *pBuf, *p;
+    long size;
+
+    if(((pFile = fopen(pPath, "rb")) == NULL) || (fseek(pFile, 0, SEEK_END) != 0) ||
+       ((size = ftell(pFile)) <= 0)) {
+        perror(pPath);
+        return NULL;
+    }
+
+    pBuf = malloc(size + 4);
+    rewind(pFile);
+    if(fread(pBuf, 1, size, pFile) != (size_t)size) {
+        perror(pPath);
+        return NULL;
+    }
+    fclose(pFile);
+
+    p = pBuf + size;
+    UINT32_TO_BSTREAM(p, OtaSimCrc32(pBuf, (uint32_t)size, 0));
+
+    *pLen = (uint32_t)size + 4;
+    return pBuf;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Append an LZ4 length extension.
+ *
+ *  \param  p        Output.
+ *  \param  len      Length less the 15 held in the token.
+ *
+ *  \return Output after the extension.
+ */
+/*************************************************************************************************/
+static uint8_t *otaTestLz4Len(uint8_t *p, uint32_t len)
+{
+    while(len >= 255) {
+        *p++ = 255;
+        len -= 255;
+    }
+    *p++ = (uint8_t)len;
+
+    return p;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Append an LZ4 sequence.
+ *
+ *  \param  p        Output.
+ *  \param  pLit     Literals.
+ *  \param  litLen   Number of literals.
+ *  \param  offset   Match offset, 0 for the final sequence.
+ *  \param  matchLen Match length, at least 4.
+ *
+ *  \return Output after the sequence.
+ */
+/*************************************************************************************************/
+static uint8_t *otaTestLz4Seq(uint8_t *p, const uint8_t *pLit, uint32_t litLen, uint32_t offset,
+                              uint32_t matchLen)
+{
+    uint8_t *pToken = p++;
+
+    *pToken = (uint8_t)(((litLen < 15) ? litLen : 15) << 4);
+    if(litLen >= 15) {
+        p = otaTestLz4Len(p, litLen - 15);
+    }
+    memcpy(p, pLit, litLen);
+    p += litLen;
+
+    if(offset == 0) {
+        return p;
+    }
+
+    UINT16_TO_BSTREAM(p, offset);
+    matchLen -= 4;
+    *pToken |= (matchLen < 15) ? matchLen : 15;
+    if(matchLen >= 15) {
+        p = otaTestLz4Len(p, matchLen - 15);
+    }
+
+    return p;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Make an LZ4 upload: header and a single LZ4 block.
+ *
+ *  \param  pIn      Data to compress.
+ *  \param  len      Number of bytes.
+ *
+ *  \return Upload.
+ */
+/*************************************************************************************************/
+static otaTestUpload_t otaTestLz4(const uint8_t *pIn, uint32_t len)
+{
+    static int32_t table[1 << OTA_TEST_LZ4_HASH_BITS];
+    otaTestUpload_t up;
+    uint32_t i, anchor, litLen, matchLen, key;
+    int32_t cand;
+    uint8_t *p;
+
+    up.pBuf = malloc(len + len / 255 + 32);
+    up.mark = 0;
+    p = up.pBuf;
+    UINT32_TO_BSTREAM(p, OTA_TEST_LZ4_MAGIC);
+    UINT32_TO_BSTREAM(p, len);
+
+    memset(table, 0xFF, sizeof(table));
+    anchor = 0;
+    i = 0;
+
+    /* The last match starts 12 bytes before the end at the latest and the last 5 are literals */
+    while(i + 12 <= len) {
+        BYTES_TO_UINT32(key, pIn + i);
+        key = (key * 2654435761u) >> (32 - OTA_TEST_LZ4_HASH_BITS);
+        cand = table[key];
+        table[key] = (int32_t)i;
+
+        if((cand < 0) || (i - cand > 0xFFFF) || (memcmp(pIn + cand, pIn + i, 4) != 0)) {
+            i++;
+            continue;
+        }
+
+        matchLen = 4;
+        while((i + matchLen < len - 5) && (pIn[cand + matchLen] == pIn[i + matchLen])) {
+            matchLen++;
+        }
+
+        /* Offset field follows the token, the literal length extension and the literals */
+        litLen = i - anchor;
+        if(up.mark == 0) {
+            up.mark = (uint32_t)(p - up.pBuf) + 1 + ((litLen >= 15) ? (litLen - 15) / 255 + 1 : 0) + litLen;
+        }
+
+        p = otaTestLz4Seq(p, pIn + anchor, litLen, i - cand, matchLen);
+        i += matchLen;
+        anchor = i;
+    }
+
+    p = otaTestLz4Seq(p, pIn + anchor, len - anchor, 0, 0);
+
+    up.len = (uint32_t)(p - up.pBuf);
+    return up;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Make a delta upload rebuilding one image from another.
+ *
+ *  \param  pOld     Running image, without a CRC32.
+ *  \param  oldLen   Running image length.
+ *  \param  pNew     New image and its CRC32.
+ *  \param  newLen   New image length with the CRC32.
+ *
+ *  \return Upload.
+ */
+/*************************************************************************************************/
+static otaTestUpload_t otaTestDelta(const uint8_t *pOld, uint32_t oldLen, const uint8_t *pNew,
+                                    uint32_t newLen)
+{
+    otaTestUpload_t up;
+    uint32_t n, lit, run;
+    uint8_t *p;
+
+    up.pBuf = malloc(2 * newLen + OTA_TEST_DELTA_HDR_LEN);
+    up.mark = 0;
+    p = up.pBuf;
+    UINT32_TO_BSTREAM(p, OTA_TEST_DELTA_MAGIC);
+    UINT32_TO_BSTREAM(p, newLen);
+    UINT32_TO_BSTREAM(p, oldLen);
+    UINT32_TO_BSTREAM(p, OtaSimCrc32(pOld, oldLen, 0));
+
+    /* Copy ranges unchanged at the same offset, insert the rest */
+    lit = 0;
+    n = 0;
+    while(n <= newLen) {
+        run = 0;
+        while((n + run < newLen) && (n + run < oldLen) && (pNew[n + run] == pOld[n + run])) {
+            run++;
+        }
+
+        if((run < OTA_TEST_MIN_COPY) && (n < newLen)) {
+            n++;
+            continue;
+        }
+
+        if(n > lit) {
+            UINT8_TO_BSTREAM(p, OTA_TEST_DELTA_INSERT);
+            UINT32_TO_BSTREAM(p, n - lit);
+            memcpy(p, pNew + lit, n - lit);
+            p += n - lit;
+        }
+
+        if(n == newLen) {
+            break;
+        }
+
+        if(up.mark == 0) {
+            up.mark = (uint32_t)(p - up.pBuf);
+        }
+        UINT8_TO_BSTREAM(p, OTA_TEST_DELTA_COPY);
+        UINT32_TO_BSTREAM(p, n);
+        UINT32_TO_BSTREAM(p, run);
+
+        n += run;
+        lit = n;
+    }
+
+    up.len = (uint32_t)(p - up.pBuf);
+    return up;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Upload through the file media and check the validate status.
+ *
+ *  \param  pName    Test name.
+ *  \param  pBuf     Upload.
+ *  \param  len      Upload length.
+ *  \param  chunk    Bytes per write.
+ *  \param  status   Expected validate status.
+ *  \param  pImage   Expected image and CRC32 in the update area on success.
+ *  \param  imageLen Image length with the CRC32.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaTestRun(const char *pName, const uint8_t *pBuf, uint32_t len, uint16_t chunk,
+                       uint8_t status, const uint8_t *pImage, uint32_t imageLen)
+{
+    uint32_t offset, n;
+    uint8_t result;
+    const char *pErr = NULL;
+
+    WsfEfsErase(OTA_TEST_HANDLE);
+
+    /* The last 4 bytes go in a write of their own, the client sends the CRC32 of a raw upload so */
+    for(offset = 0; offset < len; offset += n) {
+        n = (len - 4 - offset < chunk) ? (len - 4 - offset) : chunk;
+        if(offset == len - 4) {
+            n = 4;
+        }
+        WsfEfsPut(OTA_TEST_HANDLE, offset, pBuf + offset, (uint16_t)n);
+    }
+
+    result = WsfEfsMediaSpecificCommand(OTA_TEST_HANDLE, WSF_EFS_VALIDATE_CMD, len);
+
+    if(result != status) {
+        pErr = "wrong validate status";
+    } else if(status == WDX_FTC_ST_SUCCESS) {
+        if(memcmp((const void*)OTA_SIM_BASE, pImage, imageLen) != 0) {
+            pErr = "update area differs from the image";
+        } else if(WdxsFileGetVerifiedLength() != imageLen - 4) {
+            pErr = "wrong verified length";
+        }
+    }
+
+    if(OtaSimGetStats()->dirtyWrites != 0) {
+        pErr = "flash programmed without an erase";
+    }
+
+    printf("%-36s %5u-byte writes  %s%s\n", pName, chunk, (pErr == NULL) ? "ok" : "FAIL: ",
+           (pErr == NULL) ? "" : pErr);
+
+    if(pErr != NULL) {
+        otaTestFailures++;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the tests.
+ */
+/*************************************************************************************************/
+int main(int argc, char **argv)
+{
+    static const uint16_t chunks[] = { 20, 244 };
+    otaSimCfg_t simCfg = { 0x80000, 30000, 40, 2 };
+    otaTestUpload_t lz4, delta, edit, wrong;
+    uint8_t *pOld, *pNew, *pEdit, *pText, *pCorrupt;
+    uint32_t oldLen, newLen;
+    uint8_t *p;
+    unsigned i;
+
+    if(argc != 3) {
+        fprintf(stderr, "Usage: %s running.bin new.bin\n", argv[0]);
+        return 2;
+    }
+
+    if(((pOld = otaTestLoad(argv[1], &oldLen)) == NULL) ||
+       ((pNew = otaTestLoad(argv[2], &newLen)) == NULL)) {
+        return 1;
+    }
+
+    if((oldLen > OTA_TEST_TEXT_SIZE) || (newLen > simCfg.size)) {
+        fprintf(stderr, "image larger than a flash bank\n");
+        return 1;
+    }
+
+    /* Running image at _text */
+    pText = mmap((void*)OTA_TEST_TEXT_BASE, OTA_TEST_TEXT_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(pText != (uint8_t*)OTA_TEST_TEXT_BASE) {
+        perror("running image");
+        return 1;
+    }
+    memcpy(pText, pOld, oldLen - 4);
+
+    if(OtaSimInit(&simCfg, NULL) != 0) {
+        return 1;
+    }
+
+    WsfEfsInit();
+    WdxsFileInit();
+
+    /* Edit the new image so the delta interleaves copies and inserts */
+    pEdit = malloc(newLen);
+    memcpy(pEdit, pNew, newLen - 4);
+    for(i = 0; i < newLen - 4; i += 97) {
+        pEdit[i] ^= 0xA5;
+    }
+    p = pEdit + newLen - 4;
+    UINT32_TO_BSTREAM(p, OtaSimCrc32(pEdit, newLen - 4, 0));
+
+    lz4 = otaTestLz4(pNew, newLen);
+    delta = otaTestDelta(pOld, oldLen - 4, pNew, newLen);
+    edit = otaTestDelta(pOld, oldLen - 4, pEdit, newLen);
+    wrong = otaTestDelta(pNew, newLen - 4, pOld, oldLen);
+    pCorrupt = malloc((lz4.len > edit.len) ? lz4.len : edit.len);
+
+    printf("new image %u bytes, lz4 upload %u bytes, delta upload %u bytes, edited %u bytes\n",
+           newLen, lz4.len, delta.len, edit.len);
+
+    for(i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        otaTestRun("raw", pNew, newLen, chunks[i], WDX_FTC_ST_SUCCESS, pNew, newLen);
+        otaTestRun("lz4", lz4.pBuf, lz4.len, chunks[i], WDX_FTC_ST_SUCCESS, pNew, newLen);
+        otaTestRun("delta", delta.pBuf, delta.len, chunks[i], WDX_FTC_ST_SUCCESS, pNew, newLen);
+        otaTestRun("delta of edited image", edit.pBuf, edit.len, chunks[i], WDX_FTC_ST_SUCCESS, pEdit, newLen);
+    }
+
+    /* Truncated streams stop decoding short of the image */
+    otaTestRun("lz4 truncated", lz4.pBuf, lz4.len - 64, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+    otaTestRun("delta truncated", edit.pBuf, edit.len - 64, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+
+    /* Corrupt streams */
+    memcpy(pCorrupt, lz4.pBuf, lz4.len);
+    p = pCorrupt + lz4.mark;
+    UINT16_TO_BSTREAM(p, 0xFFFF);
+    otaTestRun("lz4 match before start of image", pCorrupt, lz4.len, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+
+    memcpy(pCorrupt, lz4.pBuf, lz4.len);
+    pCorrupt[lz4.len / 2] ^= 0x5A;
+    otaTestRun("lz4 corrupt byte", pCorrupt, lz4.len, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+
+    memcpy(pCorrupt, edit.pBuf, edit.len);
+    p = pCorrupt + edit.mark + 5;
+    UINT32_TO_BSTREAM(p, 0xFFFFFFF0);
+    otaTestRun("delta copy past source", pCorrupt, edit.len, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+
+    memcpy(pCorrupt, edit.pBuf, edit.len);
+    pCorrupt[OTA_TEST_DELTA_HDR_LEN] = 0x07;
+    otaTestRun("delta unknown operation", pCorrupt, edit.len, 244, WDX_FTC_ST_VERIFICATION, NULL, 0);
+
+    otaTestRun("delta for another running image", wrong.pBuf, wrong.len, 244, WDX_FTC_ST_VERIFICATION,
+               NULL, 0);
+
+    OtaSimClose();
+    free(pOld);
+    free(pNew);
+    free(pEdit);
+    free(pCorrupt);
+    free(lz4.pBuf);
+    free(delta.pBuf);
+    free(edit.pBuf);
+    free(wrong.pBuf);
+
+    printf("%s\n", otaTestFailures ? "FAILED" : "PASSED");
+    return otaTestFailures ? 1 : 0;
+}
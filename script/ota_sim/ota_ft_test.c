@@ -0,0 +1,606 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host test of concurrent WDXS file transfers on two interleaved connections.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "wsf_types.h"
+#include "wsf_os.h"
+#include "wsf_math.h"
+#include "wsf_efs.h"
+#include "wsf_timer.h"
+#include "util/bstream.h"
+#include "att_api.h"
+#include "wdx_defs.h"
+#include "wdxs/wdxs_api.h"
+#include "wdxs/wdxs_main.h"
+
+/*
+ * Two peers run file transfers through wdxs_ft.c at the same time. Each has its own ATT MTU
+ * and write size, and their control and data writes are interleaved one by one. The data
+ * notifications of a get stay in flight until the test confirms them, as the ATT confirm does
+ * in wdxs_main.c, so each connection has its own transmit state. Files are kept in RAM.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Connections of the two peers */
+#define OTA_FT_CONN_A           1
+#define OTA_FT_CONN_B           2
+
+/* RAM media, mapped below 4 GiB as the library keeps media addresses in 32 bits */
+#define OTA_FT_RAM_BASE         0x20000000
+#define OTA_FT_RAM_SIZE         0x4000
+
+/* Files on the RAM media, one per peer */
+#define OTA_FT_FILE_SIZE        0x2000
+
+/* Most control notifications recorded per connection */
+#define OTA_FT_MAX_FTC          16
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Peer state */
+typedef struct {
+    uint16_t  mtu;                      /* ATT MTU */
+    uint8_t   ftcOp[OTA_FT_MAX_FTC];    /* Control notifications received */
+    uint8_t   ftcStatus[OTA_FT_MAX_FTC];/* Their status, 0 for EOF */
+    uint8_t   numFtc;                   /* Number of control notifications */
+    uint8_t   *pRx;                     /* File data notifications received */
+    uint32_t  rxLen;                    /* Length received */
+    uint32_t  numNtf;                   /* Data notifications received */
+    uint32_t  inFlight;                 /* Data notifications not confirmed */
+} otaFtPeer_t;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+wdxsCb_t wdxsCb;
+
+/* Peers, indexed by connection ID - 1 */
+static otaFtPeer_t otaFtPeer[2];
+
+/* Tests failed */
+static int otaFtFailures;
+
+/**************************************************************************************************
+  RAM media
+**************************************************************************************************/
+
+static uint8_t otaFtRamErase(uint8_t *pAddress, uint32_t size)
+{
+    memset(pAddress, 0xFF, size);
+    return WSF_EFS_SUCCESS;
+}
+
+static uint8_t otaFtRamRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    memcpy(pBuf, pAddress, size);
+    return WSF_EFS_SUCCESS;
+}
+
+static uint8_t otaFtRamWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    memcpy(pAddress, pBuf, size);
+    return WSF_EFS_SUCCESS;
+}
+
+static uint8_t otaFtRamCmd(uint8_t cmd, uint32_t param)
+{
+    return WDX_FTC_ST_SUCCESS;
+}
+
+static const wsfEfsMedia_t otaFtRamMedia = {
+    OTA_FT_RAM_BASE,
+    OTA_FT_RAM_BASE + OTA_FT_RAM_SIZE,
+    0,
+    NULL,
+    otaFtRamErase,
+    otaFtRamRead,
+    otaFtRamWrite,
+    otaFtRamCmd,
+    NULL
+};
+
+/**************************************************************************************************
+  Stack stubs, the two peers are the only clients
+**************************************************************************************************/
+
+void WsfSetEvent(wsfHandlerId_t handlerId, wsfEventMask_t event)
+{
+}
+
+void WsfCsEnter(void)
+{
+}
+
+void WsfCsExit(void)
+{
+}
+
+uint16_t AttsCccEnabled(dmConnId_t connId, uint8_t idx)
+{
+    return TRUE;
+}
+
+uint16_t AttGetMtu(dmConnId_t connId)
+{
+    return otaFtPeer[connId - 1].mtu;
+}
+
+void *AttMsgAlloc(uint16_t len, uint8_t opcode)
+{
+    return malloc(len);
+}
+
+void AttMsgFree(void *pMsg, uint8_t opcode)
+{
+    free(pMsg);
+}
+
+void AttsHandleValueNtf(dmConnId_t connId, uint16_t handle, uint16_t valueLen, uint8_t *pValue)
+{
+    otaFtPeer_t *pPeer = &otaFtPeer[connId - 1];
+
+    /* Only file transfer control notifications are sent this way */
+    if(pPeer->numFtc < OTA_FT_MAX_FTC) {
+        pPeer->ftcOp[pPeer->numFtc] = pValue[0];
+        pPeer->ftcStatus[pPeer->numFtc] = (valueLen > WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN) ?
+                                          pValue[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN] : 0;
+        pPeer->numFtc++;
+    }
+}
+
+void AttsHandleValueNtfZeroCpy(dmConnId_t connId, uint16_t handle, uint16_t valueLen, uint8_t *pValue)
+{
+    otaFtPeer_t *pPeer = &otaFtPeer[connId - 1];
+
+    if(pPeer->rxLen + valueLen <= OTA_FT_FILE_SIZE) {
+        memcpy(pPeer->pRx + pPeer->rxLen, pValue, valueLen);
+    }
+    pPeer->rxLen += valueLen;
+    pPeer->numNtf++;
+    pPeer->inFlight++;
+    free(pValue);
+}
+
+void WdxsUpdateListing(void)
+{
+}
+
+void DmSetPhy(dmConnId_t connId, uint8_t allPhys, uint8_t txPhys, uint8_t rxPhys, uint16_t phyOptions)
+{
+}
+
+void DmConnSetDataLen(dmConnId_t connId, uint16_t txOctets, uint16_t txTime)
+{
+}
+
+void DmConnUpdate(dmConnId_t connId, hciConnSpec_t *pConnSpec)
+{
+}
+
+void WsfTimerStartMs(wsfTimer_t *pTimer, wsfTimerTicks_t ms)
+{
+}
+
+void WsfTimerStop(wsfTimer_t *pTimer)
+{
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Record a check.
+ *
+ *  \param  pName    Test name.
+ *  \param  ok       Check passed.
+ *  \param  pWhat    Description of the check.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtCheck(const char *pName, bool_t ok, const char *pWhat)
+{
+    if(!ok) {
+        printf("%-38s FAILED: %s\n", pName, pWhat);
+        otaFtFailures++;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Reset the peers and the transfer state, as after both connections opened.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtReset(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < 2; i++) {
+        free(otaFtPeer[i].pRx);
+        memset(&otaFtPeer[i], 0, sizeof(otaFtPeer_t));
+        otaFtPeer[i].pRx = malloc(OTA_FT_FILE_SIZE);
+    }
+    otaFtPeer[OTA_FT_CONN_A - 1].mtu = 247;
+    otaFtPeer[OTA_FT_CONN_B - 1].mtu = 64;
+
+    memset(&wdxsCb, 0, sizeof(wdxsCb));
+    wdxsCb.txReadyMask = WDXS_TX_MASK_READY_BIT;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Send queued file transfer control notifications at once.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtFtcFlush(void)
+{
+    while(wdxsCb.txReadyMask & WDXS_TX_MASK_FTC_BIT) {
+        wdxsFtcSend();
+        wdxsCb.txReadyMask |= WDXS_TX_MASK_READY_BIT;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write a get or put request to the file transfer control characteristic.
+ *
+ *  \param  connId   Connection.
+ *  \param  op       WDX_FTC_OP_GET_REQ or WDX_FTC_OP_PUT_REQ.
+ *  \param  handle   File handle.
+ *  \param  len      Transfer length.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtReq(dmConnId_t connId, uint8_t op, uint16_t handle, uint32_t len)
+{
+    uint8_t msg[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN + 13];
+    uint8_t *p = msg;
+
+    UINT8_TO_BSTREAM(p, op);
+    UINT16_TO_BSTREAM(p, handle);
+    UINT32_TO_BSTREAM(p, 0);
+    UINT32_TO_BSTREAM(p, len);
+    if(op == WDX_FTC_OP_PUT_REQ) {
+        UINT32_TO_BSTREAM(p, len);
+    }
+    UINT8_TO_BSTREAM(p, 0);
+
+    wdxsFtcWrite(connId, (uint16_t)(p - msg), msg);
+    otaFtFtcFlush();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write an abort to the file transfer control characteristic.
+ *
+ *  \param  connId   Connection.
+ *  \param  handle   File handle.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtAbort(dmConnId_t connId, uint16_t handle)
+{
+    uint8_t msg[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN];
+    uint8_t *p = msg;
+
+    UINT8_TO_BSTREAM(p, WDX_FTC_OP_ABORT);
+    UINT16_TO_BSTREAM(p, handle);
+
+    wdxsFtcWrite(connId, (uint16_t)(p - msg), msg);
+    otaFtFtcFlush();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Confirm the data notification in flight on a connection.
+ *
+ *  \param  connId   Connection.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtConfirm(dmConnId_t connId)
+{
+    if(otaFtPeer[connId - 1].inFlight != 0) {
+        otaFtPeer[connId - 1].inFlight--;
+        wdxsCb.ftdBusyMask &= ~WDXS_CONN_BIT(connId);
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Find a control notification received by a peer.
+ *
+ *  \param  connId   Connection.
+ *  \param  op       Operation.
+ *
+ *  \return Number of notifications with the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaFtFtcCount(dmConnId_t connId, uint8_t op)
+{
+    otaFtPeer_t *pPeer = &otaFtPeer[connId - 1];
+    uint8_t i, count = 0;
+
+    for(i = 0; i < pPeer->numFtc; i++) {
+        if(pPeer->ftcOp[i] == op) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Interleave puts of different lengths and write sizes from both peers.
+ *
+ *  \param  pA       Data put by peer A.
+ *  \param  lenA     Length put by peer A.
+ *  \param  pB       Data put by peer B.
+ *  \param  lenB     Length put by peer B, in fewer writes than peer A.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtTestPut(const uint8_t *pA, uint32_t lenA, const uint8_t *pB, uint32_t lenB)
+{
+    static const char *pName = "interleaved puts";
+    int failures = otaFtFailures;
+    uint32_t offA = 0, offB = 0, len;
+    uint8_t statusA = ATT_SUCCESS, statusB = ATT_SUCCESS;
+
+    otaFtReset();
+
+    otaFtReq(OTA_FT_CONN_A, WDX_FTC_OP_PUT_REQ, 0, lenA);
+    otaFtReq(OTA_FT_CONN_B, WDX_FTC_OP_PUT_REQ, 0, lenB);
+    otaFtCheck(pName, otaFtPeer[1].ftcStatus[0] == WDX_FTC_ST_IN_PROGRESS,
+               "put to a file another connection is putting was accepted");
+
+    otaFtReq(OTA_FT_CONN_B, WDX_FTC_OP_PUT_REQ, 1, lenB);
+    otaFtCheck(pName, (otaFtPeer[0].ftcStatus[0] == WDX_FTC_ST_SUCCESS) &&
+                      (otaFtPeer[1].ftcStatus[1] == WDX_FTC_ST_SUCCESS), "put request rejected");
+
+    /* One write from each peer in turn, each of its own MTU */
+    while((offA < lenA) || (offB < lenB)) {
+        if(offA < lenA) {
+            len = WSF_MIN(otaFtPeer[0].mtu - ATT_WRITE_CMD_LEN, lenA - offA);
+            statusA |= wdxsFtdWrite(OTA_FT_CONN_A, (uint16_t)len, (uint8_t*)pA + offA);
+            offA += len;
+        }
+        if(offB < lenB) {
+            len = WSF_MIN(otaFtPeer[1].mtu - ATT_WRITE_CMD_LEN, lenB - offB);
+            statusB |= wdxsFtdWrite(OTA_FT_CONN_B, (uint16_t)len, (uint8_t*)pB + offB);
+            offB += len;
+
+            /* Peer B ends first, peer A's put must be unaffected */
+            if(offB == lenB) {
+                otaFtCheck(pName, otaFtFtcCount(OTA_FT_CONN_A, WDX_FTC_OP_EOF) == 0,
+                           "EOF of peer B reached peer A");
+                otaFtCheck(pName, wdxsFtdWrite(OTA_FT_CONN_B, 1, (uint8_t*)pB) == ATT_ERR_UNLIKELY,
+                           "write after the end of peer B's put was accepted");
+            }
+        }
+        otaFtFtcFlush();
+    }
+
+    otaFtCheck(pName, (statusA == ATT_SUCCESS) && (statusB == ATT_SUCCESS), "data write rejected");
+    otaFtCheck(pName, (otaFtFtcCount(OTA_FT_CONN_A, WDX_FTC_OP_EOF) == 1) &&
+                      (otaFtFtcCount(OTA_FT_CONN_B, WDX_FTC_OP_EOF) == 1), "not one EOF per peer");
+    otaFtCheck(pName, (WsfEfsGetFileSize(0) == lenA) && (WsfEfsGetFileSize(1) == lenB) &&
+                      (wdxsCb.ftPutLen[0] == lenA) && (wdxsCb.ftPutLen[1] == lenB),
+               "put lengths mixed up");
+    otaFtCheck(pName, (memcmp((const uint8_t*)OTA_FT_RAM_BASE, pA, lenA) == 0) &&
+                      (memcmp((const uint8_t*)OTA_FT_RAM_BASE + OTA_FT_FILE_SIZE, pB, lenB) == 0),
+               "file data mixed up");
+
+    printf("%-38s %u + %u bytes  %s\n", pName, lenA, lenB, (otaFtFailures == failures) ? "ok" : "");
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Interleave gets from both peers, each confirming its notifications at its own pace.
+ *
+ *  \param  pA       Contents of the file peer A gets.
+ *  \param  lenA     Its length.
+ *  \param  pB       Contents of the file peer B gets.
+ *  \param  lenB     Its length.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtTestGet(const uint8_t *pA, uint32_t lenA, const uint8_t *pB, uint32_t lenB)
+{
+    static const char *pName = "interleaved gets";
+    int failures = otaFtFailures;
+    uint32_t pass, ahead = 0;
+
+    otaFtReset();
+
+    /* Gets past the end of the files the puts left, so each ends with an EOF */
+    otaFtReq(OTA_FT_CONN_A, WDX_FTC_OP_GET_REQ, 0, OTA_FT_FILE_SIZE);
+    otaFtReq(OTA_FT_CONN_B, WDX_FTC_OP_GET_REQ, 1, OTA_FT_FILE_SIZE);
+
+    /* Both confirm at once: each pass serves both, neither runs ahead */
+    for(pass = 0; (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT) && (pass < 16); pass++) {
+        wdxsFtdSched();
+        ahead |= otaFtPeer[0].numNtf ^ otaFtPeer[1].numNtf;
+        otaFtConfirm(OTA_FT_CONN_A);
+        otaFtConfirm(OTA_FT_CONN_B);
+    }
+    otaFtCheck(pName, ahead == 0, "one connection served ahead of the other");
+
+    /* Peer B holds its confirm: peer A keeps going, peer B gets nothing more */
+    wdxsFtdSched();
+    otaFtConfirm(OTA_FT_CONN_A);
+    for(pass = 0; pass < 4; pass++) {
+        wdxsFtdSched();
+        otaFtCheck(pName, otaFtPeer[1].inFlight <= 1, "second notification before the confirm");
+        otaFtConfirm(OTA_FT_CONN_A);
+    }
+    otaFtCheck(pName, otaFtPeer[0].numNtf == otaFtPeer[1].numNtf + 4,
+               "connection held up by another's unconfirmed notification");
+    otaFtConfirm(OTA_FT_CONN_B);
+
+    /* Run both to the end */
+    for(pass = 0; (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT) && (pass < 1000); pass++) {
+        wdxsFtdSched();
+        otaFtFtcFlush();
+        otaFtConfirm(OTA_FT_CONN_A);
+        otaFtConfirm(OTA_FT_CONN_B);
+    }
+
+    otaFtCheck(pName, (otaFtPeer[0].rxLen == lenA) && (otaFtPeer[1].rxLen == lenB) &&
+                      (memcmp(otaFtPeer[0].pRx, pA, lenA) == 0) &&
+                      (memcmp(otaFtPeer[1].pRx, pB, lenB) == 0), "file data mixed up");
+    otaFtCheck(pName, (otaFtFtcCount(OTA_FT_CONN_A, WDX_FTC_OP_EOF) == 1) &&
+                      (otaFtFtcCount(OTA_FT_CONN_B, WDX_FTC_OP_EOF) == 1), "not one EOF per peer");
+
+    printf("%-38s %u + %u notifications  %s\n", pName, otaFtPeer[0].numNtf, otaFtPeer[1].numNtf,
+           (otaFtFailures == failures) ? "ok" : "");
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Abort and disconnect one peer while the other's transfers carry on.
+ *
+ *  \param  pA       Contents of the file peer A gets.
+ *  \param  lenA     Its length.
+ *  \param  pB       Data put by peer B.
+ *  \param  lenB     Its length.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaFtTestReset(const uint8_t *pA, uint32_t lenA, const uint8_t *pB, uint32_t lenB)
+{
+    static const char *pName = "abort and disconnect of one peer";
+    uint8_t eraseReq[WDX_FTC_HDR_LEN + WDX_FTC_HANDLE_LEN] = { WDX_FTC_OP_ERASE_REQ, 0, 0 };
+    int failures = otaFtFailures;
+    uint32_t offB = 0, len, pass;
+    uint8_t status = ATT_SUCCESS;
+
+    otaFtReset();
+
+    /* Peer A gets file 0, peer B gets it too and puts file 1 */
+    otaFtReq(OTA_FT_CONN_A, WDX_FTC_OP_GET_REQ, 0, lenA);
+    otaFtReq(OTA_FT_CONN_B, WDX_FTC_OP_GET_REQ, 0, lenA);
+    otaFtCheck(pName, otaFtPeer[1].ftcStatus[0] == WDX_FTC_ST_IN_PROGRESS,
+               "get of a file another connection is getting was accepted");
+    otaFtReq(OTA_FT_CONN_B, WDX_FTC_OP_PUT_REQ, 1, lenB);
+
+    wdxsFtdSched();
+    otaFtConfirm(OTA_FT_CONN_A);
+
+    /* Peer B's abort of a file it does not transfer leaves peer A's get */
+    otaFtAbort(OTA_FT_CONN_B, 0);
+    otaFtCheck(pName, (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT) != 0, "abort ended another peer's get");
+
+    /* Both peers have a response queued when peer A disconnects */
+    wdxsFtcWrite(OTA_FT_CONN_A, sizeof(eraseReq), eraseReq);
+    wdxsFtcWrite(OTA_FT_CONN_B, sizeof(eraseReq), eraseReq);
+    wdxsFtConnReset(OTA_FT_CONN_A);
+    otaFtFtcFlush();
+    otaFtCheck(pName, (otaFtFtcCount(OTA_FT_CONN_A, WDX_FTC_OP_ERASE_RSP) == 0) &&
+                      (otaFtFtcCount(OTA_FT_CONN_B, WDX_FTC_OP_ERASE_RSP) == 1),
+               "queued responses of the wrong peer dropped");
+    otaFtCheck(pName, (wdxsCb.txReadyMask & WDXS_TX_MASK_FTD_BIT) == 0, "get of a closed connection kept");
+
+    /* Peer B's put runs to the end */
+    while(offB < lenB) {
+        len = WSF_MIN(otaFtPeer[1].mtu - ATT_WRITE_CMD_LEN, lenB - offB);
+        status |= wdxsFtdWrite(OTA_FT_CONN_B, (uint16_t)len, (uint8_t*)pB + offB);
+        offB += len;
+        for(pass = 0; pass < 2; pass++) {
+            wdxsFtdSched();
+        }
+        otaFtFtcFlush();
+    }
+
+    otaFtCheck(pName, (status == ATT_SUCCESS) && (otaFtFtcCount(OTA_FT_CONN_B, WDX_FTC_OP_EOF) == 1) &&
+                      (memcmp((const uint8_t*)OTA_FT_RAM_BASE + OTA_FT_FILE_SIZE, pB, lenB) == 0),
+               "put of the other peer disturbed");
+    otaFtCheck(pName, otaFtPeer[0].numNtf == 1, "data sent on a closed connection");
+
+    printf("%-38s %s\n", pName, (otaFtFailures == failures) ? "ok" : "");
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the tests.
+ */
+/*************************************************************************************************/
+int main(int argc, char **argv)
+{
+    wsfEsfAttributes_t attr;
+    uint8_t *pRam, *pA, *pB;
+    uint32_t lenA = 5000, lenB = 1111, i;
+
+    pRam = mmap((void*)OTA_FT_RAM_BASE, OTA_FT_RAM_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if(pRam != (uint8_t*)OTA_FT_RAM_BASE) {
+        perror("ram media");
+        return 1;
+    }
+
+    WsfEfsInit();
+    WsfEfsRegisterMedia(&otaFtRamMedia, WDX_RAM_MEDIA);
+
+    memset(&attr, 0, sizeof(attr));
+    attr.permissions = WSF_EFS_REMOTE_GET_PERMITTED | WSF_EFS_REMOTE_PUT_PERMITTED |
+                       WSF_EFS_REMOTE_ERASE_PERMITTED;
+    attr.type = WSF_EFS_FILE_TYPE_BULK;
+    WsfEfsAddFile(OTA_FT_FILE_SIZE, WDX_RAM_MEDIA, &attr, 0);
+    WsfEfsAddFile(OTA_FT_FILE_SIZE, WDX_RAM_MEDIA, &attr, OTA_FT_FILE_SIZE);
+
+    pA = malloc(lenA);
+    pB = malloc(lenB);
+    for(i = 0; i < lenA; i++) {
+        pA[i] = (uint8_t)(i * 7 + 1);
+    }
+    for(i = 0; i < lenB; i++) {
+        pB[i] = (uint8_t)(i * 13 + 5);
+    }
+
+    otaFtTestPut(pA, lenA, pB, lenB);
+    otaFtTestGet(pA, lenA, pB, lenB);
+    otaFtTestReset(pA, lenA, pB, lenB);
+
+    free(pA);
+    free(pB);
+    free(otaFtPeer[0].pRx);
+    free(otaFtPeer[1].pRx);
+    munmap(pRam, OTA_FT_RAM_SIZE);
+
+    printf("%s\n", otaFtFailures ? "FAILED" : "PASSED");
+    return otaFtFailures ? 1 : 0;
+}
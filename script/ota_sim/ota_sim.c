@@ -0,0 +1,702 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Simulated MAX32665 flash media for host OTA benchmarks.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "wsf_types.h"
+#include "wsf_efs.h"
+#include "wdx_defs.h"
+#include "mxc_errors.h"
+#include "flash_sched.h"
+#include "ota_sim.h"
+
+/*
+ * The media follows wdxs_file.c for raw uploads: the update area is erased lazily ahead of
+ * the highest write, and erases and writes are queued for the idle bank like flash_sched.c
+ * does, with the same queue and data buffer limits. Callbacks that have to wait for the
+ * queue advance otaSimNow, which shows up as handler stall in the benchmark.
+ *
+ * Flash semantics: erase sets a page to 0xFF, programming a 128-bit line can only clear
+ * bits. Lines programmed over bits that were not erased are counted as dirty writes.
+ *
+ * The update area is mapped at OTA_SIM_BASE, and the flash_sched.c API is provided on the same
+ * queue, so wdxs_file.c itself can run on the simulated flash.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+enum {
+    OTA_SIM_OP_ERASE,
+    OTA_SIM_OP_WRITE
+};
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+uint64_t otaSimNow;
+
+/* Queued flash operation */
+typedef struct {
+    uint8_t   type;                     /* OTA_SIM_OP_ERASE or OTA_SIM_OP_WRITE */
+    uint32_t  offset;                   /* Offset in the update area */
+    uint32_t  len;                      /* Number of bytes */
+    uint8_t   *pData;                   /* Write data */
+    uint64_t  done;                     /* Completion time */
+} otaSimOp_t;
+
+static struct {
+    otaSimCfg_t cfg;
+    uint8_t     *pFlash;                /* Update area contents */
+    uint8_t     *pProgrammed;           /* Lines programmed since their page was erased */
+    int         fd;                     /* Backing file, or -1 */
+    otaSimOp_t  queue[FLASH_SCHED_QUEUE_LEN];
+    uint8_t     head;                   /* Oldest queued operation */
+    uint8_t     count;                  /* Number of queued operations */
+    uint32_t    dataUsed;               /* Write data queued */
+    uint32_t    erasePos;               /* Deferred erase queued below this offset */
+    uint32_t    eraseEnd;               /* End of the deferred erase */
+    uint32_t    lastWrite;              /* Offset of the last write, the CRC32 trailer */
+    otaSimStats_t stats;
+} otaSimCb;
+
+static uint8_t otaSimMediaInit(void);
+static uint8_t otaSimErase(uint8_t *pAddress, uint32_t size);
+static uint8_t otaSimRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
+static uint8_t otaSimWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
+static uint8_t otaSimHandleCmd(uint8_t cmd, uint32_t param);
+static const uint8_t *otaSimMap(uint8_t *pAddress, uint32_t size);
+
+static wsfEfsMedia_t otaSimMedia = {
+    OTA_SIM_BASE,
+    OTA_SIM_BASE,
+    OTA_SIM_PAGE_SIZE,
+    otaSimMediaInit,
+    otaSimErase,
+    otaSimRead,
+    otaSimWrite,
+    otaSimHandleCmd,
+    otaSimMap
+};
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Apply a completed flash operation.
+ *
+ *  \param  pOp      Operation.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaSimApply(const otaSimOp_t *pOp)
+{
+    uint32_t line, i;
+    bool_t dirty;
+
+    if(pOp->type == OTA_SIM_OP_ERASE) {
+        memset(otaSimCb.pFlash + pOp->offset, 0xFF, pOp->len);
+        memset(otaSimCb.pProgrammed + pOp->offset / OTA_SIM_LINE_SIZE, 0, pOp->len / OTA_SIM_LINE_SIZE);
+        otaSimCb.stats.pageErases += pOp->len / OTA_SIM_PAGE_SIZE;
+        return;
+    }
+
+    for(line = pOp->offset / OTA_SIM_LINE_SIZE;
+        line <= (pOp->offset + pOp->len - 1) / OTA_SIM_LINE_SIZE; line++) {
+        if(otaSimCb.pProgrammed[line]) {
+            otaSimCb.stats.lineRewrites++;
+        }
+        otaSimCb.pProgrammed[line] = 1;
+        otaSimCb.stats.lineWrites++;
+    }
+
+    /* Programming only clears bits */
+    dirty = FALSE;
+    for(i = 0; i < pOp->len; i++) {
+        uint8_t *p = otaSimCb.pFlash + pOp->offset + i;
+
+        if((*p & pOp->pData[i]) != pOp->pData[i]) {
+            dirty = TRUE;
+        }
+        *p &= pOp->pData[i];
+    }
+
+    if(dirty) {
+        otaSimCb.stats.dirtyWrites++;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Complete background flash operations that finish by otaSimNow.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void OtaSimRun(void)
+{
+    otaSimOp_t *pOp;
+
+    while(otaSimCb.count && (otaSimCb.queue[otaSimCb.head].done <= otaSimNow)) {
+        pOp = &otaSimCb.queue[otaSimCb.head];
+        otaSimApply(pOp);
+
+        if(pOp->pData != NULL) {
+            otaSimCb.dataUsed -= pOp->len;
+            free(pOp->pData);
+            pOp->pData = NULL;
+        }
+
+        otaSimCb.head = (otaSimCb.head + 1) % FLASH_SCHED_QUEUE_LEN;
+        otaSimCb.count--;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for the oldest queued operation, stalling the caller.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaSimWaitOne(void)
+{
+    uint64_t done = otaSimCb.queue[otaSimCb.head].done;
+
+    if(done > otaSimNow) {
+        otaSimCb.stats.stallUs += done - otaSimNow;
+        otaSimNow = done;
+    }
+    OtaSimRun();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for all queued operations.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaSimFlush(void)
+{
+    OtaSimRun();
+    while(otaSimCb.count) {
+        otaSimWaitOne();
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether queued operations cover a range.
+ *
+ *  \param  offset   Offset in the update area.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range must not be read yet.
+ */
+/*************************************************************************************************/
+static bool_t otaSimPending(uint32_t offset, uint32_t len)
+{
+    const otaSimOp_t *pOp;
+    uint8_t i;
+
+    OtaSimRun();
+    for(i = 0; i < otaSimCb.count; i++) {
+        pOp = &otaSimCb.queue[(otaSimCb.head + i) % FLASH_SCHED_QUEUE_LEN];
+        if((offset < pOp->offset + pOp->len) && (pOp->offset < offset + len)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Queue a flash operation, waiting for queue and buffer space.
+ *
+ *  \param  type     OTA_SIM_OP_ERASE or OTA_SIM_OP_WRITE.
+ *  \param  offset   Offset in the update area.
+ *  \param  pData    Write data.
+ *  \param  len      Number of bytes, at most FLASH_SCHED_DATA_LEN for a write.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaSimQueue(uint8_t type, uint32_t offset, const uint8_t *pData, uint32_t len)
+{
+    otaSimOp_t *pOp;
+    uint64_t start;
+    uint32_t lines;
+
+    OtaSimRun();
+    while((otaSimCb.count == FLASH_SCHED_QUEUE_LEN) ||
+          ((type == OTA_SIM_OP_WRITE) && (otaSimCb.dataUsed + len > FLASH_SCHED_DATA_LEN))) {
+        otaSimWaitOne();
+    }
+
+    /* Starts when the previous operation completes */
+    start = otaSimNow;
+    if(otaSimCb.count) {
+        start = otaSimCb.queue[(otaSimCb.head + otaSimCb.count - 1) % FLASH_SCHED_QUEUE_LEN].done;
+    }
+
+    pOp = &otaSimCb.queue[(otaSimCb.head + otaSimCb.count) % FLASH_SCHED_QUEUE_LEN];
+    pOp->type = type;
+    pOp->offset = offset;
+    pOp->len = len;
+    pOp->pData = NULL;
+
+    if(type == OTA_SIM_OP_ERASE) {
+        pOp->done = start + (uint64_t)(len / OTA_SIM_PAGE_SIZE) * otaSimCb.cfg.eraseUs;
+    } else {
+        lines = (offset + len - 1) / OTA_SIM_LINE_SIZE - offset / OTA_SIM_LINE_SIZE + 1;
+        pOp->done = start + (uint64_t)lines * otaSimCb.cfg.writeUs;
+        pOp->pData = malloc(len);
+        memcpy(pOp->pData, pData, len);
+        otaSimCb.dataUsed += len;
+    }
+
+    otaSimCb.count++;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Queue the deferred erase up to an offset.
+ *
+ *  \param  offset   Offset in the update area, rounded up to a page.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void otaSimEraseTo(uint32_t offset)
+{
+    uint32_t end = (offset + OTA_SIM_PAGE_SIZE - 1) & ~(uint32_t)(OTA_SIM_PAGE_SIZE - 1);
+
+    if(end > otaSimCb.eraseEnd) {
+        end = otaSimCb.eraseEnd;
+    }
+
+    if(end > otaSimCb.erasePos) {
+        otaSimQueue(OTA_SIM_OP_ERASE, otaSimCb.erasePos, NULL, end - otaSimCb.erasePos);
+        otaSimCb.erasePos = end;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Media Init function, called when media is registered.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaSimMediaInit(void)
+{
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  File erase function. Must be page aligned.
+ *
+ *  \param  pAddress Address in media to start erasing.
+ *  \param  size     Number of bytes to erase.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaSimErase(uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)(uintptr_t)pAddress - OTA_SIM_BASE;
+
+    otaSimCb.erasePos = offset;
+    otaSimCb.eraseEnd = offset + size;
+
+    if(otaSimCb.cfg.eraseAhead == 0) {
+        /* Erase everything before the put response */
+        otaSimEraseTo(offset + size);
+        otaSimFlush();
+    } else {
+        otaSimEraseTo(offset + otaSimCb.cfg.eraseAhead * OTA_SIM_PAGE_SIZE);
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Media Read function.
+ *
+ *  \param  pBuf     Buffer to hold data.
+ *  \param  pAddress Address in media to read from.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaSimRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)(uintptr_t)pAddress - OTA_SIM_BASE;
+    uint32_t lo, hi;
+
+    if(otaSimPending(offset, size)) {
+        otaSimFlush();
+    }
+
+    memcpy(pBuf, otaSimCb.pFlash + offset, size);
+
+    /* Pages still waiting for the deferred erase */
+    lo = (offset > otaSimCb.erasePos) ? offset : otaSimCb.erasePos;
+    hi = (offset + size < otaSimCb.eraseEnd) ? (offset + size) : otaSimCb.eraseEnd;
+    if(lo < hi) {
+        memset(pBuf + (lo - offset), 0xFF, hi - lo);
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  File Write function.
+ *
+ *  \param  pBuf     Buffer with data to be written.
+ *  \param  address  Address in media to write to.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaSimWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)(uintptr_t)pAddress - OTA_SIM_BASE;
+    uint32_t chunk;
+
+    if(offset + size > otaSimCb.cfg.size) {
+        return WSF_EFS_FAILURE;
+    }
+
+    otaSimEraseTo(offset + size + otaSimCb.cfg.eraseAhead * OTA_SIM_PAGE_SIZE);
+
+    otaSimCb.lastWrite = offset;
+    while(size) {
+        chunk = (size < FLASH_SCHED_DATA_LEN) ? size : FLASH_SCHED_DATA_LEN;
+        otaSimQueue(OTA_SIM_OP_WRITE, offset, pBuf, chunk);
+        offset += chunk;
+        pBuf += chunk;
+        size -= chunk;
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Media Map function.
+ *
+ *  \param  pAddress Address in media to map.
+ *  \param  size     Number of bytes to map.
+ *
+ *  \return Pointer to read the data directly, or NULL if it must be read instead.
+ */
+/*************************************************************************************************/
+static const uint8_t *otaSimMap(uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)(uintptr_t)pAddress - OTA_SIM_BASE;
+
+    if(otaSimPending(offset, size) ||
+       ((offset + size > otaSimCb.erasePos) && (offset < otaSimCb.eraseEnd))) {
+        return NULL;
+    }
+
+    return otaSimCb.pFlash + offset;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Media Specific Command handler.
+ *
+ *  \param  cmd      Identifier of the media specific command.
+ *  \param  param    Optional Parameter to the command.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t otaSimHandleCmd(uint8_t cmd, uint32_t param)
+{
+    uint32_t crcFile;
+
+    if(cmd != WSF_EFS_VALIDATE_CMD) {
+        return WDX_FTC_ST_SUCCESS;
+    }
+
+    /* Image followed by its CRC32, the last write */
+    otaSimFlush();
+    memcpy(&crcFile, otaSimCb.pFlash + otaSimCb.lastWrite, sizeof(crcFile));
+
+    if(OtaSimCrc32(otaSimCb.pFlash, otaSimCb.lastWrite, 0) != crcFile) {
+        return WDX_FTC_ST_VERIFICATION;
+    }
+
+    return WDX_FTC_ST_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  CRC32 as computed by the validate command.
+ *
+ *  \param  pBuf     Data.
+ *  \param  len      Number of bytes.
+ *  \param  crc      Initial value, 0 to start.
+ *
+ *  \return CRC32.
+ */
+/*************************************************************************************************/
+uint32_t OtaSimCrc32(const uint8_t *pBuf, uint32_t len, uint32_t crc)
+{
+    uint32_t r;
+    int j;
+
+    while(len--) {
+        r = (uint8_t)crc ^ *pBuf++;
+        for(j = 0; j < 8; j++) {
+            r = ((r & 1) ? 0 : 0xEDB88320) ^ (r >> 1);
+        }
+        crc = (r ^ 0xFF000000) ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create the simulated flash, mapped at OTA_SIM_BASE.
+ *
+ *  \param  pCfg     Configuration.
+ *  \param  pPath    File backing the update area, created if missing, or NULL for memory.
+ *
+ *  \return 0 on success, -1 on error.
+ */
+/*************************************************************************************************/
+int OtaSimInit(const otaSimCfg_t *pCfg, const char *pPath)
+{
+    memset(&otaSimCb, 0, sizeof(otaSimCb));
+    otaSimCb.cfg = *pCfg;
+    otaSimCb.fd = -1;
+    otaSimNow = 0;
+
+    otaSimMedia.endAddress = OTA_SIM_BASE + pCfg->size;
+
+    if(pPath != NULL) {
+        if(((otaSimCb.fd = open(pPath, O_RDWR | O_CREAT, 0644)) < 0) ||
+           (ftruncate(otaSimCb.fd, pCfg->size) < 0)) {
+            perror(pPath);
+            return -1;
+        }
+
+        otaSimCb.pFlash = mmap((void*)OTA_SIM_BASE, pCfg->size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_FIXED_NOREPLACE, otaSimCb.fd, 0);
+    } else {
+        /* Old contents, every bit must be erased before it is programmed */
+        otaSimCb.pFlash = mmap((void*)OTA_SIM_BASE, pCfg->size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    }
+
+    if(otaSimCb.pFlash != (uint8_t*)OTA_SIM_BASE) {
+        perror("update area");
+        return -1;
+    }
+
+    /* Contents of an existing file are not known to be freshly erased */
+    otaSimCb.pProgrammed = malloc(pCfg->size / OTA_SIM_LINE_SIZE);
+    memset(otaSimCb.pProgrammed, 1, pCfg->size / OTA_SIM_LINE_SIZE);
+
+    return 0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write back and release the simulated flash.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void OtaSimClose(void)
+{
+    otaSimFlush();
+
+    munmap(otaSimCb.pFlash, otaSimCb.cfg.size);
+    if(otaSimCb.fd >= 0) {
+        close(otaSimCb.fd);
+    }
+
+    free(otaSimCb.pProgrammed);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the media to register with WsfEfsRegisterMedia().
+ *
+ *  \return Simulated media.
+ */
+/*************************************************************************************************/
+const wsfEfsMedia_t *OtaSimMedia(void)
+{
+    return &otaSimMedia;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the flash statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const otaSimStats_t *OtaSimGetStats(void)
+{
+    return &otaSimCb.stats;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Initialize the flash scheduler.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void FlashSchedInit(void)
+{
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check a flash scheduler range against the update area.
+ *
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range is in the update area.
+ */
+/*************************************************************************************************/
+static bool_t otaSimInArea(uint32_t addr, uint32_t len)
+{
+    return (addr >= OTA_SIM_BASE) && (len <= otaSimCb.cfg.size) &&
+           (addr - OTA_SIM_BASE <= otaSimCb.cfg.size - len);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase flash pages.
+ *
+ *  \param  addr     Page aligned address.
+ *  \param  len      Number of bytes, multiple of the page size.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued, E_BAD_PARAM for a bad range.
+ */
+/*************************************************************************************************/
+int FlashSchedErase(uint32_t addr, uint32_t len, flashSchedCback_t *cback)
+{
+    if(!otaSimInArea(addr, len) || (addr % OTA_SIM_PAGE_SIZE) || (len % OTA_SIM_PAGE_SIZE)) {
+        return E_BAD_PARAM;
+    }
+
+    otaSimQueue(OTA_SIM_OP_ERASE, addr - OTA_SIM_BASE, NULL, len);
+
+    if(cback != NULL) {
+        otaSimFlush();
+        cback(E_NO_ERROR);
+    }
+
+    return E_NO_ERROR;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Program flash.
+ *
+ *  \param  addr     Address, any alignment.
+ *  \param  pBuf     Data to program.
+ *  \param  len      Number of bytes.
+ *  \param  cback    Called when done, may be NULL.
+ *
+ *  \return E_NO_ERROR if queued, E_BAD_PARAM for a bad range.
+ */
+/*************************************************************************************************/
+int FlashSchedWrite(uint32_t addr, const void *pBuf, uint32_t len, flashSchedCback_t *cback)
+{
+    const uint8_t *p = pBuf;
+    uint32_t chunk;
+
+    if(!otaSimInArea(addr, len)) {
+        return E_BAD_PARAM;
+    }
+
+    while(len) {
+        chunk = (len < FLASH_SCHED_DATA_LEN) ? len : FLASH_SCHED_DATA_LEN;
+        otaSimQueue(OTA_SIM_OP_WRITE, addr - OTA_SIM_BASE, p, chunk);
+        addr += chunk;
+        p += chunk;
+        len -= chunk;
+    }
+
+    if(cback != NULL) {
+        otaSimFlush();
+        cback(E_NO_ERROR);
+    }
+
+    return E_NO_ERROR;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Wait for all queued operations to finish.
+ *
+ *  \return E_NO_ERROR.
+ */
+/*************************************************************************************************/
+int FlashSchedFlush(void)
+{
+    otaSimFlush();
+
+    return E_NO_ERROR;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether queued operations still cover a range.
+ *
+ *  \param  addr     Address.
+ *  \param  len      Number of bytes.
+ *
+ *  \return TRUE if the range must not be read yet.
+ */
+/*************************************************************************************************/
+bool_t FlashSchedPending(uint32_t addr, uint32_t len)
+{
+    if(!otaSimInArea(addr, len)) {
+        return FALSE;
+    }
+
+    return otaSimPending(addr - OTA_SIM_BASE, len);
+}
@@ -0,0 +1,142 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Simulated MAX32665 flash media for host OTA benchmarks.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef OTA_SIM_H
+#define OTA_SIM_H
+
+#include "wsf_types.h"
+#include "wsf_efs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+  Constant Definitions
+**************************************************************************************************/
+
+/*! \brief Address of the update area, the second flash bank */
+#define OTA_SIM_BASE              0x10080000
+
+/*! \brief Flash page size */
+#define OTA_SIM_PAGE_SIZE         0x2000
+
+/*! \brief Flash program width, 128 bits */
+#define OTA_SIM_LINE_SIZE         16
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief Simulated flash configuration */
+typedef struct
+{
+    uint32_t  size;                   /*!< \brief Update area size, multiple of the page size */
+    uint32_t  eraseUs;                /*!< \brief Page erase time */
+    uint32_t  writeUs;                /*!< \brief 128-bit line program time */
+    uint32_t  eraseAhead;             /*!< \brief Pages erased ahead of the highest write, 0 to erase all on put */
+} otaSimCfg_t;
+
+/*! \brief Simulated flash statistics */
+typedef struct
+{
+    uint32_t  pageErases;             /*!< \brief Pages erased */
+    uint32_t  lineWrites;             /*!< \brief 128-bit lines programmed */
+    uint32_t  lineRewrites;           /*!< \brief Lines programmed again without an erase */
+    uint32_t  dirtyWrites;            /*!< \brief Lines programmed over bits that were not erased */
+    uint64_t  stallUs;                /*!< \brief Time media callbacks waited on the flash */
+} otaSimStats_t;
+
+/**************************************************************************************************
+  Global Variables
+**************************************************************************************************/
+
+/*! \brief Simulated time in microseconds, advanced by the caller and by flash waits */
+extern uint64_t otaSimNow;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create the simulated flash, mapped at OTA_SIM_BASE.
+ *
+ *  \param  pCfg     Configuration.
+ *  \param  pPath    File backing the update area, created if missing, or NULL for memory.
+ *
+ *  \return 0 on success, -1 on error.
+ */
+/*************************************************************************************************/
+int OtaSimInit(const otaSimCfg_t *pCfg, const char *pPath);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Write back and release the simulated flash.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void OtaSimClose(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the media to register with WsfEfsRegisterMedia().
+ *
+ *  \return Simulated media.
+ */
+/*************************************************************************************************/
+const wsfEfsMedia_t *OtaSimMedia(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Complete background flash operations that finish by otaSimNow.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void OtaSimRun(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the flash statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const otaSimStats_t *OtaSimGetStats(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  CRC32 as computed by the validate command.
+ *
+ *  \param  pBuf     Data.
+ *  \param  len      Number of bytes.
+ *  \param  crc      Initial value, 0 to start.
+ *
+ *  \return CRC32.
+ */
+/*************************************************************************************************/
+uint32_t OtaSimCrc32(const uint8_t *pBuf, uint32_t len, uint32_t crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OTA_SIM_H */
@@ -0,0 +1,233 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Simulated flash media for host tests of the RACP record store.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <string.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include "wsf_types.h"
+#include "wsf_efs.h"
+#include "racp_sim.h"
+
+/*
+ * Flash on RAM: erasing sets bytes to 0xFF, programming can only clear bits. A reset is modelled
+ * by a long jump out of the record store, back to RacpSimResetAt().
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Media size */
+#define RACP_SIM_SIZE           (RACP_SIM_PAGE_SIZE * RACP_SIM_NUM_PAGES)
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Media */
+static wsfEfsMedia_t racpSimMedia;
+
+/* Statistics */
+static racpSimStats_t racpSimStats;
+
+/* Reset placement */
+static struct {
+    jmp_buf   env;                    /* Return to RacpSimResetAt() */
+    uint32_t  count;                  /* Operations left before the reset, 0 for none */
+    uint32_t  keep;                   /* Bytes a write cut short programs */
+    uint8_t   op;                     /* Operation */
+} racpSimResetCb;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether the reset comes at an operation.
+ *
+ *  \param  op       Operation.
+ *
+ *  \return TRUE if the reset comes now.
+ */
+/*************************************************************************************************/
+static bool_t racpSimResetNow(uint8_t op)
+{
+    if((racpSimResetCb.count == 0) || (racpSimResetCb.op != op)) {
+        return FALSE;
+    }
+
+    return --racpSimResetCb.count == 0;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Erase media.
+ *
+ *  \param  pAddress Address in media to start erasing.
+ *  \param  size     Number of bytes to erase.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpSimErase(uint8_t *pAddress, uint32_t size)
+{
+    if(racpSimResetNow(RACP_SIM_OP_ERASE)) {
+        longjmp(racpSimResetCb.env, 1);
+    }
+
+    memset(pAddress, 0xFF, size);
+    racpSimStats.erases += size / RACP_SIM_PAGE_SIZE;
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Read media.
+ *
+ *  \param  pBuf     Buffer to hold data.
+ *  \param  pAddress Address in media to read from.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpSimRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    memcpy(pBuf, pAddress, size);
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Program media.
+ *
+ *  \param  pBuf     Buffer with data to be written.
+ *  \param  pAddress Address in media to write to.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return WSF_EFS_SUCCESS.
+ */
+/*************************************************************************************************/
+static uint8_t racpSimWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    uint32_t len = size;
+    uint32_t i;
+    bool_t reset = racpSimResetNow(RACP_SIM_OP_WRITE);
+
+    if(reset && (racpSimResetCb.keep < len)) {
+        len = racpSimResetCb.keep;
+    }
+
+    for(i = 0; i < len; i++) {
+        pAddress[i] &= pBuf[i];
+    }
+    racpSimStats.writes++;
+
+    if(reset) {
+        longjmp(racpSimResetCb.env, 1);
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Map media.
+ *
+ *  \param  pAddress Address in media to map.
+ *  \param  size     Number of bytes to map.
+ *
+ *  \return pAddress.
+ */
+/*************************************************************************************************/
+static const uint8_t *racpSimMap(uint8_t *pAddress, uint32_t size)
+{
+    return pAddress;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create the media on first use, then erase it and clear the statistics.
+ *
+ *  \return Media, NULL if it cannot be mapped.
+ */
+/*************************************************************************************************/
+const wsfEfsMedia_t *RacpSimReset(void)
+{
+    void *p;
+
+    if(racpSimMedia.erase == NULL) {
+        p = mmap((void*)RACP_SIM_BASE, RACP_SIM_SIZE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if(p != (void*)RACP_SIM_BASE) {
+            return NULL;
+        }
+
+        racpSimMedia.startAddress = RACP_SIM_BASE;
+        racpSimMedia.endAddress = RACP_SIM_BASE + RACP_SIM_SIZE;
+        racpSimMedia.pageSize = RACP_SIM_PAGE_SIZE;
+        racpSimMedia.erase = racpSimErase;
+        racpSimMedia.read = racpSimRead;
+        racpSimMedia.write = racpSimWrite;
+        racpSimMedia.map = racpSimMap;
+    }
+
+    memset((void*)RACP_SIM_BASE, 0xFF, RACP_SIM_SIZE);
+    memset(&racpSimStats, 0, sizeof(racpSimStats));
+    racpSimResetCb.count = 0;
+
+    return &racpSimMedia;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Call a function with a reset at a media operation.
+ *
+ *  \param  op       RACP_SIM_OP_WRITE or RACP_SIM_OP_ERASE.
+ *  \param  count    The reset comes at this operation of the type, from 1.
+ *  \param  keep     Bytes a write cut short programs.
+ *  \param  func     Function.
+ *
+ *  \return TRUE if the reset came before the function returned.
+ */
+/*************************************************************************************************/
+bool_t RacpSimResetAt(uint8_t op, uint32_t count, uint32_t keep, void (*func)(void))
+{
+    racpSimResetCb.op = op;
+    racpSimResetCb.count = count;
+    racpSimResetCb.keep = keep;
+
+    if(setjmp(racpSimResetCb.env) != 0) {
+        return TRUE;
+    }
+
+    func();
+    racpSimResetCb.count = 0;
+
+    return FALSE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const racpSimStats_t *RacpSimGetStats(void)
+{
+    return &racpSimStats;
+}
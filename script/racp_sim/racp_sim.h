@@ -0,0 +1,101 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Simulated flash media for host tests of the RACP record store.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#ifndef RACP_SIM_H
+#define RACP_SIM_H
+
+#include "wsf_types.h"
+#include "wsf_efs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/*! \brief Media address, below 4 GiB as media addresses are kept in 32 bits */
+#define RACP_SIM_BASE             0x10000000
+
+/*! \brief Media page size and number of pages */
+#define RACP_SIM_PAGE_SIZE        512
+#define RACP_SIM_NUM_PAGES        4
+
+/** \name Media operations a reset can be placed at
+ *
+ */
+/**@{*/
+#define RACP_SIM_OP_WRITE         0
+#define RACP_SIM_OP_ERASE         1
+/**@}*/
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief Media statistics */
+typedef struct
+{
+    uint32_t  writes;                 /*!< \brief Write calls */
+    uint32_t  erases;                 /*!< \brief Pages erased */
+} racpSimStats_t;
+
+/**************************************************************************************************
+  Function Declarations
+**************************************************************************************************/
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Create the media on first use, then erase it and clear the statistics.
+ *
+ *  \return Media, NULL if it cannot be mapped.
+ */
+/*************************************************************************************************/
+const wsfEfsMedia_t *RacpSimReset(void);
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Call a function with a reset at a media operation. A write the reset cuts short
+ *          programs its first bytes only, an erase it comes at is not done.
+ *
+ *  \param  op       RACP_SIM_OP_WRITE or RACP_SIM_OP_ERASE.
+ *  \param  count    The reset comes at this operation of the type, from 1.
+ *  \param  keep     Bytes a write cut short programs.
+ *  \param  func     Function.
+ *
+ *  \return TRUE if the reset came before the function returned.
+ */
+/*************************************************************************************************/
+bool_t RacpSimResetAt(uint8_t op, uint32_t count, uint32_t keep, void (*func)(void));
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Get the statistics.
+ *
+ *  \return Statistics.
+ */
+/*************************************************************************************************/
+const racpSimStats_t *RacpSimGetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RACP_SIM_H */
@@ -0,0 +1,690 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host test of the RACP record store of racp_store.c on simulated flash.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "wsf_types.h"
+#include "wsf_efs.h"
+#include "svc_ch.h"
+#include "racp/racp_store.h"
+#include "racp_sim.h"
+
+/*
+ * A reset is modelled by opening the store again on the same media. The test keeps a model of the
+ * records it expects, oldest first, and checks the store against it. With 20 byte records a 512
+ * byte page holds 15 log entries, so the 4 page log keeps at most 30 records.
+ */
+
+/**************************************************************************************************
+  Macros
+**************************************************************************************************/
+
+/* Record length */
+#define RACP_TEST_REC_LEN         20
+
+/* Records configured, more than the log keeps */
+#define RACP_TEST_MAX_REC         40
+
+/* Records the log keeps */
+#define RACP_TEST_KEPT            30
+
+/* Time key of a record */
+#define RACP_TEST_TIME(seq)       (1000 + 60 * (uint32_t) (uint16_t) ((seq) + 0x20))
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/* Expected record */
+typedef struct {
+    uint16_t  seqNum;                 /* Sequence number */
+    uint32_t  time;                   /* Time key */
+} racpTestRec_t;
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Tests failed */
+static int racpTestFailures;
+
+/* Record store and its configuration */
+static racpStore_t racpTestStore;
+static racpStoreCfg_t racpTestCfg;
+static racpStoreIdx_t racpTestIdx[RACP_TEST_MAX_REC];
+static uint8_t racpTestBuf[RACP_TEST_REC_LEN];
+
+/* Expected records, oldest first */
+static racpTestRec_t racpTestModel[RACP_TEST_MAX_REC];
+static uint16_t racpTestNumRec;
+
+/* Next sequence number stored */
+static uint16_t racpTestSeq;
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Fill in the record of a sequence number.
+ *
+ *  \param  seqNum   Sequence number.
+ *  \param  pRec     Record, RACP_TEST_REC_LEN bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpTestFill(uint16_t seqNum, uint8_t *pRec)
+{
+    uint8_t i;
+
+    for(i = 0; i < RACP_TEST_REC_LEN; i++) {
+        pRec[i] = (uint8_t)(seqNum * 7 + i);
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Open the store, as after a reset.
+ *
+ *  \return TRUE if opened.
+ */
+/*************************************************************************************************/
+static bool_t racpTestOpen(void)
+{
+    return RacpStoreInit(&racpTestStore, &racpTestCfg);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start with erased media and sequence numbers from a value.
+ *
+ *  \param  seqNum   First sequence number.
+ *
+ *  \return TRUE if the store opened.
+ */
+/*************************************************************************************************/
+static bool_t racpTestStart(uint16_t seqNum)
+{
+    racpTestCfg.pMedia = RacpSimReset();
+    racpTestCfg.pIdx = racpTestIdx;
+    racpTestCfg.pBuf = racpTestBuf;
+    racpTestCfg.maxRec = RACP_TEST_MAX_REC;
+    racpTestCfg.recLen = RACP_TEST_REC_LEN;
+
+    racpTestNumRec = 0;
+    racpTestSeq = seqNum;
+
+    return (racpTestCfg.pMedia != NULL) && racpTestOpen();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Expect a record stored, the oldest is dropped when the store is full.
+ *
+ *  \param  seqNum   Sequence number.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpTestExpect(uint16_t seqNum)
+{
+    if(racpTestNumRec == RACP_TEST_KEPT) {
+        memmove(racpTestModel, racpTestModel + 1, (RACP_TEST_KEPT - 1) * sizeof(racpTestRec_t));
+        racpTestNumRec--;
+    }
+
+    racpTestModel[racpTestNumRec].seqNum = seqNum;
+    racpTestModel[racpTestNumRec].time = RACP_TEST_TIME(seqNum);
+    racpTestNumRec++;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store a record with the next sequence number, and expect it.
+ *
+ *  \return TRUE if stored.
+ */
+/*************************************************************************************************/
+static bool_t racpTestPut(void)
+{
+    uint8_t rec[RACP_TEST_REC_LEN];
+    uint16_t seqNum = racpTestSeq;
+
+    racpTestFill(seqNum, rec);
+    if(!RacpStorePut(&racpTestStore, seqNum, RACP_TEST_TIME(seqNum), rec)) {
+        return FALSE;
+    }
+
+    racpTestExpect(seqNum);
+    racpTestSeq++;
+
+    return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store records with the next sequence numbers.
+ *
+ *  \param  count    Number of records.
+ *
+ *  \return TRUE if all were stored.
+ */
+/*************************************************************************************************/
+static bool_t racpTestPutMany(uint16_t count)
+{
+    while(count--) {
+        if(!racpTestPut()) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Store the next record, for RacpSimResetAt().
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpTestPutOne(void)
+{
+    racpTestPut();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check whether storing the next record reclaims a page.
+ *
+ *  \return TRUE if it does.
+ */
+/*************************************************************************************************/
+static bool_t racpTestReclaimNext(void)
+{
+    racpStore_t *pStore = &racpTestStore;
+
+    return (pStore->wrEntry == pStore->pageEntries) &&
+           ((pStore->wrPage + 2) % pStore->numPages == pStore->oldest);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check a selection against the expected records.
+ *
+ *  \param  oper     RACP operator.
+ *  \param  key      RACP_STORE_KEY_SEQ or RACP_STORE_KEY_TIME.
+ *  \param  lo       Lowest key.
+ *  \param  hi       Highest key.
+ *  \param  first    First expected record.
+ *  \param  count    Number of expected records.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestSelect(uint8_t oper, uint8_t key, uint32_t lo, uint32_t hi,
+                                  uint16_t first, uint16_t count)
+{
+    racpStoreSel_t sel;
+    const uint8_t *pRec;
+    uint8_t rec[RACP_TEST_REC_LEN];
+    uint8_t status;
+    uint16_t pos;
+    uint16_t i;
+
+    status = RacpStoreSelect(&racpTestStore, oper, key, lo, hi, &sel);
+    if(status != ((count > 0) ? CH_RACP_RSP_SUCCESS : CH_RACP_RSP_NO_RECORDS)) {
+        return "wrong select status";
+    }
+
+    if(RacpStoreCount(&racpTestStore, &sel) != count) {
+        return "wrong count";
+    }
+
+    for(i = first; i < first + count; i++) {
+        if(!RacpStoreNext(&racpTestStore, &sel, &pos)) {
+            return "record missing";
+        }
+
+        if((racpTestIdx[pos].seqNum != racpTestModel[i].seqNum) ||
+           (racpTestIdx[pos].time != racpTestModel[i].time)) {
+            return "wrong record selected";
+        }
+
+        pRec = RacpStoreGet(&racpTestStore, pos);
+        racpTestFill(racpTestModel[i].seqNum, rec);
+        if(memcmp(pRec, rec, RACP_TEST_REC_LEN) != 0) {
+            return "wrong record contents";
+        }
+    }
+
+    if(RacpStoreNext(&racpTestStore, &sel, &pos)) {
+        return "too many records";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Check the store holds the expected records, before and after a reset.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestCheck(void)
+{
+    const char *pErr;
+
+    if((pErr = racpTestSelect(CH_RACP_OPERATOR_ALL, 0, 0, 0, 0, racpTestNumRec)) != NULL) {
+        return pErr;
+    }
+
+    if(!racpTestOpen()) {
+        return "store not opened";
+    }
+
+    if(racpTestStore.numRec != racpTestNumRec) {
+        return "wrong record count after a reset";
+    }
+
+    if((racpTestStore.wrPage + 1) % racpTestStore.numPages == racpTestStore.oldest) {
+        return "no erased page ahead after a reset";
+    }
+
+    if((pErr = racpTestSelect(CH_RACP_OPERATOR_ALL, 0, 0, 0, 0, racpTestNumRec)) != NULL) {
+        return pErr;
+    }
+
+    if((racpTestNumRec > 0) && (racpTestStore.lastSeq != (uint16_t)(racpTestSeq - 1))) {
+        return "wrong last sequence number";
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Records appended are found again after a reset.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestAppend(void)
+{
+    if(!racpTestStart(1)) {
+        return "store not opened";
+    }
+
+    if(racpTestStore.cfg.maxRec != RACP_TEST_KEPT) {
+        return "maxRec not capped";
+    }
+
+    if(!racpTestPutMany(20)) {
+        return "put failed";
+    }
+
+    if(racpTestOpen() && RacpStorePut(&racpTestStore, 0, 0, racpTestBuf)) {
+        return "old sequence number stored";
+    }
+
+    return racpTestCheck();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  A record cut short by a reset is dropped, and the log carries on after it.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestTornRecord(void)
+{
+    const char *pErr;
+
+    if(!racpTestStart(1) || !racpTestPutMany(5)) {
+        return "put failed";
+    }
+
+    /* the entry header is written, the record only in part */
+    if(!RacpSimResetAt(RACP_SIM_OP_WRITE, 2, 6, racpTestPutOne)) {
+        return "no reset";
+    }
+
+    if((pErr = racpTestCheck()) != NULL) {
+        return pErr;
+    }
+
+    if(!racpTestPutMany(3)) {
+        return "put after the reset failed";
+    }
+
+    return racpTestCheck();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  A page header cut short by a reset ends the generations replayed, and the page is
+ *          written again.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestTornPage(void)
+{
+    const char *pErr;
+    uint32_t keep;
+
+    /* magic only, then magic and part of the generation */
+    for(keep = 4; keep <= 6; keep += 2) {
+        if(!racpTestStart(1) || !racpTestPutMany(15)) {
+            return "put failed";
+        }
+
+        if(!RacpSimResetAt(RACP_SIM_OP_WRITE, 1, keep, racpTestPutOne)) {
+            return "no reset";
+        }
+
+        if((pErr = racpTestCheck()) != NULL) {
+            return pErr;
+        }
+
+        if(racpTestStore.wrPage != 0) {
+            return "torn page replayed";
+        }
+
+        if(!racpTestPutMany(20)) {
+            return "put after the reset failed";
+        }
+
+        if((pErr = racpTestCheck()) != NULL) {
+            return pErr;
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  The oldest records are dropped when the store is full, and reclaiming pages keeps
+ *          the live records.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestReclaim(void)
+{
+    racpStoreSel_t sel;
+    const char *pErr;
+    uint16_t i;
+
+    if(!racpTestStart(1) || !racpTestPutMany(100)) {
+        return "put failed";
+    }
+
+    if(RacpSimGetStats()->erases < 5) {
+        return "pages not reclaimed";
+    }
+
+    if((pErr = racpTestCheck()) != NULL) {
+        return pErr;
+    }
+
+    /* delete a run in the middle, the space is reclaimed */
+    RacpStoreSelect(&racpTestStore, CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ,
+                    racpTestModel[10].seqNum, racpTestModel[19].seqNum, &sel);
+    RacpStoreDelete(&racpTestStore, &sel);
+    memmove(racpTestModel + 10, racpTestModel + 20, 10 * sizeof(racpTestRec_t));
+    racpTestNumRec -= 10;
+
+    if((pErr = racpTestCheck()) != NULL) {
+        return pErr;
+    }
+
+    for(i = 0; i < 50; i++) {
+        if(!racpTestPut()) {
+            return "put after the delete failed";
+        }
+    }
+
+    return racpTestCheck();
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  A reset at any write or at the erase of a reclaim loses no live record.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestReclaimReset(void)
+{
+    racpStoreSel_t sel;
+    const char *pErr;
+    uint16_t seqNum;
+    uint32_t count;
+    uint8_t op;
+
+    for(op = RACP_SIM_OP_WRITE; op <= RACP_SIM_OP_ERASE; op++) {
+        for(count = 1; count <= ((op == RACP_SIM_OP_WRITE) ? 40 : 1); count++) {
+            if(!racpTestStart(1) || !racpTestPutMany(40)) {
+                return "put failed";
+            }
+
+            while(!racpTestReclaimNext()) {
+                if(!racpTestPut()) {
+                    return "put failed";
+                }
+            }
+
+            seqNum = racpTestSeq;
+            if(!RacpSimResetAt(op, count, 6, racpTestPutOne)) {
+                continue;
+            }
+
+            /* the record being stored may be there or not, the oldest may be deleted already */
+            if(!racpTestOpen()) {
+                return "store not opened";
+            }
+            if(RacpStoreSelect(&racpTestStore, CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, seqNum,
+                               seqNum, &sel) == CH_RACP_RSP_SUCCESS) {
+                racpTestExpect(seqNum);
+            } else if(racpTestStore.numRec < racpTestNumRec) {
+                memmove(racpTestModel, racpTestModel + 1, (racpTestNumRec - 1) * sizeof(racpTestRec_t));
+                racpTestNumRec--;
+            }
+            racpTestSeq = racpTestStore.lastSeq + 1;
+
+            if((pErr = racpTestCheck()) != NULL) {
+                return pErr;
+            }
+
+            if(!racpTestPutMany(50)) {
+                return "put after the reset failed";
+            }
+
+            if((pErr = racpTestCheck()) != NULL) {
+                return pErr;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Selections by sequence number and by sorted time are found by binary search, and by
+ *          time out of order by a scan.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestSelectKeys(void)
+{
+    racpStoreSel_t sel;
+    const char *pErr;
+    uint8_t rec[RACP_TEST_REC_LEN];
+
+    if(!racpTestStart(1) || !racpTestPutMany(RACP_TEST_KEPT)) {
+        return "put failed";
+    }
+
+    if(!racpTestStore.timeSorted) {
+        return "time keys not sorted";
+    }
+
+    if(((pErr = racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_SEQ, 10, 0, 9, 21)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_LTEQ, RACP_STORE_KEY_SEQ, 0, 10, 0, 10)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, 5, 9, 4, 5)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_SEQ, 31, 0, 0, 0)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_FIRST, 0, 0, 0, 0, 1)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_LAST, 0, 0, 0, 29, 1)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_TIME, racpTestModel[20].time, 0,
+                               20, 10)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_TIME, racpTestModel[3].time - 1,
+                               racpTestModel[7].time + 1, 3, 5)) != NULL)) {
+        return pErr;
+    }
+
+    if(RacpStoreSelect(&racpTestStore, CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, 9, 5, &sel) !=
+       CH_RACP_RSP_INV_OPERAND) {
+        return "reversed range selected";
+    }
+
+    /* a record with an earlier time turns time selections into scans, the oldest is dropped */
+    racpTestFill(racpTestSeq, rec);
+    if(!RacpStorePut(&racpTestStore, racpTestSeq, 0, rec)) {
+        return "put failed";
+    }
+    racpTestExpect(racpTestSeq++);
+    racpTestModel[racpTestNumRec - 1].time = 0;
+
+    if(racpTestStore.timeSorted) {
+        return "time keys sorted";
+    }
+
+    if(((pErr = racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_TIME, racpTestModel[20].time, 0,
+                               20, 9)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_LTEQ, RACP_STORE_KEY_TIME, 0, 0, 29, 1)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_TIME, racpTestModel[3].time - 1,
+                               racpTestModel[7].time + 1, 3, 5)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, 2, 6, 0, 5)) != NULL)) {
+        return pErr;
+    }
+
+    return NULL;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Sequence numbers that wrap to 0 are stored after the others and keep the selections
+ *          in order, before and after a reset.
+ *
+ *  \return NULL on success, else the failure.
+ */
+/*************************************************************************************************/
+static const char *racpTestWrap(void)
+{
+    racpStoreSel_t sel;
+    const char *pErr;
+
+    if(!racpTestStart(0xFFF0) || !racpTestPutMany(26)) {
+        return "put over the wrap failed";
+    }
+
+    if(racpTestSeq != 10) {
+        return "sequence numbers did not wrap";
+    }
+
+    if(((pErr = racpTestCheck()) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_SEQ, 0xFFF8, 0, 8, 18)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_LTEQ, RACP_STORE_KEY_SEQ, 0, 5, 0, 22)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, 0xFFFE, 1, 14, 4)) != NULL) ||
+       ((pErr = racpTestSelect(CH_RACP_OPERATOR_LAST, 0, 0, 0, 25, 1)) != NULL)) {
+        return pErr;
+    }
+
+    /* a deleted sequence number from after the wrap is not new */
+    RacpStoreSelect(&racpTestStore, CH_RACP_OPERATOR_RANGE, RACP_STORE_KEY_SEQ, 3, 3, &sel);
+    RacpStoreDelete(&racpTestStore, &sel);
+    memmove(racpTestModel + 19, racpTestModel + 20, 6 * sizeof(racpTestRec_t));
+    racpTestNumRec--;
+
+    if(RacpStorePut(&racpTestStore, 3, 0, racpTestBuf)) {
+        return "old sequence number stored";
+    }
+
+    /* drop the records from before the wrap, through reclaims */
+    if(!racpTestPutMany(60)) {
+        return "put after the wrap failed";
+    }
+
+    if((pErr = racpTestCheck()) != NULL) {
+        return pErr;
+    }
+
+    return racpTestSelect(CH_RACP_OPERATOR_GTEQ, RACP_STORE_KEY_SEQ, 40, 0, 0, 30);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run a test and report the result.
+ *
+ *  \param  pName    Test name.
+ *  \param  test     Test.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void racpTestRun(const char *pName, const char *(*test)(void))
+{
+    const char *pErr = test();
+
+    printf("%-44s %s%s\n", pName, (pErr == NULL) ? "ok" : "FAIL: ", (pErr == NULL) ? "" : pErr);
+
+    if(pErr != NULL) {
+        racpTestFailures++;
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the tests.
+ *
+ *  \return 0 if all passed.
+ */
+/*************************************************************************************************/
+int main(void)
+{
+    if(RacpSimReset() == NULL) {
+        perror("media");
+        return 1;
+    }
+
+    racpTestRun("append and replay", racpTestAppend);
+    racpTestRun("record cut short by a reset", racpTestTornRecord);
+    racpTestRun("page header cut short by a reset", racpTestTornPage);
+    racpTestRun("full store and page reclaim", racpTestReclaim);
+    racpTestRun("reset while reclaiming", racpTestReclaimReset);
+    racpTestRun("selections by sequence number and time", racpTestSelectKeys);
+    racpTestRun("sequence number wrap", racpTestWrap);
+
+    printf("%s\n", racpTestFailures ? "FAILED" : "PASSED");
+    return racpTestFailures ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+/*************************************************************************************************/
+/*!
+ *  \file
+ *
+ *  \brief  Host benchmark of the ExactLE ACL receive path, with and without
+ *          LCTR_CONN_RX_ACL_AGGREGATION.
+ *
+ *  Copyright (c) 2013-2018 Arm Ltd. All Rights Reserved.
+ *  ARM Ltd. confidential and proprietary.
+ *
+ *  IMPORTANT.  Your use of this file is governed by a Software License Agreement
+ *  ("Agreement") that must be accepted in order to download or otherwise receive a
+ *  copy of this file.  You may not use or copy this file for any purpose other than
+ *  as described in the Agreement.  If you do not agree to all of the terms of the
+ *  Agreement do not use this file and delete all copies in your possession or control;
+ *  if you do not have a copy of the Agreement, you must contact ARM Ltd. prior
+ *  to any use, copying or further distribution of this software.
+ */
+/*************************************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "wsf_types.h"
+#include "wsf_buf.h"
+#include "wsf_msg.h"
+#include "wsf_queue.h"
+#include "util/bstream.h"
+#include "hci_api.h"
+#include "hci_core.h"
+#include "l2c_defs.h"
+#include "lctr_int_conn.h"
+#include "lmgr_api_conn.h"
+
+/*
+ * Receive model: the peer sends L2CAP SDUs of -s bytes (header included) split into data PDUs
+ * of up to -p bytes. The link layer takes a PDU while one of its -b receive buffers is free, as
+ * lctrProcessRxAck() does, and queues it with lctrRxConnEnq(). After every -e PDUs, one
+ * connection event, the LL pending handler runs as hciCoreAclRecvPending() does:
+ * lctrRxConnDeqAcl() until it returns NULL, each ACL packet queued for the host and its buffer
+ * credited back. The host then runs hciCoreAclReassembly() on each packet and consumes complete
+ * SDUs. A PDU that finds no free buffer waits for the next event, which is counted as a stall.
+ */
+
+/**************************************************************************************************
+  Local Variables
+**************************************************************************************************/
+
+/* Connection handle of the simulated link */
+#define RX_BENCH_HANDLE         0
+
+/* L2CAP channel of the simulated SDUs */
+#define RX_BENCH_CID            L2C_CID_ATT
+
+/* Largest SDU, header included */
+#define RX_BENCH_MAX_SDU        1024
+
+/* Memory for the WSF buffer pools */
+static uint8_t rxBenchHeap[64 * 1024];
+
+/* Pools as in stack_dats.c, sized for the larger message header of a 64-bit host */
+static wsfBufPoolDesc_t rxBenchPoolDesc[] = {
+    { 16,               8 },
+    { 32,               4 },
+    { 192,              8 },
+    { 288,              32 },
+    { RX_BENCH_MAX_SDU + 32, 4 }
+};
+
+static struct {
+    uint32_t sduLen;                    /* L2CAP SDU length, header included */
+    uint32_t pduLen;                    /* Data PDU payload length */
+    uint32_t rxBufs;                    /* Link layer receive buffers */
+    uint32_t pdusPerEvt;                /* PDUs per connection event */
+    uint32_t numSdu;                    /* SDUs per run */
+    uint32_t runs;                      /* Runs, the fastest is reported */
+} rxBenchCfg = { 251, 27, 8, 4, 100000, 5 };
+
+static struct {
+    uint32_t allocs;                    /* WSF buffer allocations */
+    uint32_t msgs;                      /* ACL packets queued for the host */
+    uint32_t stalls;                    /* PDUs held off for lack of a receive buffer */
+    uint32_t sdus;                      /* SDUs received intact */
+} rxBenchStats;
+
+static lctrConnCtx_t rxBenchConn;
+static wsfQueue_t rxBenchHostQ;
+static uint32_t rxBenchNextSdu;
+static uint32_t rxBenchEvtPdus;
+
+/* Payload pattern, the payload of SDU n starts at byte n % 256 */
+static uint8_t rxBenchPattern[RX_BENCH_MAX_SDU + 256];
+
+lctrConnCtx_t *pLctrConnTbl = &rxBenchConn;
+lmgrConnCtrlBlk_t lmgrConnCb;
+
+/**************************************************************************************************
+  Stack stubs, the benchmark is the only client
+**************************************************************************************************/
+
+void WsfCsEnter(void)
+{
+}
+
+void WsfCsExit(void)
+{
+}
+
+void *WsfHeapGetFreeStartAddress(void)
+{
+    return rxBenchHeap;
+}
+
+uint32_t WsfHeapCountAvailable(void)
+{
+    return sizeof(rxBenchHeap);
+}
+
+void *__real_WsfBufAlloc(uint16_t len);
+
+void *__wrap_WsfBufAlloc(uint16_t len)
+{
+    rxBenchStats.allocs++;
+    return __real_WsfBufAlloc(len);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Consume an SDU delivered to L2CAP and check its contents.
+ *
+ *  \param  pAcl     Complete ACL packet.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void rxBenchHostConsume(uint8_t *pAcl)
+{
+    uint16_t aclLen, l2cLen, cid;
+    uint8_t *p = pAcl + HCI_ACL_HDR_LEN;
+
+    BYTES_TO_UINT16(aclLen, pAcl + 2);
+    BSTREAM_TO_UINT16(l2cLen, p);
+    BSTREAM_TO_UINT16(cid, p);
+
+    if((aclLen != rxBenchCfg.sduLen) || (l2cLen + L2C_HDR_LEN != aclLen) || (cid != RX_BENCH_CID)) {
+        fprintf(stderr, "SDU %u: bad header\n", rxBenchNextSdu);
+        exit(1);
+    }
+    if(memcmp(p, &rxBenchPattern[rxBenchNextSdu % 256], l2cLen) != 0) {
+        fprintf(stderr, "SDU %u: bad payload\n", rxBenchNextSdu);
+        exit(1);
+    }
+
+    rxBenchNextSdu++;
+    rxBenchStats.sdus++;
+    WsfMsgFree(pAcl);
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Run the LL pending handler and the HCI receive handler, as in hci_core_ps.c.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void rxBenchDeliver(void)
+{
+    wsfHandlerId_t handlerId;
+    uint8_t *pBuf;
+
+    rxBenchEvtPdus = 0;
+
+    while((pBuf = lctrRxConnDeqAcl(&rxBenchConn)) != NULL) {
+        WsfMsgEnq(&rxBenchHostQ, HCI_ACL_TYPE, pBuf);
+        lctrDataRxIncAvailBuf(1);       /* LctrRxAclComplete() */
+        rxBenchStats.msgs++;
+    }
+
+    while((pBuf = WsfMsgDeq(&rxBenchHostQ, &handlerId)) != NULL) {
+        if((pBuf = hciCoreAclReassembly(pBuf)) != NULL) {
+            rxBenchHostConsume(pBuf);
+        }
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Receive one data PDU, waiting for a free receive buffer first.
+ *
+ *  \param  llid     LLID of the PDU.
+ *  \param  pData    Payload.
+ *  \param  len      Payload length.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void rxBenchRxPdu(uint8_t llid, const uint8_t *pData, uint8_t len)
+{
+    uint8_t *pBuf;
+
+    while(lmgrConnCb.availRxBuf == 0) {
+        rxBenchStats.stalls++;
+        rxBenchDeliver();
+        if(lmgrConnCb.availRxBuf == 0) {
+            fprintf(stderr, "Receive buffers exhausted\n");
+            exit(1);
+        }
+    }
+
+    if((pBuf = lctrRxPduAlloc(LL_MAX_DATA_LEN_ABS_MAX)) == NULL) {
+        fprintf(stderr, "Out of PDU buffers\n");
+        exit(1);
+    }
+    lmgrConnCb.availRxBuf--;
+
+    pBuf[LCTR_DATA_PDU_FC_OFFSET] = llid;
+    pBuf[LCTR_DATA_PDU_LEN_OFFSET] = len;
+    memcpy(pBuf + LL_DATA_HDR_LEN, pData, len);
+    lctrRxConnEnq(&rxBenchConn, pBuf);
+
+    if(++rxBenchEvtPdus == rxBenchCfg.pdusPerEvt) {
+        rxBenchDeliver();
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Current time in nanoseconds.
+ *
+ *  \return Time.
+ */
+/*************************************************************************************************/
+static uint64_t rxBenchNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Current cycle count, 0 where the host has no cycle counter.
+ *
+ *  \return Cycles.
+ */
+/*************************************************************************************************/
+static uint64_t rxBenchCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Print usage.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void rxBenchUsage(const char *pName)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -s len     L2CAP SDU length including its 4-byte header (251)\n"
+            "  -p len     Data PDU payload length, 27 to 251 (27)\n"
+            "  -b bufs    Link layer receive buffers (8)\n"
+            "  -e pdus    PDUs per connection event (4)\n"
+            "  -n num     SDUs per run (100000)\n"
+            "  -r runs    Runs, the fastest is reported (5)\n",
+            pName);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t sdu[RX_BENCH_MAX_SDU];
+    uint64_t ns, cycles, minNs = UINT64_MAX, minCycles = UINT64_MAX;
+    uint32_t run, seq, offset, len;
+    uint8_t *p;
+    double kb;
+    uint8_t i;
+    int opt;
+
+    while((opt = getopt(argc, argv, "s:p:b:e:n:r:")) != -1) {
+        switch(opt) {
+            case 's': rxBenchCfg.sduLen = strtoul(optarg, NULL, 0); break;
+            case 'p': rxBenchCfg.pduLen = strtoul(optarg, NULL, 0); break;
+            case 'b': rxBenchCfg.rxBufs = strtoul(optarg, NULL, 0); break;
+            case 'e': rxBenchCfg.pdusPerEvt = strtoul(optarg, NULL, 0); break;
+            case 'n': rxBenchCfg.numSdu = strtoul(optarg, NULL, 0); break;
+            case 'r': rxBenchCfg.runs = strtoul(optarg, NULL, 0); break;
+            default: rxBenchUsage(argv[0]);
+        }
+    }
+
+    if((optind != argc) || (rxBenchCfg.sduLen <= L2C_HDR_LEN) ||
+       (rxBenchCfg.sduLen > RX_BENCH_MAX_SDU) || (rxBenchCfg.pduLen < LL_MAX_DATA_LEN_MIN) ||
+       (rxBenchCfg.pduLen > LL_MAX_DATA_LEN_ABS_MAX) || (rxBenchCfg.rxBufs == 0) ||
+       (rxBenchCfg.rxBufs > UINT8_MAX) || (rxBenchCfg.pdusPerEvt == 0) ||
+       (rxBenchCfg.numSdu == 0) || (rxBenchCfg.runs == 0)) {
+        rxBenchUsage(argv[0]);
+    }
+
+    if(WsfBufInit(sizeof(rxBenchPoolDesc) / sizeof(rxBenchPoolDesc[0]), rxBenchPoolDesc) == 0) {
+        fprintf(stderr, "WSF buffer pools do not fit\n");
+        return 1;
+    }
+    lmgrConnCb.availRxBuf = (uint8_t)rxBenchCfg.rxBufs;
+    rxBenchConn.effDataPdu.maxRxLen = (uint16_t)rxBenchCfg.pduLen;
+
+    for(i = 0; i < DM_CONN_MAX; i++) {
+        hciCoreCb.conn[i].handle = HCI_HANDLE_NONE;
+    }
+    HciSetMaxRxAclLen(RX_BENCH_MAX_SDU);
+    hciCoreConnOpen(RX_BENCH_HANDLE);
+
+    for(len = 0; len < sizeof(rxBenchPattern); len++) {
+        rxBenchPattern[len] = (uint8_t)len;
+    }
+    p = sdu;
+    UINT16_TO_BSTREAM(p, rxBenchCfg.sduLen - L2C_HDR_LEN);
+    UINT16_TO_BSTREAM(p, RX_BENCH_CID);
+
+    for(run = 0; run < rxBenchCfg.runs; run++) {
+        memset(&rxBenchStats, 0, sizeof(rxBenchStats));
+        ns = rxBenchNs();
+        cycles = rxBenchCycles();
+
+        for(seq = run * rxBenchCfg.numSdu; seq < (run + 1) * rxBenchCfg.numSdu; seq++) {
+            memcpy(p, &rxBenchPattern[seq % 256], rxBenchCfg.sduLen - L2C_HDR_LEN);
+            for(offset = 0; offset < rxBenchCfg.sduLen; offset += len) {
+                len = rxBenchCfg.sduLen - offset;
+                if(len > rxBenchCfg.pduLen) {
+                    len = rxBenchCfg.pduLen;
+                }
+                rxBenchRxPdu((offset == 0) ? LL_LLID_START_PDU : LL_LLID_CONT_PDU, sdu + offset,
+                             (uint8_t)len);
+            }
+        }
+        rxBenchDeliver();
+
+        cycles = rxBenchCycles() - cycles;
+        ns = rxBenchNs() - ns;
+
+        if(rxBenchStats.sdus != rxBenchCfg.numSdu) {
+            fprintf(stderr, "%u of %u SDUs received\n", rxBenchStats.sdus, rxBenchCfg.numSdu);
+            return 1;
+        }
+        minNs = (ns < minNs) ? ns : minNs;
+        minCycles = (cycles < minCycles) ? cycles : minCycles;
+    }
+
+    kb = (double)rxBenchCfg.sduLen * rxBenchCfg.numSdu / 1024;
+    printf("%-5s sdu %4u pdu %3u bufs %3u evt %2u: allocs/KB %6.2f  msgs/KB %6.2f  stalls/KB %5.2f  "
+           "ns/KB %7.0f  cycles/KB %7.0f\n",
+#ifdef LCTR_CONN_RX_ACL_AGGREGATION
+           "aggr",
+#else
+           "plain",
+#endif
+           rxBenchCfg.sduLen, rxBenchCfg.pduLen, rxBenchCfg.rxBufs, rxBenchCfg.pdusPerEvt,
+           rxBenchStats.allocs / kb, rxBenchStats.msgs / kb, rxBenchStats.stalls / kb, minNs / kb, minCycles / kb);
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# Generate a WDXS delta update.
+#
+# The patch rebuilds a new firmware image from ranges of the image currently
+# running on the device plus inserted literal data. Upload the output file in
+# place of the full image; the device decodes it into the update area and
+# validates the result with the same CRC32 check as a full upload.
+#
+# Usage: wdxs_delta.py old.bin new.bin patch.bin [--verify]
+#
+#   old.bin  image running on the device (as programmed at the application
+#            start address)
+#   new.bin  new image
+#
+# Patch format, all values little endian:
+#
+#   "WDXP"   magic
+#   uint32   output length, new image plus trailing CRC32
+#   uint32   source length, length of old.bin
+#   uint32   CRC32 of old.bin
+#
+#   followed by operations:
+#
+#   0x01 uint32 offset, uint32 length   copy from the running image
+#   0x02 uint32 length, data            insert literal data
+#
+###############################################################################
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b'WDXP'
+OP_COPY = 0x01
+OP_INSERT = 0x02
+
+# Shortest copy worth an operation header
+MIN_COPY = 16
+# Bytes hashed to find candidate copies
+KEY_LEN = 8
+# Candidate source positions tried per key
+MAX_CANDIDATES = 16
+
+
+def match_len(old, o, new, n):
+    length = 0
+    limit = min(len(old) - o, len(new) - n)
+    while length < limit and old[o + length] == new[n + length]:
+        length += 1
+    return length
+
+
+def make_patch(old, new):
+    crc = zlib.crc32(new) & 0xFFFFFFFF
+    out = new + struct.pack('<I', crc)
+
+    index = {}
+    for i in range(len(old) - KEY_LEN + 1):
+        index.setdefault(old[i:i + KEY_LEN], []).append(i)
+
+    ops = bytearray()
+    literal = bytearray()
+    next_src = None
+    i = 0
+
+    def flush_literal():
+        if literal:
+            ops.extend(struct.pack('<BI', OP_INSERT, len(literal)))
+            ops.extend(literal)
+            literal.clear()
+
+    while i < len(out):
+        best_off, best_len = 0, 0
+
+        # Unchanged code usually continues where the last copy ended
+        if next_src is not None and next_src < len(old):
+            best_off, best_len = next_src, match_len(old, next_src, out, i)
+
+        if best_len < MIN_COPY:
+            for cand in index.get(bytes(out[i:i + KEY_LEN]), [])[:MAX_CANDIDATES]:
+                length = match_len(old, cand, out, i)
+                if length > best_len:
+                    best_off, best_len = cand, length
+
+        if best_len >= MIN_COPY:
+            flush_literal()
+            ops.extend(struct.pack('<BII', OP_COPY, best_off, best_len))
+            i += best_len
+            next_src = best_off + best_len
+        else:
+            literal.append(out[i])
+            i += 1
+            if next_src is not None:
+                next_src += 1
+
+    flush_literal()
+
+    hdr = MAGIC + struct.pack('<III', len(out), len(old), zlib.crc32(old) & 0xFFFFFFFF)
+    return hdr + bytes(ops), out
+
+
+def apply_patch(old, patch):
+    if patch[:4] != MAGIC:
+        raise ValueError('bad magic')
+
+    out_len, src_len, src_crc = struct.unpack_from('<III', patch, 4)
+    if src_len != len(old) or src_crc != (zlib.crc32(old) & 0xFFFFFFFF):
+        raise ValueError('patch not made against this source image')
+
+    out = bytearray()
+    pos = 16
+    while pos < len(patch):
+        op = patch[pos]
+        if op == OP_COPY:
+            off, length = struct.unpack_from('<II', patch, pos + 1)
+            if off + length > src_len:
+                raise ValueError('copy outside source image')
+            out.extend(old[off:off + length])
+            pos += 9
+        elif op == OP_INSERT:
+            (length,) = struct.unpack_from('<I', patch, pos + 1)
+            out.extend(patch[pos + 5:pos + 5 + length])
+            pos += 5 + length
+        else:
+            raise ValueError('bad operation 0x%02x at %d' % (op, pos))
+
+    if len(out) != out_len:
+        raise ValueError('output length %d, expected %d' % (len(out), out_len))
+
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate a WDXS delta update.')
+    parser.add_argument('old', help='image running on the device')
+    parser.add_argument('new', help='new image')
+    parser.add_argument('patch', help='output patch file')
+    parser.add_argument('--verify', action='store_true',
+                        help='apply the patch and compare against the new image')
+    args = parser.parse_args()
+
+    with open(args.old, 'rb') as f:
+        old = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+
+    patch, out = make_patch(old, new)
+
+    with open(args.patch, 'wb') as f:
+        f.write(patch)
+
+    print('image %d bytes, patch %d bytes (%.1f%%)' %
+          (len(out), len(patch), 100.0 * len(patch) / len(out)))
+
+    if args.verify:
+        if apply_patch(old, patch) != out:
+            print('verify: reconstructed image differs')
+            return 1
+        print('verify: OK')
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
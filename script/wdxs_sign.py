@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# Sign a WDXS firmware update.
+#
+# Builds with WDXS_FILE_SIGNED=1 only accept an update whose image is followed
+# by an ECDSA P-256 signature over the SHA-256 digest of the image. The device
+# checks the signature after the CRC32 when the upload is validated.
+#
+# Usage:
+#
+#   wdxs_sign.py keygen key.txt wdxs_sign_key.h
+#       Create a private key and the public key header built into the device.
+#
+#   wdxs_sign.py pubkey key.txt wdxs_sign_key.h
+#       Write the public key header for an existing private key.
+#
+#   wdxs_sign.py sign key.txt new.bin signed.bin [--no-crc] [--verify]
+#       Append the signature and the CRC32. With --no-crc the CRC32 is left
+#       off, to pass the output on to wdxs_delta.py or an LZ4 compressor.
+#
+# Upload format, all values big endian except the CRC32:
+#
+#   image
+#   32 bytes   signature r
+#   32 bytes   signature s
+#   uint32     CRC32 of all the above, little endian
+#
+# Keep key.txt private. It holds the private key as a hex string.
+#
+###############################################################################
+
+import argparse
+import hashlib
+import hmac
+import secrets
+import struct
+import sys
+import zlib
+
+# NIST P-256
+P = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+A = P - 3
+B = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+N = 0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551
+G = (0x6B17D1F2E12C4247F8BCE6E563A440F277037D812DEB33A0F4A13945D898C296,
+     0x4FE342E2FE1A7F9B8EE7EB4A7C0F9E162BCE33576B315ECECBB6406837BF51F5)
+
+COORD_LEN = 32
+
+
+def point_add(p1, p2):
+    if p1 is None:
+        return p2
+    if p2 is None:
+        return p1
+    if p1[0] == p2[0]:
+        if (p1[1] + p2[1]) % P == 0:
+            return None
+        lam = (3 * p1[0] * p1[0] + A) * pow(2 * p1[1], -1, P) % P
+    else:
+        lam = (p2[1] - p1[1]) * pow(p2[0] - p1[0], -1, P) % P
+    x = (lam * lam - p1[0] - p2[0]) % P
+    return (x, (lam * (p1[0] - x) - p1[1]) % P)
+
+
+def point_mul(k, point):
+    result = None
+    while k:
+        if k & 1:
+            result = point_add(result, point)
+        point = point_add(point, point)
+        k >>= 1
+    return result
+
+
+def int_to_bytes(value):
+    return value.to_bytes(COORD_LEN, 'big')
+
+
+def digest_int(digest):
+    return int.from_bytes(digest, 'big') % N
+
+
+def rfc6979_k(priv, digest):
+    # Deterministic nonce, RFC 6979 section 3.2 with HMAC-SHA256
+    x = int_to_bytes(priv)
+    h = int_to_bytes(digest_int(digest))
+    v = b'\x01' * 32
+    k = b'\x00' * 32
+    k = hmac.new(k, v + b'\x00' + x + h, hashlib.sha256).digest()
+    v = hmac.new(k, v, hashlib.sha256).digest()
+    k = hmac.new(k, v + b'\x01' + x + h, hashlib.sha256).digest()
+    v = hmac.new(k, v, hashlib.sha256).digest()
+    while True:
+        v = hmac.new(k, v, hashlib.sha256).digest()
+        candidate = int.from_bytes(v, 'big')
+        if 1 <= candidate < N:
+            return candidate
+        k = hmac.new(k, v + b'\x00', hashlib.sha256).digest()
+        v = hmac.new(k, v, hashlib.sha256).digest()
+
+
+def sign(priv, data):
+    digest = hashlib.sha256(data).digest()
+    e = digest_int(digest)
+    k = rfc6979_k(priv, digest)
+    r = point_mul(k, G)[0] % N
+    s = pow(k, -1, N) * (e + r * priv) % N
+    # Low-s form
+    if s > N // 2:
+        s = N - s
+    return int_to_bytes(r) + int_to_bytes(s)
+
+
+def verify(pub, data, sig):
+    r = int.from_bytes(sig[:COORD_LEN], 'big')
+    s = int.from_bytes(sig[COORD_LEN:], 'big')
+    if not (1 <= r < N and 1 <= s < N):
+        return False
+    e = digest_int(hashlib.sha256(data).digest())
+    w = pow(s, -1, N)
+    point = point_add(point_mul(e * w % N, G), point_mul(r * w % N, pub))
+    return point is not None and point[0] % N == r
+
+
+def read_key(path):
+    with open(path) as f:
+        priv = int(f.read().strip(), 16)
+    if not 1 <= priv < N:
+        sys.exit('invalid private key in %s' % path)
+    return priv
+
+
+def write_header(priv, path):
+    pub = point_mul(priv, G)
+    key = int_to_bytes(pub[0]) + int_to_bytes(pub[1])
+    lines = []
+    for i in range(0, len(key), 8):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in key[i:i + 8]))
+
+    with open(path, 'w') as f:
+        f.write('/* Generated by script/wdxs_sign.py, do not edit */\n\n')
+        f.write('#ifndef WDXS_SIGN_KEY_H\n#define WDXS_SIGN_KEY_H\n\n')
+        f.write('/*! \\brief Update signing public key, X || Y big endian */\n')
+        f.write('#define WDXS_SIGN_PUB_KEY \\\n{ \\\n')
+        f.write(', \\\n'.join(lines))
+        f.write(' \\\n}\n\n#endif /* WDXS_SIGN_KEY_H */\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Sign a WDXS firmware update')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+
+    p = sub.add_parser('keygen', help='create a signing key')
+    p.add_argument('key')
+    p.add_argument('header')
+
+    p = sub.add_parser('pubkey', help='write the public key header')
+    p.add_argument('key')
+    p.add_argument('header')
+
+    p = sub.add_parser('sign', help='sign an image')
+    p.add_argument('key')
+    p.add_argument('image')
+    p.add_argument('output')
+    p.add_argument('--no-crc', action='store_true', help='leave off the trailing CRC32')
+    p.add_argument('--verify', action='store_true', help='check the signature after signing')
+
+    args = parser.parse_args()
+
+    if args.cmd == 'keygen':
+        priv = secrets.randbelow(N - 1) + 1
+        with open(args.key, 'w') as f:
+            f.write('%064x\n' % priv)
+        write_header(priv, args.header)
+        return
+
+    priv = read_key(args.key)
+
+    if args.cmd == 'pubkey':
+        write_header(priv, args.header)
+        return
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+
+    sig = sign(priv, image)
+    out = image + sig
+
+    if args.verify and not verify(point_mul(priv, G), image, sig):
+        sys.exit('signature verification failed')
+
+    if not args.no_crc:
+        out += struct.pack('<I', zlib.crc32(out) & 0xFFFFFFFF)
+
+    with open(args.output, 'wb') as f:
+        f.write(out)
+
+    print('%s: %d bytes signed, %d bytes written' % (args.output, len(image), len(out)))
+
+
+if __name__ == '__main__':
+    main()
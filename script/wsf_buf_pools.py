@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+###############################################################################
+#
+# Recommend a WSF buffer pool table from a recorded workload.
+#
+# Build with BUF_STATS=1 (WSF_BUF_STATS and WSF_BUF_STATS_HIST), run the
+# workload, then enter "buf" on the terminal and save the serial output. "buf
+# clear" restarts the capture. This tool reads the last capture in the log and
+# prints a wsfBufPoolDesc_t table for mainPoolDesc in stack_dats.c.
+#
+# Usage: wsf_buf_pools.py capture.log [--pools N] [--overflow P]
+#
+# Capture lines, as printed by the terminal:
+#
+#   wsfbuf pool <id> <len> <num> <maxAlloc> <maxReqLen> <overflow> <numReq> <sumAlloc>
+#   wsfbuf bin <binLen> <index> <count>
+#   wsfbuf end
+#
+# Model: each pool is sized so that a Poisson number of outstanding buffers,
+# with the mean seen in the capture, exceeds it with probability at most P.
+# It is never sized below the peak seen in the capture. Pool lengths are
+# chosen from the request histogram to minimize the total RAM.
+#
+# With ExactLE, stack_dats.c resizes pools 2 and 3 for the link layer
+# buffers at run time; keep those two entries when applying the table.
+#
+###############################################################################
+
+import argparse
+import math
+import re
+import sys
+
+# sizeof(wsfBufMem_t) with WSF_BUF_FREE_CHECK_ASSERT, pool length alignment
+BUF_ALIGN = 8
+# sizeof(wsfBufPool_t) with WSF_BUF_STATS, cost of each extra pool
+POOL_OVERHEAD = 24
+
+POOL_RE = re.compile(r'wsfbuf pool (\d+) (\d+) (\d+) (\d+) (\d+) (\d+) (\d+) (\d+)')
+BIN_RE = re.compile(r'wsfbuf bin (\d+) (\d+) (\d+)')
+
+
+class Pool:
+    def __init__(self, fields):
+        (self.id, self.len, self.num, self.max_alloc, self.max_req_len,
+         self.overflow, self.num_req, self.sum_alloc) = fields
+
+
+def parse(path):
+    pools, bins = [], {}
+    cur_pools, cur_bins, bin_len = [], {}, 16
+    with open(path, errors='replace') as f:
+        for line in f:
+            m = POOL_RE.search(line)
+            if m:
+                cur_pools.append(Pool([int(x) for x in m.groups()]))
+                continue
+            m = BIN_RE.search(line)
+            if m:
+                bin_len = int(m.group(1))
+                cur_bins[int(m.group(2))] = int(m.group(3))
+                continue
+            if 'wsfbuf end' in line:
+                pools, bins = cur_pools, cur_bins
+                cur_pools, cur_bins = [], {}
+    if not pools:
+        sys.exit('%s: no complete "buf" capture found' % path)
+    if not bins:
+        sys.exit('%s: no request histogram, build with WSF_BUF_STATS_HIST' % path)
+    return pools, bins, bin_len
+
+
+def align(length):
+    return max(BUF_ALIGN, (length + BUF_ALIGN - 1) // BUF_ALIGN * BUF_ALIGN)
+
+
+def poisson_quantile(mean, p):
+    # Smallest n with P(X > n) <= p
+    n, term = 0, math.exp(-mean)
+    cdf = term
+    while 1.0 - cdf > p:
+        n += 1
+        term *= mean / n
+        cdf += term
+    return n
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Recommend a WSF buffer pool table')
+    parser.add_argument('log', help='terminal output containing a "buf" capture')
+    parser.add_argument('--pools', type=int, help='maximum number of pools (default: as captured)')
+    parser.add_argument('--overflow', type=float, default=1e-3,
+                        help='target overflow probability per pool (default: 1e-3)')
+    args = parser.parse_args()
+
+    if not 1e-9 <= args.overflow < 1:
+        sys.exit('--overflow must be between 1e-9 and 1')
+
+    pools, bins, bin_len = parse(args.log)
+    max_pools = args.pools or len(pools)
+    max_req = max(p.max_req_len for p in pools)
+
+    # Request classes: upper length and count of each used histogram bin
+    classes = []
+    for index in sorted(bins):
+        upper = (index + 1) * bin_len
+        if index == max(bins):
+            upper = max(upper, max_req)
+        classes.append((align(upper), bins[index]))
+
+    # Captured pool serving each class, and its mean occupancy per request
+    def served_by(length):
+        for p in pools:
+            if length <= p.len:
+                return p
+        return pools[-1]
+
+    demand = []
+    for length, count in classes:
+        p = served_by(length)
+        # Arrivals see the time average plus themselves
+        mean = max(p.sum_alloc / p.num_req - 1.0, 0.0) if p.num_req else 0.0
+        share = count / p.num_req if p.num_req else 0.0
+        demand.append((length, count, mean * share, p.max_alloc * share))
+
+    def pool_cost(i, j):
+        # Pool serving classes i..j, sized for the longest
+        length = demand[j][0]
+        mean = sum(d[2] for d in demand[i:j + 1])
+        peak = sum(d[3] for d in demand[i:j + 1])
+        num = max(1, poisson_quantile(mean, args.overflow), math.ceil(peak - 1e-9))
+        return length * num + POOL_OVERHEAD, (length, num)
+
+    # cost[k][j]: cheapest layout of classes 0..j with k pools
+    n = len(demand)
+    inf = float('inf')
+    cost = [[inf] * n for _ in range(max_pools + 1)]
+    prev = [[None] * n for _ in range(max_pools + 1)]
+    for j in range(n):
+        cost[1][j], desc = pool_cost(0, j)
+        prev[1][j] = (-1, desc)
+    for k in range(2, max_pools + 1):
+        for j in range(n):
+            for i in range(k - 2, j):
+                c, desc = pool_cost(i + 1, j)
+                if cost[k - 1][i] + c < cost[k][j]:
+                    cost[k][j] = cost[k - 1][i] + c
+                    prev[k][j] = (i, desc)
+
+    best = min(range(1, max_pools + 1), key=lambda k: cost[k][n - 1])
+    table, k, j = [], best, n - 1
+    while j >= 0:
+        i, desc = prev[k][j]
+        table.append(desc)
+        k, j = k - 1, i
+    table.reverse()
+
+    total_req = sum(bins.values())
+    overflows = sum(p.overflow for p in pools)
+    old_ram = sum(p.len * p.num + POOL_OVERHEAD for p in pools)
+    new_ram = sum(length * num + POOL_OVERHEAD for length, num in table)
+
+    print('/* Recommended by script/wsf_buf_pools.py: %u requests, %u overflows captured,' %
+          (total_req, overflows))
+    print(' * overflow target %g per pool. %u bytes, captured table %u bytes. */' %
+          (args.overflow, new_ram, old_ram))
+    print('static wsfBufPoolDesc_t mainPoolDesc[] = {')
+    print(',\n'.join('    { %-16s %u }' % ('%u,' % length, num) for length, num in table))
+    print('};')
+
+
+if __name__ == '__main__':
+    main()
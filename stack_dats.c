@@ -66,6 +66,10 @@
 #include "wdxs/wdxs_api.h"
 #include "pal_led.h"
 
+#if defined(MEM_STATS) && (MEM_STATS == 1)
+#include "mem_stats.h"
+#endif
+
 #if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
 #include "ll_init_api.h"
 #endif
@@ -370,6 +374,9 @@ void bleStartup(void)
 
     APP_TRACE_INFO1("memory is used %d \n", memUsed);
     AppTerminalInit();
+#if defined(MEM_STATS) && (MEM_STATS == 1)
+    MemStatsInit();
+#endif
 
 #if defined(HCI_TR_EXACTLE) && (HCI_TR_EXACTLE == 1)
     LlInitRtCfg_t llCfg = {
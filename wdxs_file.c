@@ -25,6 +25,7 @@
 #include "wsf_assert.h"
 #include "wsf_efs.h"
 #include "wsf_cs.h"
+#include "wsf_math.h"
 #include "util/bstream.h"
 #include "svc_wdxs.h"
 #include "wdxs/wdxs_api.h"
@@ -34,11 +35,141 @@
 #include "att_api.h"
 #include "app_api.h"
 #include "flc.h"
+#include "flash_sched.h"
 
 #ifndef FW_VERSION
 #define FW_VERSION      1
 #endif
 
+/* Accept LZ4 compressed uploads */
+#ifndef WDXS_FILE_LZ4
+#define WDXS_FILE_LZ4   1
+#endif
+
+/* Accept delta uploads patched against the running image */
+#ifndef WDXS_FILE_DELTA
+#define WDXS_FILE_DELTA 1
+#endif
+
+#define WDXS_FILE_DECODE        (WDXS_FILE_LZ4 || WDXS_FILE_DELTA)
+
+/* Upload into the inactive bank and boot it in place; requires a slot-aware bootloader */
+#ifndef WDXS_FILE_AB_SLOTS
+#define WDXS_FILE_AB_SLOTS      0
+#endif
+
+/* Require an ECDSA P-256 signature over the image, see script/wdxs_sign.py */
+#ifndef WDXS_FILE_SIGNED
+#define WDXS_FILE_SIGNED        0
+#endif
+
+/* Pages of the update area erased ahead of the highest write */
+#ifndef WDXS_FILE_ERASE_AHEAD
+#define WDXS_FILE_ERASE_AHEAD   2
+#endif
+
+/* Bytes of the update area erased when a client subscribes to file transfer, 0 to wait for a put */
+#ifndef WDXS_FILE_PRE_ERASE_LEN
+#define WDXS_FILE_PRE_ERASE_LEN 0
+#endif
+
+#if WDXS_FILE_SIGNED
+#include "tpu.h"
+#include "uECC.h"
+#include "wdxs_sign_key.h"
+
+/* Signature r || s, big endian, between the image and the CRC32 */
+#define WDXS_SIG_LEN            64
+
+/* Bytes following the signed image */
+#define WDXS_SIG_TRAILER_LEN    (WDXS_SIG_LEN + 4)
+
+#define WDXS_SHA_BLOCK_LEN      64
+#define WDXS_SHA_DGST_LEN       32
+#endif
+
+#if WDXS_FILE_AB_SLOTS
+/* Boot attempts allowed before an unconfirmed slot is abandoned */
+#define WDXS_SLOT_ATTEMPTS      0x07
+
+/* Flash copy chunk, multiple of the 128-bit flash word */
+#define WDXS_SLOT_COPY_LEN      128
+#endif
+
+#if WDXS_FILE_DECODE
+/* Compressed upload header: magic, decompressed length */
+#define WDXS_LZ4_MAGIC          0x5A584457      /* "WDXZ" */
+#define WDXS_LZ4_HDR_LEN        8
+
+/* Delta upload header: magic, output length, source length, source CRC32 */
+#define WDXS_DELTA_MAGIC        0x50584457      /* "WDXP" */
+#define WDXS_DELTA_HDR_LEN      16
+
+/* Delta operations */
+#define WDXS_DELTA_OP_COPY      0x01            /* Source offset, length: copy from running image */
+#define WDXS_DELTA_OP_INSERT    0x02            /* Length, data: insert literal data */
+#define WDXS_DELTA_OP_MAX_LEN   9
+
+/* Decoded bytes staged in RAM before programming, multiple of the 128-bit flash word */
+#define WDXS_DEC_STAGE_LEN      256
+
+/* Upload formats */
+enum {
+    WDXS_DEC_RAW,
+    WDXS_DEC_LZ4,
+    WDXS_DEC_DELTA
+};
+
+/* Decoder states */
+enum {
+    WDXS_DEC_DONE,
+    WDXS_DEC_ERROR,
+    WDXS_LZ4_TOKEN,
+    WDXS_LZ4_LIT_LEN,
+    WDXS_LZ4_LIT,
+    WDXS_LZ4_OFFSET_LO,
+    WDXS_LZ4_OFFSET_HI,
+    WDXS_LZ4_MATCH_LEN,
+    WDXS_DELTA_OP,
+    WDXS_DELTA_INSERT
+};
+
+/* Streaming upload decoder control block */
+static struct {
+    uint8_t  mode;                              /* Upload format */
+    uint8_t  state;                             /* Decoder state */
+    uint16_t offset;                            /* LZ4 match offset */
+    uint32_t litLen;                            /* Remaining LZ4 literal or delta insert length */
+    uint32_t matchLen;                          /* LZ4 match length, less the minimum match */
+    uint32_t srcLen;                            /* Delta source image length */
+    uint8_t  opBuf[WDXS_DELTA_OP_MAX_LEN];      /* Delta operation being received */
+    uint8_t  opLen;                             /* Delta operation bytes received */
+    uint32_t inPos;                             /* Next expected upload offset */
+    uint32_t outPos;                            /* Decoded bytes produced */
+    uint32_t outLen;                            /* Expected decoded length */
+    uint32_t flushPos;                          /* Decoded bytes programmed to flash */
+    uint32_t stage[WDXS_DEC_STAGE_LEN / 4];     /* Staging buffer, word aligned for MXC_FLC_Write */
+} wdxsDecCb;
+#endif /* WDXS_FILE_DECODE */
+
+#if WDXS_FILE_SIGNED
+/* Streaming image digest control block */
+static struct {
+    uint32_t state[WDXS_SHA_DGST_LEN / 4];      /* Intermediate TPU digest */
+    uint32_t hashPos;                           /* Image bytes hashed */
+    uint32_t endPos;                            /* Image bytes programmed in order */
+    bool_t   inOrder;                           /* FALSE once a write lands out of order */
+} wdxsSigCb;
+#endif /* WDXS_FILE_SIGNED */
+
+/* Deferred erase of the update area, offsets in the media */
+static struct {
+    uint32_t start;                             /* Start of the area to erase */
+    uint32_t pos;                               /* Erase queued below this offset */
+    uint32_t end;                               /* End of the area to erase */
+    bool_t   written;                           /* Programmed since the erase was requested */
+} wdxsEraseCb;
+
 static volatile uint32_t verifyLen;
 static volatile uint8_t* lastWriteAddr;
 static volatile uint32_t lastWriteLen;
@@ -49,20 +180,49 @@ static uint8_t wdxsFileErase(uint8_t* address, uint32_t size);
 static uint8_t wdxsFileRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
 static uint8_t wdxsFileWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size);
 static uint8_t wsfFileHandle(uint8_t cmd, uint32_t param);
+static const uint8_t *wdxsFileMap(uint8_t *pAddress, uint32_t size);
+void crc32(const void *data, size_t n_bytes, uint32_t* crc);
 
+extern uint32_t _text;
 extern uint32_t _flash_update;
 extern uint32_t _eflash_update;
 
+#if WDXS_FILE_AB_SLOTS
+extern uint32_t _boot;
+extern uint32_t _slot_hdr;
+extern uint32_t _slot_update;
+extern uint32_t _eslot_update;
+extern uint32_t __pal_nvm_db_start__;
+extern uint32_t __pal_nvm_db_end__;
+
+/* Slot header of the running image, and of the inactive slot which follows its image area */
+#define WDXS_SLOT_HDR           ((const wdxsSlotHdr_t*)&_slot_hdr)
+#define WDXS_SLOT_HDR_UPDATE    ((const wdxsSlotHdr_t*)&_eslot_update)
+#endif
+
+/* Update area, host tests may place it at a fixed address instead */
+#ifndef WDXS_FILE_START_ADDR
+#if WDXS_FILE_AB_SLOTS
+/* Use the image area of the inactive bank */
+#define WDXS_FILE_START_ADDR    ((uint32_t)&_slot_update)
+#define WDXS_FILE_END_ADDR      ((uint32_t)&_eslot_update)
+#else
 /* Use the second half of the flash space for scratch space */
+#define WDXS_FILE_START_ADDR    ((uint32_t)&_flash_update)
+#define WDXS_FILE_END_ADDR      ((uint32_t)&_eflash_update)
+#endif
+#endif
+
 static const wsfEfsMedia_t WDXS_FileMedia = {
-    /*   uint32_t                startAddress;  Start address. */                   ((uint32_t)&_flash_update),
-    /*   uint32_t                endAddress;    End address. */                     ((uint32_t)&_eflash_update),
+    /*   uint32_t                startAddress;  Start address. */                   WDXS_FILE_START_ADDR,
+    /*   uint32_t                endAddress;    End address. */                     WDXS_FILE_END_ADDR,
     /*   uint32_t                pageSize;      Page size. */                       MXC_FLASH_PAGE_SIZE,
     /*   wsfMediaInitFunc_t      *init;         Media initialization callback. */   wdxsFileInitMedia,
     /*   wsfMediaEraseFunc_t     *erase;        Media erase callback. */            wdxsFileErase,
     /*   wsfMediaReadFunc_t      *read;         Media read callback. */             wdxsFileRead,
     /*   wsfMediaWriteFunc_t     *write;        Media write callback. */            wdxsFileWrite,
-    /*   wsfMediaHandleCmdFunc_t *handleCmd;    Media command handler callback. */  wsfFileHandle
+    /*   wsfMediaHandleCmdFunc_t *handleCmd;    Media command handler callback. */  wsfFileHandle,
+    /*   wsfMediaMapFunc_t       *map;          Media direct map callback. */       wdxsFileMap
 };
 
 /*************************************************************************************************/
@@ -75,14 +235,71 @@ static const wsfEfsMedia_t WDXS_FileMedia = {
 static uint8_t wdxsFileInitMedia(void)
 {
     MXC_FLC_Init();
+    FlashSchedInit();
     APP_TRACE_INFO1("FW_VERSION: %d", FW_VERSION);
     return WSF_EFS_SUCCESS;
 }
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Queue the deferred erase of the update area up to an offset.
+ *
+ *  \param  offset   Offset in the media, rounded up to a page.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsEraseTo(uint32_t offset)
+{
+    uint32_t end = (offset + MXC_FLASH_PAGE_SIZE - 1) & ~(MXC_FLASH_PAGE_SIZE - 1);
+
+    if(end > wdxsEraseCb.end) {
+        end = wdxsEraseCb.end;
+    }
+
+    if(end <= wdxsEraseCb.pos) {
+        return WSF_EFS_SUCCESS;
+    }
+
+    if(FlashSchedErase(WDXS_FileMedia.startAddress + wdxsEraseCb.pos, end - wdxsEraseCb.pos, NULL) != E_NO_ERROR) {
+        return WSF_EFS_FAILURE;
+    }
+
+    wdxsEraseCb.pos = end;
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Start a deferred erase of part of the update area.
+ *
+ *  \param  offset   Page aligned offset in the media.
+ *  \param  size     Number of bytes, multiple of the page size.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsEraseStart(uint32_t offset, uint32_t size)
+{
+    /* Keep the pages a pre-erase already queued if nothing was written since */
+    if(!wdxsEraseCb.written && (wdxsEraseCb.start == offset) && (wdxsEraseCb.end == offset + size)) {
+        return;
+    }
+
+    wdxsEraseCb.start = offset;
+    wdxsEraseCb.pos = offset;
+    wdxsEraseCb.end = offset + size;
+    wdxsEraseCb.written = FALSE;
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  File erase function. Must be page aligned.
  *
+ *  The update area is erased lazily, WDXS_FILE_ERASE_AHEAD pages ahead of the highest write,
+ *  so a put does not wait for the whole area. Pages not erased yet read as erased. Other
+ *  pages, e.g. the slot header, are erased at once.
+ *
  *  \param  pAddress Address in media to start erasing.
  *  \param  size     Number of bytes to erase.
  *
@@ -91,19 +308,16 @@ static uint8_t wdxsFileInitMedia(void)
 /*************************************************************************************************/
 static uint8_t wdxsFileErase(uint8_t* address, uint32_t size)
 {
-    int err;
-    volatile uint32_t address32 = (uint32_t)address;
+    uint32_t offset = (uint32_t)address - WDXS_FileMedia.startAddress;
 
-    while(size) {
-        // WsfCsEnter();
-        err = MXC_FLC_PageErase((uint32_t)address32);
-        // WsfCsExit();
-        if(err != E_NO_ERROR) {
-            return WSF_EFS_FAILURE;
-        }
+    if(((uint32_t)address >= WDXS_FileMedia.startAddress) && ((uint32_t)address < WDXS_FileMedia.endAddress)) {
+        wdxsEraseStart(offset, size);
+        return wdxsEraseTo(offset + (WDXS_FILE_ERASE_AHEAD * MXC_FLASH_PAGE_SIZE));
+    }
 
-        address32 += MXC_FLASH_PAGE_SIZE;
-        size -= MXC_FLASH_PAGE_SIZE;
+    /* Erase of the update bank runs in the background, errors show on validate */
+    if(FlashSchedErase((uint32_t)address, size, NULL) != E_NO_ERROR) {
+        return WSF_EFS_FAILURE;
     }
 
     return WSF_EFS_SUCCESS;
@@ -122,13 +336,199 @@ static uint8_t wdxsFileErase(uint8_t* address, uint32_t size)
 /*************************************************************************************************/
 static uint8_t wdxsFileRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
 {
+    uint32_t offset, lo, hi;
+
+    if(FlashSchedPending((uint32_t)pAddress, size) && (FlashSchedFlush() != E_NO_ERROR)) {
+        return WSF_EFS_FAILURE;
+    }
+
     memcpy(pBuf, pAddress, size);
+
+    /* Pages still waiting for a deferred erase */
+    offset = (uint32_t)pAddress - WDXS_FileMedia.startAddress;
+    lo = WSF_MAX(offset, wdxsEraseCb.pos);
+    hi = WSF_MIN(offset + size, wdxsEraseCb.end);
+    if(lo < hi) {
+        memset(pBuf + (lo - offset), 0xFF, hi - lo);
+    }
+
     return WSF_EFS_SUCCESS;
 }
 
 /*************************************************************************************************/
 /*!
- *  \brief  File Write function.
+ *  \brief  Media Map function, internal flash is memory mapped.
+ *
+ *  \param  pAddress Address in media to map.
+ *  \param  size     Number of bytes to map.
+ *
+ *  \return Pointer to read the data directly, or NULL if it must be read instead.
+ */
+/*************************************************************************************************/
+static const uint8_t *wdxsFileMap(uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)pAddress - WDXS_FileMedia.startAddress;
+
+    /* Pages waiting for a deferred erase do not hold the file data */
+    if((offset + size > wdxsEraseCb.pos) && (offset < wdxsEraseCb.end)) {
+        return NULL;
+    }
+
+    if(FlashSchedPending((uint32_t)pAddress, size) && (FlashSchedFlush() != E_NO_ERROR)) {
+        return NULL;
+    }
+
+    return pAddress;
+}
+
+#if WDXS_FILE_SIGNED
+/*************************************************************************************************/
+/*!
+ *  \brief  Hash one SHA-256 block of the image with the TPU.
+ *
+ *  The TPU is shared with the link layer, so the digest is reloaded and saved around each block.
+ *
+ *  \param  pBlock   Word aligned image data.
+ *  \param  len      Block length, WDXS_SHA_BLOCK_LEN unless this is the last block.
+ *  \param  msgLen   Total message length when this is the last block, 0 otherwise.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsSigBlock(const uint32_t *pBlock, uint32_t len, uint32_t msgLen)
+{
+    uint32_t word;
+    uint32_t i;
+
+    WsfCsEnter();
+
+    MXC_TPU_Hash_Config(MXC_TPU_HASH_SHA256);
+
+    if(wdxsSigCb.hashPos != 0) {
+        for(i = 0; i < WDXS_SHA_DGST_LEN / 4; i++) {
+            MXC_TPU->hash_digest[i] = wdxsSigCb.state[i];
+        }
+    }
+
+    MXC_TPU->ctrl |= MXC_F_TPU_CTRL_HSH_DONE;
+
+    if(msgLen != 0) {
+        /* Engine pads the last block from the message size */
+        MXC_TPU->hash_msg_sz[0] = msgLen;
+        MXC_TPU->hash_ctrl |= MXC_F_TPU_HASH_CTRL_LAST;
+    }
+
+    for(i = 0; i < len; i += 4) {
+        word = pBlock[i / 4];
+        if((len - i) < 4) {
+            word &= 0xFFFFFFFF >> (8 * (4 - (len - i)));
+        }
+
+        while(!(MXC_TPU->ctrl & MXC_F_TPU_CTRL_RDY)) {}
+        MXC_TPU->data_in[0] = word;
+    }
+
+    while(!(MXC_TPU->ctrl & MXC_F_TPU_CTRL_HSH_DONE)) {}
+    MXC_TPU->ctrl |= MXC_F_TPU_CTRL_HSH_DONE;
+
+    memcpy(wdxsSigCb.state, (const void*)MXC_TPU->hash_digest, WDXS_SHA_DGST_LEN);
+
+    WsfCsExit();
+
+    wdxsSigCb.hashPos += len;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Hash whole blocks of the image up to a limit.
+ *
+ *  \param  limit    Image offset to stop before; at least one byte is left for the last block.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsSigHash(uint32_t limit)
+{
+    /* Stop at data still queued for programming, a later write picks up from there */
+    while(((wdxsSigCb.hashPos + WDXS_SHA_BLOCK_LEN) < limit) &&
+          !FlashSchedPending(WDXS_FileMedia.startAddress + wdxsSigCb.hashPos, WDXS_SHA_BLOCK_LEN)) {
+        wdxsSigBlock((const uint32_t*)(WDXS_FileMedia.startAddress + wdxsSigCb.hashPos),
+                     WDXS_SHA_BLOCK_LEN, 0);
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Hash the image as it is programmed, so little is left to do on validate.
+ *
+ *  \param  pAddress Address written.
+ *  \param  size     Number of bytes written.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsSigUpdate(const uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)pAddress - WDXS_FileMedia.startAddress;
+
+    if(offset != wdxsSigCb.endPos) {
+        /* Rehash from flash on validate */
+        wdxsSigCb.inOrder = FALSE;
+        return;
+    }
+
+    wdxsSigCb.endPos += size;
+
+    /* The signature and CRC32 trail the image */
+    if(wdxsSigCb.inOrder && (wdxsSigCb.endPos > WDXS_SIG_TRAILER_LEN)) {
+        wdxsSigHash(wdxsSigCb.endPos - WDXS_SIG_TRAILER_LEN);
+    }
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Finish the image digest and check the signature.
+ *
+ *  \param  length   Length of the image and signature, less the CRC32.
+ *
+ *  \return TRUE if the signature is valid.
+ */
+/*************************************************************************************************/
+static bool_t wdxsSigVerify(uint32_t length)
+{
+    uint8_t digest[WDXS_SHA_DGST_LEN];
+    static const uint8_t pubKey[] = WDXS_SIGN_PUB_KEY;
+    uint32_t imgLen;
+
+    if(length <= WDXS_SIG_LEN) {
+        return FALSE;
+    }
+
+    imgLen = length - WDXS_SIG_LEN;
+
+    if(!wdxsSigCb.inOrder || (wdxsSigCb.hashPos >= imgLen)) {
+        wdxsSigCb.hashPos = 0;
+    }
+
+    APP_TRACE_INFO2("Image digest 0x%08X of 0x%08X hashed while streaming", wdxsSigCb.hashPos, imgLen);
+
+    wdxsSigHash(imgLen);
+    wdxsSigBlock((const uint32_t*)(WDXS_FileMedia.startAddress + wdxsSigCb.hashPos),
+                 imgLen - wdxsSigCb.hashPos, imgLen);
+
+    /* The next validate must start over */
+    wdxsSigCb.inOrder = FALSE;
+
+    memcpy(digest, wdxsSigCb.state, WDXS_SHA_DGST_LEN);
+
+    return uECC_verify(pubKey, digest,
+                       (const uint8_t*)(WDXS_FileMedia.startAddress + imgLen)) != 0;
+}
+#endif /* WDXS_FILE_SIGNED */
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Program flash.
  *
  *  \param  pBuf     Buffer with data to be written.
  *  \param  address  Address in media to write to.
@@ -137,16 +537,24 @@ static uint8_t wdxsFileRead(uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
  *  \return Status of the operation.
  */
 /*************************************************************************************************/
-static uint8_t wdxsFileWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+static uint8_t wdxsFileProgram(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
 {
-    int err;
-    // WsfCsEnter();
-    err = MXC_FLC_Write((uint32_t)pAddress, size, (uint32_t *)pBuf);
-    // WsfCsExit();
-    if(err == E_NO_ERROR) {
+    uint32_t offset = (uint32_t)pAddress - WDXS_FileMedia.startAddress;
+
+    /* Keep the deferred erase ahead of the data */
+    wdxsEraseCb.written = TRUE;
+    if(wdxsEraseTo(offset + size + (WDXS_FILE_ERASE_AHEAD * MXC_FLASH_PAGE_SIZE)) != WSF_EFS_SUCCESS) {
+        return WSF_EFS_FAILURE;
+    }
+
+    /* Data is copied and programmed in the background, errors show on validate */
+    if(FlashSchedWrite((uint32_t)pAddress, pBuf, size, NULL) == E_NO_ERROR) {
 
         lastWriteAddr = pAddress;
         lastWriteLen = size;
+#if WDXS_FILE_SIGNED
+        wdxsSigUpdate(pAddress, size);
+#endif
         return WSF_EFS_SUCCESS;
     }
 
@@ -155,6 +563,614 @@ static uint8_t wdxsFileWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t si
     return WSF_EFS_FAILURE;
 }
 
+#if WDXS_FILE_DECODE
+/*************************************************************************************************/
+/*!
+ *  \brief  Program staged decoded data to flash.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDecFlush(void)
+{
+    uint32_t len = wdxsDecCb.outPos - wdxsDecCb.flushPos;
+
+    if(len == 0) {
+        return WSF_EFS_SUCCESS;
+    }
+
+    if(wdxsFileProgram((const uint8_t*)wdxsDecCb.stage,
+        (uint8_t*)(WDXS_FileMedia.startAddress + wdxsDecCb.flushPos), len) != WSF_EFS_SUCCESS) {
+        return WSF_EFS_FAILURE;
+    }
+
+    wdxsDecCb.flushPos = wdxsDecCb.outPos;
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Append data to the decoded image.
+ *
+ *  \param  pBuf     Data to append.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDecWrite(const uint8_t *pBuf, uint32_t size)
+{
+    uint32_t len;
+
+    if(size > (wdxsDecCb.outLen - wdxsDecCb.outPos)) {
+        return WSF_EFS_FAILURE;
+    }
+
+    while(size) {
+        len = WDXS_DEC_STAGE_LEN - (wdxsDecCb.outPos - wdxsDecCb.flushPos);
+        if(len > size) {
+            len = size;
+        }
+
+        memcpy((uint8_t*)wdxsDecCb.stage + (wdxsDecCb.outPos - wdxsDecCb.flushPos), pBuf, len);
+        wdxsDecCb.outPos += len;
+        pBuf += len;
+        size -= len;
+
+        if((wdxsDecCb.outPos - wdxsDecCb.flushPos) == WDXS_DEC_STAGE_LEN) {
+            if(wdxsDecFlush() != WSF_EFS_SUCCESS) {
+                return WSF_EFS_FAILURE;
+            }
+        }
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Complete a decode step.
+ *
+ *  \param  err      Status of the decode step.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDecComplete(uint8_t err)
+{
+    if((err == WSF_EFS_SUCCESS) && (wdxsDecCb.outPos == wdxsDecCb.outLen)) {
+        wdxsDecCb.state = WDXS_DEC_DONE;
+
+        if((err = wdxsDecFlush()) == WSF_EFS_SUCCESS) {
+            /* Hand the image and trailing CRC32 to validation as for a raw upload */
+            lastWriteAddr = (uint8_t*)(WDXS_FileMedia.startAddress + wdxsDecCb.outLen - 4);
+            lastWriteLen = 4;
+        }
+    }
+
+    if(err != WSF_EFS_SUCCESS) {
+        APP_TRACE_ERR1("Upload decode error at output offset 0x%08X", wdxsDecCb.outPos);
+        wdxsDecCb.state = WDXS_DEC_ERROR;
+    }
+
+    return err;
+}
+#endif /* WDXS_FILE_DECODE */
+
+#if WDXS_FILE_LZ4
+/*************************************************************************************************/
+/*!
+ *  \brief  Copy a match from previously decompressed data.
+ *
+ *  Data older than the staging buffer is read back from flash, so the full 64 kB LZ4 window is
+ *  available without holding it in RAM.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsLz4Match(void)
+{
+    uint32_t len = wdxsDecCb.matchLen + 4;
+    uint32_t readyPos = 0;
+    uint32_t pos;
+    uint8_t b;
+
+    if((wdxsDecCb.offset == 0) || (wdxsDecCb.offset > wdxsDecCb.outPos)) {
+        return WSF_EFS_FAILURE;
+    }
+
+    while(len--) {
+        pos = wdxsDecCb.outPos - wdxsDecCb.offset;
+
+        if(pos >= wdxsDecCb.flushPos) {
+            b = ((uint8_t*)wdxsDecCb.stage)[pos - wdxsDecCb.flushPos];
+        } else {
+            /* The match may read back output still queued for programming, including output
+               the match itself flushed from the staging buffer */
+            if(pos >= readyPos) {
+                if(FlashSchedPending(WDXS_FileMedia.startAddress + pos, wdxsDecCb.flushPos - pos) &&
+                   (FlashSchedFlush() != E_NO_ERROR)) {
+                    return WSF_EFS_FAILURE;
+                }
+                readyPos = wdxsDecCb.flushPos;
+            }
+
+            b = *(const uint8_t*)(WDXS_FileMedia.startAddress + pos);
+        }
+
+        if(wdxsDecWrite(&b, 1) != WSF_EFS_SUCCESS) {
+            return WSF_EFS_FAILURE;
+        }
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Feed compressed data to the LZ4 block decoder.
+ *
+ *  \param  pBuf     Compressed data.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsLz4Decode(const uint8_t *pBuf, uint32_t size)
+{
+    uint8_t err = WSF_EFS_SUCCESS;
+    uint8_t b;
+
+    while(size && (err == WSF_EFS_SUCCESS)) {
+        b = *pBuf++;
+        size--;
+
+        switch(wdxsDecCb.state) {
+            case WDXS_LZ4_TOKEN:
+                wdxsDecCb.litLen = b >> 4;
+                wdxsDecCb.matchLen = b & 0x0F;
+                if(wdxsDecCb.litLen == 15) {
+                    wdxsDecCb.state = WDXS_LZ4_LIT_LEN;
+                } else if(wdxsDecCb.litLen) {
+                    wdxsDecCb.state = WDXS_LZ4_LIT;
+                } else {
+                    wdxsDecCb.state = WDXS_LZ4_OFFSET_LO;
+                }
+                break;
+
+            case WDXS_LZ4_LIT_LEN:
+                wdxsDecCb.litLen += b;
+                if(b != 255) {
+                    wdxsDecCb.state = WDXS_LZ4_LIT;
+                }
+                break;
+
+            case WDXS_LZ4_LIT:
+                err = wdxsDecWrite(&b, 1);
+                if(--wdxsDecCb.litLen == 0) {
+                    /* Final sequence carries literals only */
+                    wdxsDecCb.state = (wdxsDecCb.outPos == wdxsDecCb.outLen) ?
+                        WDXS_DEC_DONE : WDXS_LZ4_OFFSET_LO;
+                }
+                break;
+
+            case WDXS_LZ4_OFFSET_LO:
+                wdxsDecCb.offset = b;
+                wdxsDecCb.state = WDXS_LZ4_OFFSET_HI;
+                break;
+
+            case WDXS_LZ4_OFFSET_HI:
+                wdxsDecCb.offset |= (uint16_t)b << 8;
+                if(wdxsDecCb.matchLen == 15) {
+                    wdxsDecCb.state = WDXS_LZ4_MATCH_LEN;
+                } else {
+                    err = wdxsLz4Match();
+                    wdxsDecCb.state = WDXS_LZ4_TOKEN;
+                }
+                break;
+
+            case WDXS_LZ4_MATCH_LEN:
+                wdxsDecCb.matchLen += b;
+                if(b != 255) {
+                    err = wdxsLz4Match();
+                    wdxsDecCb.state = WDXS_LZ4_TOKEN;
+                }
+                break;
+
+            case WDXS_DEC_DONE:
+            default:
+                /* Trailing data */
+                err = WSF_EFS_FAILURE;
+                break;
+        }
+    }
+
+    return wdxsDecComplete(err);
+}
+#endif /* WDXS_FILE_LZ4 */
+
+#if WDXS_FILE_DELTA
+/*************************************************************************************************/
+/*!
+ *  \brief  Execute a received delta operation.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDeltaOp(void)
+{
+    uint32_t srcOff;
+    uint32_t len;
+
+    if(wdxsDecCb.opBuf[0] == WDXS_DELTA_OP_COPY) {
+        BYTES_TO_UINT32(srcOff, &wdxsDecCb.opBuf[1]);
+        BYTES_TO_UINT32(len, &wdxsDecCb.opBuf[5]);
+
+        if((srcOff > wdxsDecCb.srcLen) || (len > (wdxsDecCb.srcLen - srcOff))) {
+            return WSF_EFS_FAILURE;
+        }
+
+        wdxsDecCb.state = WDXS_DELTA_OP;
+        return wdxsDecWrite((const uint8_t*)((uint32_t)&_text + srcOff), len);
+    }
+
+    /* WDXS_DELTA_OP_INSERT */
+    BYTES_TO_UINT32(wdxsDecCb.litLen, &wdxsDecCb.opBuf[1]);
+    wdxsDecCb.state = (wdxsDecCb.litLen > 0) ? WDXS_DELTA_INSERT : WDXS_DELTA_OP;
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Feed patch data to the delta decoder.
+ *
+ *  The patch rebuilds the new image from ranges of the running image and inserted literal data.
+ *
+ *  \param  pBuf     Patch data.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDeltaDecode(const uint8_t *pBuf, uint32_t size)
+{
+    uint8_t err = WSF_EFS_SUCCESS;
+    uint32_t len;
+
+    while(size && (err == WSF_EFS_SUCCESS)) {
+        switch(wdxsDecCb.state) {
+            case WDXS_DELTA_OP:
+                if(wdxsDecCb.opLen == 0) {
+                    if((*pBuf != WDXS_DELTA_OP_COPY) && (*pBuf != WDXS_DELTA_OP_INSERT)) {
+                        err = WSF_EFS_FAILURE;
+                        break;
+                    }
+                }
+
+                wdxsDecCb.opBuf[wdxsDecCb.opLen++] = *pBuf++;
+                size--;
+
+                if(wdxsDecCb.opLen == ((wdxsDecCb.opBuf[0] == WDXS_DELTA_OP_COPY) ? 9 : 5)) {
+                    wdxsDecCb.opLen = 0;
+                    err = wdxsDeltaOp();
+                }
+                break;
+
+            case WDXS_DELTA_INSERT:
+                len = (size < wdxsDecCb.litLen) ? size : wdxsDecCb.litLen;
+                err = wdxsDecWrite(pBuf, len);
+                pBuf += len;
+                size -= len;
+
+                if((wdxsDecCb.litLen -= len) == 0) {
+                    wdxsDecCb.state = WDXS_DELTA_OP;
+                }
+                break;
+
+            case WDXS_DEC_DONE:
+            default:
+                /* Trailing data */
+                err = WSF_EFS_FAILURE;
+                break;
+        }
+
+        if((err == WSF_EFS_SUCCESS) && (wdxsDecCb.outPos == wdxsDecCb.outLen)) {
+            wdxsDecCb.state = WDXS_DEC_DONE;
+        }
+    }
+
+    return wdxsDecComplete(err);
+}
+#endif /* WDXS_FILE_DELTA */
+
+#if WDXS_FILE_DECODE
+/*************************************************************************************************/
+/*!
+ *  \brief  Start decoding an upload if it begins with a recognized header.
+ *
+ *  \param  pBuf     First data written to the file.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsDecStart(const uint8_t *pBuf, uint32_t size)
+{
+    uint32_t magic;
+    uint32_t hdrLen;
+
+    wdxsDecCb.mode = WDXS_DEC_RAW;
+
+    if(size < 4) {
+        return WSF_EFS_SUCCESS;
+    }
+
+    BYTES_TO_UINT32(magic, pBuf);
+
+#if WDXS_FILE_LZ4
+    if((magic == WDXS_LZ4_MAGIC) && (size >= WDXS_LZ4_HDR_LEN)) {
+        memset(&wdxsDecCb, 0, sizeof(wdxsDecCb));
+        wdxsDecCb.mode = WDXS_DEC_LZ4;
+        wdxsDecCb.state = WDXS_LZ4_TOKEN;
+        hdrLen = WDXS_LZ4_HDR_LEN;
+    } else
+#endif
+#if WDXS_FILE_DELTA
+    if((magic == WDXS_DELTA_MAGIC) && (size >= WDXS_DELTA_HDR_LEN)) {
+        uint32_t srcCrc;
+        uint32_t crcResult = 0;
+
+        memset(&wdxsDecCb, 0, sizeof(wdxsDecCb));
+        wdxsDecCb.mode = WDXS_DEC_DELTA;
+        wdxsDecCb.state = WDXS_DELTA_OP;
+        hdrLen = WDXS_DELTA_HDR_LEN;
+
+        BYTES_TO_UINT32(wdxsDecCb.srcLen, &pBuf[8]);
+        BYTES_TO_UINT32(srcCrc, &pBuf[12]);
+
+        /* Patch must have been made against the running image */
+        if(wdxsDecCb.srcLen <= (WDXS_FileMedia.startAddress - (uint32_t)&_text)) {
+            crc32((const void*)&_text, wdxsDecCb.srcLen, &crcResult);
+        }
+
+        if(crcResult != srcCrc) {
+            APP_TRACE_INFO2("Delta source mismatch, CRC: 0x%08X expected: 0x%08X", crcResult, srcCrc);
+            wdxsDecCb.state = WDXS_DEC_ERROR;
+            return WSF_EFS_FAILURE;
+        }
+    } else
+#endif
+    {
+        return WSF_EFS_SUCCESS;
+    }
+
+    wdxsDecCb.inPos = size;
+    BYTES_TO_UINT32(wdxsDecCb.outLen, &pBuf[4]);
+
+    APP_TRACE_INFO2("Decoding upload, format: %d len: 0x%08X", wdxsDecCb.mode, wdxsDecCb.outLen);
+
+    if((wdxsDecCb.outLen <= 4) ||
+       (wdxsDecCb.outLen > (WDXS_FileMedia.endAddress - WDXS_FileMedia.startAddress))) {
+        wdxsDecCb.state = WDXS_DEC_ERROR;
+        return WSF_EFS_FAILURE;
+    }
+
+#if WDXS_FILE_LZ4
+    if(wdxsDecCb.mode == WDXS_DEC_LZ4) {
+        return wdxsLz4Decode(pBuf + hdrLen, size - hdrLen);
+    }
+#endif
+#if WDXS_FILE_DELTA
+    if(wdxsDecCb.mode == WDXS_DEC_DELTA) {
+        return wdxsDeltaDecode(pBuf + hdrLen, size - hdrLen);
+    }
+#endif
+
+    return WSF_EFS_SUCCESS;
+}
+#endif /* WDXS_FILE_DECODE */
+
+#if WDXS_FILE_AB_SLOTS
+/*************************************************************************************************/
+/*!
+ *  \brief  Copy a flash region into the inactive bank.
+ *
+ *  \param  pDst     Page aligned destination in the inactive bank.
+ *  \param  pSrc     Source in the running bank.
+ *  \param  size     Number of bytes, multiple of the page size.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsSlotCopy(uint8_t *pDst, const uint8_t *pSrc, uint32_t size)
+{
+    uint32_t buf[WDXS_SLOT_COPY_LEN / 4];
+    uint32_t i;
+
+    /* Skip when already identical, e.g. an unchanged bootloader */
+    if(memcmp(pDst, pSrc, size) == 0) {
+        return WSF_EFS_SUCCESS;
+    }
+
+    if(wdxsFileErase(pDst, size) != WSF_EFS_SUCCESS) {
+        return WSF_EFS_FAILURE;
+    }
+
+    for(i = 0; i < size; i += WDXS_SLOT_COPY_LEN) {
+        memcpy(buf, pSrc + i, WDXS_SLOT_COPY_LEN);
+        if(FlashSchedWrite((uint32_t)(pDst + i), buf, WDXS_SLOT_COPY_LEN, NULL) != E_NO_ERROR) {
+            return WSF_EFS_FAILURE;
+        }
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Make the verified image in the inactive slot bootable.
+ *
+ *  \param  length   Image length.
+ *  \param  crc      Image CRC32.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsSlotActivate(uint32_t length, uint32_t crc)
+{
+    uint32_t hdr[4];
+    uint32_t nvmLen = (uint32_t)&__pal_nvm_db_end__ - (uint32_t)&__pal_nvm_db_start__;
+
+    /* The inactive bank must boot on its own and keep the bonds */
+    if((wdxsSlotCopy((uint8_t*)&_flash_update, (const uint8_t*)&_boot,
+                     (uint32_t)&_text - (uint32_t)&_boot) != WSF_EFS_SUCCESS) ||
+       (wdxsSlotCopy((uint8_t*)&__pal_nvm_db_start__ + MXC_FLASH_MEM_SIZE,
+                     (const uint8_t*)&__pal_nvm_db_start__, nvmLen) != WSF_EFS_SUCCESS)) {
+        APP_TRACE_ERR0("Slot activation copy failed");
+        return WSF_EFS_FAILURE;
+    }
+
+    hdr[0] = WDXS_SLOT_MAGIC;
+    hdr[1] = (WDXS_SLOT_HDR->magic == WDXS_SLOT_MAGIC) ? (WDXS_SLOT_HDR->version + 1) : 1;
+    hdr[2] = length;
+    hdr[3] = crc;
+
+    if(FlashSchedWrite((uint32_t)&WDXS_SLOT_HDR_UPDATE->magic, hdr, sizeof(hdr), NULL) != E_NO_ERROR) {
+        return WSF_EFS_FAILURE;
+    }
+
+    hdr[0] = WDXS_SLOT_ATTEMPTS;
+    hdr[1] = hdr[2] = hdr[3] = 0xFFFFFFFF;
+
+    if((FlashSchedWrite((uint32_t)&WDXS_SLOT_HDR_UPDATE->attempts, hdr, sizeof(hdr), NULL) != E_NO_ERROR) ||
+       (FlashSchedFlush() != E_NO_ERROR)) {
+        return WSF_EFS_FAILURE;
+    }
+
+    APP_TRACE_INFO2("Slot activated, version: %d len: 0x%08X", WDXS_SLOT_HDR_UPDATE->version, length);
+
+    return WSF_EFS_SUCCESS;
+}
+
+/*************************************************************************************************/
+/*!
+ *  \brief  Confirm the running slot so the bootloader stops counting boot attempts.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+static void wdxsSlotConfirm(void)
+{
+    uint32_t word[4] = {0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+
+    if((WDXS_SLOT_HDR->magic == WDXS_SLOT_MAGIC) && (WDXS_SLOT_HDR->confirmed != 0)) {
+        FlashSchedWrite((uint32_t)&WDXS_SLOT_HDR->confirmed, word, sizeof(word), NULL);
+        APP_TRACE_INFO1("Slot version %d confirmed", WDXS_SLOT_HDR->version);
+    }
+}
+#endif /* WDXS_FILE_AB_SLOTS */
+
+#if WDXS_FILE_SIGNED
+/*************************************************************************************************/
+/*!
+ *  \brief  Keep the bootloader from running a received image that was rejected.
+ *
+ *  A slot-aware bootloader needs the inactive slot header, the copying bootloader only checks
+ *  the image CRC32. The erase is flushed before returning, ahead of any reset the peer requests.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsUpdateInvalidate(void)
+{
+#if WDXS_FILE_AB_SLOTS
+    uint8_t *pAddress = (uint8_t*)WDXS_SLOT_HDR_UPDATE;
+#else
+    uint8_t *pAddress = (uint8_t*)WDXS_FileMedia.startAddress;
+#endif
+
+    if((wdxsFileErase(pAddress, MXC_FLASH_PAGE_SIZE) != WSF_EFS_SUCCESS) ||
+       (FlashSchedFlush() != E_NO_ERROR)) {
+        APP_TRACE_ERR0("Rejected update could not be invalidated");
+        return WSF_EFS_FAILURE;
+    }
+
+    return WSF_EFS_SUCCESS;
+}
+#endif /* WDXS_FILE_SIGNED */
+
+/*************************************************************************************************/
+/*!
+ *  \brief  File Write function.
+ *
+ *  An upload that begins with a WDXZ or WDXP header at the start of the file is decoded into
+ *  flash as it arrives. WDXZ carries an LZ4 block. WDXP carries a delta patch against the
+ *  running image. Decoded data has the same layout as a raw upload, the image followed by its
+ *  CRC32.
+ *
+ *  \param  pBuf     Buffer with data to be written.
+ *  \param  address  Address in media to write to.
+ *  \param  size     Size of pBuf in bytes.
+ *
+ *  \return Status of the operation.
+ */
+/*************************************************************************************************/
+static uint8_t wdxsFileWrite(const uint8_t *pBuf, uint8_t *pAddress, uint32_t size)
+{
+    uint32_t offset = (uint32_t)pAddress - WDXS_FileMedia.startAddress;
+
+    /* Start of a new upload */
+    if(offset == 0) {
+#if WDXS_FILE_AB_SLOTS
+        /* Inactive slot is not bootable until the new image is verified */
+        if(wdxsFileErase((uint8_t*)WDXS_SLOT_HDR_UPDATE, MXC_FLASH_PAGE_SIZE) != WSF_EFS_SUCCESS) {
+            return WSF_EFS_FAILURE;
+        }
+#endif
+
+#if WDXS_FILE_SIGNED
+        memset(&wdxsSigCb, 0, sizeof(wdxsSigCb));
+        wdxsSigCb.inOrder = TRUE;
+#endif
+
+#if WDXS_FILE_DECODE
+        {
+            uint8_t err = wdxsDecStart(pBuf, size);
+
+            if((err != WSF_EFS_SUCCESS) || (wdxsDecCb.mode != WDXS_DEC_RAW)) {
+                return err;
+            }
+        }
+#endif
+    }
+
+#if WDXS_FILE_DECODE
+    if(wdxsDecCb.mode != WDXS_DEC_RAW) {
+        /* Encoded data must arrive in order */
+        if((wdxsDecCb.state == WDXS_DEC_ERROR) || (offset != wdxsDecCb.inPos)) {
+            wdxsDecCb.state = WDXS_DEC_ERROR;
+            return WSF_EFS_FAILURE;
+        }
+
+        wdxsDecCb.inPos += size;
+
+#if WDXS_FILE_LZ4
+        if(wdxsDecCb.mode == WDXS_DEC_LZ4) {
+            return wdxsLz4Decode(pBuf, size);
+        }
+#endif
+#if WDXS_FILE_DELTA
+        if(wdxsDecCb.mode == WDXS_DEC_DELTA) {
+            return wdxsDeltaDecode(pBuf, size);
+        }
+#endif
+    }
+#endif /* WDXS_FILE_DECODE */
+
+    return wdxsFileProgram(pBuf, pAddress, size);
+}
+
 /* http://home.thep.lu.se/~bjorn/crc/ */
 /*************************************************************************************************/
 /*!
@@ -219,6 +1235,22 @@ static uint8_t wsfFileHandle(uint8_t cmd, uint32_t param)
             uint32_t crcResult = 0;
             uint32_t crcFile;
 
+            /* Everything queued must be in flash before it is checked */
+            if(FlashSchedFlush() != E_NO_ERROR) {
+                APP_TRACE_INFO0("Update file programming failure");
+                verifyLen = 0;
+                return WDX_FTC_ST_VERIFICATION;
+            }
+
+#if WDXS_FILE_DECODE
+            /* Encoded upload must have decoded completely */
+            if((wdxsDecCb.mode != WDXS_DEC_RAW) && (wdxsDecCb.state != WDXS_DEC_DONE)) {
+                APP_TRACE_INFO2("Upload decode incomplete: 0x%08X of 0x%08X", wdxsDecCb.outPos, wdxsDecCb.outLen);
+                verifyLen = 0;
+                return WDX_FTC_ST_VERIFICATION;
+            }
+#endif
+
             verifyLen = (uint32_t)lastWriteAddr - WDXS_FileMedia.startAddress;
 
             APP_TRACE_INFO2("CRC start addr: 0x%08X Len: 0x%08X", WDXS_FileMedia.startAddress, verifyLen);
@@ -235,6 +1267,21 @@ static uint8_t wsfFileHandle(uint8_t cmd, uint32_t param)
                 return WDX_FTC_ST_VERIFICATION;
             }
 
+#if WDXS_FILE_SIGNED
+            if(!wdxsSigVerify(verifyLen)) {
+                APP_TRACE_INFO0("Update file signature failure");
+                verifyLen = 0;
+                wdxsUpdateInvalidate();
+                return WDX_FTC_ST_VERIFICATION;
+            }
+#endif
+
+#if WDXS_FILE_AB_SLOTS
+            if(wdxsSlotActivate(verifyLen, crcFile) != WSF_EFS_SUCCESS) {
+                return WDX_FTC_ST_VERIFICATION;
+            }
+#endif
+
             return WDX_FTC_ST_SUCCESS;
         }
         break;
@@ -289,9 +1336,41 @@ void WdxsFileInit(void)
 
     /* Add a file for the stream */
     WsfEfsAddFile(WDXS_FileMedia.endAddress - WDXS_FileMedia.startAddress, WDX_FLASH_MEDIA, &attr, 0);
+
+#if WDXS_FILE_AB_SLOTS
+    /* Reaching init is a good enough boot to keep this slot */
+    wdxsSlotConfirm();
+#endif
 }
 
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Start erasing the update area ahead of a put, WDXS_FILE_PRE_ERASE_LEN bytes.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WdxsFilePreErase(void)
+{
+#if WDXS_FILE_PRE_ERASE_LEN
+    /* Leave an upload in progress or a received image alone */
+    if(wdxsEraseCb.written) {
+        return;
+    }
+
+#if WDXS_FILE_AB_SLOTS
+    /* Inactive slot is no longer bootable once its image is gone */
+    if(wdxsFileErase((uint8_t*)WDXS_SLOT_HDR_UPDATE, MXC_FLASH_PAGE_SIZE) != WSF_EFS_SUCCESS) {
+        return;
+    }
+#endif
+
+    wdxsEraseStart(0, WDXS_FileMedia.endAddress - WDXS_FileMedia.startAddress);
+    wdxsEraseTo(WDXS_FILE_PRE_ERASE_LEN);
+#endif
+}
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get the base address of the WDXS file.
@@ -31,6 +31,38 @@ extern "C" {
   Constant Definitions
 **************************************************************************************************/
 
+/*! \brief Slot header magic, "WDXA" */
+#define WDXS_SLOT_MAGIC           0x41584457
+
+/**************************************************************************************************
+  Data Types
+**************************************************************************************************/
+
+/*! \brief A/B slot header.
+ *
+ *  Each flash bank holds the bootloader, an image, this header and NVM at the same offsets. The
+ *  header sits in the page that follows the image area. Each 128-bit flash word is programmed
+ *  separately: the image word when the image is activated, then one attempts bit per boot, then
+ *  the confirmation.
+ *
+ *  At reset the bootloader checks each bank. A slot is bootable if its magic and image CRC32 are
+ *  valid, and it is either confirmed or has attempts bits left. The bootloader picks the bootable
+ *  slot with the highest version. For an unconfirmed slot it clears one attempts bit. It then sets
+ *  the flash page flip if that slot is in the second bank, and jumps to the image. No image is
+ *  copied. A slot that never confirms runs out of attempts, and the previous slot boots again.
+ */
+typedef struct
+{
+    uint32_t  magic;                  /*!< \brief WDXS_SLOT_MAGIC */
+    uint32_t  version;                /*!< \brief Slot sequence number, highest boots first */
+    uint32_t  length;                 /*!< \brief Image length */
+    uint32_t  crc;                    /*!< \brief Image CRC32 */
+    uint32_t  attempts;               /*!< \brief Boot attempts left, one bit cleared per boot */
+    uint32_t  reserved0[3];
+    uint32_t  confirmed;              /*!< \brief Cleared by the image after a good boot */
+    uint32_t  reserved1[3];
+} wdxsSlotHdr_t;
+
 /**************************************************************************************************
   Function Declarations
 **************************************************************************************************/
@@ -44,6 +76,18 @@ extern "C" {
 /*************************************************************************************************/
 void WdxsFileInit(void);
 
+/*************************************************************************************************/
+/*!
+ *  \brief  Start erasing the update area ahead of a put, WDXS_FILE_PRE_ERASE_LEN bytes.
+ *
+ *  Call when a client subscribes to file transfer control. Does nothing once update data
+ *  was received since boot.
+ *
+ *  \return None.
+ */
+/*************************************************************************************************/
+void WdxsFilePreErase(void);
+
 /*************************************************************************************************/
 /*!
  *  \brief  Get the base address of the WDXS file.